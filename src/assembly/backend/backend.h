@@ -30,6 +30,7 @@ public:
     virtual Reg cgstorsym(Reg r, Symbol identifier, PrimitiveType type) = 0;
     virtual void cglocalsym(Symbol sym) = 0;
     virtual void cgglobsym(Symbol sym, std::shared_ptr<ArrayInitializer> init = nullptr) = 0;
+    virtual void cgglobvalue(Symbol sym, Value value) = 0; // 初值在编译期已知的标量全局变量
     virtual void freereg(Reg reg) = 0;
     virtual Reg cgcompare(Reg r1, Reg r2, const char *op) = 0;
     virtual Reg cgequal(Reg r1, Reg r2) = 0;
@@ -47,8 +48,23 @@ public:
     virtual void cglessequaljump(Reg r1, Reg r2, const char *label) = 0;
     virtual void cglessthanjump(Reg r1, Reg r2, const char *label) = 0;
     virtual void cggreaterthanjump(Reg r1, Reg r2, const char *label) = 0;
+    virtual Reg cgcompareop(const Operand &left, const Operand &right, PrimitiveType type, ExprType op) = 0; // 0/1 result of the signed comparison "left op right"; left is not an immediate
+    virtual void cgcompareopjump(const Operand &left, const Operand &right, PrimitiveType type, ExprType op, const char *label) = 0; // Jump to label when "left op right" is false
+    virtual void cgcmov(const Operand &left, const Operand &right, PrimitiveType type, ExprType op, const Operand &src, const Operand &dst, PrimitiveType value_type) = 0; // Compare, then copy src to dst when "left op right"; dst is a REG or a SYM kept in a register and stays live
+    virtual Reg cgfloatmask(Reg left, Reg right, ExprType op) = 0; // All ones when the float comparison "left op right" holds, zero otherwise
+    virtual Reg cgfloatblend(Reg mask, Reg if_true, Reg if_false) = 0; // Pick if_true where mask is set and if_false elsewhere
+    virtual Reg cgfloatminmax(Reg reg, const Operand &src, bool max) = 0; // reg = min or max of reg and src; src when either is NaN
+    virtual void cgtestjump(Reg reg, const char *label) = 0; // Jump to label when reg is zero
+    virtual void cgzerojump(Reg reg, const char *label) = 0; // Jump to label when the integer op that produced reg gave zero, reusing its flags
+    virtual void cgtestnonzerojump(Reg reg, const char *label) = 0; // Jump to label when reg is not zero
+    virtual void cgnonzerojump(Reg reg, const char *label) = 0; // Like cgzerojump, but jump when the result was not zero
+    virtual void cgswitchcompare(Reg reg, long value, const char *equal_label, const char *less_label) = 0; // Compare once, jump on == and (if less_label) on <; reg stays live
+    virtual void cgjumptable(Reg reg, long low, const std::vector<std::string> &targets, const char *default_label) = 0; // Indirect jump to targets[reg - low], default_label when out of range; clobbers reg
+    virtual void cgbittest(Reg reg, long low, long high, const std::vector<std::pair<std::string, unsigned long>> &masks, const char *default_label) = 0; // Jump to the target whose mask has bit reg - low; clobbers reg
     virtual void cgfuncpreamble(Function func) = 0;
     virtual void cgfuncpostamble(Function func, const char *label) = 0;
+    virtual void cgprologue() = 0; // Mark where the frame is set up, code before it runs without one
+    virtual void cgtailcall(Function func, const char *name) = 0; // Tear down the frame and jump to name, which returns to our caller
     virtual Reg cgint2char(Reg reg) = 0;
     virtual Reg cgchar2int(Reg reg) = 0;
     virtual Reg cgfloat2int(Reg reg) = 0;
@@ -63,9 +79,19 @@ public:
     virtual Reg cgchar2long(Reg reg) = 0;
     virtual Reg cgcall(const char *name, PrimitiveType ret_type) = 0;
     virtual void cgreturn(Reg reg, const char *end_label) = 0;
+    virtual void cgframelessreturn(Reg reg) = 0; // Return before the prologue has set up the frame
     virtual Reg cgaddress(Symbol identifier) = 0;
     virtual Reg cgderef(Reg reg, PrimitiveType type) = 0;
+    virtual Reg cgloadop(const Operand &src, PrimitiveType type, PrimitiveType to) = 0; // Load src of the given type into a new register, extending it to the wider type to
+    virtual void cgstoreop(const Operand &src, const Operand &dst, PrimitiveType type) = 0; // Store a REG or IMM operand to a SYM or MEM operand; a REG source stays live
+    virtual Reg cgarith(ExprType op, Reg reg, const Operand &src) = 0; // reg = reg op src for +, -, *, &, |, ^, shifts by an immediate, and float /
+    virtual Reg cglea(const Operand &addr, PrimitiveType type) = 0; // Compute base + index * scale + disp of a MEM operand with one lea
+    virtual void cgincop(const Operand &dst, PrimitiveType type, long delta) = 0; // Add delta to the int, char, long or pointer at dst
+    virtual void cgupdateop(ExprType op, const Operand &dst, const Operand &src, PrimitiveType type) = 0; // dst = dst op src for integer +, -, &, |, ^ without loading dst
     virtual Reg cgshlconst(Reg reg, int value) = 0;
+    virtual Reg cgmulconst(Reg reg, long value) = 0;
+    virtual Reg cgdivconst(Reg reg, long value) = 0;
+    virtual Reg cgmodconst(Reg reg, long value) = 0;
     virtual Reg cgstorderef(Reg reg, Reg addr, PrimitiveType type) = 0;
     virtual void cginc(Symbol identifier, PrimitiveType type) = 0;
     virtual void cgdec(Symbol identifier, PrimitiveType type) = 0;
@@ -83,8 +109,24 @@ public:
     virtual void cgloadparamtostack(Reg reg) = 0;
     virtual void cgloadparamtoreg(Reg reg, int idx) = 0;
     virtual void cglocalarrayzeroinit(int base, int left_size, int current_size, int elem_size) = 0;
-    virtual std::vector<Reg> cgprotectscene() = 0; // Protect the scene before generating code for the function call
-    virtual void cgrestorescene(const std::vector<Reg> &protected_regs) = 0; // Restore the protected registers from the stack
+    virtual void cglocalarraycopy(int base, const std::vector<unsigned char> &image) = 0; // Initialize a local array from its constant image
+    virtual std::vector<Reg> cgprotectscene(const std::vector<Reg> &live_params) = 0; // Save the values a call would clobber
+    virtual void cgrestorescene(const std::vector<Reg> &protected_regs) = 0; // Restore the saved values after the call
+    virtual Reg cgcalleesaved(Reg reg) = 0; // Move a value that has to survive a call into a callee-saved register
     virtual Reg cgmod(Reg reg1, Reg reg2) = 0; // Generate code for modulo operation
+    virtual Reg cgvload(Reg addr, PrimitiveType type) = 0; // Load a vector of array elements
+    virtual void cgvstore(Reg reg, Reg addr, PrimitiveType type) = 0; // Store a vector of array elements
+    virtual Reg cgvbroadcast(Reg reg, PrimitiveType type) = 0; // Copy a scalar into every lane of a vector
+    virtual Reg cgvadd(Reg reg1, Reg reg2, PrimitiveType type) = 0;
+    virtual Reg cgvsub(Reg reg1, Reg reg2, PrimitiveType type) = 0;
+    virtual Reg cgvmul(Reg reg1, Reg reg2, PrimitiveType type) = 0;
+    virtual Reg cgvdiv(Reg reg1, Reg reg2, PrimitiveType type) = 0;
+    virtual void cgoverlapjump(Reg diff, long bytes, const char *label) = 0; // Jump if two arrays are closer than bytes
+    virtual void cgvzeroupper() = 0; // Leave the vector loop
+    virtual void cgalignloop() = 0; // Align the head of a hot loop
+    virtual void cgcoldsection() = 0; // Code up to cgendcoldsection goes to .text.unlikely
+    virtual void cgendcoldsection() = 0;
+    virtual void cgprofilecounter(int index) = 0; // Increment __profile_counters[index]
+    virtual void cgprofiledata(long counters, long checksum) = 0; // Define the counters and the layout checksum for the profile runtime
 };
 
@@ -1,5 +1,10 @@
 #include "common/defs.h"
 #include "assembly/backend/backend.h"
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <sstream>
+#include <algorithm>
 #pragma once
 class X86RegisterManager: public RegisterManager {
     public:
@@ -19,9 +24,40 @@ class X86RegisterManager: public RegisterManager {
 
         // Allocate a register
         Reg allocateRegister(PrimitiveType type) override {
+            return allocateFrom(type, 0);
+        }
+
+        // 在被调用者保存的 r12/r13 中分配，都被占用时返回 P_NONE
+        Reg allocateCalleeSaved(PrimitiveType type) {
+            auto& allocated = type_to_register_status.at(type);
+            for (size_t i = first_callee_saved; i < allocated.size(); ++i) {
+                if (!allocated[i]) return allocateFrom(type, i);
+            }
+            return Reg{P_NONE, false, -1};
+        }
+
+        // r12/r13 由被调用者保存，跨调用不会被破坏；函数用到时在序言中保存一次
+        bool isCalleeSaved(Reg reg) const {
+            return reg.type != P_FLOAT && reg.idx >= (int)first_callee_saved;
+        }
+
+        // 当前函数用到过的被调用者保存寄存器
+        std::vector<std::string> getUsedCalleeSaved() const {
+            std::vector<std::string> ret;
+            for (size_t i = first_callee_saved; i < registers_long.size(); ++i) {
+                if (used_callee_saved[i]) ret.push_back(registers_long[i]);
+            }
+            return ret;
+        }
+
+        void resetUsedCalleeSaved() {
+            used_callee_saved.assign(registers_long.size(), false);
+        }
+
+        Reg allocateFrom(PrimitiveType type, size_t first) {
             auto& allocated = type_to_register_status.at(type);
             int idx = -1;
-            for (size_t i = 0; i < allocated.size(); ++i) {
+            for (size_t i = first; i < allocated.size(); ++i) {
                 if (!allocated[i]) { // Find a free register
                     allocated[i] = true; // Mark the register as allocated
                     idx = i;
@@ -37,6 +73,7 @@ class X86RegisterManager: public RegisterManager {
                     auto& allocated_other = type_to_register_status.at(valid_type);
                     allocated_other[idx] = true;
                 }
+                if (idx >= (int)first_callee_saved) used_callee_saved[idx] = true;
                 return Reg{type, false, idx}; // Return the allocated register
             } else if (type == P_FLOAT) {
                 allocated[idx] = true; // Mark the register as allocated
@@ -184,6 +221,8 @@ class X86RegisterManager: public RegisterManager {
         const std::vector<std::string> registers_char = { "%r10b", "%r11b", "%r12b", "%r13b" };
         const std::vector<std::string> registers_long = { "%r10", "%r11", "%r12", "%r13" }; // Long registers for 64-bit operations
         const std::vector<std::string> registers_float = { "%xmm8", "%xmm9", "%xmm10", "%xmm11" }; // Floating-point registers
+        const size_t first_callee_saved = 2; // %r12 and %r13 are callee-saved
+        std::vector<bool> used_callee_saved = std::vector<bool>(4, false);
 
         const std::vector<std::string> registers_float_param = { "%xmm0", "%xmm1", "%xmm2", "%xmm3", "%xmm4", "%xmm5", "%xmm6", "%xmm7" }; // Floating-point registers for function parameters
         const std::vector<std::string> registers_int_param = { "%edi", "%esi", "%edx", "%ecx", "%r8d", "%r9d" }; // Integer registers for function parameters
@@ -199,9 +238,9 @@ class X86RegisterManager: public RegisterManager {
 
 class X86AssemblyCode : public AssemblyCode {
 public:
-    X86AssemblyCode(const std::string &outputFileName): outputFile(outputFileName, std::ios::out),
+    X86AssemblyCode(const std::string &outputFileName): file(outputFileName, std::ios::out), outputFile(file.rdbuf()),
       regManager(std::make_unique<X86RegisterManager>()) {
-        if (!outputFile.is_open()) {
+        if (!file.is_open()) {
             throw std::runtime_error("Could not open output file: " + outputFileName);
         }
       }
@@ -346,15 +385,16 @@ public:
         switch (reg1.type) {
             case P_INT:
                 outputFile << "\tmovl\t" << regManager->getRegister(reg1) << ", %eax\n"; // Move reg1 to eax
-                outputFile << "\tcqto\n"; // Sign-extend eax to rdx:rax
+                outputFile << "\tcltd\n"; // Sign-extend eax to edx:eax
                 outputFile << "\tidivl\t" << regManager->getRegister(reg2) << "\n"; // Divide rdx:rax by reg2
                 outputFile << "\tmovl\t%eax, " << regManager->getRegister(reg1) << "\n"; // Move result back to reg1
                 regManager->freeRegister(reg2);
                 break;
             case P_CHAR:
-                outputFile << "\tmovb\t" << regManager->getRegisterLower8bit(reg1) << ", %al\n"; // Move reg1 to al
-                outputFile << "\tcqto\n"; // Sign-extend al to rdx:rax
-                outputFile << "\tidivb\t" << regManager->getRegisterLower8bit(reg2) << "\n"; // Divide rdx:rax by reg2
+                outputFile << "\tmovsbl\t" << regManager->getRegisterLower8bit(reg1) << ", %eax\n"; // Promote reg1 to int in eax
+                outputFile << "\tmovsbl\t" << regManager->getRegisterLower8bit(reg2) << ", %ecx\n"; // Promote reg2 to int in ecx
+                outputFile << "\tcltd\n"; // Sign-extend eax to edx:eax
+                outputFile << "\tidivl\t%ecx\n"; // Divide edx:eax by ecx
                 outputFile << "\tmovb\t%al, " << regManager->getRegisterLower8bit(reg1) << "\n"; // Move result back to reg1
                 regManager->freeRegister(reg2);
                 break;
@@ -383,15 +423,16 @@ public:
         switch (reg1.type) {
             case P_INT:
                 outputFile << "\tmovl\t" << regManager->getRegister(reg1) << ", %eax\n"; // Move reg1 to eax
-                outputFile << "\tcqto\n"; // Sign-extend eax to rdx:rax
+                outputFile << "\tcltd\n"; // Sign-extend eax to edx:eax
                 outputFile << "\tidivl\t" << regManager->getRegister(reg2) << "\n"; // Divide rdx:rax by reg2
                 outputFile << "\tmovl\t%edx, " << regManager->getRegister(reg1) << "\n"; // Move remainder to reg1
                 regManager->freeRegister(reg2);
                 break;
             case P_CHAR:
-                outputFile << "\tmovb\t" << regManager->getRegisterLower8bit(reg1) << ", %al\n"; // Move reg1 to al
-                outputFile << "\tcqto\n"; // Sign-extend al to rdx:rax
-                outputFile << "\tidivb\t" << regManager->getRegisterLower8bit(reg2) << "\n"; // Divide rdx:rax by reg2
+                outputFile << "\tmovsbl\t" << regManager->getRegisterLower8bit(reg1) << ", %eax\n"; // Promote reg1 to int in eax
+                outputFile << "\tmovsbl\t" << regManager->getRegisterLower8bit(reg2) << ", %ecx\n"; // Promote reg2 to int in ecx
+                outputFile << "\tcltd\n"; // Sign-extend eax to edx:eax
+                outputFile << "\tidivl\t%ecx\n"; // Divide edx:eax by ecx
                 outputFile << "\tmovb\t%dl, " << regManager->getRegisterLower8bit(reg1) << "\n"; // Move remainder to reg1
                 regManager->freeRegister(reg2);
                 break;
@@ -425,8 +466,11 @@ public:
     void cgfloatconst() {
         outputFile << ".section\t.data\n";
         for (auto & [value, name] : float_constants) {
+            // 按位写出，优化器折叠出来的常量不会因为十进制输出的精度而改变
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
             outputFile << name << ":\n";
-            outputFile << "\t.double\t" << value << "\n"; // Store float as int
+            outputFile << "\t.quad\t" << bits << "\t# " << value << "\n";
         }
     }
     void cgstringconst() {
@@ -454,7 +498,7 @@ public:
         if (is_pointer(type)) type = P_LONG; // Treat pointers as long for loading
         // Load the value of the global variable into a register
         Reg reg = regManager->allocateRegister(type);
-        std::string addr = identifier.getAddress(); // Get the address of the global variable
+        std::string addr = symbolAddress(identifier); // Get the address of the global variable
         if (type == P_INT) {
             outputFile <<
                 "\tmovl\t" << addr << ", " << regManager->getRegister(reg) << "\n";
@@ -479,7 +523,7 @@ public:
 
     Reg cgstorsym(Reg r, Symbol identifer, PrimitiveType type) override {
         type = is_pointer(type) ? P_LONG : type; // Treat pointers as long for storing
-        std::string addr = identifer.getAddress();
+        std::string addr = symbolAddress(identifer);
         auto getRegister = [this] (Reg reg) {
             if (reg.is_param) {
                 return regManager->getParamRegister(reg);
@@ -487,6 +531,7 @@ public:
                 return regManager->getRegister(reg);
             }
         };
+        if (addr == getRegister(r)) return r; // The variable already lives in this register
         if (type == P_INT) {
             outputFile <<
             "\tmovl\t" << getRegister(r) << ", " << addr << "\n";
@@ -515,36 +560,40 @@ public:
         return;
     }
 
+    // 没有初值的全局变量放在.bss，由加载器清零，不占目标文件的空间
     void cgglobsym(Symbol sym, std::shared_ptr<ArrayInitializer> init = nullptr) override {
-        outputFile <<
-            "\t.data\n\t.globl\t" <<sym.name << "\n" << sym.name << ":\t" ; // Declare a global symbol
-        switch (sym.type) {
-            case P_INT:
-                outputFile << "\t.long\t0\n"; // Initialize int global variable to 0
-                break;
-            case P_CHAR:
-                outputFile << "\t.byte\t0\n"; // Initialize char global variable to 0
-                break;
-            case P_FLOAT:
-                outputFile << "\t.double\t0.0\n"; // Initialize float global variable to 0.0
-                break;
-            case P_LONG:
-                outputFile << "\t.quad\t0\n"; // Initialize long global variable to 0
-                break;
-            case P_INTPTR : case P_FLOATPTR : case P_CHARPTR : case P_LONGPTR : case P_VOIDPTR:
-                outputFile << "\t.quad\t0\n"; // Initialize pointer global variable to 0
-                break;
-            case P_INTARR : case P_FLOATARR : case P_CHARARR : case P_LONGARR:
-                if (init != nullptr) cgglobarray(sym, init);
-                else {
-                    outputFile << "\t.zero\t" << sym.size << "\n"; // Initialize array global variable to 0
-                }
+        if (init == nullptr) {
+            outputFile << "\t.bss\n";
+            cgglobheader(sym);
+            outputFile << "\t.zero\t" << sym.size << "\n";
+            return;
+        }
+        outputFile << "\t.data\n";
+        cgglobheader(sym);
+        cgglobarray(sym, init);
+    }
+
+    void cgglobvalue(Symbol sym, Value value) override {
+        bool zero = value.type == P_LONG ? value.lvalue == 0 : value.type == P_FLOAT ? value.fvalue == 0.0 && !std::signbit(value.fvalue) : value.ivalue == 0;
+        if (zero) return cgglobsym(sym);
+        outputFile << "\t.data\n";
+        cgglobheader(sym);
+        switch (value.type) {
+            case P_CHAR: outputFile << "\t.byte\t" << value.ivalue << "\n"; break;
+            case P_INT: outputFile << "\t.long\t" << value.ivalue << "\n"; break;
+            case P_LONG: outputFile << "\t.quad\t" << value.lvalue << "\n"; break;
+            case P_FLOAT: {
+                // 按位模式输出，十进制打印会丢失精度
+                uint64_t bits;
+                std::memcpy(&bits, &value.fvalue, sizeof(bits));
+                outputFile << "\t.quad\t" << bits << "\t# " << value.fvalue << "\n";
                 break;
+            }
             default:
-                throw std::runtime_error("GenCode::cgglobsym: Unsupported type for global symbol");
+                throw std::runtime_error("GenCode::cgglobvalue: Unsupported type for global value");
         }
-       
     }
+
     void freereg(Reg reg) override {
         regManager->freeRegister(reg); // Free the specified register
     }
@@ -558,22 +607,18 @@ public:
             case P_LONG:
 
                 outputFile <<
-                    "\tcmpq\t" << regManager->getRegister(r2) << ", " << regManager->getRegister(r1) << "\n"
-                    "\t" << op << "\t" << regManager->getRegisterLower8bit(r2) << "\n"
-                    "\tmovzbq\t" << regManager->getRegisterLower8bit(r2) << ", " << regManager->getRegister(r2) << "\n"; 
+                    "\tcmpq\t" << regManager->getRegister(r2) << ", " << regManager->getRegister(r1) << "\n";
                 regManager->freeRegister(r1);
-                return r2; // Return the register containing the result
+                return setFlagResult(r2, op);
 
             case P_CHAR:
             case P_INT:
-                r3 = regManager->allocateRegister(P_LONG); // Allocate a new register for the result
+                // 结果写到r2的低8位再零扩展，不需要再分配寄存器
                 outputFile <<
-                    "\tcmpq\t" << regManager->getRegister(r2) << ", " << regManager->getRegister(r1) << "\n"
-                    "\t" << op << "\t" << regManager->getRegisterLower8bit(r3) << "\n"
-                    "\tmovzbq\t" << regManager->getRegisterLower8bit(r3) << ", " << regManager->getRegister(r3) << "\n"; 
+                    "\tcmp" << widthSuffix(r1.type) << "\t" << regManager->getRegister(r2) << ", " << regManager->getRegister(r1) << "\n";
                 regManager->freeRegister(r1);
-                regManager->freeRegister(r2);
-                return r3; // Return the register containing the result
+                r2.type = P_LONG;
+                return setFlagResult(r2, op);
             case P_FLOAT:
                 // 用整型寄存器存储结果
                 r3 = regManager->allocateRegister(P_LONG);
@@ -590,6 +635,171 @@ public:
         return Reg{.type = P_NONE, .idx = 0}; // Return an invalid register if comparison fails
     }
 
+    // 按比较结果的标志位生成0/1：movzbl 写32位寄存器时高32位自动清零
+    Reg setFlagResult(Reg reg, const char *op) {
+        outputFile <<
+            "\t" << op << "\t" << regManager->getRegisterLower8bit(reg) << "\n"
+            "\tmovzbl\t" << regManager->getRegisterLower8bit(reg) << ", " << regManager->getRegister(Reg{.type = P_INT, .idx = reg.idx}) << "\n";
+        reg.type = P_LONG;
+        return reg;
+    }
+
+    // 和立即数比较，与0比较时用 test。int 和 long 的比较都是有符号的
+    void cmpimm(Reg reg, long value) {
+        std::string r = regManager->getRegister(reg);
+        if (value == 0) outputFile << "\ttest" << widthSuffix(reg.type) << "\t" << r << ", " << r << "\n";
+        else outputFile << "\tcmp" << widthSuffix(reg.type) << "\t$" << value << ", " << r << "\n";
+    }
+
+    // 比较两个操作数后释放它们的寄存器。cmp 最多有一个内存操作数，两边都在内存中时先把左边装入寄存器；
+    // 和0比较且左边在寄存器中时用 test
+    void cmpop(Operand left, Operand right, PrimitiveType type) {
+        if (inMemory(left) && inMemory(right)) left = registerOperand(cgloadop(left, type, type));
+        std::string l = operandText(left, type);
+        std::string r = operandText(right, type);
+        if (right.kind == Operand::IMM && right.value == 0 && !inMemory(left)) {
+            outputFile << "\ttest" << widthSuffix(type) << "\t" << l << ", " << l << "\n";
+        } else {
+            outputFile << "\tcmp" << widthSuffix(type) << "\t" << r << ", " << l << "\n";
+        }
+        releaseOperand(left);
+        releaseOperand(right);
+    }
+
+    Reg cgcompareop(const Operand &left, const Operand &right, PrimitiveType type, ExprType op) override {
+        cmpop(left, right, type);
+        // 左边的寄存器已经释放，setcc 不改变标志位，可以直接复用
+        return setFlagResult(regManager->allocateRegister(P_LONG), conditionSet(op));
+    }
+
+    void cgcompareopjump(const Operand &left, const Operand &right, PrimitiveType type, ExprType op, const char *label) override {
+        cmpop(left, right, type);
+        outputFile << "\t" << conditionJump(op, false) << "\t" << label << "\n";
+    }
+
+    // cmov 只有寄存器目标，没有8位的形式；src 可以在内存中，无论条件是否成立都会被读取
+    void cgcmov(const Operand &left, const Operand &right, PrimitiveType type, ExprType op, const Operand &src, const Operand &dst, PrimitiveType value_type) override {
+        if (value_type != P_INT && value_type != P_LONG) throw std::runtime_error("GenCode::cgcmov: Unsupported type for conditional move");
+        Operand s = src, d = dst;
+        cmpop(left, right, type);
+        std::string from = operandText(s, value_type);
+        std::string to = operandText(d, value_type);
+        outputFile << "\t" << conditionMove(op) << "\t" << from << ", " << to << "\n";
+        releaseOperand(s);
+    }
+
+    // cmpsd 只有 eq/lt/le/neq 这些谓词，> 和 >= 交换两边。结果写在比较的目标寄存器中，
+    // 和 ucomisd 后的条件跳转一样，有 NaN 时只有 != 成立
+    Reg cgfloatmask(Reg left, Reg right, ExprType op) override {
+        const char *predicate;
+        switch (op) {
+            case A_EQ: predicate = "eq"; break;
+            case A_NE: predicate = "neq"; break;
+            case A_LT: predicate = "lt"; break;
+            case A_LE: predicate = "le"; break;
+            case A_GT: predicate = "lt"; std::swap(left, right); break;
+            case A_GE: predicate = "le"; std::swap(left, right); break;
+            default: throw std::runtime_error("GenCode::cgfloatmask: Unsupported comparison");
+        }
+        outputFile << "\tcmp" << predicate << "sd\t" << regManager->getRegister(right) << ", " << regManager->getRegister(left) << "\n";
+        regManager->freeRegister(right);
+        return left;
+    }
+
+    Reg cgfloatblend(Reg mask, Reg if_true, Reg if_false) override {
+        std::string m = regManager->getRegister(mask);
+        std::string t = regManager->getRegister(if_true);
+        outputFile <<
+            "\tandpd\t" << m << ", " << t << "\n"
+            "\tandnpd\t" << regManager->getRegister(if_false) << ", " << m << "\n"
+            "\torpd\t" << m << ", " << t << "\n";
+        regManager->freeRegister(mask);
+        regManager->freeRegister(if_false);
+        return if_true;
+    }
+
+    // minsd/maxsd 在两边相等或有 NaN 时都取第二个操作数 src
+    Reg cgfloatminmax(Reg reg, const Operand &src, bool max) override {
+        Operand s = src;
+        std::string text = operandText(s, P_FLOAT);
+        outputFile << "\t" << (max ? "maxsd" : "minsd") << "\t" << text << ", " << regManager->getRegister(reg) << "\n";
+        releaseOperand(s);
+        return reg;
+    }
+
+    // switch 的比较树：一次 cmp 之后按 == 和 < 各跳一次。放不进32位立即数的值先装入临时寄存器
+    void cgswitchcompare(Reg reg, long value, const char *equal_label, const char *less_label) override {
+        if (value >= INT32_MIN && value <= INT32_MAX) {
+            cmpimm(reg, value);
+        } else {
+            Reg tmp = regManager->allocateRegister(P_LONG);
+            outputFile << "\tmovabsq\t$" << value << ", " << regManager->getRegister(tmp) << "\n";
+            outputFile << "\tcmpq\t" << regManager->getRegister(tmp) << ", " << regManager->getRegister(reg) << "\n";
+            regManager->freeRegister(tmp);
+        }
+        outputFile << "\tje\t" << equal_label << "\n";
+        if (less_label != nullptr) outputFile << "\tjl\t" << less_label << "\n";
+    }
+
+    // 减去下界后一次无符号比较同时排除两边越界的值。表项是目标相对表头的32位偏移，
+    // 和代码的加载地址无关，表放在.rodata
+    void cgjumptable(Reg reg, long low, const std::vector<std::string> &targets, const char *default_label) override {
+        std::string r = regManager->getRegister(reg);
+        std::string table = "SWITCH_TABLE_" + labelAllocator.getLabel(SWITCH_LABEL);
+        if (low != 0) outputFile << "\tsubq\t$" << low << ", " << r << "\n";
+        outputFile << "\tcmpq\t$" << targets.size() - 1 << ", " << r << "\n";
+        outputFile << "\tja\t" << default_label << "\n";
+        Reg base = regManager->allocateRegister(P_LONG);
+        std::string b = regManager->getRegister(base);
+        outputFile << "\tleaq\t" << table << "(%rip), " << b << "\n";
+        outputFile << "\tmovslq\t(" << b << ", " << r << ", 4), " << r << "\n";
+        outputFile << "\taddq\t" << b << ", " << r << "\n";
+        outputFile << "\tjmp\t*" << r << "\n";
+        regManager->freeRegister(base);
+        rodata << "\t.align\t4\n" << table << ":\n";
+        for (const auto& target : targets) rodata << "\t.long\t" << target << "-" << table << "\n";
+    }
+
+    // 值域不超过64时，每个目标对应一个掩码，bt 取出 reg - low 对应的位
+    void cgbittest(Reg reg, long low, long high, const std::vector<std::pair<std::string, unsigned long>> &masks, const char *default_label) override {
+        std::string r = regManager->getRegister(reg);
+        if (low != 0) outputFile << "\tsubq\t$" << low << ", " << r << "\n";
+        outputFile << "\tcmpq\t$" << high - low << ", " << r << "\n";
+        outputFile << "\tja\t" << default_label << "\n";
+        Reg tmp = regManager->allocateRegister(P_LONG);
+        std::string t = regManager->getRegister(tmp);
+        for (const auto& [target, mask] : masks) {
+            if (mask <= INT32_MAX) outputFile << "\tmovl\t$" << mask << ", " << regManager->getRegister(Reg{.type = P_INT, .idx = tmp.idx}) << "\n";
+            else outputFile << "\tmovabsq\t$" << (long)mask << ", " << t << "\n";
+            outputFile << "\tbtq\t" << r << ", " << t << "\n";
+            outputFile << "\tjc\t" << target << "\n";
+        }
+        outputFile << "\tjmp\t" << default_label << "\n";
+        regManager->freeRegister(tmp);
+    }
+
+    void cgtestjump(Reg reg, const char *label) override {
+        cmpimm(reg, 0);
+        outputFile << "\tje\t" << label << "\n";
+        regManager->freeRegister(reg);
+    }
+
+    void cgzerojump(Reg reg, const char *label) override {
+        outputFile << "\tje\t" << label << "\n";
+        regManager->freeRegister(reg);
+    }
+
+    void cgtestnonzerojump(Reg reg, const char *label) override {
+        cmpimm(reg, 0);
+        outputFile << "\tjne\t" << label << "\n";
+        regManager->freeRegister(reg);
+    }
+
+    void cgnonzerojump(Reg reg, const char *label) override {
+        outputFile << "\tjne\t" << label << "\n";
+        regManager->freeRegister(reg);
+    }
+
     Reg cgequal(Reg r1, Reg r2) override {
         return cgcompare(r1, r2, "sete");
     }
@@ -634,12 +844,15 @@ public:
         outputFile << "\tjmp\t" << label << "\n"; // Generate an unconditional jump to the specified label
     }
 
+    // 浮点比较的跳转只用于条件为假时跳走：有 NaN 时 comisd 置 ZF=PF=CF=1，除 != 外的比较都不成立，要跳转
     void cgequaljump(Reg r1, Reg r2, const char *label) override {
         if (r1.type == P_FLOAT) {
             outputFile << "\tcomisd\t" << regManager->getRegister(r2) << ", " << regManager->getRegister(r1) << "\n"
-                      << "\tje\t" << label << "\n";
+                      << "\tjp\t1f\n"
+                      << "\tje\t" << label << "\n"
+                      << "1:\n";
         } else {
-            outputFile << "\tcmpq\t" << regManager->getRegister(r2) << ", " << regManager->getRegister(r1) << "\n"
+            outputFile << "\tcmp" << widthSuffix(r1.type) << "\t" << regManager->getRegister(r2) << ", " << regManager->getRegister(r1) << "\n"
                     << "\tje\t" << label << "\n"; // Generate a conditional jump if equal
         }
 
@@ -649,9 +862,10 @@ public:
     void cgnotequaljump(Reg r1, Reg r2, const char *label) override {
         if (r1.type == P_FLOAT) {
             outputFile << "\tcomisd\t" << regManager->getRegister(r2) << ", " << regManager->getRegister(r1) << "\n"
-                      << "\tjne\t" << label << "\n";
+                      << "\tjne\t" << label << "\n"
+                      << "\tjp\t" << label << "\n";
         } else {
-            outputFile << "\tcmpq\t" << regManager->getRegister(r2) << ", " << regManager->getRegister(r1) << "\n"
+            outputFile << "\tcmp" << widthSuffix(r1.type) << "\t" << regManager->getRegister(r2) << ", " << regManager->getRegister(r1) << "\n"
                     << "\tjne\t" << label << "\n"; // Generate a conditional jump if not equal
         }
 
@@ -660,10 +874,11 @@ public:
     }
     void cggreaterequaljump(Reg r1, Reg r2, const char *label) override {
         if (r1.type == P_FLOAT) {
-            outputFile << "\tcomisd\t" << regManager->getRegister(r2) << ", " << regManager->getRegister(r1) << "\n"
-                      << "\tjae\t" << label << "\n";
+            // 交换两边：r2 > r1 不成立时跳转，无序时 jbe 也跳转
+            outputFile << "\tcomisd\t" << regManager->getRegister(r1) << ", " << regManager->getRegister(r2) << "\n"
+                      << "\tjbe\t" << label << "\n";
         } else {
-            outputFile << "\tcmpq\t" << regManager->getRegister(r2) << ", " << regManager->getRegister(r1) << "\n"
+            outputFile << "\tcmp" << widthSuffix(r1.type) << "\t" << regManager->getRegister(r2) << ", " << regManager->getRegister(r1) << "\n"
                     << "\tjge\t" << label << "\n"; // Generate a conditional jump if greater than or equal
         }
 
@@ -675,7 +890,7 @@ public:
             outputFile << "\tcomisd\t" << regManager->getRegister(r2) << ", " << regManager->getRegister(r1) << "\n"
                       << "\tjbe\t" << label << "\n";
         } else {
-            outputFile << "\tcmpq\t" << regManager->getRegister(r2) << ", " << regManager->getRegister(r1) << "\n"
+            outputFile << "\tcmp" << widthSuffix(r1.type) << "\t" << regManager->getRegister(r2) << ", " << regManager->getRegister(r1) << "\n"
                      << "\tjle\t" << label << "\n"; // Generate a conditional jump if less than or equal
         }
 
@@ -687,7 +902,7 @@ public:
             outputFile << "\tcomisd\t" << regManager->getRegister(r2) << ", " << regManager->getRegister(r1) << "\n"
                       << "\tjb\t" << label << "\n";
         } else {
-            outputFile << "\tcmpq\t" << regManager->getRegister(r2) << ", " << regManager->getRegister(r1) << "\n"
+            outputFile << "\tcmp" << widthSuffix(r1.type) << "\t" << regManager->getRegister(r2) << ", " << regManager->getRegister(r1) << "\n"
                     << "\tjl\t" << label << "\n"; // Generate a conditional jump if less than
         }
 
@@ -696,10 +911,10 @@ public:
     }
     void cggreaterthanjump(Reg r1, Reg r2, const char *label) override {
         if (r1.type == P_FLOAT) {
-            outputFile << "\tcomisd\t" << regManager->getRegister(r2) << ", " << regManager->getRegister(r1) << "\n"
-                      << "\tja\t" << label << "\n";
+            outputFile << "\tcomisd\t" << regManager->getRegister(r1) << ", " << regManager->getRegister(r2) << "\n"
+                      << "\tjb\t" << label << "\n";
         } else {
-            outputFile << "\tcmpq\t" << regManager->getRegister(r2) << ", " << regManager->getRegister(r1) << "\n"
+            outputFile << "\tcmp" << widthSuffix(r1.type) << "\t" << regManager->getRegister(r2) << ", " << regManager->getRegister(r1) << "\n"
                     << "\tjg\t" << label << "\n"; // Generate a conditional jump if greater than
         }
 
@@ -707,28 +922,84 @@ public:
         regManager->freeRegister(r2);
     }
 
+    // 函数体先写入缓冲区，生成完才知道调用现场保存区的大小和用到的被调用者保存寄存器，
+    // 那时再输出序言。cgprologue 标记序言的位置，之前的提前返回路径不建立栈帧；
+    // 函数体中拆栈帧的位置用 frame_teardown 占位
     void cgfuncpreamble(Function func) override {
-        outputFile << 
-            "\t.text\n"
-            "\t.globl\t" << func.name << "\n"
-            "\t.type\t" << func.name << ", @function\n"
-            << func.name << ":\n"
-            "\tpushq\t%rbp\n"
-            "\tmovq\t%rsp, %rbp\n"
-            "\tsubq\t$" << func.stack_size << ", %rsp\n"; // Adjust stack pointer for local variables
-        
+        current_func = func;
+        if (!func.omitsFramePointer()) frame_kind = FRAME_RBP;
+        else if (func.is_leaf && func.stack_size + 24 <= 128) frame_kind = FRAME_RED_ZONE; // 留出r12/r13的槽位
+        else frame_kind = FRAME_RSP;
+        save_depth = 0;
+        save_slots = 0;
+        regManager->resetUsedCalleeSaved();
+        function_body.str("");
+        outputFile.rdbuf(&function_body);
+    }
+
+    void cgprologue() override {
+        outputFile << frame_prologue;
     }
 
     void cgfuncpostamble(Function func, const char *label) override {
         cglabel(label);
-        outputFile << 
-            "\taddq\t$" << func.stack_size << ", %rsp\n"; // Restore stack pointer
-        outputFile << 
-            "\tpopq\t%rbp\n"
-            "\tret\n";
+        outputFile << frame_teardown << "\tret\n";
+        outputFile.rdbuf(file.rdbuf());
+
+        // 栈帧中依次是局部变量、调用现场保存区、r12/r13 的保存槽位
+        auto saved_regs = func.saved_regs;
+        int size = func.stack_size + save_slots * 8;
+        for (const auto& reg : regManager->getUsedCalleeSaved()) {
+            size += 8;
+            saved_regs.push_back({reg, frame_kind == FRAME_RSP ? size - 8 - func.stack_size : -size});
+        }
+        int stack_size = 0; // subq 分配的大小
+        if (frame_kind == FRAME_RBP) stack_size = size + (size % 16 ? 16 - size % 16 : 0);
+        else if (frame_kind == FRAME_RSP) {
+            // 加上返回地址后16字节对齐
+            stack_size = size + 8;
+            stack_size += stack_size % 16 ? 16 - stack_size % 16 : 0;
+            stack_size -= 8;
+        }
+
+        std::string prologue;
+        if (frame_kind == FRAME_RBP) prologue += "\tpushq\t%rbp\n\tmovq\t%rsp, %rbp\n";
+        if (frame_kind == FRAME_RBP || stack_size) prologue += "\tsubq\t$" + std::to_string(stack_size) + ", %rsp\n"; // Adjust stack pointer for local variables
+        for (const auto& [reg, pos] : saved_regs) {
+            prologue += "\tmovq\t" + reg + ", " + frameAddress(pos) + "\n"; // Save callee-saved registers used by the function
+        }
+        std::string teardown;
+        for (const auto& [reg, pos] : saved_regs) {
+            teardown += "\tmovq\t" + frameAddress(pos) + ", " + reg + "\n"; // Restore callee-saved registers
+        }
+        if (frame_kind == FRAME_RBP || stack_size) teardown += "\taddq\t$" + std::to_string(stack_size) + ", %rsp\n"; // Restore stack pointer
+        if (frame_kind == FRAME_RBP) teardown += "\tpopq\t%rbp\n";
+
+        std::string body = function_body.str();
+        size_t pos = body.find(frame_prologue);
+        if (pos == std::string::npos) body = prologue + body;
+        else body.replace(pos, strlen(frame_prologue), prologue);
+        for (pos = body.find(frame_teardown); pos != std::string::npos; pos = body.find(frame_teardown, pos + teardown.size())) {
+            body.replace(pos, strlen(frame_teardown), teardown);
+        }
+        outputFile << (func.is_cold ? "\t.section\t.text.unlikely,\"ax\",@progbits\n" : "\t.text\n") <<
+            "\t.globl\t" << func.name << "\n"
+            "\t.type\t" << func.name << ", @function\n"
+            << (compiler_options.opt_level > 0 && !func.is_cold ? "\t.p2align\t4\n" : "")
+            << func.name << ":\n"
+            << body;
+        if (!rodata.str().empty()) {
+            outputFile << "\t.section\t.rodata\n" << rodata.str();
+            rodata.str("");
+        }
         // regManager->freeAllRegister(); // Free all registers at the end of the function
     }
 
+    void cgtailcall(Function func, const char *name) override {
+        // 参数已经在传参寄存器中，恢复调用者的寄存器和栈帧后跳转，被调用者直接返回到我们的调用者
+        outputFile << frame_teardown << "\tjmp\t" << name << "\n";
+    }
+
     Reg cgint2char(Reg reg) override {
         reg.type = P_CHAR; // Update the register type to character
         return reg; // Return the register containing the character
@@ -771,6 +1042,7 @@ public:
 
     Reg cgint2long(Reg reg) override {
         // Convert the integer in the specified register to a long
+        reg.type = P_INT; // 位运算的结果寄存器可能已被标成 long，源操作数总是低32位
         outputFile << "\tmovslq\t" << regManager->getRegister(reg) << ", " ;
         reg.type = P_LONG; // Update the register type to long
         outputFile << regManager->getRegister(reg) << "\n"; // Move int to long
@@ -830,6 +1102,17 @@ public:
     }
 
     void cgreturn(const Reg reg, const char *end_label) override {
+        loadReturnValue(reg);
+        cgjump(end_label);
+    }
+
+    // 序言之前的提前返回，还没有栈帧要拆
+    void cgframelessreturn(const Reg reg) override {
+        loadReturnValue(reg);
+        outputFile << "\tret\n";
+    }
+
+    void loadReturnValue(const Reg reg) {
         switch (reg.type) {
             case P_CHAR:
                 outputFile << "\tmovb\t" << regManager->getRegister(reg) << ", %eax\n";
@@ -843,16 +1126,17 @@ public:
             case P_FLOAT:
                 outputFile << "\tmovsd\t" << regManager->getRegister(reg) << ", %xmm0\n";
                 break;
+            case P_VOID:
+                break;
             default:
                 throw std::runtime_error("GenCode::cgreturn: Unsupported register type for return");
         }
         if (reg.type != P_VOID) regManager->freeRegister(reg); // Free the register after use
-        cgjump(end_label);
     }
 
     Reg cgaddress(Symbol identifier) override {
         Reg reg = regManager->allocateRegister(P_LONG); // Allocate a register for the address
-        outputFile << "\tleaq\t" << identifier.getAddress() << ", " << regManager->getRegister(reg) << "\n"; // Load the address into the register
+        outputFile << "\tleaq\t" << symbolAddress(identifier) << ", " << regManager->getRegister(reg) << "\n"; // Load the address into the register
         return reg; // Return the register containing the address
     }
 
@@ -881,6 +1165,106 @@ public:
         return val_reg; // Return the register containing the dereferenced value
     }
 
+    // 装载和扩展合成一条 mov/movslq/movzbl。地址用到的寄存器先释放，结果可以复用它们
+    Reg cgloadop(const Operand &src, PrimitiveType type, PrimitiveType to) override {
+        Operand op = src;
+        if (op.kind == Operand::REG && type == to) return op.reg;
+        std::string text = operandText(op, type);
+        releaseOperand(op);
+        Reg reg = regManager->allocateRegister(to);
+        reg.type = to;
+        std::string mnemonic = type == to ? moveInstruction(type) : extendInstruction(type, to);
+        outputFile << "\t" << mnemonic << "\t" << text << ", " << regManager->getRegister(reg) << "\n";
+        return reg;
+    }
+
+    void cgstoreop(const Operand &src, const Operand &dst, PrimitiveType type) override {
+        Operand value = src, op = dst;
+        std::string from = operandText(value, type);
+        std::string to = operandText(op, type);
+        outputFile << "\t" << moveInstruction(type) << "\t" << from << ", " << to << "\n";
+        releaseOperand(op);
+    }
+
+    // 双操作数的运算，src 折叠进指令。imul 没有8位的形式，移位次数只能是立即数
+    Reg cgarith(ExprType op, Reg reg, const Operand &src) override {
+        Operand s = src;
+        std::string mnemonic;
+        if (reg.type == P_FLOAT) {
+            switch (op) {
+                case A_ADD: mnemonic = "addsd"; break;
+                case A_SUBTRACT: mnemonic = "subsd"; break;
+                case A_MULTIPLY: mnemonic = "mulsd"; break;
+                case A_DIVIDE: mnemonic = "divsd"; break;
+                default: throw std::runtime_error("GenCode::cgarith: Unsupported float operation");
+            }
+            if (s.kind == Operand::IMM) throw std::runtime_error("GenCode::cgarith: Float operations have no immediate form");
+        } else {
+            switch (op) {
+                case A_ADD: mnemonic = "add"; break;
+                case A_SUBTRACT: mnemonic = "sub"; break;
+                case A_AND: mnemonic = "and"; break;
+                case A_OR: mnemonic = "or"; break;
+                case A_XOR: mnemonic = "xor"; break;
+                case A_MULTIPLY: mnemonic = "imul"; break;
+                case A_LSHIFT: mnemonic = "shl"; break;
+                case A_RSHIFT: mnemonic = reg.type == P_INT ? "sar" : "shr"; break; // 见 cgshr
+                default: throw std::runtime_error("GenCode::cgarith: Unsupported integer operation");
+            }
+            if (op == A_MULTIPLY && reg.type == P_CHAR) throw std::runtime_error("GenCode::cgarith: No 8-bit imul");
+            if ((op == A_LSHIFT || op == A_RSHIFT) && s.kind != Operand::IMM) throw std::runtime_error("GenCode::cgarith: Shift count must be an immediate");
+            mnemonic += widthSuffix(reg.type);
+        }
+        std::string r = regManager->getRegister(reg);
+        std::string text = operandText(s, reg.type);
+        if (op == A_MULTIPLY && s.kind == Operand::IMM) {
+            outputFile << "\t" << mnemonic << "\t" << text << ", " << r << ", " << r << "\n";
+        } else {
+            outputFile << "\t" << mnemonic << "\t" << text << ", " << r << "\n";
+        }
+        releaseOperand(s);
+        return reg;
+    }
+
+    Reg cglea(const Operand &addr, PrimitiveType type) override {
+        Operand op = addr;
+        std::string text = operandText(op, P_LONG);
+        releaseOperand(op);
+        Reg reg = regManager->allocateRegister(type);
+        reg.type = type;
+        outputFile << "\tlea" << widthSuffix(type) << "\t" << text << ", " << regManager->getRegister(reg) << "\n";
+        return reg;
+    }
+
+    void cgincop(const Operand &dst, PrimitiveType type, long delta) override {
+        Operand op = dst;
+        std::string text = operandText(op, type);
+        if (delta == 1) outputFile << "\tinc" << widthSuffix(type) << "\t" << text << "\n";
+        else if (delta == -1) outputFile << "\tdec" << widthSuffix(type) << "\t" << text << "\n";
+        else if (delta > 0) outputFile << "\tadd" << widthSuffix(type) << "\t$" << delta << ", " << text << "\n";
+        else outputFile << "\tsub" << widthSuffix(type) << "\t$" << -delta << ", " << text << "\n";
+        releaseOperand(op);
+    }
+
+    void cgupdateop(ExprType op, const Operand &dst, const Operand &src, PrimitiveType type) override {
+        std::string mnemonic;
+        switch (op) {
+            case A_ADD: mnemonic = "add"; break;
+            case A_SUBTRACT: mnemonic = "sub"; break;
+            case A_AND: mnemonic = "and"; break;
+            case A_OR: mnemonic = "or"; break;
+            case A_XOR: mnemonic = "xor"; break;
+            default: throw std::runtime_error("GenCode::cgupdateop: Unsupported operation");
+        }
+        Operand s = src, d = dst;
+        if (inMemory(s) && inMemory(d)) s = registerOperand(cgloadop(s, type, type)); // 两个操作数不能都在内存中
+        std::string from = operandText(s, type);
+        std::string to = operandText(d, type);
+        outputFile << "\t" << mnemonic << widthSuffix(type) << "\t" << from << ", " << to << "\n";
+        releaseOperand(s);
+        releaseOperand(d);
+    }
+
     Reg cgshlconst(Reg reg, int value) override {
         // Shift the value in the specified register left by the given constant
         if (reg.type == P_INT || reg.type == P_LONG || reg.type == P_CHAR) {
@@ -892,6 +1276,45 @@ public:
     }
     
 
+    Reg cgmulconst(Reg reg, long value) override {
+        // Multiply by a constant with lea/shift sequences, falling back to imul with an immediate
+        if (reg.type != P_INT && reg.type != P_LONG) {
+            return cgmul(reg, cgload(constValue(reg.type, value)));
+        }
+        std::string suffix = reg.type == P_INT ? "l" : "q";
+        std::string r = regManager->getRegister(reg);
+        std::string r64 = regManager->getRegister(Reg{P_LONG, false, reg.idx});
+        if (value == 0) {
+            outputFile << "\txor" << suffix << "\t" << r << ", " << r << "\n";
+            return reg;
+        }
+        unsigned long odd = value < 0 ? 0UL - (unsigned long)value : (unsigned long)value;
+        int shift = 0;
+        while ((odd & 1) == 0) {
+            odd >>= 1;
+            shift++;
+        }
+        if (odd == 1 || odd == 3 || odd == 5 || odd == 9) {
+            // value = ±odd * 2^shift
+            if (odd != 1) outputFile << "\tlea" << suffix << "\t(" << r64 << "," << r64 << "," << odd - 1 << "), " << r << "\n";
+            if (shift) outputFile << "\tsal" << suffix << "\t$" << shift << ", " << r << "\n";
+            if (value < 0) outputFile << "\tneg" << suffix << "\t" << r << "\n";
+        } else if (value >= INT32_MIN && value <= INT32_MAX) {
+            outputFile << "\timul" << suffix << "\t$" << value << ", " << r << ", " << r << "\n";
+        } else {
+            return cgmul(reg, cgload(constValue(reg.type, value)));
+        }
+        return reg;
+    }
+
+    Reg cgdivconst(Reg reg, long value) override {
+        return cgdivmodconst(reg, value, false);
+    }
+
+    Reg cgmodconst(Reg reg, long value) override {
+        return cgdivmodconst(reg, value, true);
+    }
+
     Reg cgstorderef(Reg reg, Reg addr, PrimitiveType type) override {
         // Store the value in the specified register to the address pointed by identifier
         if (type == P_INT) {
@@ -909,6 +1332,170 @@ public:
         return reg; // Return the register containing the stored value
     }
 
+    // 向量寄存器与标量浮点寄存器共用 xmm8 ~ xmm11，AVX2 时使用同编号的 ymm
+    std::string getVectorRegister(Reg reg) const {
+        std::string name = regManager->getRegister(reg);
+        if (compiler_options.avx2) name.replace(name.find("xmm"), 3, "ymm");
+        return name;
+    }
+
+    // AVX 指令在 SSE 助记符前加 v
+    std::string vectorOp(const std::string &op) const {
+        return compiler_options.avx2 ? "v" + op : op;
+    }
+
+    Reg cgvload(Reg addr, PrimitiveType type) override {
+        Reg reg = regManager->allocateRegister(P_FLOAT);
+        std::string op = type == P_FLOAT ? "movupd" : "movdqu";
+        outputFile << "\t" << vectorOp(op) << "\t(" << regManager->getRegister(addr) << "), " << getVectorRegister(reg) << "\n";
+        regManager->freeRegister(addr);
+        return reg;
+    }
+
+    void cgvstore(Reg reg, Reg addr, PrimitiveType type) override {
+        std::string op = type == P_FLOAT ? "movupd" : "movdqu";
+        outputFile << "\t" << vectorOp(op) << "\t" << getVectorRegister(reg) << ", (" << regManager->getRegister(addr) << ")\n";
+        regManager->freeRegister(addr);
+        regManager->freeRegister(reg);
+    }
+
+    Reg cgvbroadcast(Reg reg, PrimitiveType type) override {
+        if (type == P_FLOAT) {
+            // 标量已经在同一个 xmm 寄存器的低64位
+            if (compiler_options.avx2) {
+                outputFile << "\tvbroadcastsd\t" << regManager->getRegister(reg) << ", " << getVectorRegister(reg) << "\n";
+            } else {
+                outputFile << "\tunpcklpd\t" << regManager->getRegister(reg) << ", " << regManager->getRegister(reg) << "\n";
+            }
+            return reg;
+        }
+        Reg vec = regManager->allocateRegister(P_FLOAT);
+        std::string xmm = regManager->getRegister(vec);
+        if (type == P_INT) {
+            outputFile << "\t" << vectorOp("movd") << "\t" << regManager->getRegister(reg) << ", " << xmm << "\n";
+            if (compiler_options.avx2) outputFile << "\tvpbroadcastd\t" << xmm << ", " << getVectorRegister(vec) << "\n";
+            else outputFile << "\tpshufd\t$0, " << xmm << ", " << xmm << "\n";
+        } else if (type == P_LONG) {
+            outputFile << "\t" << vectorOp("movq") << "\t" << regManager->getRegister(reg) << ", " << xmm << "\n";
+            if (compiler_options.avx2) outputFile << "\tvpbroadcastq\t" << xmm << ", " << getVectorRegister(vec) << "\n";
+            else outputFile << "\tpunpcklqdq\t" << xmm << ", " << xmm << "\n";
+        } else {
+            throw std::runtime_error("GenCode::cgvbroadcast: Unsupported element type for broadcast");
+        }
+        regManager->freeRegister(reg);
+        return vec;
+    }
+
+    // 按元素运算 reg1 = reg1 op reg2
+    Reg cgvarith(const std::string &op, Reg reg1, Reg reg2) {
+        if (compiler_options.avx2) {
+            outputFile << "\tv" << op << "\t" << getVectorRegister(reg2) << ", " << getVectorRegister(reg1) << ", " << getVectorRegister(reg1) << "\n";
+        } else {
+            outputFile << "\t" << op << "\t" << getVectorRegister(reg2) << ", " << getVectorRegister(reg1) << "\n";
+        }
+        regManager->freeRegister(reg2);
+        return reg1;
+    }
+
+    Reg cgvadd(Reg reg1, Reg reg2, PrimitiveType type) override {
+        switch (type) {
+            case P_INT: return cgvarith("paddd", reg1, reg2);
+            case P_LONG: return cgvarith("paddq", reg1, reg2);
+            case P_FLOAT: return cgvarith("addpd", reg1, reg2);
+            default:
+                throw std::runtime_error("GenCode::cgvadd: Unsupported element type for vector addition");
+        }
+    }
+
+    Reg cgvsub(Reg reg1, Reg reg2, PrimitiveType type) override {
+        switch (type) {
+            case P_INT: return cgvarith("psubd", reg1, reg2);
+            case P_LONG: return cgvarith("psubq", reg1, reg2);
+            case P_FLOAT: return cgvarith("subpd", reg1, reg2);
+            default:
+                throw std::runtime_error("GenCode::cgvsub: Unsupported element type for vector subtraction");
+        }
+    }
+
+    Reg cgvmul(Reg reg1, Reg reg2, PrimitiveType type) override {
+        if (type == P_FLOAT) return cgvarith("mulpd", reg1, reg2);
+        if (type != P_INT) throw std::runtime_error("GenCode::cgvmul: Unsupported element type for vector multiplication");
+        if (compiler_options.avx2) return cgvarith("pmulld", reg1, reg2);
+        // SSE2 没有 pmulld：pmuludq 分别算出第0、2个和第1、3个元素的64位乘积，再取低32位交错合并
+        Reg tmp = regManager->allocateRegister(P_FLOAT);
+        std::string a = regManager->getRegister(reg1), b = regManager->getRegister(reg2), t = regManager->getRegister(tmp);
+        outputFile << "\tmovdqa\t" << a << ", " << t << "\n"
+                   << "\tpmuludq\t" << b << ", " << a << "\n"
+                   << "\tpsrlq\t$32, " << t << "\n"
+                   << "\tpsrlq\t$32, " << b << "\n"
+                   << "\tpmuludq\t" << b << ", " << t << "\n"
+                   << "\tpshufd\t$8, " << a << ", " << a << "\n"
+                   << "\tpshufd\t$8, " << t << ", " << t << "\n"
+                   << "\tpunpckldq\t" << t << ", " << a << "\n";
+        regManager->freeRegister(tmp);
+        regManager->freeRegister(reg2);
+        return reg1;
+    }
+
+    Reg cgvdiv(Reg reg1, Reg reg2, PrimitiveType type) override {
+        if (type != P_FLOAT) throw std::runtime_error("GenCode::cgvdiv: Unsupported element type for vector division");
+        return cgvarith("divpd", reg1, reg2);
+    }
+
+    void cgoverlapjump(Reg diff, long bytes, const char *label) override {
+        // -bytes < diff < bytes 等价于 diff + bytes - 1 作为无符号数不超过 2 * (bytes - 1)
+        std::string r = regManager->getRegister(diff);
+        outputFile << "\taddq\t$" << bytes - 1 << ", " << r << "\n"
+                   << "\tcmpq\t$" << 2 * (bytes - 1) << ", " << r << "\n"
+                   << "\tjbe\t" << label << "\n";
+        regManager->freeRegister(diff);
+    }
+
+    void cgvzeroupper() override {
+        // 清掉 ymm 的高128位，避免之后的 SSE 指令付出状态切换的代价
+        if (compiler_options.avx2) outputFile << "\tvzeroupper\n";
+    }
+
+    // 对齐的代价模型按常见 x86-64 处理器的16字节取指块：函数入口总是对齐到16字节；
+    // 循环头只在填充不超过10字节时对齐，更长的 nop 在进入循环时的开销抵消了取指上的收益
+    void cgalignloop() override {
+        outputFile << "\t.p2align\t4,,10\n";
+    }
+
+    // 冷代码就地切换到 .text.unlikely，汇编器把它和热代码分开存放，嵌套的冷代码也可以
+    void cgcoldsection() override {
+        outputFile << "\t.pushsection\t.text.unlikely,\"ax\",@progbits\n";
+    }
+
+    void cgendcoldsection() override {
+        outputFile << "\t.popsection\n";
+    }
+
+    // 只在语句开头计数，这时没有活跃的标志位，incq 不需要寄存器
+    void cgprofilecounter(int index) override {
+        outputFile << "\tincq\t__profile_counters+" << 8L * index << "(%rip)\n";
+    }
+
+    // 运行时库通过这三个全局符号找到计数器，没有插桩的程序中它们不存在
+    void cgprofiledata(long counters, long checksum) override {
+        outputFile << "\t.bss\n";
+        cgglobheader(Symbol("__profile_counters", P_LONG, 8 * counters, true, true, 0));
+        outputFile << "\t.zero\t" << 8 * counters << "\n";
+        outputFile << "\t.data\n";
+        cgglobheader(Symbol("__profile_size", P_LONG, 8, false, true, 0));
+        outputFile << "\t.quad\t" << counters << "\n";
+        cgglobheader(Symbol("__profile_checksum", P_LONG, 8, false, true, 0));
+        outputFile << "\t.quad\t" << checksum << "\n";
+    }
+
+    // 按元素大小对齐，数组最多按8字节对齐
+    void cgglobheader(const Symbol& sym) {
+        int align = sym.size >= 8 ? 8 : sym.size >= 4 ? 4 : sym.size >= 2 ? 2 : 1;
+        outputFile << "\t.globl\t" << sym.name << "\n";
+        if (align > 1) outputFile << "\t.align\t" << align << "\n";
+        outputFile << sym.name << ":\n";
+    }
+
     void cgglobarray(Symbol sym, std::shared_ptr<ArrayInitializer> init) {
         PrimitiveType type = init->getPrimitiveType();
         for (auto &elem: init->getElements()) {
@@ -938,23 +1525,23 @@ public:
     void cginc(Symbol identifier, PrimitiveType type) override {
         // Increment the value of the global variable by 1
         if (type == P_INT) {
-            outputFile << "\tincb\t" << identifier.getAddress() << "\n"; // Increment int value
+            outputFile << "\tincl\t" << symbolAddress(identifier) << "\n"; // Increment int value
         } else if (type == P_CHAR) {
-            outputFile << "\tincl\t" << identifier.getAddress() << "\n"; // Increment char value
+            outputFile << "\tincb\t" << symbolAddress(identifier) << "\n"; // Increment char value
         } else if (type == P_LONG || type == P_CHARPTR) {
-            outputFile << "\tincq\t" << identifier.getAddress() << "\n"; // Increment long value
+            outputFile << "\tincq\t" << symbolAddress(identifier) << "\n"; // Increment long value
         } else if (type == P_FLOAT) {
             Reg r1 = cgload(Value{ .type = P_FLOAT, .fvalue = 1.0f }); // Load float constant 1.0
             Reg r2 = regManager->allocateRegister(P_FLOAT); // Allocate a register for the float value
-            outputFile << "\tmovsd\t" << identifier.getAddress() << ", " << regManager->getRegister(r2) << "\n"; // Load the float value from the global variable
+            outputFile << "\tmovsd\t" << symbolAddress(identifier) << ", " << regManager->getRegister(r2) << "\n"; // Load the float value from the global variable
             outputFile << "\taddsd\t" << regManager->getRegister(r1) << ", " << regManager->getRegister(r2) << "\n"; // Add float value
-            outputFile << "\tmovsd\t" << regManager->getRegister(r2) << ", " << identifier.getAddress() << "\n"; // Store the incremented value back to the global variable
+            outputFile << "\tmovsd\t" << regManager->getRegister(r2) << ", " << symbolAddress(identifier) << "\n"; // Store the incremented value back to the global variable
             regManager->freeRegister(r1); // Free the register used for the float constant
             regManager->freeRegister(r2); // Free the register used for the float value
         } else if (type == P_INTPTR) {
-            outputFile << "\taddq\t$4, " << identifier.getAddress() << "\n"; // Increment pointer by 4 bytes
+            outputFile << "\taddq\t$4, " << symbolAddress(identifier) << "\n"; // Increment pointer by 4 bytes
         } else if (type == P_FLOATPTR || type == P_LONGPTR) {
-            outputFile << "\taddq\t$8, " << identifier.getAddress() << "\n";
+            outputFile << "\taddq\t$8, " << symbolAddress(identifier) << "\n";
         } else {
             throw std::runtime_error("GenCode::cginc: Unsupported type for incrementing global variable");
         }
@@ -963,23 +1550,23 @@ public:
     void cgdec(Symbol identifier, PrimitiveType type) override {
         // Decrement the value of the global variable by 1
         if (type == P_INT) {
-            outputFile << "\tdecl\t" << identifier.getAddress() << "\n"; // Decrement int value
+            outputFile << "\tdecl\t" << symbolAddress(identifier) << "\n"; // Decrement int value
         } else if (type == P_CHAR) {
-            outputFile << "\tdecb\t" << identifier.getAddress() << "\n"; // Decrement char value
+            outputFile << "\tdecb\t" << symbolAddress(identifier) << "\n"; // Decrement char value
         } else if (type == P_LONG || type == P_CHARPTR) {
-            outputFile << "\tdecq\t" << identifier.getAddress() << "\n"; // Decrement long value
+            outputFile << "\tdecq\t" << symbolAddress(identifier) << "\n"; // Decrement long value
         } else if (type == P_FLOAT) {
             Reg r1 = cgload(Value{ .type = P_FLOAT, .fvalue = 1.0f }); // Load float constant 1.0
             Reg r2 = regManager->allocateRegister(P_FLOAT); // Allocate a register for the float value
-            outputFile << "\tmovsd\t" << identifier.getAddress() << ", " << regManager->getRegister(r2) << "\n"; // Load the float value from the global variable
+            outputFile << "\tmovsd\t" << symbolAddress(identifier) << ", " << regManager->getRegister(r2) << "\n"; // Load the float value from the global variable
             outputFile << "\tsubsd\t" << regManager->getRegister(r1) << ", " << regManager->getRegister(r2) << "\n"; // Subtract float value
-            outputFile << "\tmovsd\t" << regManager->getRegister(r2) << ", " << identifier.getAddress() << "\n"; // Store the decremented value back to the global variable
+            outputFile << "\tmovsd\t" << regManager->getRegister(r2) << ", " << symbolAddress(identifier) << "\n"; // Store the decremented value back to the global variable
             regManager->freeRegister(r1); // Free the register used for the float constant
             regManager->freeRegister(r2); // Free the register used for the float value
         } else if (type == P_INTPTR) {
-            outputFile << "\tsubq\t$4, " << identifier.getAddress() << "\n"; // Decrement pointer by 4 bytes
+            outputFile << "\tsubq\t$4, " << symbolAddress(identifier) << "\n"; // Decrement pointer by 4 bytes
         } else if (type == P_FLOATPTR || type == P_LONGPTR) {
-            outputFile << "\tsubq\t$8, " << identifier.getAddress() << "\n";
+            outputFile << "\tsubq\t$8, " << symbolAddress(identifier) << "\n";
         } else {
             throw std::runtime_error("GenCode::cgdec: Unsupported type for decrementing global variable");
         }
@@ -988,9 +1575,9 @@ public:
     void cginc(Reg addr, PrimitiveType type) override {
         // Increment the value at the address pointed by the register by 1
         if (type == P_INT) {
-            outputFile << "\tincb\t(" << regManager->getRegister(addr) << ")\n"; // Increment int value
+            outputFile << "\tincl\t(" << regManager->getRegister(addr) << ")\n"; // Increment int value
         } else if (type == P_CHAR) {
-            outputFile << "\tincl\t(" << regManager->getRegister(addr) << ")\n"; // Increment char value
+            outputFile << "\tincb\t(" << regManager->getRegister(addr) << ")\n"; // Increment char value
         } else if (type == P_LONG || type == P_CHARPTR) {
             outputFile << "\tincq\t(" << regManager->getRegister(addr) << ")\n"; // Increment long value
         } else if (type == P_FLOAT) {
@@ -1014,9 +1601,9 @@ public:
     void cgdec(Reg addr, PrimitiveType type) override {
         // Decrement the value at the address pointed by the register by 1
         if (type == P_INT) {
-            outputFile << "\tdecb\t(" << regManager->getRegister(addr) << ")\n"; // Decrement int value
+            outputFile << "\tdecl\t(" << regManager->getRegister(addr) << ")\n"; // Decrement int value
         } else if (type == P_CHAR) {
-            outputFile << "\tdecl\t(" << regManager->getRegister(addr) << ")\n"; // Decrement char value
+            outputFile << "\tdecb\t(" << regManager->getRegister(addr) << ")\n"; // Decrement char value
         } else if (type == P_LONG || type == P_CHARPTR) {
             outputFile << "\tdecq\t(" << regManager->getRegister(addr) << ")\n"; // Decrement long value
         } else if (type == P_FLOAT) {
@@ -1101,17 +1688,18 @@ public:
     }
 
     Reg cgshl(Reg r1, Reg r2) override {
-        assert(r2.type == P_CHAR && r1.type == P_LONG);
+        assert(r2.type == P_CHAR && (r1.type == P_LONG || r1.type == P_INT));
         outputFile << "\tmovb\t" << regManager->getRegisterLower8bit(r2) << ", %cl\n"; // Move the lower 8 bits of r2 to cl
-        outputFile << "\tshlq\t" << "%cl, " << regManager->getRegister(r1) << "\n"; // Shift left
+        outputFile << "\tshl" << widthSuffix(r1.type) << "\t" << "%cl, " << regManager->getRegister(r1) << "\n"; // Shift left
         regManager->freeRegister(r2); // Free the second register after use
         return r1; // Return the register containing the shifted value
     }
 
+    // long 的右移是逻辑右移。int 的移位只来自类型收窄，左操作数原来是 int 的符号扩展，低32位等于算术右移
     Reg cgshr(Reg r1, Reg r2) override {
-        assert(r2.type == P_CHAR && r1.type == P_LONG);
+        assert(r2.type == P_CHAR && (r1.type == P_LONG || r1.type == P_INT));
         outputFile << "\tmovb\t" << regManager->getRegisterLower8bit(r2) << ", %cl\n"; // Move the lower 8 bits of r2 to cl
-        outputFile << "\tshrq\t" << "%cl, " << regManager->getRegister(r1) << "\n"; // Shift right
+        outputFile << (r1.type == P_INT ? "\tsarl\t" : "\tshrq\t") << "%cl, " << regManager->getRegister(r1) << "\n"; // Shift right
         regManager->freeRegister(r2); // Free the second register after use
         return r1; // Return the register containing the shifted value
     }
@@ -1152,7 +1740,8 @@ public:
         // Load the parameter value from the register to the stack
         
         if (reg.type == P_FLOAT) {
-            outputFile << "\tpushsd\t" << regManager->getRegister(reg) << "\n"; // Move float value to stack
+            outputFile << "\tsubq\t$8, %rsp\n"
+                       << "\tmovsd\t" << regManager->getRegister(reg) << ", (%rsp)\n"; // Move float value to stack
         } else if (reg.type == P_INT || reg.type == P_CHAR || reg.type == P_LONG) {
             reg.type = P_LONG; // Ensure the register type is long for stack operations
             outputFile << "\tpushq\t" << regManager->getRegister(reg) << "\n"; // Move value to stack
@@ -1164,7 +1753,7 @@ public:
 
     void cglocalarrayzeroinit(int base, int left_size, int current_size, int elem_size) override {
         base += current_size * elem_size; // Calculate the base address for the local array
-        outputFile << "\tleaq\t" << base << "(%rbp), %rdi\n"; // Load the address of the local array into rax
+        outputFile << "\tleaq\t" << frameAddress(base) << ", %rdi\n"; // Load the address of the local array into rax
         outputFile << "\tmovl\t" << "$" << left_size << ", %ecx\n"; // Load the size of the array into ecx
         if (elem_size == 4) {
             outputFile << "\tmovl\t$0, %eax\n"; // Initialize the first element to zero
@@ -1180,43 +1769,352 @@ public:
         }
     }
 
-    std::vector<Reg> cgprotectscene() override {
-        std::vector<Reg> used = regManager->getAllocatedRegister();
-        std::vector<Reg> protected_regs; // Vector to store protected registers and their stack offsets
-        if (used.empty()) {
-            return protected_regs; // Return empty vector if no registers are used
-        }
-        if (used.size() % 2) cgadjuststack(8); // Push rax if the number of used registers is odd
-        for (size_t i = 0; i < used.size(); i ++) {
-            Reg reg = used[i];
-            if (reg.type == P_FLOAT) {
-                outputFile << "\tpushsd\t" << regManager->getRegister(reg) << "\n"; // Move float value to stack
-            } else if (reg.type == P_LONG) {
-                outputFile << "\tpushq\t" << regManager->getRegister(reg) << "\n"; // Move value to stack
+    // 非零前缀从.rodata中的映像复制，后面的零单独清零。不到16字节的部分直接存立即数，
+    // 不超过限制的部分用16字节的 movdqu 展开，最后一块和前一块重叠；更长的才用 rep movsb/stosb，它们的启动开销很大
+    void cglocalarraycopy(int base, const std::vector<unsigned char> &image) override {
+        int size = image.size();
+        int prefix = size;
+        while (prefix > 0 && image[prefix - 1] == 0) prefix--;
+        prefix = std::min(size, (prefix + 7) / 8 * 8); // 零的部分从8字节边界开始，两边都不用拆出零碎的存储
+        if (prefix >= 16) {
+            std::string label = labelAllocator.getLabel(ARRAY_CONSTANT_LABEL);
+            rodata << "\t.align\t16\n" << label << ":\n";
+            for (int i = 0; i < prefix; i += 16) {
+                rodata << "\t.byte\t";
+                for (int j = i; j < std::min(prefix, i + 16); j++) rodata << (j > i ? ", " : "") << (int)image[j];
+                rodata << "\n";
+            }
+            if (prefix > inline_copy_limit) {
+                outputFile << "\tleaq\t" << label << "(%rip), %rsi\n";
+                outputFile << "\tleaq\t" << frameAddress(base) << ", %rdi\n";
+                outputFile << "\tmovl\t$" << prefix << ", %ecx\n";
+                outputFile << "\trep movsb\n";
             } else {
-                throw std::runtime_error("GenCode::cgloadparamtostack: Unsupported type for loading parameter to stack");
+                Reg reg = regManager->allocateRegister(P_FLOAT);
+                for (int offset = 0; offset < prefix; offset += 16) {
+                    int at = std::min(offset, prefix - 16);
+                    outputFile << "\tmovdqu\t" << label << "+" << at << "(%rip), " << regManager->getRegister(reg) << "\n";
+                    outputFile << "\tmovdqu\t" << regManager->getRegister(reg) << ", " << frameAddress(base + at) << "\n";
+                }
+                regManager->freeRegister(reg);
+            }
+        } else {
+            cgstoreimmediates(base, image, 0, prefix);
+        }
+
+        int zeros = size - prefix;
+        if (zeros > inline_zero_limit) {
+            outputFile << "\tleaq\t" << frameAddress(base + prefix) << ", %rdi\n";
+            outputFile << "\tmovl\t$" << zeros << ", %ecx\n";
+            outputFile << "\txorl\t%eax, %eax\n";
+            outputFile << "\trep stosb\n";
+        } else if (zeros >= 16) {
+            Reg reg = regManager->allocateRegister(P_FLOAT);
+            outputFile << "\tpxor\t" << regManager->getRegister(reg) << ", " << regManager->getRegister(reg) << "\n";
+            for (int offset = prefix; offset < size; offset += 16) {
+                outputFile << "\tmovdqu\t" << regManager->getRegister(reg) << ", " << frameAddress(base + std::min(offset, size - 16)) << "\n";
             }
-            protected_regs.emplace_back(reg); // Store the register and its stack offset
+            regManager->freeRegister(reg);
+        } else {
+            cgstoreimmediates(base, image, prefix, size);
         }
-        return protected_regs; // Return the vector of protected registers and their stack offsets
+    }
+
+    // image[begin, end) 依次用8/4/2/1字节的立即数存到栈帧的base处，8字节放不进32位立即数时拆成两个4字节
+    void cgstoreimmediates(int base, const std::vector<unsigned char> &image, int begin, int end) {
+        static const std::map<int, std::string> moves = {{8, "movq"}, {4, "movl"}, {2, "movw"}, {1, "movb"}};
+        int offset = begin;
+        for (int width = 8; width > 0; width /= 2) {
+            for (; offset + width <= end; offset += width) {
+                int64_t value = 0;
+                std::memcpy(&value, &image[offset], width);
+                if (width == 8 && value != (int32_t)value) {
+                    cgstoreimmediates(base, image, offset, offset + 4);
+                    cgstoreimmediates(base, image, offset + 4, offset + 8);
+                    continue;
+                }
+                if (width == 4) value = (int32_t)value;
+                outputFile << "\t" << moves.at(width) << "\t$" << value << ", " << frameAddress(base + offset) << "\n";
+            }
+        }
+    }
+
+    // 调用会破坏的活跃值：r10/r11 和 xmm8-11 中已分配的临时值，以及外层调用已经装入传参寄存器的实参。
+    // 存入栈帧中的调用现场保存区，嵌套调用使用更深的槽位，不改变 %rsp
+    std::vector<Reg> cgprotectscene(const std::vector<Reg> &live_params) override {
+        std::vector<Reg> protected_regs;
+        for (const auto& reg : regManager->getAllocatedRegister()) {
+            if (!regManager->isCalleeSaved(reg)) protected_regs.push_back(reg);
+        }
+        protected_regs.insert(protected_regs.end(), live_params.begin(), live_params.end());
+        for (const auto& reg : protected_regs) {
+            outputFile << "\t" << (reg.type == P_FLOAT ? "movsd" : "movq") << "\t" << savedRegister(reg) << ", " << frameAddress(saveSlot(save_depth++)) << "\n";
+        }
+        save_slots = std::max(save_slots, save_depth);
+        return protected_regs;
     }
 
     void cgrestorescene(const std::vector<Reg> &protected_regs) override {
-        // Restore the protected registers from the stack
-        for (auto it = protected_regs.rbegin(); it != protected_regs.rend(); ++it) {
-            Reg reg = *it;
-            if (reg.type == P_FLOAT) {
-                outputFile << "\tpopsd\t" << regManager->getRegister(reg) << "\n"; // Restore float value from stack
-            } else if (reg.type == P_LONG) {
-                outputFile << "\tpopq\t" << regManager->getRegister(reg) << "\n"; // Restore value from stack
+        save_depth -= protected_regs.size();
+        for (size_t i = 0; i < protected_regs.size(); i++) {
+            Reg reg = protected_regs[i];
+            outputFile << "\t" << (reg.type == P_FLOAT ? "movsd" : "movq") << "\t" << frameAddress(saveSlot(save_depth + i)) << ", " << savedRegister(reg) << "\n";
+        }
+    }
+
+    // 跨调用的整数临时值换到空闲的 r12/r13 中，调用前后不需要保存
+    Reg cgcalleesaved(Reg reg) override {
+        if (reg.type == P_FLOAT || regManager->isCalleeSaved(reg)) return reg;
+        Reg out = regManager->allocateCalleeSaved(reg.type);
+        if (out.type == P_NONE) return reg;
+        Reg src = reg;
+        src.type = out.type = P_LONG;
+        outputFile << "\tmovq\t" << regManager->getRegister(src) << ", " << regManager->getRegister(out) << "\n";
+        regManager->freeRegister(src);
+        out.type = reg.type;
+        return out;
+    }
+
+private:
+    std::string savedRegister(Reg reg) const {
+        if (reg.is_param) return regManager->getParamRegister(reg);
+        return regManager->getRegister(reg);
+    }
+
+    // 局部变量的偏移是相对于%rbp的，不建立栈帧时换算成相对于%rsp的地址：
+    // FRAME_RSP 的局部变量在栈帧最底部，红区中的布局和有%rbp时一样，只是少了压栈的%rbp
+    std::string frameAddress(int pos) const {
+        switch (frame_kind) {
+            case FRAME_RBP: return std::to_string(pos) + "(%rbp)";
+            case FRAME_RSP: return std::to_string(pos + current_func.stack_size) + "(%rsp)";
+            default: return std::to_string(pos - 8) + "(%rsp)";
+        }
+    }
+
+    std::string symbolAddress(const Symbol &sym) const {
+        if (sym.is_global || !sym.home_reg.empty()) return sym.getAddress();
+        return frameAddress(sym.getFrameOffset());
+    }
+
+    // 调用现场保存区第k个槽位的偏移：有%rbp时在局部变量之下，FRAME_RSP 时在局部变量之上
+    int saveSlot(int k) const {
+        if (frame_kind == FRAME_RSP) return k * 8;
+        return -(current_func.stack_size + (k + 1) * 8);
+    }
+
+    Operand registerOperand(Reg reg) const {
+        Operand op;
+        op.reg = reg;
+        return op;
+    }
+
+    // 变量在栈上或者是全局变量时操作数在内存中
+    static bool inMemory(const Operand &op) {
+        return op.kind == Operand::MEM || (op.kind == Operand::SYM && (op.sym.is_global || op.sym.home_reg.empty()));
+    }
+
+    // 操作数按 type 的宽度写成汇编文本。%rip 相对寻址不能带下标，全局数组带下标时先用 leaq 把基址装入寄存器
+    std::string operandText(Operand &op, PrimitiveType type) {
+        if (op.kind == Operand::REG) {
+            Reg reg = op.reg;
+            if (reg.type != P_FLOAT) reg.type = type;
+            return regManager->getRegister(reg);
+        }
+        if (op.kind == Operand::IMM) return "$" + std::to_string(op.value);
+        if (op.kind == Operand::SYM) return symbolAddress(op.sym);
+        std::string index;
+        if (op.index.type != P_NONE) {
+            index = "," + regManager->getRegister(Reg{.type = P_LONG, .idx = op.index.idx}) + "," + std::to_string(op.scale);
+        }
+        std::string disp = op.value != 0 ? std::to_string(op.value) : "";
+        if (op.reg.type == P_NONE && op.sym_value) return disp + "(" + op.sym.home_reg + index + ")";
+        if (op.reg.type == P_NONE && !op.sym.is_global) {
+            std::string addr = frameAddress(op.sym.getFrameOffset() + op.value);
+            return addr.substr(0, addr.size() - 1) + index + ")";
+        }
+        if (op.reg.type == P_NONE && index.empty()) {
+            return op.sym.name + (op.value > 0 ? "+" : "") + disp + "(%rip)";
+        }
+        if (op.reg.type == P_NONE) {
+            op.reg = regManager->allocateRegister(P_LONG);
+            outputFile << "\tleaq\t" << op.sym.name << "(%rip), " << regManager->getRegister(op.reg) << "\n";
+        }
+        return disp + "(" + regManager->getRegister(Reg{.type = P_LONG, .idx = op.reg.idx}) + index + ")";
+    }
+
+    void releaseOperand(const Operand &op) {
+        if ((op.kind == Operand::REG || op.kind == Operand::MEM) && op.reg.type != P_NONE) regManager->freeRegister(op.reg);
+        if (op.kind == Operand::MEM && op.index.type != P_NONE) regManager->freeRegister(op.index);
+    }
+
+    static const char *moveInstruction(PrimitiveType type) {
+        return type == P_FLOAT ? "movsd" : type == P_LONG ? "movq" : type == P_CHAR ? "movb" : "movl";
+    }
+
+    // 从from类型扩展到to类型的装载指令，char 是无符号的
+    static const char *extendInstruction(PrimitiveType from, PrimitiveType to) {
+        if (from == P_INT && to == P_LONG) return "movslq";
+        if (from == P_CHAR && to == P_INT) return "movzbl";
+        if (from == P_CHAR && to == P_LONG) return "movzbq";
+        throw std::runtime_error("GenCode::extendInstruction: Unsupported extension");
+    }
+
+    static const char *widthSuffix(PrimitiveType type) {
+        return type == P_LONG ? "q" : type == P_CHAR ? "b" : "l";
+    }
+
+    // 有符号整数比较 op 成立时的 setcc
+    static const char *conditionSet(ExprType op) {
+        switch (op) {
+            case A_EQ: return "sete";
+            case A_NE: return "setne";
+            case A_LT: return "setl";
+            case A_LE: return "setle";
+            case A_GT: return "setg";
+            case A_GE: return "setge";
+            default: throw std::runtime_error("GenCode::conditionSet: Unsupported comparison");
+        }
+    }
+
+    // 有符号整数比较 op 成立时的 cmov
+    static const char *conditionMove(ExprType op) {
+        switch (op) {
+            case A_EQ: return "cmove";
+            case A_NE: return "cmovne";
+            case A_LT: return "cmovl";
+            case A_LE: return "cmovle";
+            case A_GT: return "cmovg";
+            case A_GE: return "cmovge";
+            default: throw std::runtime_error("GenCode::conditionMove: Unsupported comparison");
+        }
+    }
+
+    // 比较结果为taken时跳转的jcc
+    static const char *conditionJump(ExprType op, bool taken) {
+        switch (op) {
+            case A_EQ: return taken ? "je" : "jne";
+            case A_NE: return taken ? "jne" : "je";
+            case A_LT: return taken ? "jl" : "jge";
+            case A_LE: return taken ? "jle" : "jg";
+            case A_GT: return taken ? "jg" : "jle";
+            case A_GE: return taken ? "jge" : "jl";
+            default: throw std::runtime_error("GenCode::conditionJump: Unsupported comparison");
+        }
+    }
+
+    Value constValue(PrimitiveType type, long value) {
+        if (type == P_LONG) return Value{.type = P_LONG, .lvalue = value};
+        return Value{.type = type, .ivalue = (int)value};
+    }
+
+    // Hacker's Delight 10-1: 计算有符号除法的魔数M和移位量s，使 x / d == mulhi(x, M) >> s（再做符号修正）
+    template <typename S, typename U>
+    static void signedMagic(S d, S &magic, int &shift) {
+        const int bits = sizeof(U) * 8;
+        const U two = (U)1 << (bits - 1);
+        U ad = d < 0 ? (U)0 - (U)d : (U)d;
+        U t = two + ((U)d >> (bits - 1));
+        U anc = t - 1 - t % ad; // Absolute value of nc
+        int p = bits - 1;
+        U q1 = two / anc, r1 = two - q1 * anc;
+        U q2 = two / ad, r2 = two - q2 * ad;
+        U delta;
+        do {
+            p++;
+            q1 = 2 * q1; r1 = 2 * r1;
+            if (r1 >= anc) { q1++; r1 -= anc; }
+            q2 = 2 * q2; r2 = 2 * r2;
+            if (r2 >= ad) { q2++; r2 -= ad; }
+            delta = ad - r2;
+        } while (q1 < delta || (q1 == delta && r1 == 0));
+        U m = q2 + 1;
+        magic = (S)(d < 0 ? (U)0 - m : m);
+        shift = p - bits;
+    }
+
+    // 常量除法和取模，结果向零取整，与idiv一致；使用%rax/%rdx作为临时寄存器
+    Reg cgdivmodconst(Reg reg, long d, bool want_mod) {
+        bool is_long = reg.type == P_LONG;
+        if ((reg.type != P_INT && !is_long) || d == 0 || (!is_long && (d < INT32_MIN || d > INT32_MAX))) {
+            Reg divisor = cgload(constValue(reg.type, d));
+            return want_mod ? cgmod(reg, divisor) : cgdiv(reg, divisor);
+        }
+        int bits = is_long ? 64 : 32;
+        std::string suffix = is_long ? "q" : "l";
+        std::string r = regManager->getRegister(reg);
+        std::string ax = is_long ? "%rax" : "%eax";
+        std::string dx = is_long ? "%rdx" : "%edx";
+        unsigned long ad = d < 0 ? 0UL - (unsigned long)d : (unsigned long)d;
+        if (ad == 1) {
+            if (want_mod) outputFile << "\txor" << suffix << "\t" << r << ", " << r << "\n";
+            else if (d < 0) outputFile << "\tneg" << suffix << "\t" << r << "\n";
+            return reg;
+        }
+        if ((ad & (ad - 1)) == 0) {
+            // 2的幂：负数被除数先加上 2^k-1 再算术右移
+            int k = __builtin_ctzl(ad);
+            outputFile << "\tmov" << suffix << "\t" << r << ", " << dx << "\n";
+            if (k > 1) outputFile << "\tsar" << suffix << "\t$" << bits - 1 << ", " << dx << "\n";
+            outputFile << "\tshr" << suffix << "\t$" << bits - k << ", " << dx << "\n";
+            outputFile << "\tadd" << suffix << "\t" << r << ", " << dx << "\n";
+            outputFile << "\tsar" << suffix << "\t$" << k << ", " << dx << "\n";
+            if (want_mod) {
+                outputFile << "\tsal" << suffix << "\t$" << k << ", " << dx << "\n";
+                outputFile << "\tsub" << suffix << "\t" << dx << ", " << r << "\n";
+            } else {
+                if (d < 0) outputFile << "\tneg" << suffix << "\t" << dx << "\n";
+                outputFile << "\tmov" << suffix << "\t" << dx << ", " << r << "\n";
+            }
+            return reg;
+        }
+        long magic;
+        int shift;
+        if (is_long) {
+            signedMagic<long, unsigned long>(d, magic, shift);
+            outputFile << "\tmovabsq\t$" << magic << ", %rax\n";
+        } else {
+            int magic32;
+            signedMagic<int, unsigned int>((int)d, magic32, shift);
+            magic = magic32;
+            outputFile << "\tmovl\t$" << magic << ", %eax\n";
+        }
+        outputFile << "\timul" << suffix << "\t" << r << "\n"; // High half of x * M in %rdx
+        if (d > 0 && magic < 0) outputFile << "\tadd" << suffix << "\t" << r << ", " << dx << "\n";
+        if (d < 0 && magic > 0) outputFile << "\tsub" << suffix << "\t" << r << ", " << dx << "\n";
+        if (shift) outputFile << "\tsar" << suffix << "\t$" << shift << ", " << dx << "\n";
+        outputFile << "\tmov" << suffix << "\t" << dx << ", " << ax << "\n";
+        outputFile << "\tshr" << suffix << "\t$" << bits - 1 << ", " << ax << "\n";
+        outputFile << "\tadd" << suffix << "\t" << ax << ", " << dx << "\n"; // Round negative quotients toward zero
+        if (want_mod) {
+            if (d >= INT32_MIN && d <= INT32_MAX) {
+                outputFile << "\timul" << suffix << "\t$" << d << ", " << dx << ", " << dx << "\n";
             } else {
-                throw std::runtime_error("GenCode::cgrestorescene: Unsupported type for restoring protected register");
+                outputFile << "\tmovabsq\t$" << d << ", %rax\n";
+                outputFile << "\timulq\t%rax, %rdx\n";
             }
+            outputFile << "\tsub" << suffix << "\t" << dx << ", " << r << "\n";
+        } else {
+            outputFile << "\tmov" << suffix << "\t" << dx << ", " << r << "\n";
         }
-        if (protected_regs.size() % 2) cgadjuststack(-8); // Pop rax if the number of protected registers is odd
+        return reg;
     }
 
-private:
-    std::ofstream outputFile; // Output file stream for writing assembly code
+    std::ofstream file; // Output file for the assembly code
+    std::ostream outputFile; // Writes to file, or to function_body while a function is being generated
+    std::stringbuf function_body;
+    std::ostringstream rodata; // 当前函数中局部数组初值的映像和 switch 的跳转表，函数结束后输出
+    static constexpr int inline_copy_limit = 128; // 超过这个字节数的局部数组初值用 rep movsb 复制
+    static constexpr int inline_zero_limit = 256; // 超过这个字节数的零用 rep stosb 填充
+    Function current_func; // Function whose body is being generated
+    int save_depth = 0; // Call save slots in use
+    int save_slots = 0; // Call save slots the function needs
+    enum FrameKind {
+        FRAME_RBP, // pushq %rbp 建立栈帧，变量相对%rbp寻址
+        FRAME_RSP, // 不保存%rbp，subq 分配栈帧，变量相对%rsp寻址
+        FRAME_RED_ZONE // 叶子函数直接使用%rsp下方128字节的红区，不移动%rsp
+    };
+    FrameKind frame_kind = FRAME_RBP;
+    static constexpr const char *frame_prologue = "\t#prologue\n";
+    static constexpr const char *frame_teardown = "\t#teardown\n";
     std::unique_ptr<X86RegisterManager> regManager; // Register manager for handling register allocation
 };
\ No newline at end of file
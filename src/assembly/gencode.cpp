@@ -1,4 +1,7 @@
 #include "assembly/gencode.h"
+#include "optimizer/optimizer.h"
+#include "optimizer/ast_utils.h"
+#include <algorithm>
 
 Reg GenCode::transformType(PrimitiveType from, PrimitiveType to, Reg reg) {
     if (from == P_INT && to == P_CHAR) {
@@ -30,8 +33,516 @@ Reg GenCode::transformType(PrimitiveType from, PrimitiveType to, Reg reg) {
     }
 }
 
+// 整数扩展：char 是无符号的，扩展到 int 和 long 都是零扩展
+static bool isExtension(PrimitiveType from, PrimitiveType to) {
+    return (from == P_INT && to == P_LONG) || (from == P_CHAR && (to == P_INT || to == P_LONG));
+}
+
+// 计算ast并扩展成to类型。标量变量和解引用的值在装载时直接扩展，不需要先读进寄存器再用一条指令扩展
+Reg GenCode::walkExtended(const std::shared_ptr<ExprNode>& ast, PrimitiveType to) {
+    PrimitiveType from = ast->getPrimitiveType();
+    if (scalarOperand(ast, from) || derefOf(ast, from) != nullptr) return cgloadop(selectOperand(ast, from), from, to);
+    return transformType(from, to, walkExpr(ast));
+}
+
+// 指令选择：自顶向下用树模式覆盖表达式，每个结点取能覆盖最多结点的模式。常量折叠成立即数，
+// 标量变量直接作为操作数读取，解引用写成 base+index*scale+disp 的内存操作数，
+// 只有剩下的子树才单独算进寄存器
+
+// 能写成32位立即数的整数常量
+static bool immediateOf(const std::shared_ptr<ExprNode>& ast, long& value) {
+    Value v;
+    if (!evalConstant(ast, v)) return false;
+    if (v.type == P_LONG) value = v.lvalue;
+    else if (v.type == P_INT || v.type == P_CHAR) value = v.ivalue;
+    else return false;
+    return value == (int)value;
+}
+
+// 寄存器中的类型，指针按 long 处理
+static PrimitiveType registerType(PrimitiveType type) {
+    return is_pointer(type) ? P_LONG : type;
+}
+
+// 可以直接作为 type 类型操作数的标量变量
+bool GenCode::scalarOperand(const std::shared_ptr<ExprNode>& ast, PrimitiveType type) {
+    auto x = std::dynamic_pointer_cast<LValueNode>(ast);
+    return x != nullptr && !x->isArray() && registerType(x->getSymbol()->type) == type;
+}
+
+// 读出 type 类型值的解引用，不是时返回空
+std::shared_ptr<UnaryExpNode> GenCode::derefOf(const std::shared_ptr<ExprNode>& ast, PrimitiveType type) {
+    auto x = std::dynamic_pointer_cast<UnaryExpNode>(ast);
+    if (x == nullptr || x->getOp() != U_DEREF) return nullptr;
+    PrimitiveType ptr = x->getExpr()->getPrimitiveType();
+    if (!is_pointer(ptr) && !is_array(ptr)) return nullptr;
+    if (ptr == P_VOIDPTR || valueAt(ptr) != type) return nullptr;
+    return x;
+}
+
+// ast 能不计算进寄存器，直接作为 type 类型的操作数
+bool GenCode::foldable(const std::shared_ptr<ExprNode>& ast, PrimitiveType type) {
+    long value;
+    if (type != P_FLOAT && immediateOf(ast, value)) return true;
+    return scalarOperand(ast, type) || derefOf(ast, type) != nullptr;
+}
+
+Operand GenCode::selectOperand(const std::shared_ptr<ExprNode>& ast, PrimitiveType type) {
+    Operand op;
+    long value;
+    if (type != P_FLOAT && immediateOf(ast, value)) {
+        op.kind = Operand::IMM;
+        op.value = value;
+    } else if (scalarOperand(ast, type)) {
+        op.kind = Operand::SYM;
+        op.sym = std::dynamic_pointer_cast<LValueNode>(ast)->getIdentifier();
+    } else if (auto x = derefOf(ast, type)) {
+        op = selectAddress(x->getExpr());
+    } else {
+        op.reg = walkExpr(ast);
+    }
+    return op;
+}
+
+// 指针变量作为基址：在寄存器中时直接使用，在栈上时先装入寄存器
+void GenCode::selectBase(Operand& op, const std::shared_ptr<LValueNode>& var) {
+    if (!var->getSymbol()->home_reg.empty()) {
+        op.sym = var->getIdentifier();
+        op.sym_value = true;
+    } else {
+        op.reg = cgloadsym(var->getIdentifier(), var->getCalculateType());
+    }
+}
+
+// 已经乘上元素大小的下标写成 index*scale+disp：常量只改变位移，乘上1、2、4、8的缩放用寻址方式的比例因子，
+// 缩放前加减的常量也并进位移
+void GenCode::selectIndex(Operand& op, const std::shared_ptr<ExprNode>& ast) {
+    auto index = ast;
+    if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(index); x != nullptr && x->getOp() == U_TRANSFORM
+        && x->getPrimitiveType() == P_INT && x->getExpr()->getPrimitiveType() == P_LONG) {
+        index = x->getExpr(); // 语义分析套上的转换并不截断，见 walkExpr 中的数组元素
+    }
+    long value;
+    if (immediateOf(index, value)) {
+        op.value += value;
+        return;
+    }
+    auto x = std::dynamic_pointer_cast<UnaryExpNode>(index);
+    int scale = x != nullptr && x->getOp() == U_SCALE ? x->getOffset() : 0;
+    if (scale != 1 && scale != 2 && scale != 4 && scale != 8) {
+        Reg reg = walkExpr(index);
+        reg.type = P_LONG;
+        op.index = reg;
+        return;
+    }
+    auto scaled = x->getExpr();
+    if (auto y = std::dynamic_pointer_cast<BinaryExpNode>(scaled); y != nullptr && (y->getOp() == A_ADD || y->getOp() == A_SUBTRACT)
+        && immediateOf(y->getRight(), value)) {
+        op.value += (y->getOp() == A_ADD ? value : -value) * scale;
+        scaled = y->getLeft();
+    }
+    PrimitiveType type = scaled->getPrimitiveType();
+    op.index = isExtension(type, P_LONG) ? walkExtended(scaled, P_LONG) : walkExpr(scaled);
+    op.index.type = P_LONG;
+    op.scale = scale;
+}
+
+// 指针加上偏移或减去常量，偏移已经乘上了元素大小
+static bool pointerOffset(const std::shared_ptr<BinaryExpNode>& ast) {
+    long value;
+    if (!is_pointer(ast->getLeft()->getPrimitiveType())) return false;
+    return ast->getOp() == A_ADD || (ast->getOp() == A_SUBTRACT && immediateOf(ast->getRight(), value));
+}
+
+// 地址表达式写成内存操作数：数组元素、指针加减偏移和指针变量，其他地址算进基址寄存器。
+// 子表达式的求值顺序和不做选择时相同：数组元素先算下标再取基址，指针加偏移先算指针
+Operand GenCode::selectAddress(const std::shared_ptr<ExprNode>& ast) {
+    Operand op;
+    op.kind = Operand::MEM;
+    if (auto x = std::dynamic_pointer_cast<LValueNode>(ast)) {
+        if (!x->isArray()) {
+            selectBase(op, x);
+            return op;
+        }
+        if (x->getIndex() != nullptr) selectIndex(op, x->getIndex());
+        if (x->isParam()) selectBase(op, x);
+        else op.sym = x->getIdentifier();
+        return op;
+    }
+    auto x = std::dynamic_pointer_cast<BinaryExpNode>(ast);
+    if (x != nullptr && pointerOffset(x)) {
+        long value = 0;
+        immediateOf(x->getRight(), value);
+        auto base = std::dynamic_pointer_cast<LValueNode>(x->getLeft());
+        if (base != nullptr && !base->isArray() && !hasSideEffects(x->getRight())) selectBase(op, base);
+        else op.reg = keepAcrossCalls(walkExpr(x->getLeft()), x->getRight());
+        if (x->getOp() == A_SUBTRACT) op.value = -value;
+        else selectIndex(op, x->getRight());
+        return op;
+    }
+    op.reg = walkExpr(ast);
+    return op;
+}
+
+// 寄存器中的整数变量加减常量用一条 lea 算到新的寄存器，省掉先复制变量的 mov
+Reg GenCode::walkLea(const std::shared_ptr<BinaryExpNode>& ast) {
+    ExprType op = ast->getOp();
+    PrimitiveType type = ast->getPrimitiveType();
+    if ((op != A_ADD && op != A_SUBTRACT) || (type != P_INT && type != P_LONG) || ast->getCalType() != type) return Reg{.type = P_NONE, .idx = 0};
+    auto var = ast->getLeft();
+    auto other = ast->getRight();
+    long value;
+    if (op == A_ADD && immediateOf(var, value)) std::swap(var, other);
+    auto x = std::dynamic_pointer_cast<LValueNode>(var);
+    if (!scalarOperand(var, type) || x->getSymbol()->home_reg.empty() || !immediateOf(other, value)) return Reg{.type = P_NONE, .idx = 0};
+    Operand addr;
+    addr.kind = Operand::MEM;
+    addr.sym = x->getIdentifier();
+    addr.sym_value = true;
+    addr.value = op == A_ADD ? value : -value;
+    return cglea(addr, type);
+}
+
+// 双操作数的运算，右边能作为操作数时折叠进指令。可交换的运算在左边能折叠时可以交换两边
+Reg GenCode::walkFoldedArith(const std::shared_ptr<BinaryExpNode>& ast) {
+    ExprType op = ast->getOp();
+    auto left = ast->getLeft();
+    auto right = ast->getRight();
+    PrimitiveType type = left->getPrimitiveType();
+    bool shift = op == A_LSHIFT || op == A_RSHIFT;
+    bool commutative = op == A_ADD || op == A_MULTIPLY || op == A_AND || op == A_OR || op == A_XOR;
+    if (type == P_FLOAT) {
+        if (op != A_ADD && op != A_SUBTRACT && op != A_MULTIPLY && op != A_DIVIDE) return Reg{.type = P_NONE, .idx = 0};
+    } else if (type == P_INT || type == P_LONG || type == P_CHAR) {
+        if (op == A_DIVIDE || op == A_MOD || (op == A_MULTIPLY && type == P_CHAR)) return Reg{.type = P_NONE, .idx = 0};
+    } else {
+        return Reg{.type = P_NONE, .idx = 0};
+    }
+    if (shift) {
+        long count;
+        if (type == P_CHAR || !immediateOf(right, count) || count < 0 || count >= (type == P_INT ? 32 : 64)) return Reg{.type = P_NONE, .idx = 0};
+    } else if (right->getPrimitiveType() != type) {
+        return Reg{.type = P_NONE, .idx = 0};
+    }
+    // 右边的内存操作数比左边需要更多寄存器时，和不折叠时一样先算右边，交换后把左边折叠进指令
+    if (!foldable(right, type) || (derefOf(right, type) != nullptr && rightFirst(left, right))) {
+        if (!commutative || !foldable(left, type) || hasSideEffects(left) || hasSideEffects(right)) return Reg{.type = P_NONE, .idx = 0};
+        std::swap(left, right);
+    }
+    Reg reg = keepAcrossCalls(walkExpr(left), right);
+    Operand src = shift ? Operand{.kind = Operand::IMM} : selectOperand(right, type);
+    if (shift) immediateOf(right, src.value);
+    Reg ret = cgarith(op, reg, src);
+    if (op == A_AND || op == A_OR || op == A_XOR || shift) ret.type = ast->getPrimitiveType();
+    return ret;
+}
+
+// 变量或内存上的自增自减，目标直接作为 inc/dec/add/sub 的操作数。浮点数不能这样做，返回false
+bool GenCode::walkIncrement(const std::shared_ptr<UnaryExpNode>& ast) {
+    if (compiler_options.opt_level == 0) return false;
+    PrimitiveType type = ast->getPrimitiveType();
+    long delta = 1;
+    if (is_pointer(type)) {
+        if (type == P_VOIDPTR) return false;
+        delta = symbol_table.typeToSize(valueAt(type));
+        type = P_LONG;
+    }
+    if (type == P_FLOAT) return false;
+    if (ast->getOp() == U_PREDEC || ast->getOp() == U_POSTDEC) delta = -delta;
+    if (scalarOperand(ast->getExpr(), type)) {
+        cgincop(selectOperand(ast->getExpr(), type), type, delta);
+        return true;
+    }
+    auto x = std::dynamic_pointer_cast<UnaryExpNode>(ast->getExpr());
+    if (x == nullptr || x->getOp() != U_DEREF) return false;
+    cgincop(selectAddress(x->getExpr()), type, delta);
+    return true;
+}
+
+// 变量 v = v op x 的赋值直接改写变量：add/sub/and/or/xor 以变量为目标操作数，不用先读进寄存器再写回。
+// x 没有副作用，先读 v 还是先算 x 结果相同
+bool GenCode::walkUpdate(const std::shared_ptr<AssignmentNode>& ast) {
+    auto var = std::dynamic_pointer_cast<LValueNode>(ast->getLvalue());
+    auto bin = std::dynamic_pointer_cast<BinaryExpNode>(ast->getExpr());
+    if (var == nullptr || var->isArray() || bin == nullptr) return false;
+    ExprType op = bin->getOp();
+    if (op != A_ADD && op != A_SUBTRACT && op != A_AND && op != A_OR && op != A_XOR) return false;
+    PrimitiveType type = registerType(var->getSymbol()->type);
+    if (type != P_INT && type != P_LONG && type != P_CHAR) return false;
+    if (bin->getPrimitiveType() != var->getSymbol()->type || registerType(bin->getCalType()) != type) return false;
+    auto other = bin->getRight();
+    if (!exprEqual(bin->getLeft(), var)) {
+        if (op == A_SUBTRACT || !exprEqual(other, var)) return false;
+        other = bin->getLeft();
+    }
+    if (other->getPrimitiveType() != type || hasSideEffects(other)) return false;
+    Operand dst;
+    dst.kind = Operand::SYM;
+    dst.sym = var->getIdentifier();
+    cgupdateop(op, dst, selectOperand(other, type), type);
+    return true;
+}
+
+// 值不被使用的表达式语句：内存或变量上的自增自减和常量赋值直接写目标，不需要寄存器。已经生成时返回true
+bool GenCode::walkEffect(const std::shared_ptr<ExprNode>& ast) {
+    if (compiler_options.opt_level == 0) return false;
+    if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(ast)) {
+        UnaryOp op = x->getOp();
+        return (op == U_PREINC || op == U_PREDEC || op == U_POSTINC || op == U_POSTDEC) && walkIncrement(x);
+    }
+    auto x = std::dynamic_pointer_cast<AssignmentNode>(ast);
+    long value;
+    if (x != nullptr && walkUpdate(x)) return true;
+    if (x == nullptr || x->getPrimitiveType() == P_FLOAT || !immediateOf(x->getExpr(), value)) return false;
+    Operand src;
+    src.kind = Operand::IMM;
+    src.value = value;
+    if (auto y = std::dynamic_pointer_cast<LValueNode>(x->getLvalue()); y != nullptr && !y->isArray()) {
+        Operand dst;
+        dst.kind = Operand::SYM;
+        dst.sym = y->getIdentifier();
+        cgstoreop(src, dst, registerType(x->getCalculateType()));
+        return true;
+    }
+    auto y = std::dynamic_pointer_cast<UnaryExpNode>(x->getLvalue());
+    if (y == nullptr || y->getOp() != U_DEREF) return false;
+    cgstoreop(src, selectAddress(y->getExpr()), registerType(x->getPrimitiveType()));
+    return true;
+}
+
+// 下标或指针偏移乘上元素大小，reg 已经是 long
+Reg GenCode::walkScale(Reg reg, int size) {
+    switch (size) {
+        case 2: return cgshlconst(reg, 1);
+        case 4: return cgshlconst(reg, 2);
+        case 8: return cgshlconst(reg, 3);
+        default:
+            if (compiler_options.opt_level > 0) return cgmulconst(reg, size);
+            // Load a register with the size and
+            // multiply the leftreg by this size
+            Reg rightreg = cgload(Value{.type = P_LONG, .ivalue = size});
+            return cgmul(reg, rightreg);
+    }
+}
+
+// 整型字面量（可能被U_TRANSFORM包裹）返回true，并通过value返回它的值
+bool GenCode::getConstant(const std::shared_ptr<ExprNode>& ast, long &value) {
+    if (auto x = std::dynamic_pointer_cast<ValueNode>(ast)) {
+        if (x->getPrimitiveType() != P_INT && x->getPrimitiveType() != P_LONG) return false;
+        value = x->getLongValue();
+        return true;
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(ast)) {
+        if (x->getOp() != U_TRANSFORM && x->getOp() != U_MINUS) return false;
+        if (x->getPrimitiveType() != P_INT && x->getPrimitiveType() != P_LONG) return false;
+        if (!getConstant(x->getExpr(), value)) return false;
+        if (x->getOp() == U_MINUS) value = -value;
+        if (x->getPrimitiveType() == P_INT) value = (int)value;
+        return true;
+    }
+    return false;
+}
+
+// 乘除数为常量时的强度削弱，返回P_NONE表示不适用
+Reg GenCode::walkConstArith(const std::shared_ptr<BinaryExpNode>& ast) {
+    ExprType op = ast->getOp();
+    if (op != A_MULTIPLY && op != A_DIVIDE && op != A_MOD) return Reg{.type = P_NONE, .idx = 0};
+    if (ast->getCalType() != P_INT && ast->getCalType() != P_LONG) return Reg{.type = P_NONE, .idx = 0};
+    long value;
+    if (getConstant(ast->getRight(), value)) {
+        Reg reg = walkExpr(ast->getLeft());
+        if (op == A_MULTIPLY) return cgmulconst(reg, value);
+        if (op == A_DIVIDE) return cgdivconst(reg, value);
+        return cgmodconst(reg, value);
+    } else if (op == A_MULTIPLY && getConstant(ast->getLeft(), value)) {
+        Reg reg = walkExpr(ast->getRight());
+        return cgmulconst(reg, value);
+    }
+    return Reg{.type = P_NONE, .idx = 0};
+}
+
+static bool isComparison(ExprType op) {
+    return op == A_EQ || op == A_NE || op == A_LT || op == A_LE || op == A_GT || op == A_GE;
+}
+
+// 交换比较的两边：a < b 等价于 b > a
+static ExprType swapComparison(ExprType op) {
+    switch (op) {
+        case A_LT: return A_GT;
+        case A_LE: return A_GE;
+        case A_GT: return A_LT;
+        case A_GE: return A_LE;
+        default: return op;
+    }
+}
+
+// 比较取反：!(a < b) 等价于 a >= b，只用于整数比较
+static ExprType negateComparison(ExprType op) {
+    switch (op) {
+        case A_EQ: return A_NE;
+        case A_NE: return A_EQ;
+        case A_LT: return A_GE;
+        case A_LE: return A_GT;
+        case A_GT: return A_LE;
+        default: return A_LT;
+    }
+}
+
+// 浮点比较遇到 NaN 时 a < b 和 !(a >= b) 不同，这样的条件不能反过来跳转
+static bool canInvertCondition(const std::shared_ptr<ExprNode>& ast) {
+    auto x = std::dynamic_pointer_cast<BinaryExpNode>(ast);
+    return x == nullptr || x->getCalType() != P_FLOAT;
+}
+
+// int 扩展成 long 后再比较，和直接比较两个 int 的结果相同
+static std::shared_ptr<ExprNode> narrowOperand(const std::shared_ptr<ExprNode>& ast) {
+    auto x = std::dynamic_pointer_cast<UnaryExpNode>(ast);
+    if (x == nullptr || x->getOp() != U_TRANSFORM || x->getPrimitiveType() != P_LONG) return ast;
+    if (x->getExpr()->getPrimitiveType() != P_INT) return ast;
+    return x->getExpr();
+}
+
+// 按 int 计算比较的操作数。位运算和比较的结果寄存器被标成 long，但低32位就是 int 的值
+static bool containsCall(const std::shared_ptr<ExprNode>& ast) {
+    if (ast == nullptr) return false;
+    if (std::dynamic_pointer_cast<FunctionCallNode>(ast)) return true;
+    if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(ast)) return containsCall(x->getLeft()) || containsCall(x->getRight());
+    if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(ast)) return containsCall(x->getExpr());
+    if (auto x = std::dynamic_pointer_cast<LValueNode>(ast)) return containsCall(x->getIndex());
+    if (auto x = std::dynamic_pointer_cast<AssignmentNode>(ast)) return containsCall(x->getLvalue()) || containsCall(x->getExpr());
+    return false;
+}
+
+// reg在计算later期间一直活跃，later中有调用时优先放到被调用者保存的寄存器里，省掉调用前后的保存和恢复
+Reg GenCode::keepAcrossCalls(Reg reg, const std::shared_ptr<ExprNode>& later) {
+    if (compiler_options.opt_level == 0 || !containsCall(later)) return reg;
+    return cgcalleesaved(reg);
+}
+
+// Ershov 数：不溢出到内存时计算表达式最少需要的临时寄存器个数，两边都没有副作用的二元运算可以先算需要寄存器多的一边
+int GenCode::registerNeed(const std::shared_ptr<ExprNode>& ast) {
+    if (ast == nullptr) return 0;
+    if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(ast)) {
+        int left = registerNeed(x->getLeft());
+        int right = registerNeed(x->getRight());
+        long value;
+        // 常量作为立即数，不占寄存器
+        if (compiler_options.opt_level > 0 && x->getCalType() != P_FLOAT) {
+            ExprType op = x->getOp();
+            bool imm = op == A_MULTIPLY || op == A_DIVIDE || op == A_MOD || isComparison(op);
+            if (imm && getConstant(x->getRight(), value)) return left;
+            if ((op == A_MULTIPLY || isComparison(op)) && getConstant(x->getLeft(), value)) return right;
+        }
+        if (hasSideEffects(x->getLeft()) || hasSideEffects(x->getRight())) return std::max(left, right + 1);
+        return left == right ? left + 1 : std::max(left, right);
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(ast)) {
+        int need = registerNeed(x->getExpr());
+        // 取值时地址和值同时占着寄存器，自增自减后缀的值算完后还要再算一次地址
+        if (x->getOp() == U_DEREF) return std::max(need, 2);
+        if (x->getOp() == U_ADDR) return std::max(need, 1);
+        if (x->getOp() == U_POSTINC || x->getOp() == U_POSTDEC) {
+            if (auto y = std::dynamic_pointer_cast<UnaryExpNode>(x->getExpr())) return std::max(need, registerNeed(y->getExpr()) + 1);
+        }
+        return need;
+    } else if (auto x = std::dynamic_pointer_cast<LValueNode>(ast)) {
+        // 数组元素的地址：先算下标，再装载基址
+        if (!x->isArray()) return 1;
+        return x->getIndex() != nullptr ? std::max(registerNeed(x->getIndex()), 2) : 1;
+    } else if (auto x = std::dynamic_pointer_cast<AssignmentNode>(ast)) {
+        int need = registerNeed(x->getExpr());
+        auto y = std::dynamic_pointer_cast<UnaryExpNode>(x->getLvalue());
+        if (y == nullptr) return need;
+        int addr = registerNeed(y->getExpr());
+        if (addressFirst(x)) return std::max(addr, need + 1);
+        return std::max(need, addr + 1);
+    } else if (auto x = std::dynamic_pointer_cast<FunctionCallNode>(ast)) {
+        // 实参算完立即放进传参寄存器，只有栈上传递的实参一直占着临时寄存器
+        int need = 1, held = 0, ints = 0, floats = 0;
+        for (const auto& arg : x->getArguments()) {
+            need = std::max(need, registerNeed(arg) + held);
+            bool stack = arg->getCalculateType() == P_FLOAT ? floats++ >= 8 : ints++ >= 6;
+            if (stack) held++;
+        }
+        return need;
+    }
+    return 1;
+}
+
+// 二元运算先算右边：右边需要的寄存器更多，且交换求值顺序不改变结果。
+// 否则右重的表达式会用完临时寄存器，不优化时也这样做
+bool GenCode::rightFirst(const std::shared_ptr<ExprNode>& left, const std::shared_ptr<ExprNode>& right) {
+    if (hasSideEffects(left) || hasSideEffects(right)) return false;
+    return registerNeed(right) > registerNeed(left);
+}
+
+// 通过指针赋值时先算地址
+bool GenCode::addressFirst(const std::shared_ptr<AssignmentNode>& ast) {
+    auto y = std::dynamic_pointer_cast<UnaryExpNode>(ast->getLvalue());
+    return y != nullptr && rightFirst(ast->getExpr(), y->getExpr());
+}
+
+Reg GenCode::walkIntOperand(const std::shared_ptr<ExprNode>& ast) {
+    Reg reg = walkExpr(ast);
+    reg.type = P_INT;
+    return reg;
+}
+
+// 计算整数比较的操作数，返回比较的类型。一边是常量时换到右边作为立即数，两边都是 int 时不扩展成 long。
+// 右边没有副作用时左边的变量和内存也不装入寄存器，由 cmp 直接读取
+PrimitiveType GenCode::walkCompareOperands(const std::shared_ptr<BinaryExpNode>& ast, ExprType& op, Operand& left, Operand& right) {
+    op = ast->getOp();
+    auto lhs = ast->getLeft();
+    auto rhs = ast->getRight();
+    long value;
+    if (immediateOf(lhs, value) && !immediateOf(rhs, value)) {
+        std::swap(lhs, rhs);
+        op = swapComparison(op);
+    }
+    auto narrow_lhs = narrowOperand(lhs);
+    auto narrow_rhs = narrowOperand(rhs);
+    bool narrow = narrow_lhs != lhs && (narrow_rhs != rhs || immediateOf(rhs, value));
+    if (narrow) {
+        lhs = narrow_lhs;
+        if (narrow_rhs != rhs) rhs = narrow_rhs;
+    }
+    PrimitiveType type = narrow ? P_INT : registerType(lhs->getPrimitiveType());
+    auto walk = [&](const std::shared_ptr<ExprNode>& operand) {
+        Operand ret;
+        ret.reg = narrow ? walkIntOperand(operand) : walkExpr(operand);
+        return ret;
+    };
+    if (rightFirst(lhs, rhs)) {
+        right = walk(rhs);
+        left = walk(lhs);
+        return type;
+    }
+    if (!hasSideEffects(rhs) && (scalarOperand(lhs, type) || derefOf(lhs, type) != nullptr)) left = selectOperand(lhs, type);
+    else left = walk(lhs);
+    if (left.kind == Operand::REG) left.reg = keepAcrossCalls(left.reg, rhs);
+    if (foldable(rhs, type)) right = selectOperand(rhs, type);
+    else right = walk(rhs);
+    return type;
+}
+
 Reg GenCode::walkExpr(const std::shared_ptr<ExprNode>& ast) { 
     if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(ast)) {
+        if (compiler_options.opt_level > 0) {
+            Reg reg = walkConstArith(x);
+            if (reg.type != P_NONE) return reg;
+            if (isComparison(x->getOp()) && x->getCalType() != P_FLOAT) {
+                ExprType op;
+                Operand left, right;
+                PrimitiveType type = walkCompareOperands(x, op, left, right);
+                return cgcompareop(left, right, type, op);
+            }
+            reg = walkLea(x);
+            if (reg.type != P_NONE) return reg;
+            if (is_pointer(x->getPrimitiveType()) && pointerOffset(x) && !rightFirst(x->getLeft(), x->getRight())) {
+                // 指针加减偏移用 lea 算出地址
+                return cglea(selectAddress(x), P_LONG);
+            }
+            reg = walkFoldedArith(x);
+            if (reg.type != P_NONE) return reg;
+        }
         // TODO
         // if (x->getOp() == A_AND) {
         //     return walkAndExpr(x);
@@ -39,8 +550,14 @@ Reg GenCode::walkExpr(const std::shared_ptr<ExprNode>& ast) {
         //     return walkOrExpr(x);
         // }
         // Handle binary expression node
-        Reg reg1 = walkExpr(x->getLeft());
-        Reg reg2 = walkExpr(x->getRight());
+        Reg reg1, reg2;
+        if (rightFirst(x->getLeft(), x->getRight())) {
+            reg2 = walkExpr(x->getRight());
+            reg1 = walkExpr(x->getLeft());
+        } else {
+            reg1 = keepAcrossCalls(walkExpr(x->getLeft()), x->getRight());
+            reg2 = walkExpr(x->getRight());
+        }
         // assert(reg1.type == reg2.type); // Ensure both registers have the same type
         Reg ret;
         switch (x->getOp()) {
@@ -63,9 +580,17 @@ Reg GenCode::walkExpr(const std::shared_ptr<ExprNode>& ast) {
             default:
                 throw std::runtime_error("GenCode::generate: Unknown binary expression type");
         }
-        ret.type = P_LONG;
+        // 比较的结果是 long。位运算和移位按结点的类型，收窄成 int 的运算留在32位寄存器里
+        ret.type = isComparison(x->getOp()) ? P_LONG : x->getPrimitiveType();
         return ret;
     } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(ast)) {
+        // 解引用的地址折叠进装载指令的寻址方式
+        if (compiler_options.opt_level > 0 && x->getOp() == U_DEREF) {
+            PrimitiveType ptr = x->getExpr()->getPrimitiveType();
+            if ((is_pointer(ptr) || is_array(ptr)) && ptr != P_VOIDPTR) {
+                return cgloadop(selectAddress(x->getExpr()), valueAt(ptr), valueAt(ptr));
+            }
+        }
         if (x->getOp() == U_ADDR || x->getOp() == U_DEREF) {
             auto y = std::dynamic_pointer_cast<LValueNode>(x->getExpr());
             if (y != nullptr && !y->isArray()) {
@@ -84,7 +609,7 @@ Reg GenCode::walkExpr(const std::shared_ptr<ExprNode>& ast) {
                 }
             }
         }
-        if (x->getOp() == U_PREINC || x->getOp() == U_PREDEC) {
+        if ((x->getOp() == U_PREINC || x->getOp() == U_PREDEC) && !walkIncrement(x)) {
             if (auto y = std::dynamic_pointer_cast<LValueNode>(x->getExpr())) {
                 if (x->getOp() == U_PREINC) {
                     cginc(y->getIdentifier(), y->getIdentifier().type); // Increment the register
@@ -101,10 +626,19 @@ Reg GenCode::walkExpr(const std::shared_ptr<ExprNode>& ast) {
                 }
             }
         }
-    
+
+        // 从变量或内存读出后立即扩展的值用一条 movslq/movzbl 装载
+        if (compiler_options.opt_level > 0 && (x->getOp() == U_TRANSFORM || x->getOp() == U_SCALE)) {
+            PrimitiveType to = x->getOp() == U_SCALE ? P_LONG : x->getPrimitiveType();
+            if (isExtension(x->getExpr()->getPrimitiveType(), to)) {
+                Reg reg = walkExtended(x->getExpr(), to);
+                return x->getOp() == U_SCALE ? walkScale(reg, x->getOffset()) : reg;
+            }
+        }
+
         Reg reg = walkExpr(x->getExpr()); // Walk the expression in the unary node
 
-        if (x->getOp() == U_POSTINC || x->getOp() == U_POSTDEC) {
+        if ((x->getOp() == U_POSTINC || x->getOp() == U_POSTDEC) && !walkIncrement(x)) {
             if (auto y = std::dynamic_pointer_cast<LValueNode>(x->getExpr())) {
                 if (x->getOp() == U_POSTINC) {
                     cginc(y->getIdentifier(), y->getIdentifier().type); // Increment the register
@@ -135,17 +669,7 @@ Reg GenCode::walkExpr(const std::shared_ptr<ExprNode>& ast) {
             if (leftreg.type != P_LONG) {
                 leftreg = transformType(leftreg.type, P_LONG, leftreg); // Ensure the left register is treated as a long integer
             }
-            Reg rightreg;
-            switch (x->getOffset()) {
-                case 2: return(cgshlconst(leftreg, 1));
-                case 4: return(cgshlconst(leftreg, 2));
-                case 8: return(cgshlconst(leftreg, 3));
-                default:
-                  // Load a register with the size and
-                  // multiply the leftreg by this size
-                      rightreg= cgload(Value{.type = P_LONG, .ivalue = x->getOffset()});
-                      return (cgmul(leftreg, rightreg));
-            }
+            return walkScale(leftreg, x->getOffset());
         } else if (x->getOp() == U_INVERT) {
             return cginvert(reg); // Perform bitwise NOT operation
         }
@@ -156,7 +680,9 @@ Reg GenCode::walkExpr(const std::shared_ptr<ExprNode>& ast) {
     } else if (auto x = std::dynamic_pointer_cast<LValueNode>(ast)) {
         // 在这一步，指针类型会被转换为P_LONG寄存器
         if (!x->isArray()) return cgloadsym(x->getIdentifier(), x->getCalculateType()); // Load the global variable into a register
-        else {
+        else if (compiler_options.opt_level > 0 && x->getIndex() != nullptr) {
+            return cglea(selectAddress(x), P_LONG); // 数组元素的地址用一条 lea 算出
+        } else {
             Reg index;
             if (x->getIndex() != nullptr){
                 index = walkExpr(x->getIndex()); // Walk the index expression
@@ -172,12 +698,33 @@ Reg GenCode::walkExpr(const std::shared_ptr<ExprNode>& ast) {
         }
     } else if (auto x = std::dynamic_pointer_cast<AssignmentNode>(ast)) {
         // Handle assignment node
+        auto target = std::dynamic_pointer_cast<UnaryExpNode>(x->getLvalue());
+        if (compiler_options.opt_level > 0 && target != nullptr) {
+            // 存储的地址折叠进 mov 的寻址方式
+            Operand src, dst;
+            if (addressFirst(x)) {
+                dst = selectAddress(target->getExpr());
+                src.reg = walkExpr(x->getExpr());
+            } else {
+                src.reg = keepAcrossCalls(walkExpr(x->getExpr()), target->getExpr());
+                dst = selectAddress(target->getExpr());
+            }
+            cgstoreop(src, dst, x->getPrimitiveType());
+            return src.reg;
+        }
+        if (addressFirst(x)) {
+            Reg addr = walkExpr(std::dynamic_pointer_cast<UnaryExpNode>(x->getLvalue())->getExpr());
+            Reg reg = walkExpr(x->getExpr());
+            cgstorderef(reg, addr, x->getPrimitiveType());
+            return reg;
+        }
         Reg reg = walkExpr(x->getExpr()); // Walk the expression in the assignment node
 
         if (auto y = std::dynamic_pointer_cast<LValueNode>(x->getLvalue())) {
             cgstorsym(reg, y->getIdentifier(), x->getCalculateType());
         } else if (auto y = std::dynamic_pointer_cast<UnaryExpNode>(x->getLvalue())) {
             assert(y->getOp() == U_DEREF); // Ensure the unary operation is dereference
+            reg = keepAcrossCalls(reg, y->getExpr());
             Reg addr = walkExpr(y->getExpr()); // Walk the expression in the unary node
             cgstorderef(reg, addr, x->getPrimitiveType());
         }
@@ -190,18 +737,43 @@ Reg GenCode::walkExpr(const std::shared_ptr<ExprNode>& ast) {
     }
 }
 
-void GenCode::walkCondition(const std::shared_ptr<ExprNode>& ast, std::string false_label) {
-    if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(ast)) {
+// 条件的值等于 jump_if 时跳到 label，默认在条件为假时跳转。浮点比较不能取反，jump_if 只用于整数条件
+void GenCode::walkCondition(const std::shared_ptr<ExprNode>& ast, std::string label, bool jump_if) {
+    if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(ast); x != nullptr && compiler_options.opt_level > 0
+        && isComparison(x->getOp()) && x->getCalType() != P_FLOAT) {
+        // 比较直接生成 cmp/test 和条件跳转，常量作为立即数
+        ExprType op;
+        Operand left, right;
+        PrimitiveType type = walkCompareOperands(x, op, left, right);
+        if (jump_if) op = negateComparison(op);
+        return cgcompareopjump(left, right, type, op, label.c_str());
+    } else if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(ast); x != nullptr && compiler_options.opt_level > 0
+        && !isComparison(x->getOp()) && x->getCalType() != P_FLOAT) {
+        // 加减和位运算的最后一条指令已经按结果设置了ZF，其余的运算用 test。
+        // lea 不改变标志位：寄存器变量加减常量和指针偏移用 lea 算出时也要 test
+        ExprType op = x->getOp();
+        bool flags = op == A_ADD || op == A_SUBTRACT || op == A_AND || op == A_OR || op == A_XOR;
+        Reg reg = Reg{.type = P_NONE, .idx = 0};
+        if (op == A_ADD || op == A_SUBTRACT) {
+            reg = walkLea(x);
+            if (reg.type != P_NONE || is_pointer(x->getPrimitiveType())) flags = false;
+        }
+        if (reg.type == P_NONE) reg = walkExpr(x);
+        if (jump_if) return flags ? cgnonzerojump(reg, label.c_str()) : cgtestnonzerojump(reg, label.c_str());
+        return flags ? cgzerojump(reg, label.c_str()) : cgtestjump(reg, label.c_str());
+    } else if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(ast)) {
         Reg reg1 = walkExpr(x->getLeft()); // Walk the left expression
         Reg reg2 = walkExpr(x->getRight()); // Walk the right expression
         assert(reg1.type == reg2.type); // Ensure both registers have the same type
-        switch (x->getOp()) {
-            case A_EQ: return cgnotequaljump(reg1, reg2, false_label.c_str());
-            case A_NE: return cgequaljump(reg1, reg2, false_label.c_str());
-            case A_LT: return cggreaterequaljump(reg1, reg2, false_label.c_str());
-            case A_LE: return cggreaterthanjump(reg1, reg2, false_label.c_str());
-            case A_GT: return cglessequaljump(reg1, reg2, false_label.c_str());
-            case A_GE: return cglessthanjump(reg1, reg2, false_label.c_str());
+        ExprType op = x->getOp();
+        if (jump_if && isComparison(op)) op = negateComparison(op);
+        switch (op) {
+            case A_EQ: return cgnotequaljump(reg1, reg2, label.c_str());
+            case A_NE: return cgequaljump(reg1, reg2, label.c_str());
+            case A_LT: return cggreaterequaljump(reg1, reg2, label.c_str());
+            case A_LE: return cggreaterthanjump(reg1, reg2, label.c_str());
+            case A_GT: return cglessequaljump(reg1, reg2, label.c_str());
+            case A_GE: return cglessthanjump(reg1, reg2, label.c_str());
             case A_ADD: reg1 = cgadd(reg1, reg2); break;// Add the two registers and return the result
             case A_SUBTRACT: reg1 = cgsub(reg1, reg2); break;// Subtract the two registers and return the result
             case A_MULTIPLY: reg1 = cgmul(reg1, reg2); break;// Multiply the two registers and return the result
@@ -214,14 +786,294 @@ void GenCode::walkCondition(const std::shared_ptr<ExprNode>& ast, std::string fa
             default:
                 throw std::runtime_error("GenCode::walkCondition: Unknown binary expression type");
         }
-        reg2 = cgload(Value{ .type = P_LONG, .ivalue = 0 }); // Load zero into a register
-        return cgequaljump(reg1, reg2, false_label.c_str()); // Compare the result with zero and jump if equal
+        reg2 = cgload(Value{ .type = reg1.type == P_INT ? P_INT : P_LONG, .ivalue = 0 }); // Load zero into a register of the result's width
+        if (jump_if) return cgnotequaljump(reg1, reg2, label.c_str());
+        return cgequaljump(reg1, reg2, label.c_str()); // Compare the result with zero and jump if equal
+    } else if (auto x = std::dynamic_pointer_cast<ValueNode>(ast); x != nullptr && x->getValue().type != P_FLOAT) {
+        // 常量条件不需要比较，如尾递归改写出的 while (1)
+        Value v = x->getValue();
+        if (((v.type == P_LONG ? v.lvalue : v.ivalue) != 0) == jump_if) cgjump(label.c_str());
     } else {
         Reg reg1 = walkExpr(ast); // Walk the expression in the condition
+        if (compiler_options.opt_level > 0 && reg1.type != P_FLOAT) {
+            return jump_if ? cgtestnonzerojump(reg1, label.c_str()) : cgtestjump(reg1, label.c_str());
+        }
         reg1.type = P_LONG; // Ensure the register is treated as a long integer
         Reg reg2 = cgload(Value{ .type = P_LONG, .ivalue = 0 }); // Load zero into a register
-        return cgequaljump(reg1, reg2, false_label.c_str()); // Compare the result with zero and jump if equal
+        if (jump_if) return cgnotequaljump(reg1, reg2, label.c_str());
+        return cgequaljump(reg1, reg2, label.c_str()); // Compare the result with zero and jump if equal
+    }
+}
+
+// 分支中唯一的一条语句是给标量变量的赋值时返回它
+static std::shared_ptr<AssignmentNode> singleAssignment(const std::shared_ptr<StatementNode>& stmt) {
+    if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        if (x->getStatements().size() != 1) return nullptr;
+        return singleAssignment(x->getStatements()[0]);
     }
+    auto x = std::dynamic_pointer_cast<AssignmentNode>(stmt);
+    auto var = x != nullptr ? std::dynamic_pointer_cast<LValueNode>(x->getLvalue()) : nullptr;
+    if (var == nullptr || var->isArray()) return nullptr;
+    return x;
+}
+
+// 不管条件是否成立都计算时的运算个数。只允许常量、标量变量和不会出错的运算，
+// 读内存可能越界、整数除法可能除零，这些表达式和其他有副作用的表达式返回-1
+static int speculationCost(const std::shared_ptr<ExprNode>& ast) {
+    if (auto x = std::dynamic_pointer_cast<ValueNode>(ast)) {
+        return x->getValue().type == P_STRING ? -1 : 0;
+    } else if (auto x = std::dynamic_pointer_cast<LValueNode>(ast)) {
+        return x->isArray() ? -1 : 0;
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(ast)) {
+        UnaryOp op = x->getOp();
+        if (op != U_PLUS && op != U_MINUS && op != U_NOT && op != U_INVERT && op != U_TRANSFORM) return -1;
+        int cost = speculationCost(x->getExpr());
+        return cost < 0 ? -1 : cost + (op != U_PLUS);
+    } else if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(ast)) {
+        ExprType op = x->getOp();
+        if (op == A_DIVIDE || op == A_MOD) return -1;
+        int left = speculationCost(x->getLeft());
+        int right = speculationCost(x->getRight());
+        return left < 0 || right < 0 ? -1 : left + right + 1;
+    }
+    return -1;
+}
+
+// if 转换：两个分支只给同一个标量变量赋值，赋的值又可以无条件计算时，整数用 cmov，浮点数用 minsd/maxsd
+// 或者按比较结果的掩码选择，不再有会预测错的跳转。两边的值都要算出来，只转换总共不超过3个运算的分支；
+// profile 中九成以上走同一边的分支能被准确预测，保留跳转
+bool GenCode::walkSelect(const std::shared_ptr<IfStatementNode>& ast) {
+    if (compiler_options.opt_level == 0) return false;
+    auto cond = std::dynamic_pointer_cast<BinaryExpNode>(ast->getCondition());
+    auto then_assign = singleAssignment(ast->getThenStatement());
+    if (cond == nullptr || !isComparison(cond->getOp()) || hasSideEffects(cond) || then_assign == nullptr) return false;
+    auto var = std::dynamic_pointer_cast<LValueNode>(then_assign->getLvalue());
+    std::shared_ptr<ExprNode> if_false = var; // 没有 else 时变量保持原来的值
+    if (ast->getElseStatement() != nullptr) {
+        auto else_assign = singleAssignment(ast->getElseStatement());
+        if (else_assign == nullptr) return false;
+        if (std::dynamic_pointer_cast<LValueNode>(else_assign->getLvalue())->getSymbol() != var->getSymbol()) return false;
+        if_false = else_assign->getExpr();
+    }
+    auto if_true = then_assign->getExpr();
+    int true_cost = speculationCost(if_true);
+    int false_cost = speculationCost(if_false);
+    if (true_cost < 0 || false_cost < 0 || true_cost + false_cost > 3) return false;
+    long then_count = ast->getThenCount();
+    long else_count = ast->getElseCount();
+    if (then_count >= 0 && else_count >= 0 && std::min(then_count, else_count) * 10 < then_count + else_count) return false;
+
+    PrimitiveType type = var->getSymbol()->type;
+    bool done;
+    if (cond->getCalType() == P_FLOAT) done = type == P_FLOAT && walkFloatSelect(cond, var, if_true, if_false);
+    else done = type != P_FLOAT && walkIntSelect(ast, var, if_true, if_false);
+    if (done) opt_stats.count("if-convert", func_name);
+    return done;
+}
+
+// expr是否读取放在寄存器reg中的变量
+static bool readsRegister(const std::shared_ptr<ExprNode>& expr, const std::string& reg) {
+    bool ret = false;
+    forEachNode(expr, [&](const std::shared_ptr<ASTNode>& n, int) {
+        auto x = std::dynamic_pointer_cast<LValueNode>(n);
+        if (x != nullptr && x->getSymbol()->home_reg == reg) ret = true;
+    });
+    return ret;
+}
+
+// 变量在寄存器中时用 cmov 直接改写变量，有 else 时先照常执行 else 的赋值，这要求条件和 then 的值都不读变量所在的寄存器；
+// 否则在临时寄存器中选出结果再存回变量
+bool GenCode::walkIntSelect(const std::shared_ptr<IfStatementNode>& ast, const std::shared_ptr<LValueNode>& var,
+    const std::shared_ptr<ExprNode>& if_true, const std::shared_ptr<ExprNode>& if_false) {
+    PrimitiveType type = registerType(var->getSymbol()->type);
+    auto cond = std::dynamic_pointer_cast<BinaryExpNode>(ast->getCondition());
+    if (type != P_INT && type != P_LONG) return false;
+    if (registerNeed(cond) + registerNeed(if_true) + registerNeed(if_false) > 4) return false;
+    const Symbol* sym = var->getSymbol().get();
+    // 活跃范围不相交的变量可能被分配到同一个寄存器，只比较符号不够
+    bool direct = !sym->home_reg.empty() && (ast->getElseStatement() == nullptr
+        || (!readsRegister(cond, sym->home_reg) && !readsRegister(if_true, sym->home_reg)));
+    Operand dst;
+    if (direct) {
+        if (ast->getElseStatement() != nullptr) walkStatement(ast->getElseStatement());
+        dst.kind = Operand::SYM;
+        dst.sym = var->getIdentifier();
+    } else {
+        dst.reg = walkExpr(if_false);
+    }
+    Operand src;
+    if (scalarOperand(if_true, type)) src = selectOperand(if_true, type);
+    else src.reg = walkExpr(if_true);
+    ExprType op;
+    Operand left, right;
+    PrimitiveType cmp_type = walkCompareOperands(cond, op, left, right);
+    cgcmov(left, right, cmp_type, op, src, dst, type);
+    if (!direct) {
+        cgstorsym(dst.reg, var->getIdentifier(), var->getCalculateType());
+        freereg(dst.reg);
+    }
+    return true;
+}
+
+// 选出比较的一边时就是 minsd/maxsd：a < b 时取 a 否则取 b 等于 min(a, b)，两边相等或有 NaN 时都取 b。
+// 其余的情况用 cmpsd 得到掩码，再用位运算合成结果
+bool GenCode::walkFloatSelect(const std::shared_ptr<BinaryExpNode>& cond, const std::shared_ptr<LValueNode>& var,
+    const std::shared_ptr<ExprNode>& if_true, const std::shared_ptr<ExprNode>& if_false) {
+    ExprType op = cond->getOp();
+    auto left = cond->getLeft();
+    auto right = cond->getRight();
+    Reg result;
+    if ((op == A_LT || op == A_GT) && exprEqual(if_true, left) && exprEqual(if_false, right)) {
+        result = walkExpr(left);
+        result = cgfloatminmax(result, selectOperand(right, P_FLOAT), op == A_GT);
+    } else if ((op == A_LT || op == A_GT) && exprEqual(if_true, right) && exprEqual(if_false, left)) {
+        result = walkExpr(right);
+        result = cgfloatminmax(result, selectOperand(left, P_FLOAT), op == A_LT);
+    } else {
+        // 掩码、两个值同时占着寄存器，浮点临时寄存器只有4个
+        if (registerNeed(cond) > 3 || registerNeed(if_true) > 2 || registerNeed(if_false) > 2) return false;
+        Reg mask = walkExpr(left);
+        mask = cgfloatmask(mask, walkExpr(right), op);
+        Reg value = walkExpr(if_true);
+        result = cgfloatblend(mask, value, walkExpr(if_false));
+    }
+    cgstorsym(result, var->getIdentifier(), var->getCalculateType());
+    freereg(result);
+    return true;
+}
+
+// if 语句的布局。有 profile 时，从没执行过的分支放进 .text.unlikely，
+// 执行得更多的 else 放在条件跳转之后落空，then 成为跳转目标
+void GenCode::walkIf(const std::shared_ptr<IfStatementNode>& ast) {
+    if (walkSelect(ast)) return;
+    std::string if_label_no = labelAllocator.getLabel(LableType::IF_LABEL);
+    std::string if_true = "IF_TRUE_" + if_label_no;
+    std::string if_false = "IF_FALSE_" + if_label_no;
+    std::string if_end = "IF_END_" + if_label_no;
+    auto cond = ast->getCondition();
+    auto else_stmt = ast->getElseStatement();
+    long then_count = ast->getThenCount();
+    long else_count = ast->getElseCount();
+    bool invertible = canInvertCondition(cond);
+    bool cold_then = invertible && then_count == 0 && else_count > 0;
+    bool cold_else = else_stmt != nullptr && else_count == 0 && then_count > 0;
+    bool hot_else = invertible && else_stmt != nullptr && else_count > then_count && then_count > 0;
+    if (cold_then || cold_else || hot_else) opt_stats.count("profile-layout", func_name);
+
+    if (cold_then || hot_else) {
+        walkCondition(cond, if_true, true);
+        cglabel(if_false.c_str());
+        if (else_stmt != nullptr) walkStatement(else_stmt);
+        if (cold_then) cgcoldsection();
+        else cgjump(if_end.c_str());
+        cglabel(if_true.c_str());
+        walkStatement(ast->getThenStatement());
+        if (cold_then) {
+            cgjump(if_end.c_str());
+            cgendcoldsection();
+        }
+        cglabel(if_end.c_str());
+        return;
+    }
+    walkCondition(cond, if_false); // Walk the condition and generate code for the jump
+    cglabel(if_true.c_str());
+    walkStatement(ast->getThenStatement()); // Walk the then statement
+    if (cold_else) cgcoldsection();
+    cgjump(if_end.c_str());
+    cglabel(if_false.c_str());
+    if (else_stmt != nullptr) {
+        walkStatement(else_stmt); // Walk the else statement
+    }
+    if (cold_else) {
+        cgjump(if_end.c_str());
+        cgendcoldsection();
+    }
+    cglabel(if_end.c_str()); // Generate the end label for the if statement
+}
+
+// 只有不含循环和调用的最内层循环值得对齐：外层循环头执行的次数少，填充反而会挪动内层循环的位置
+static bool isInnermostLoop(const std::shared_ptr<StatementNode>& body) {
+    bool ret = true;
+    forEachNode(body, [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (std::dynamic_pointer_cast<WhileStatementNode>(n) || std::dynamic_pointer_cast<ForStatementNode>(n)
+            || std::dynamic_pointer_cast<VectorLoopNode>(n) || std::dynamic_pointer_cast<FunctionCallNode>(n)
+            || std::dynamic_pointer_cast<PrintStatementNode>(n)) ret = false;
+    });
+    return ret;
+}
+
+// 循环倒置：入口先判断一次条件，条件放在循环底部，每次迭代只执行一次跳回循环体的条件跳转，
+// 省掉了条件在顶部时回到开头的 jmp。continue 跳到的 start 在底部的条件之前
+void GenCode::walkLoop(const std::shared_ptr<ExprNode>& cond, const std::shared_ptr<StatementNode>& body,
+    const std::shared_ptr<StatementNode>& postop, const std::string& start, const std::string& end, bool guard) {
+    std::string loop_body = labelAllocator.getLabel(LableType::LOOP_LABEL);
+    if (guard) walkCondition(cond, end);
+    if (cold_depth == 0 && isInnermostLoop(body)) cgalignloop();
+    cglabel(loop_body.c_str());
+    walkStatement(body);
+    if (postop != nullptr) walkStatement(postop);
+    cglabel(start.c_str());
+    walkCondition(cond, loop_body, true);
+    cglabel(end.c_str());
+}
+
+// 向量循环：数组参数可能重叠时直接跳到结尾，由后面的标量循环处理全部元素
+void GenCode::walkVectorLoop(const std::shared_ptr<VectorLoopNode>& ast) {
+    std::string label_no = labelAllocator.getLabel(LableType::VECTOR_LABEL);
+    std::string vec_start = "VEC_START_" + label_no;
+    std::string vec_end = "VEC_END_" + label_no;
+    PrimitiveType type = ast->getElementType();
+    long bytes = (long)ast->getWidth() * symbol_table.typeToSize(type);
+    for (const auto& [a, b] : ast->getAliasChecks()) {
+        Reg reg1 = walkExpr(a);
+        Reg reg2 = walkExpr(b);
+        cgoverlapjump(cgsub(reg1, reg2), bytes, vec_end.c_str());
+    }
+    for (const auto& [expr, pos] : ast->getInvariants()) {
+        Symbol slot = {"", type, (int)bytes, false, false, pos};
+        Reg reg = cgvbroadcast(walkExpr(expr), type);
+        cgvstore(reg, cgaddress(slot), type);
+    }
+    // 和标量循环一样倒置，条件在底部
+    walkCondition(ast->getCondition(), vec_end);
+    if (cold_depth == 0) cgalignloop();
+    cglabel(vec_start.c_str());
+    for (const auto& stmt : ast->getBody()) {
+        Reg reg = walkVectorExpr(ast, stmt->getExpr());
+        auto lvalue = std::dynamic_pointer_cast<UnaryExpNode>(stmt->getLvalue());
+        Reg addr = walkExpr(lvalue->getExpr()); // 数组元素的地址
+        cgvstore(reg, addr, type);
+    }
+    walkStatement(ast->getIncrement());
+    walkCondition(ast->getCondition(), vec_start, true);
+    cglabel(vec_end.c_str());
+    cgvzeroupper();
+}
+
+// 向量表达式：数组元素按向量读取，其他的叶子是循环不变的标量，从进入循环前展开好的栈槽中读取
+Reg GenCode::walkVectorExpr(const std::shared_ptr<VectorLoopNode>& loop, const std::shared_ptr<ExprNode>& ast) {
+    PrimitiveType type = loop->getElementType();
+    if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(ast)) {
+        auto y = std::dynamic_pointer_cast<LValueNode>(x->getExpr());
+        if (x->getOp() == U_DEREF && y != nullptr && y->isArray()) return cgvload(walkExpr(y), type);
+    } else if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(ast)) {
+        Reg reg1 = walkVectorExpr(loop, x->getLeft());
+        Reg reg2 = walkVectorExpr(loop, x->getRight());
+        switch (x->getOp()) {
+            case A_ADD: return cgvadd(reg1, reg2, type);
+            case A_SUBTRACT: return cgvsub(reg1, reg2, type);
+            case A_MULTIPLY: return cgvmul(reg1, reg2, type);
+            case A_DIVIDE: return cgvdiv(reg1, reg2, type);
+            default:
+                throw std::runtime_error("GenCode::walkVectorExpr: Unsupported vector operation");
+        }
+    }
+    for (const auto& [expr, pos] : loop->getInvariants()) {
+        if (expr != ast) continue;
+        Symbol slot = {"", type, loop->getWidth() * symbol_table.typeToSize(type), false, false, pos};
+        return cgvload(cgaddress(slot), type);
+    }
+    throw std::runtime_error("GenCode::walkVectorExpr: Unsupported vector operand");
 }
 
 void GenCode::localArrayInit(const std::shared_ptr<ArrayInitializer>& y) {
@@ -256,6 +1108,105 @@ void GenCode::localArrayInit(const std::shared_ptr<ArrayInitializer>& y) {
     }
 }
 
+// 按内存布局展开数组初值，没有给出的元素补零
+void GenCode::arrayImage(const std::shared_ptr<ArrayInitializer>& init, std::vector<unsigned char>& image) {
+    PrimitiveType type = init->getPrimitiveType();
+    int elem_size = symbol_table.typeToSize(type);
+    for (const auto& elem : init->getElements()) {
+        if (auto x = std::dynamic_pointer_cast<ArrayInitializer>(elem)) {
+            arrayImage(x, image);
+            continue;
+        }
+        auto z = std::dynamic_pointer_cast<ValueNode>(elem);
+        unsigned char bytes[8] = {};
+        if (type == P_INT) {
+            int v = z->getIntValue();
+            std::memcpy(bytes, &v, sizeof(v));
+        } else if (type == P_FLOAT) {
+            double v = z->getFloatValue();
+            std::memcpy(bytes, &v, sizeof(v));
+        } else if (type == P_LONG) {
+            long v = z->getLongValue();
+            std::memcpy(bytes, &v, sizeof(v));
+        } else if (type == P_CHAR) {
+            bytes[0] = z->getCharValue();
+        } else {
+            throw std::runtime_error("GenCode::arrayImage: Unknown array element type");
+        }
+        image.insert(image.end(), bytes, bytes + elem_size);
+    }
+    image.resize(image.size() + init->getLeftSize() * elem_size, 0);
+}
+
+// 先分派到各个分支的标号，再按源代码顺序生成分支，没有 break 的分支自然落入下一个
+void GenCode::walkSwitch(const std::shared_ptr<SwitchStatementNode>& ast) {
+    std::string switch_end = ast->getSwitchEndLabel();
+    std::string default_label = switch_end;
+    std::vector<std::string> labels;
+    std::vector<std::pair<long, std::string>> cases;
+    for (const auto& c : ast->getCases()) {
+        labels.push_back("SWITCH_CASE_" + labelAllocator.getLabel(LableType::SWITCH_LABEL));
+        if (c.is_default) default_label = labels.back();
+        for (long value : c.values) cases.push_back({value, labels.back()});
+    }
+    std::sort(cases.begin(), cases.end());
+    Reg reg = walkExpr(ast->getCondition());
+    walkSwitchCases(reg, cases, 0, cases.size(), default_label);
+    freereg(reg);
+    for (size_t i = 0; i < labels.size(); i++) {
+        cglabel(labels[i].c_str());
+        walkStatement(ast->getCases()[i].body);
+    }
+    cglabel(switch_end.c_str());
+}
+
+// 在按值排好序的 cases[begin, end) 中分派，不等于其中任何值时跳到 default_label。
+// 目标很少、值域不超过64时用位测试；至少三分之一的值有 case 时用跳转表；
+// 否则和中间的值比较后两边递归，稀疏的 switch 中稠密的一段仍然可以用跳转表
+void GenCode::walkSwitchCases(Reg reg, const std::vector<std::pair<long, std::string>>& cases, size_t begin, size_t end, const std::string& default_label) {
+    size_t n = end - begin;
+    if (n == 0) {
+        cgjump(default_label.c_str());
+        return;
+    }
+    long low = cases[begin].first;
+    long high = cases[end - 1].first;
+    bool small = low >= INT32_MIN && high <= INT32_MAX;
+    unsigned long range = small ? (unsigned long)(high - low) + 1 : 0;
+
+    std::vector<std::pair<std::string, unsigned long>> masks;
+    if (small && range <= 64) {
+        for (size_t i = begin; i < end; i++) {
+            auto it = std::find_if(masks.begin(), masks.end(), [&](const auto& m) { return m.first == cases[i].second; });
+            if (it == masks.end()) it = masks.insert(masks.end(), {cases[i].second, 0});
+            it->second |= 1UL << (cases[i].first - low);
+        }
+    }
+    // 和逐个比较相比，每个目标的位测试要多三条指令，值足够多时才划算
+    size_t bittest_min = masks.size() == 1 ? 3 : masks.size() == 2 ? 5 : 6;
+    if (!masks.empty() && masks.size() <= 3 && n >= bittest_min) {
+        cgbittest(reg, low, high, masks, default_label.c_str());
+        return;
+    }
+    if (small && n >= 4 && range <= 3 * n) {
+        std::vector<std::string> targets(range, default_label);
+        for (size_t i = begin; i < end; i++) targets[cases[i].first - low] = cases[i].second;
+        cgjumptable(reg, low, targets, default_label.c_str());
+        return;
+    }
+    if (n <= 3) {
+        for (size_t i = begin; i < end; i++) cgswitchcompare(reg, cases[i].first, cases[i].second.c_str(), nullptr);
+        cgjump(default_label.c_str());
+        return;
+    }
+    size_t mid = begin + n / 2;
+    std::string left = "SWITCH_TREE_" + labelAllocator.getLabel(LableType::SWITCH_LABEL);
+    cgswitchcompare(reg, cases[mid].first, cases[mid].second.c_str(), left.c_str());
+    walkSwitchCases(reg, cases, mid + 1, end, default_label);
+    cglabel(left.c_str());
+    walkSwitchCases(reg, cases, begin, mid, default_label);
+}
+
 Reg GenCode::walkStatement(const std::shared_ptr<StatementNode>& ast) {
     if (auto x = std::dynamic_pointer_cast<BlockNode>(ast)) {
         std::string block_label = labelAllocator.getLabel(LableType::BLOCK_LABEL);
@@ -268,7 +1219,8 @@ Reg GenCode::walkStatement(const std::shared_ptr<StatementNode>& ast) {
     } else if (auto x  = std::dynamic_pointer_cast<PrintStatementNode>(ast)) {
         Reg reg = walkExpr(x->getExpression());
 
-        if (x->getCalculateType() == P_LONG) cgprintlong(reg);
+        // 语义检查已经把表达式转换成 long 或 float
+        if (x->getExpression()->getCalculateType() == P_LONG) cgprintlong(reg);
         else cgprintfloat(reg); // Print the value in the register
         return Reg{.type = P_NONE, .idx = 0};
     } else if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(ast)) {
@@ -283,6 +1235,14 @@ Reg GenCode::walkStatement(const std::shared_ptr<StatementNode>& ast) {
                 assemblyCode->freereg(reg);
             } else {
                 if (auto y = std::dynamic_pointer_cast<ArrayInitializer>(initializer)) {
+                    if (compiler_options.opt_level > 0) {
+                        // 初值都是常量，整个数组的内容在编译期就确定了，一次复制代替逐个元素的存储
+                        std::vector<unsigned char> image;
+                        arrayImage(y, image);
+                        image.resize(identifier.size, 0);
+                        cglocalarraycopy(identifier.getFrameOffset(), image);
+                        continue;
+                    }
                     y->setBaseOffset();
                     localArrayInit(y); // Initialize the local array variable
                 } else {
@@ -292,25 +1252,15 @@ Reg GenCode::walkStatement(const std::shared_ptr<StatementNode>& ast) {
         }
         return Reg{.type = P_NONE, .idx = 0};
     } else if (auto x = std::dynamic_pointer_cast<IfStatementNode>(ast)) {
-        // 目前只考虑都是Block
-        // TODO: assignment寄存器的释放
-        std::string if_label_no = labelAllocator.getLabel(LableType::IF_LABEL);
-        std::string if_true = "IF_TRUE_" + if_label_no;
-        std::string if_false = "IF_FALSE_" + if_label_no;
-        std::string if_end = "IF_END_" + if_label_no;
-        walkCondition(x->getCondition(), if_false); // Walk the condition and generate code for the jump
-        cglabel(if_true.c_str());
-        walkStatement(x->getThenStatement()); // Walk the then statement
-        cgjump(if_end.c_str());
-        cglabel(if_false.c_str());
-        if (x->getElseStatement() != nullptr) {
-            walkStatement(x->getElseStatement()); // Walk the else statement
-        }
-        cglabel(if_end.c_str()); // Generate the end label for the if statement
+        walkIf(x);
         return Reg{.type = P_NONE, .idx = 0};
     } else if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(ast)) {
         std::string while_start = x->getWhileStartLabel(); // Get the start label for the while loop
         std::string while_end = x->getWhileEndLabel(); // Get the end label for the while loop
+        if (compiler_options.opt_level > 0 && canInvertCondition(x->getCondition())) {
+            walkLoop(x->getCondition(), x->getBody(), nullptr, while_start, while_end, true);
+            return Reg{.type = P_NONE, .idx = 0};
+        }
         cglabel(while_start.c_str()); // Generate the start label for the while loop
         walkCondition(x->getCondition(), while_end); // Walk the condition and generate code for the jump
         walkStatement(x->getBody()); // Walk the body of the while loop
@@ -323,6 +1273,11 @@ Reg GenCode::walkStatement(const std::shared_ptr<StatementNode>& ast) {
         if (x->getPreopStatement() != nullptr) {
             walkStatement(x->getPreopStatement()); // Walk the pre-operation statement
         }
+        if (compiler_options.opt_level > 0 && canInvertCondition(x->getCondition())) {
+            bool guard = !entersLoop(x->getPreopStatement(), x->getCondition());
+            walkLoop(x->getCondition(), x->getBody(), x->getPostopStatement(), for_start, for_end, guard);
+            return Reg{.type = P_NONE, .idx = 0};
+        }
         cglabel(for_start.c_str()); // Generate the start label for the for loop
         walkCondition(x->getCondition(), for_end); // Walk the condition and generate code for the jump
         walkStatement(x->getBody()); // Walk the body of the for loop
@@ -332,8 +1287,15 @@ Reg GenCode::walkStatement(const std::shared_ptr<StatementNode>& ast) {
         cgjump(for_start.c_str()); // Jump back to the start of the loop
         cglabel(for_end.c_str()); // Generate the end label for the for loop
         return Reg{.type = P_NONE, .idx = 0};
+    } else if (auto x = std::dynamic_pointer_cast<VectorLoopNode>(ast)) {
+        walkVectorLoop(x);
+        return Reg{.type = P_NONE, .idx = 0};
+    } else if (auto x = std::dynamic_pointer_cast<SwitchStatementNode>(ast)) {
+        walkSwitch(x);
+        return Reg{.type = P_NONE, .idx = 0};
     } else if (auto x = std::dynamic_pointer_cast<ExprNode>(ast)) {
         // Handle expression node
+        if (walkEffect(x)) return Reg{.type = P_NONE, .idx = 0};
         Reg reg = walkExpr(x); // Walk the expression node to generate code
         if (reg.type != P_NONE) assemblyCode->freereg(reg); // Free the register after use
         return Reg{.type = P_NONE, .idx = 0};
@@ -346,13 +1308,113 @@ Reg GenCode::walkStatement(const std::shared_ptr<StatementNode>& ast) {
     } else if (auto x = std::dynamic_pointer_cast<ContinueStatementNode>(ast)) {
         cgjump(x->getLabel().c_str());
         return Reg{.type = P_NONE, .idx = 0}; // Jump to the continue label
+    } else if (auto x = std::dynamic_pointer_cast<ProfileCounterNode>(ast)) {
+        cgprofilecounter(x->getIndex());
+        return Reg{.type = P_NONE, .idx = 0};
     } else {
         throw std::runtime_error("GenCode::generate: Unknown statement node type");
     }
 }
 
-void GenCode::walkFunction(const std::shared_ptr<FunctionDeclareNode>& ast) {
-    walkStatement(ast->getBody()); // Walk the function body to generate code
+// 生成函数体，跳过已经在序言之前生成的语句
+void GenCode::walkFunction(const std::shared_ptr<FunctionDeclareNode>& ast, const std::set<std::shared_ptr<StatementNode>>& done) {
+    for (const auto& stmt : ast->getBody()->getStatements()) {
+        if (!done.count(stmt)) walkStatement(stmt); // Walk the function body to generate code
+    }
+}
+
+static const std::vector<std::string> int_param_regs = { "%rdi", "%rsi", "%rdx", "%rcx", "%r8", "%r9" };
+
+// 不需要栈帧就能计算的表达式需要的临时寄存器个数，不能计算时返回-1。
+// 只允许常量和仍在传入寄存器中的整数参数，不能有调用、访存和会用到%rdx/%rcx的除法和移位
+static int framelessRegs(const std::shared_ptr<ExprNode>& ast, const std::map<Symbol*, std::string>& incoming) {
+    if (auto x = std::dynamic_pointer_cast<ValueNode>(ast)) {
+        PrimitiveType type = x->getValue().type;
+        return type == P_FLOAT || type == P_STRING ? -1 : 1;
+    } else if (auto x = std::dynamic_pointer_cast<LValueNode>(ast)) {
+        return !x->isArray() && incoming.count(x->getSymbol().get()) ? 1 : -1;
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(ast)) {
+        UnaryOp op = x->getOp();
+        if (op != U_MINUS && op != U_PLUS && op != U_NOT && op != U_INVERT && op != U_TRANSFORM) return -1;
+        if (x->getPrimitiveType() == P_FLOAT || x->getExpr()->getPrimitiveType() == P_FLOAT) return -1;
+        return framelessRegs(x->getExpr(), incoming);
+    } else if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(ast)) {
+        switch (x->getOp()) {
+            case A_ADD: case A_SUBTRACT: case A_MULTIPLY: case A_AND: case A_OR: case A_XOR:
+            case A_EQ: case A_NE: case A_LT: case A_LE: case A_GT: case A_GE:
+                break;
+            default:
+                return -1;
+        }
+        if (x->getCalType() == P_FLOAT) return -1;
+        int left = framelessRegs(x->getLeft(), incoming);
+        int right = framelessRegs(x->getRight(), incoming);
+        if (left < 0 || right < 0) return -1;
+        return std::max(left, right + 1); // 先算左边，算右边时左边的结果占着一个寄存器
+    }
+    return -1;
+}
+
+// 收缩包装：函数开头的 if (cond) return expr; 只用到传入寄存器中的参数和常量时，在序言之前生成，
+// 提前返回的路径不建立栈帧、不保存寄存器，也不把参数存到栈上。临时寄存器限制在 r10/r11，
+// 不会用到需要在序言中保存的 r12/r13。没有初值的声明不生成代码，可以越过。返回已经生成的语句
+std::set<std::shared_ptr<StatementNode>> GenCode::walkEarlyExits(const std::shared_ptr<FunctionDeclareNode>& ast) {
+    std::vector<std::shared_ptr<Symbol>> params;
+    if (ast->getParams() != nullptr) params = ast->getParams()->getParams();
+    std::map<Symbol*, std::string> incoming;
+    int int_idx = 0;
+    for (const auto& param : params) {
+        if (param->type == P_FLOAT) continue;
+        if (int_idx < (int)int_param_regs.size() && !param->is_array) incoming[param.get()] = int_param_regs[int_idx];
+        int_idx++;
+    }
+
+    std::vector<std::pair<std::shared_ptr<ExprNode>, std::shared_ptr<ReturnStatementNode>>> exits;
+    std::set<std::shared_ptr<StatementNode>> done;
+    for (const auto& stmt : ast->getBody()->getStatements()) {
+        if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(stmt)) {
+            bool initialized = false;
+            for (const auto& sym : x->getSymbols()) {
+                if (x->getInitializer(*sym) != nullptr) initialized = true;
+            }
+            if (initialized) break;
+            continue;
+        }
+        auto x = std::dynamic_pointer_cast<IfStatementNode>(stmt);
+        if (x == nullptr || x->getElseStatement() != nullptr) break;
+        auto then_stmt = x->getThenStatement();
+        if (auto y = std::dynamic_pointer_cast<BlockNode>(then_stmt); y != nullptr && y->getStatements().size() == 1) {
+            then_stmt = y->getStatements()[0];
+        }
+        auto ret = std::dynamic_pointer_cast<ReturnStatementNode>(then_stmt);
+        if (ret == nullptr || ret->isTailCall()) break;
+        int regs = framelessRegs(x->getCondition(), incoming);
+        if (regs < 0 || regs > 2) break;
+        if (ret->getExpression() != nullptr) {
+            regs = framelessRegs(ret->getExpression(), incoming);
+            if (regs < 0 || regs > 2) break;
+        }
+        exits.push_back({x->getCondition(), ret});
+        done.insert(stmt);
+    }
+    if (exits.empty()) return done;
+
+    // 生成时参数从传入的寄存器中读取
+    std::map<Symbol*, std::string> homes;
+    for (auto& [sym, reg] : incoming) {
+        homes[sym] = sym->home_reg;
+        sym->home_reg = reg;
+    }
+    for (const auto& [cond, ret] : exits) {
+        std::string if_false = "IF_FALSE_" + labelAllocator.getLabel(LableType::IF_LABEL);
+        walkCondition(cond, if_false);
+        if (ret->getExpression() != nullptr) cgframelessreturn(walkExpr(ret->getExpression()));
+        else cgframelessreturn(Reg{.type = P_VOID, .idx = 0});
+        cglabel(if_false.c_str());
+    }
+    for (auto& [sym, reg] : homes) sym->home_reg = reg;
+    opt_stats.count("shrinkwrap", ast->getIdentifier(), exits.size());
+    return done;
 }
 
 void GenCode::walkFunctionParam(const std::shared_ptr<FunctionParamNode>& ast) {
@@ -366,34 +1428,49 @@ void GenCode::walkFunctionParam(const std::shared_ptr<FunctionParamNode>& ast) {
 }
 
 Reg GenCode::walkPragram(const std::shared_ptr<Pragram>& ast) {
+    // 初值能在编译期算出的全局变量直接写进数据段，只有依赖运行时状态的初值在main的开头求值
+    std::vector<std::pair<Symbol, std::shared_ptr<ExprNode>>> dynamic_inits;
     for (const auto &x: ast->getGlobalVariables()) {
         for (const auto &identifier: x->getIdentifiers()) {
-            if (identifier.is_array) cgglobsym(identifier, std::dynamic_pointer_cast<ArrayInitializer> (x->getInitializer(identifier))); // Declare a global array variable with the given identifier and type
-            else cgglobsym(identifier); // Declare a global variable with the given identifier and type
+            auto initializer = x->getInitializer(identifier);
+            Value value;
+            if (identifier.is_array) {
+                cgglobsym(identifier, std::dynamic_pointer_cast<ArrayInitializer>(initializer)); // Declare a global array variable with the given identifier and type
+            } else if (getStaticInitializer(identifier, initializer, value)) {
+                cgglobvalue(identifier, value);
+            } else {
+                cgglobsym(identifier); // Declare a global variable with the given identifier and type
+                if (initializer != nullptr) dynamic_inits.push_back({identifier, initializer});
+            }
         }
     }
-    // for (const auto &x: ast->getGlobalVariables()) {
-    //     walkStatement(x); // Walk each global variable declaration to generate code
-    // } 
     for (const auto &x: ast->getFunctions()) {
-        std::string func_name = x->getIdentifier() ;
+        func_name = x->getIdentifier() ;
         Function func = symbol_table.getFunction(func_name); // Get the function from the symbol table
+        func.is_leaf = true;
+        func.is_cold = x->getProfileCount() == 0;
+        cold_depth = func.is_cold ? 1 : 0;
+        auto visit = [&](const std::shared_ptr<ASTNode>& n, int) {
+            if (std::dynamic_pointer_cast<FunctionCallNode>(n) || std::dynamic_pointer_cast<PrintStatementNode>(n)) func.is_leaf = false;
+        };
+        forEachNode(x->getBody(), visit);
+        if (func_name == "main") {
+            for (const auto& [identifier, initializer] : dynamic_inits) forEachNode(initializer, visit);
+        }
         cgfuncpreamble(func); // Generate function preamble code
+        std::set<std::shared_ptr<StatementNode>> done;
+        if (compiler_options.opt_level > 0 && func_name != "main") done = walkEarlyExits(x);
+        cgprologue();
         walkFunctionParam(x->getParams()); // Walk the function parameters to generate code
         if (func_name == "main") {
             // 全局变量初始化
-            for (const auto &x: ast->getGlobalVariables()) {
-                for (const auto &identifier: x->getIdentifiers()) {
-                    auto initializer = x->getInitializer(identifier);
-                    if (initializer != nullptr && !identifier.is_array) {
-                        Reg reg = walkExpr(initializer);
-                        reg = cgstorsym(reg, identifier, x->getVariableType()); // Store the value in the global variable
-                        assemblyCode->freereg(reg);
-                    }
-                }
+            for (const auto& [identifier, initializer] : dynamic_inits) {
+                Reg reg = walkExpr(initializer);
+                reg = cgstorsym(reg, identifier, identifier.type); // Store the value in the global variable
+                assemblyCode->freereg(reg);
             }
         }
-        walkFunction(x); // Walk each function to generate code
+        walkFunction(x, done); // Walk each function to generate code
         cgfuncpostamble(func, (func_name + "_end").c_str()); // Generate function postamble code
     }
     return Reg{.type = P_NONE, .idx = 0}; // Return a dummy register for now
@@ -402,20 +1479,17 @@ Reg GenCode::walkPragram(const std::shared_ptr<Pragram>& ast) {
 void GenCode::generate(const std::shared_ptr<Pragram>& ast) {
     cgpreamble(); // Generate preamble code
     assert(walkPragram(ast).type == P_NONE); // Walk the AST to generate code
+    if (ast->getProfileCounters() > 0) cgprofiledata(ast->getProfileCounters(), ast->getProfileChecksum());
     // cgpostamble(); // Generate postamble code
 }
 
-// 目前只考虑无参数或者一个参数调用
+// 实参依次装入传参寄存器，后面的实参中还有调用时，已经装好的传参寄存器和临时值一起在内层调用前保存
 Reg GenCode::walkFunctionCall(const std::shared_ptr<FunctionCallNode>& ast) {
 
-    std::vector<Reg> used = cgprotectscene(); // Protect the scene before generating code for the function call
+    std::vector<Reg> used = cgprotectscene(loaded_params); // Protect the scene before generating code for the function call
+    size_t outer_params = loaded_params.size();
 
     auto args = ast->getArguments();
-    int stack_offset = 0;
-    if (ast->needAdjustStack()) {
-        assemblyCode->cgadjuststack(8); // Adjust the stack size for the function call
-        stack_offset = 8; // Set the stack offset for the function call
-    } 
     std::vector<Reg> int_need_load_to_stack;
     std::vector<Reg> float_need_load_to_stack;
     int int_param_count = 0;
@@ -429,6 +1503,7 @@ Reg GenCode::walkFunctionCall(const std::shared_ptr<FunctionCallNode>& ast) {
             if (float_param_count >= 8) {
                 float_need_load_to_stack.push_back(reg);
             } else {
+                loaded_params.push_back(Reg{.type = P_FLOAT, .is_param = true, .idx = float_param_count});
                 cgloadparamtoreg(reg, float_param_count); // Load the float parameter to a register
             }
             float_param_count++;
@@ -436,11 +1511,20 @@ Reg GenCode::walkFunctionCall(const std::shared_ptr<FunctionCallNode>& ast) {
             if (int_param_count >= 6) {
                 int_need_load_to_stack.push_back(reg);
             } else {
+                loaded_params.push_back(Reg{.type = P_LONG, .is_param = true, .idx = int_param_count});
                 cgloadparamtoreg(reg, int_param_count); // Load the integer parameter to a register
             }
             int_param_count++;
         }
     }
+    loaded_params.resize(outer_params);
+
+    // 栈上传递的实参在所有实参求值之后才压栈，保证调用时 %rsp 16字节对齐
+    int stack_offset = 0;
+    if (ast->needAdjustStack()) {
+        assemblyCode->cgadjuststack(8); // Adjust the stack size for the function call
+        stack_offset = 8; // Set the stack offset for the function call
+    } 
 
     for (auto reg = int_need_load_to_stack.rbegin(); reg != int_need_load_to_stack.rend(); reg++) {
         assemblyCode->cgloadparamtostack(*reg); // Load the integer parameter to the stack
@@ -462,10 +1546,26 @@ Reg GenCode::walkFunctionCall(const std::shared_ptr<FunctionCallNode>& ast) {
 
 void GenCode::walkReturn(const std::shared_ptr<ReturnStatementNode>& ast) {
     std::string end_label = ast->getFunction().name + "_end";
+    if (ast->isTailCall()) {
+        walkTailCall(std::dynamic_pointer_cast<FunctionCallNode>(ast->getExpression()), ast->getFunction().name);
+        return;
+    }
     if (ast->getExpression() != nullptr) {
         Reg reg = walkExpr(ast->getExpression()); // Walk the return expression to generate code
         assemblyCode->cgreturn(reg, end_label.c_str()); // Generate return code with the register
     } else {
         assemblyCode->cgreturn(Reg{.type = P_VOID, .idx = 0}, end_label.c_str()); // Generate return code without a value
     }
-}
\ No newline at end of file
+}
+// 尾调用：实参全部在寄存器中传递且不含调用，装入传参寄存器后拆掉当前栈帧再跳转
+void GenCode::walkTailCall(const std::shared_ptr<FunctionCallNode>& ast, const std::string& func_name) {
+    int int_param_count = 0;
+    int float_param_count = 0;
+    for (const auto& arg : ast->getArguments()) {
+        PrimitiveType type = arg->getCalculateType();
+        Reg reg = walkExpr(arg);
+        if (type == P_FLOAT) cgloadparamtoreg(reg, float_param_count++);
+        else cgloadparamtoreg(reg, int_param_count++);
+    }
+    cgtailcall(symbol_table.getFunction(func_name), ast->getIdentifier().c_str());
+}
@@ -5,6 +5,7 @@
 #include <iostream>
 #include <vector>
 #include <memory>
+#include <set>
 #pragma once
 
 class GenCode {
@@ -18,6 +19,9 @@ class GenCode {
         void generate(const std::shared_ptr<Pragram>& ast);
     private:
         std::unique_ptr<X86AssemblyCode> assemblyCode; // Pointer to AssemblyCode object to hold generated code
+        std::vector<Reg> loaded_params; // 正在准备的调用已经装入传参寄存器的实参，嵌套调用前要保存
+        std::string func_name; // 正在生成的函数
+        int cold_depth = 0; // 大于0时正在生成 .text.unlikely 中的冷代码，不需要对齐
         
         Reg cgload(Value value) {
             return assemblyCode->cgload(value); // Load the value into a register
@@ -67,6 +71,10 @@ class GenCode {
             assemblyCode->cgglobsym(sym, init); // Generate global symbol definition
         }
 
+        void cgglobvalue(Symbol sym, Value value) {
+            assemblyCode->cgglobvalue(sym, value);
+        }
+
         void freereg(Reg reg) {
             assemblyCode->freereg(reg);
         }
@@ -135,6 +143,58 @@ class GenCode {
             assemblyCode->cggreaterthanjump(r1, r2, label);
         }
 
+        Reg cgcompareop(const Operand &left, const Operand &right, PrimitiveType type, ExprType op) {
+            return assemblyCode->cgcompareop(left, right, type, op);
+        }
+
+        void cgcompareopjump(const Operand &left, const Operand &right, PrimitiveType type, ExprType op, const char *label) {
+            assemblyCode->cgcompareopjump(left, right, type, op, label);
+        }
+
+        void cgcmov(const Operand &left, const Operand &right, PrimitiveType type, ExprType op, const Operand &src, const Operand &dst, PrimitiveType value_type) {
+            assemblyCode->cgcmov(left, right, type, op, src, dst, value_type);
+        }
+
+        Reg cgfloatmask(Reg left, Reg right, ExprType op) {
+            return assemblyCode->cgfloatmask(left, right, op);
+        }
+
+        Reg cgfloatblend(Reg mask, Reg if_true, Reg if_false) {
+            return assemblyCode->cgfloatblend(mask, if_true, if_false);
+        }
+
+        Reg cgfloatminmax(Reg reg, const Operand &src, bool max) {
+            return assemblyCode->cgfloatminmax(reg, src, max);
+        }
+
+        void cgtestjump(Reg reg, const char *label) {
+            assemblyCode->cgtestjump(reg, label);
+        }
+
+        void cgzerojump(Reg reg, const char *label) {
+            assemblyCode->cgzerojump(reg, label);
+        }
+
+        void cgtestnonzerojump(Reg reg, const char *label) {
+            assemblyCode->cgtestnonzerojump(reg, label);
+        }
+
+        void cgnonzerojump(Reg reg, const char *label) {
+            assemblyCode->cgnonzerojump(reg, label);
+        }
+
+        void cgswitchcompare(Reg reg, long value, const char *equal_label, const char *less_label) {
+            assemblyCode->cgswitchcompare(reg, value, equal_label, less_label);
+        }
+
+        void cgjumptable(Reg reg, long low, const std::vector<std::string> &targets, const char *default_label) {
+            assemblyCode->cgjumptable(reg, low, targets, default_label);
+        }
+
+        void cgbittest(Reg reg, long low, long high, const std::vector<std::pair<std::string, unsigned long>> &masks, const char *default_label) {
+            assemblyCode->cgbittest(reg, low, high, masks, default_label);
+        }
+
         void cgfuncpreamble(Function name) {
             assemblyCode->cgfuncpreamble(name);
         }
@@ -142,6 +202,16 @@ class GenCode {
         void cgfuncpostamble(Function name, const char *label) {
             assemblyCode->cgfuncpostamble(name, label);
         }
+        void cgprologue() {
+            assemblyCode->cgprologue();
+        }
+        void cgframelessreturn(Reg reg) {
+            assemblyCode->cgframelessreturn(reg);
+        }
+
+        void cgtailcall(Function func, const char *name) {
+            assemblyCode->cgtailcall(func, name);
+        }
 
         Reg cgint2char(Reg reg) {
             return assemblyCode->cgint2char(reg);
@@ -196,9 +266,39 @@ class GenCode {
         Reg cgderef(Reg reg, PrimitiveType type) {
             return assemblyCode->cgderef(reg, type);
         }
+        Reg cgloadop(const Operand &src, PrimitiveType type, PrimitiveType to) {
+            return assemblyCode->cgloadop(src, type, to);
+        }
+        void cgstoreop(const Operand &src, const Operand &dst, PrimitiveType type) {
+            assemblyCode->cgstoreop(src, dst, type);
+        }
+        Reg cgarith(ExprType op, Reg reg, const Operand &src) {
+            return assemblyCode->cgarith(op, reg, src);
+        }
+        Reg cglea(const Operand &addr, PrimitiveType type) {
+            return assemblyCode->cglea(addr, type);
+        }
+        void cgincop(const Operand &dst, PrimitiveType type, long delta) {
+            assemblyCode->cgincop(dst, type, delta);
+        }
+        void cgupdateop(ExprType op, const Operand &dst, const Operand &src, PrimitiveType type) {
+            assemblyCode->cgupdateop(op, dst, src, type);
+        }
         Reg cgshlconst(Reg reg, int value) {
             return assemblyCode->cgshlconst(reg, value);
         }
+
+        Reg cgmulconst(Reg reg, long value) {
+            return assemblyCode->cgmulconst(reg, value);
+        }
+
+        Reg cgdivconst(Reg reg, long value) {
+            return assemblyCode->cgdivconst(reg, value);
+        }
+
+        Reg cgmodconst(Reg reg, long value) {
+            return assemblyCode->cgmodconst(reg, value);
+        }
         void cglocalsym(Symbol sym) {
             assemblyCode->cglocalsym(sym);
         }
@@ -257,23 +357,108 @@ class GenCode {
         void cglocalarrayzeroinit(int base, int left_size, int current_size, int elem_size) {
             assemblyCode->cglocalarrayzeroinit(base, left_size, current_size, elem_size); // Initialize local array to zero
         }
+        void cglocalarraycopy(int base, const std::vector<unsigned char> &image) {
+            assemblyCode->cglocalarraycopy(base, image);
+        }
         void cgrestorescene(const std::vector<Reg> &protected_regs) {
             assemblyCode->cgrestorescene(protected_regs); // Restore the protected registers from the stack
         }
-        std::vector<Reg> cgprotectscene() {
-            return assemblyCode->cgprotectscene(); // Protect the scene before generating code for the function call
+        std::vector<Reg> cgprotectscene(const std::vector<Reg> &live_params) {
+            return assemblyCode->cgprotectscene(live_params); // Protect the scene before generating code for the function call
+        }
+        Reg cgcalleesaved(Reg reg) {
+            return assemblyCode->cgcalleesaved(reg);
         }
         Reg cgmod(Reg reg1, Reg reg2) {
             return assemblyCode->cgmod(reg1, reg2); // Generate code for modulo operation
         }
+        Reg cgvload(Reg addr, PrimitiveType type) {
+            return assemblyCode->cgvload(addr, type);
+        }
+        void cgvstore(Reg reg, Reg addr, PrimitiveType type) {
+            assemblyCode->cgvstore(reg, addr, type);
+        }
+        Reg cgvbroadcast(Reg reg, PrimitiveType type) {
+            return assemblyCode->cgvbroadcast(reg, type);
+        }
+        Reg cgvadd(Reg reg1, Reg reg2, PrimitiveType type) {
+            return assemblyCode->cgvadd(reg1, reg2, type);
+        }
+        Reg cgvsub(Reg reg1, Reg reg2, PrimitiveType type) {
+            return assemblyCode->cgvsub(reg1, reg2, type);
+        }
+        Reg cgvmul(Reg reg1, Reg reg2, PrimitiveType type) {
+            return assemblyCode->cgvmul(reg1, reg2, type);
+        }
+        Reg cgvdiv(Reg reg1, Reg reg2, PrimitiveType type) {
+            return assemblyCode->cgvdiv(reg1, reg2, type);
+        }
+        void cgoverlapjump(Reg diff, long bytes, const char *label) {
+            assemblyCode->cgoverlapjump(diff, bytes, label);
+        }
+        void cgvzeroupper() {
+            assemblyCode->cgvzeroupper();
+        }
+        void cgalignloop() {
+            assemblyCode->cgalignloop();
+        }
+        void cgcoldsection() {
+            assemblyCode->cgcoldsection();
+            cold_depth++;
+        }
+        void cgendcoldsection() {
+            assemblyCode->cgendcoldsection();
+            cold_depth--;
+        }
+        void cgprofilecounter(int index) {
+            assemblyCode->cgprofilecounter(index);
+        }
+        void cgprofiledata(long counters, long checksum) {
+            assemblyCode->cgprofiledata(counters, checksum);
+        }
         Reg walkPragram(const std::shared_ptr<Pragram>& ast);
         Reg walkStatement(const std::shared_ptr<StatementNode>& ast);
         Reg walkExpr(const std::shared_ptr<ExprNode>& ast);
-        void walkCondition(const std::shared_ptr<ExprNode>& ast, std::string false_label);
-        void walkFunction(const std::shared_ptr<FunctionDeclareNode>& ast);
+        void walkCondition(const std::shared_ptr<ExprNode>& ast, std::string label, bool jump_if = false);
+        void walkIf(const std::shared_ptr<IfStatementNode>& ast);
+        bool walkSelect(const std::shared_ptr<IfStatementNode>& ast);
+        bool walkIntSelect(const std::shared_ptr<IfStatementNode>& ast, const std::shared_ptr<LValueNode>& var, const std::shared_ptr<ExprNode>& if_true, const std::shared_ptr<ExprNode>& if_false);
+        bool walkFloatSelect(const std::shared_ptr<BinaryExpNode>& cond, const std::shared_ptr<LValueNode>& var, const std::shared_ptr<ExprNode>& if_true, const std::shared_ptr<ExprNode>& if_false);
+        void walkLoop(const std::shared_ptr<ExprNode>& cond, const std::shared_ptr<StatementNode>& body,
+            const std::shared_ptr<StatementNode>& postop, const std::string& start, const std::string& end, bool guard);
+        void walkFunction(const std::shared_ptr<FunctionDeclareNode>& ast, const std::set<std::shared_ptr<StatementNode>>& done);
+        std::set<std::shared_ptr<StatementNode>> walkEarlyExits(const std::shared_ptr<FunctionDeclareNode>& ast);
         Reg walkFunctionCall(const std::shared_ptr<FunctionCallNode>& ast);
         void walkReturn(const std::shared_ptr<ReturnStatementNode>& ast);
+        void walkTailCall(const std::shared_ptr<FunctionCallNode>& ast, const std::string& func_name);
         Reg transformType(PrimitiveType type, PrimitiveType target_type, Reg reg);
+        Reg walkExtended(const std::shared_ptr<ExprNode>& ast, PrimitiveType to);
+        Reg walkScale(Reg reg, int size);
         void localArrayInit(const std::shared_ptr<ArrayInitializer>& init);
+        void arrayImage(const std::shared_ptr<ArrayInitializer>& init, std::vector<unsigned char>& image);
         void walkFunctionParam(const std::shared_ptr<FunctionParamNode>& ast);
+        bool getConstant(const std::shared_ptr<ExprNode>& ast, long &value);
+        Reg walkConstArith(const std::shared_ptr<BinaryExpNode>& ast);
+        Reg keepAcrossCalls(Reg reg, const std::shared_ptr<ExprNode>& later);
+        int registerNeed(const std::shared_ptr<ExprNode>& ast);
+        bool rightFirst(const std::shared_ptr<ExprNode>& left, const std::shared_ptr<ExprNode>& right);
+        bool addressFirst(const std::shared_ptr<AssignmentNode>& ast);
+        PrimitiveType walkCompareOperands(const std::shared_ptr<BinaryExpNode>& ast, ExprType& op, Operand& left, Operand& right);
+        bool scalarOperand(const std::shared_ptr<ExprNode>& ast, PrimitiveType type);
+        std::shared_ptr<UnaryExpNode> derefOf(const std::shared_ptr<ExprNode>& ast, PrimitiveType type);
+        bool foldable(const std::shared_ptr<ExprNode>& ast, PrimitiveType type);
+        Operand selectOperand(const std::shared_ptr<ExprNode>& ast, PrimitiveType type);
+        void selectBase(Operand& op, const std::shared_ptr<LValueNode>& var);
+        void selectIndex(Operand& op, const std::shared_ptr<ExprNode>& ast);
+        Operand selectAddress(const std::shared_ptr<ExprNode>& ast);
+        Reg walkLea(const std::shared_ptr<BinaryExpNode>& ast);
+        Reg walkFoldedArith(const std::shared_ptr<BinaryExpNode>& ast);
+        bool walkIncrement(const std::shared_ptr<UnaryExpNode>& ast);
+        bool walkUpdate(const std::shared_ptr<AssignmentNode>& ast);
+        bool walkEffect(const std::shared_ptr<ExprNode>& ast);
+        Reg walkIntOperand(const std::shared_ptr<ExprNode>& ast);
+        void walkSwitch(const std::shared_ptr<SwitchStatementNode>& ast);
+        void walkSwitchCases(Reg reg, const std::vector<std::pair<long, std::string>>& cases, size_t begin, size_t end, const std::string& default_label);
+        void walkVectorLoop(const std::shared_ptr<VectorLoopNode>& ast);
+        Reg walkVectorExpr(const std::shared_ptr<VectorLoopNode>& loop, const std::shared_ptr<ExprNode>& ast);
 };
\ No newline at end of file
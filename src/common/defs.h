@@ -18,9 +18,13 @@ enum LableType {
     BLOCK_LABEL,
     WHILE_LABEL,
     FOR_LABEL,
+    SWITCH_LABEL,
+    VECTOR_LABEL,
+    LOOP_LABEL, // Body of a rotated loop, target of the bottom test
     FUNCT_LABEL,
     FLOAT_CONSTANT_LABEL, // Label type for float constants
-    STRING_CONSTANT_LABEL // Label type for string constants
+    STRING_CONSTANT_LABEL, // Label type for string constants
+    ARRAY_CONSTANT_LABEL // Label type for local array initializer images
 };
 
 extern std::map<double, std::string> float_constants; // Map to store float constants for unique representation
@@ -37,6 +41,12 @@ public:
             return std::to_string(whileLabelCounter++);
         } else if (l == FOR_LABEL) {
             return std::to_string(forLabelCounter++);
+        } else if (l == SWITCH_LABEL) {
+            return std::to_string(switchLabelCounter++);
+        } else if (l == VECTOR_LABEL) {
+            return std::to_string(vectorLabelCounter++);
+        } else if (l == LOOP_LABEL) {
+            return "LOOP_BODY_" + std::to_string(loopLabelCounter++);
         } else if (l == FUNCT_LABEL) {
             return "FUNCT_END" + std::to_string(functLabelCounter++);
         } else if (l == FLOAT_CONSTANT_LABEL) {
@@ -44,6 +54,8 @@ public:
             return "FLOAT_CONST_" + std::to_string(floatConstantCounter++);
         } else if (l == STRING_CONSTANT_LABEL) {
             return "STRING_CONST_" + std::to_string(stringConstantCounter++);
+        } else if (l == ARRAY_CONSTANT_LABEL) {
+            return "ARRAY_CONST_" + std::to_string(arrayConstantCounter++);
         } else {
             throw std::runtime_error("LabelAllocator::getLabel: Unknown label type");
         }
@@ -54,7 +66,11 @@ private:
     int functLabelCounter = 0; // Counter for function labels
     int whileLabelCounter = 0;
     int forLabelCounter = 0;
+    int switchLabelCounter = 0;
+    int vectorLabelCounter = 0;
+    int loopLabelCounter = 0;
     int floatConstantCounter = 0;
+    int arrayConstantCounter = 0;
     int stringConstantCounter = 0; // Counter for string constants
 };
 extern LabelAllocator labelAllocator; // Static label allocator for generating unique labels
@@ -65,7 +81,7 @@ enum TokenType {
     T_IDENTIFIER, T_PRINT, T_IF, T_ELSE, T_WHILE, T_FOR, T_RETURN,
     T_SEMI, T_NUMBER, T_INT, T_ASSIGN, T_COMMA, T_VOID, T_CHAR, T_FLOAT, T_LONG,
     T_LT, T_GT, T_LE, T_GE, T_NE, T_EQ, T_NOT, T_LOGAND, T_LOGOR, T_AMPER, T_OR, T_INVERT, T_INC, T_DEC, T_XOR, T_LSHIFT, T_RSHIFT,
-    T_STRING, T_BREAK, T_CONTINUE
+    T_STRING, T_BREAK, T_CONTINUE, T_SWITCH, T_CASE, T_DEFAULT, T_COLON
 };
 
 enum PrimitiveType {
@@ -87,7 +103,7 @@ inline bool is_array(PrimitiveType type) {
 
 enum StmtType {
     S_PRINT, S_ASSIGN, S_IF, S_WHILE, S_RETURN, S_BLOCK, S_EXPR, S_VARDEF, S_FOR, S_FUNCTDEF,
-    S_BREAK, S_CONTINUE
+    S_BREAK, S_CONTINUE, S_VECTOR, S_SWITCH, S_PROFILE
 };
 
 enum ExprType {
@@ -100,6 +116,22 @@ enum UnaryOp {
     U_ADDR, U_DEREF, U_TRANSFORM, U_SCALE
 };
 
+// 将64位寄存器名转换为对应宽度的别名，如 %rbx -> %ebx / %bl
+inline std::string registerAlias(const std::string &reg64, int size) {
+    static const std::map<std::string, std::vector<std::string>> aliases = {
+        {"%rax", {"%al", "%eax"}}, {"%rbx", {"%bl", "%ebx"}}, {"%rcx", {"%cl", "%ecx"}},
+        {"%rdx", {"%dl", "%edx"}}, {"%rsi", {"%sil", "%esi"}}, {"%rdi", {"%dil", "%edi"}},
+        {"%r8", {"%r8b", "%r8d"}}, {"%r9", {"%r9b", "%r9d"}}, {"%r10", {"%r10b", "%r10d"}},
+        {"%r11", {"%r11b", "%r11d"}}, {"%r12", {"%r12b", "%r12d"}}, {"%r13", {"%r13b", "%r13d"}},
+        {"%r14", {"%r14b", "%r14d"}}, {"%r15", {"%r15b", "%r15d"}}, {"%rbp", {"%bpl", "%ebp"}}
+    };
+    auto it = aliases.find(reg64);
+    if (it == aliases.end() || size == 8) return reg64; // xmm registers have no narrower alias
+    if (size == 1) return it->second[0];
+    if (size == 4) return it->second[1];
+    throw std::runtime_error("registerAlias: Unsupported register size " + std::to_string(size));
+}
+
 struct Symbol {
     std::string name;
     PrimitiveType type;
@@ -109,6 +141,7 @@ struct Symbol {
     bool is_param = false;
     int pos_in_stack; // Position in stack for local variables, if applicable
     std::vector<int> array_dimensions; // Dimensions for array types, if applicable
+    std::string home_reg; // 被提升到寄存器的变量所在的64位寄存器，为空表示变量在栈上
 
     Symbol() = default; // Default constructor for Symbol
 
@@ -130,22 +163,59 @@ struct Symbol {
         }
         return offset;
     }
+    // Offset of a stack variable from the frame pointer
+    int getFrameOffset() const {
+        if (size < 4) return pos_in_stack + 4 - size;
+        return pos_in_stack;
+    }
     std::string getAddress() const {
         // Generate a string representation of the symbol's address
         if (is_global) return name + "(%rip)";
+        else if (!home_reg.empty()) return registerAlias(home_reg, size);
         else {
-            if (size < 4) return std::to_string(pos_in_stack + 4 - size) + "(%rbp)"; // Assuming %rbp is the base pointer for local variables
-            return std::to_string(pos_in_stack) + "(%rbp)"; // Assuming %rbp is the base pointer for local variables
+            return std::to_string(getFrameOffset()) + "(%rbp)"; // Assuming %rbp is the base pointer for local variables
         }
     }
 };
 
+struct CompilerOptions {
+    bool enable_log = true; // Print the AST and progress messages
+    int opt_level = 1; // 0 disables the optimizer
+    bool print_opt_stats = false; // Print optimization statistics after code generation
+    bool avx2 = false; // Vectorized loops use 256-bit AVX2 instead of SSE2
+    int inline_limit = 40; // Largest callee body (in AST nodes) the inliner expands, 0 disables inlining
+    int unroll_factor = 4; // Copies of the body per iteration of a partially unrolled loop, 1 disables partial unrolling
+    int unroll_limit = 64; // Largest unrolled loop body (in AST nodes), 0 disables unrolling
+    int specialize_limit = 200; // Largest function body (in AST nodes) cloned for constant arguments, 0 disables specialization
+    bool omit_frame_pointer = false; // Address locals off %rsp and let %rbp hold a variable
+    bool profile_generate = false; // Count block executions, the program writes them to mini_c.profdata at exit
+    std::string profile_use; // Profile from an instrumented run that guides block layout and inlining, empty when unused
+};
+
+extern CompilerOptions compiler_options;
+
 struct Function {
     std::string name;
     PrimitiveType return_type;
     std::vector<std::shared_ptr<Symbol>> params; // Parameters of the function
     bool has_return;
     int stack_size; // Size of the stack frame for the function
+    std::vector<std::pair<std::string, int>> saved_regs; // Callee-saved registers used by the function and their frame slots
+    bool is_leaf = false; // The body makes no calls, set by the code generator
+    bool is_cold = false; // Never entered in the profiled run, placed in .text.unlikely
+
+    // Parameters beyond the argument registers are read from the caller's frame
+    bool hasStackParams() const {
+        for (const auto& param : params) {
+            if (param->pos_in_stack > 0) return true;
+        }
+        return false;
+    }
+
+    // 不建立%rbp栈帧，局部变量相对%rsp寻址，%rbp可以分配给变量
+    bool omitsFramePointer() const {
+        return compiler_options.omit_frame_pointer && !hasStackParams();
+    }
 };
 
 struct SymbolTable {
@@ -234,7 +304,7 @@ struct SymbolTable {
                 throw std::runtime_error("SymbolTable::addFunction: Function already exists: " + name);
             }
         }
-        functions.push_back({name, return_type, params, false, 8});
+        functions.push_back({name, return_type, params, false, 8, {}});
     }
 
     void enterFunction(std::vector<std::shared_ptr<Symbol>> params) {
@@ -311,6 +381,32 @@ struct SymbolTable {
         }
         throw std::runtime_error("SymbolTable::getFunction: Function not found: " + name);
     }
+
+    Function& getFunctionRef(std::string name) {
+        for (auto& func : functions) {
+            if (func.name == name) {
+                return func; // Return the function so that the optimizer can update its frame
+            }
+        }
+        throw std::runtime_error("SymbolTable::getFunctionRef: Function not found: " + name);
+    }
+
+    // 在函数栈帧底部分配新的槽位，返回相对于%rbp的偏移
+    int allocateFrameSlot(std::string name, int size) {
+        Function &func = getFunctionRef(name);
+        func.stack_size += size < 4 ? 4 : size;
+        int pos = -func.stack_size;
+        func.stack_size += func.stack_size % 16 ? 16 - func.stack_size % 16 : 0;
+        return pos;
+    }
+    // 为优化遍创建编译器临时变量，在函数栈帧底部分配槽位
+    std::shared_ptr<Symbol> newTemp(std::string func_name, PrimitiveType type) {
+        int size = typeToSize(type);
+        int pos = allocateFrameSlot(func_name, size);
+        return std::make_shared<Symbol>(".T" + std::to_string(temp_counter++), type, size, false, false, pos);
+    }
+    int temp_counter = 0; // Counter for compiler temporaries
+
     void setCurrentFunction(const Function& func) {
         current_function = func; // Set the current function being processed
     }
@@ -435,6 +531,22 @@ struct Reg {
     int idx;
 };
 
+// An instruction operand picked by the instruction selector
+struct Operand {
+    enum Kind {
+        REG, // A value already computed into reg
+        IMM, // A constant that fits a 32-bit immediate
+        SYM, // A scalar variable read in place, from its home register or its memory slot
+        MEM // Memory at base + index * scale + value
+    } kind = REG;
+    Reg reg = {P_NONE, false, -1}; // REG: the value; MEM: the base register, P_NONE when the base comes from sym
+    long value = 0; // IMM: the constant; MEM: the displacement in bytes
+    Symbol sym; // SYM: the variable; MEM without a base register: the array whose address is the base
+    bool sym_value = false; // MEM: the base is the value of the pointer in sym's home register instead of sym's address
+    Reg index = {P_NONE, false, -1}; // MEM: the long index register, P_NONE when there is none
+    int scale = 1; // MEM: 1, 2, 4 or 8
+};
+
 struct Token {
     TokenType type;
     Value value; // Value of the token, if applicable
@@ -3,6 +3,7 @@
 #include "parser/parser.h"
 #include "assembly/gencode.h"
 #include "semantic/semantic.h"
+#include "optimizer/optimizer.h"
 #include <iostream>
 #include <vector>
 #include <filesystem>
@@ -10,6 +11,7 @@ SymbolTable symbol_table;
 std::map<double, std::string> float_constants; // Map to store float literals
 std::map<std::string, std::string> string_constants; // Map to store string literals
 LabelAllocator labelAllocator; // Static label allocator for generating unique labels
+CompilerOptions compiler_options; // Options parsed from the command line
 
 int main(int argc, char *argv[]) {
     if (argc < 2) {
@@ -17,12 +19,40 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     std::string output_file = "output.s";
-    bool enable_log = true; // Flag to enable or disable logging
-    if (argc > 2) {
-        if (std::string(argv[2]) == "-disable_log") {
-            enable_log = false;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-disable_log") {
+            compiler_options.enable_log = false;
+        } else if (arg == "-O0") {
+            compiler_options.opt_level = 0;
+        } else if (arg == "-O1") {
+            compiler_options.opt_level = 1;
+        } else if (arg == "-fopt-stats") {
+            compiler_options.print_opt_stats = true;
+        } else if (arg == "-mavx2") {
+            compiler_options.avx2 = true;
+        } else if (arg == "-fomit-frame-pointer") {
+            compiler_options.omit_frame_pointer = true;
+        } else if (arg == "-fprofile-generate") {
+            compiler_options.profile_generate = true;
+        } else if (arg == "-fprofile-use") {
+            compiler_options.profile_use = "mini_c.profdata";
+        } else if (arg.rfind("-fprofile-use=", 0) == 0) {
+            compiler_options.profile_use = arg.substr(14);
+        } else if (arg.rfind("-finline-limit=", 0) == 0) {
+            compiler_options.inline_limit = std::stoi(arg.substr(15));
+        } else if (arg.rfind("-funroll-factor=", 0) == 0) {
+            compiler_options.unroll_factor = std::stoi(arg.substr(16));
+        } else if (arg.rfind("-funroll-limit=", 0) == 0) {
+            compiler_options.unroll_limit = std::stoi(arg.substr(15));
+        } else if (arg.rfind("-fspecialize-limit=", 0) == 0) {
+            compiler_options.specialize_limit = std::stoi(arg.substr(19));
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
         }
     }
+    bool enable_log = compiler_options.enable_log; // Flag to enable or disable logging
     try {
         float_constants[1.0] = labelAllocator.getLabel(FLOAT_CONSTANT_LABEL);
         Scanner scanner = Scanner(argv[1]);
@@ -52,11 +82,18 @@ int main(int argc, char *argv[]) {
             std::cout << "Semantic check completed." << std::endl;
         }
 
+        if (compiler_options.opt_level > 0) {
+            if (enable_log) std::cout << "Optimization." << std::endl;
+            Optimizer optimizer(ast);
+            optimizer.optimize();
+        }
+
         // Code generation would go here, e.g., generating assembly code from the AST
         if (enable_log) std::cout << "Current working directory: " << std::filesystem::current_path() << std::endl;
         GenCode genCode(output_file);
         genCode.generate(ast);
         if (enable_log) std::cout << "Code generation completed. Output written to output.s." << std::endl;
+        if (compiler_options.print_opt_stats) opt_stats.print(std::cout);
 
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
@@ -0,0 +1,531 @@
+#include "optimizer/ast_utils.h"
+#include <limits>
+#include <cmath>
+
+void forEachNode(const std::shared_ptr<ASTNode>& node, const NodeCallback& callback, int loop_depth) {
+    if (node == nullptr) return;
+    callback(node, loop_depth);
+    if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(node)) {
+        forEachNode(x->getLeft(), callback, loop_depth);
+        forEachNode(x->getRight(), callback, loop_depth);
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(node)) {
+        forEachNode(x->getExpr(), callback, loop_depth);
+    } else if (auto x = std::dynamic_pointer_cast<LValueNode>(node)) {
+        forEachNode(x->getIndex(), callback, loop_depth);
+    } else if (auto x = std::dynamic_pointer_cast<FunctionCallNode>(node)) {
+        for (const auto& arg : x->getArguments()) {
+            forEachNode(arg, callback, loop_depth);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<AssignmentNode>(node)) {
+        forEachNode(x->getLvalue(), callback, loop_depth);
+        forEachNode(x->getExpr(), callback, loop_depth);
+    } else if (auto x = std::dynamic_pointer_cast<ArrayInitializer>(node)) {
+        for (const auto& elem : x->getElements()) {
+            forEachNode(elem, callback, loop_depth);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<BlockNode>(node)) {
+        for (const auto& stmt : x->getStatements()) {
+            forEachNode(stmt, callback, loop_depth);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<PrintStatementNode>(node)) {
+        forEachNode(x->getExpression(), callback, loop_depth);
+    } else if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(node)) {
+        for (const auto& sym : x->getSymbols()) {
+            forEachNode(x->getInitializer(*sym), callback, loop_depth);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<IfStatementNode>(node)) {
+        forEachNode(x->getCondition(), callback, loop_depth);
+        forEachNode(x->getThenStatement(), callback, loop_depth);
+        forEachNode(x->getElseStatement(), callback, loop_depth);
+    } else if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(node)) {
+        forEachNode(x->getCondition(), callback, loop_depth + 1);
+        forEachNode(x->getBody(), callback, loop_depth + 1);
+    } else if (auto x = std::dynamic_pointer_cast<ForStatementNode>(node)) {
+        forEachNode(x->getPreopStatement(), callback, loop_depth);
+        forEachNode(x->getCondition(), callback, loop_depth + 1);
+        forEachNode(x->getBody(), callback, loop_depth + 1);
+        forEachNode(x->getPostopStatement(), callback, loop_depth + 1);
+    } else if (auto x = std::dynamic_pointer_cast<SwitchStatementNode>(node)) {
+        forEachNode(x->getCondition(), callback, loop_depth);
+        for (const auto& c : x->getCases()) {
+            forEachNode(c.body, callback, loop_depth);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<VectorLoopNode>(node)) {
+        for (const auto& [a, b] : x->getAliasChecks()) {
+            forEachNode(a, callback, loop_depth);
+            forEachNode(b, callback, loop_depth);
+        }
+        forEachNode(x->getCondition(), callback, loop_depth + 1);
+        for (const auto& stmt : x->getBody()) {
+            forEachNode(stmt, callback, loop_depth + 1);
+        }
+        forEachNode(x->getIncrement(), callback, loop_depth + 1);
+    } else if (auto x = std::dynamic_pointer_cast<ReturnStatementNode>(node)) {
+        forEachNode(x->getExpression(), callback, loop_depth);
+    } else if (auto x = std::dynamic_pointer_cast<FunctionDeclareNode>(node)) {
+        forEachNode(x->getBody(), callback, loop_depth);
+    }
+}
+
+SideEffects collectSideEffects(const std::shared_ptr<ASTNode>& node) {
+    SideEffects effects;
+    // 写入目标：标量变量直接记录，解引用时记录数组或标记为指针写
+    auto addTarget = [&](const std::shared_ptr<ExprNode>& target) {
+        if (auto x = std::dynamic_pointer_cast<LValueNode>(target)) {
+            effects.written.insert(x->getSymbol().get());
+        } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(target)) {
+            auto y = std::dynamic_pointer_cast<LValueNode>(x->getExpr());
+            if (y != nullptr && y->isArray() && !y->isParam()) effects.written.insert(y->getSymbol().get());
+            else effects.has_pointer_store = true;
+        }
+    };
+    forEachNode(node, [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (auto x = std::dynamic_pointer_cast<AssignmentNode>(n)) {
+            addTarget(x->getLvalue());
+        } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(n)) {
+            UnaryOp op = x->getOp();
+            if (op == U_PREINC || op == U_PREDEC || op == U_POSTINC || op == U_POSTDEC) addTarget(x->getExpr());
+        } else if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(n)) {
+            for (const auto& sym : x->getSymbols()) {
+                effects.written.insert(sym.get());
+            }
+        } else if (std::dynamic_pointer_cast<FunctionCallNode>(n)) {
+            effects.has_call = true;
+        }
+    });
+    return effects;
+}
+
+std::set<Symbol*> collectAddressTaken(const std::shared_ptr<ASTNode>& node) {
+    std::set<Symbol*> ret;
+    forEachNode(node, [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(n)) {
+            if (x->getOp() != U_ADDR) return;
+            auto y = std::dynamic_pointer_cast<LValueNode>(x->getExpr());
+            if (y != nullptr && !y->isArray()) ret.insert(y->getSymbol().get());
+        }
+    });
+    return ret;
+}
+
+bool hasSideEffects(const std::shared_ptr<ExprNode>& expr) {
+    bool ret = false;
+    forEachNode(expr, [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (std::dynamic_pointer_cast<AssignmentNode>(n) || std::dynamic_pointer_cast<FunctionCallNode>(n)) {
+            ret = true;
+        } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(n)) {
+            UnaryOp op = x->getOp();
+            if (op == U_PREINC || op == U_PREDEC || op == U_POSTINC || op == U_POSTDEC) ret = true;
+        }
+    });
+    return ret;
+}
+
+bool exprEqual(const std::shared_ptr<ExprNode>& a, const std::shared_ptr<ExprNode>& b) {
+    if (a == nullptr || b == nullptr) return a == b;
+    if (a->getPrimitiveType() != b->getPrimitiveType()) return false;
+    if (auto x = std::dynamic_pointer_cast<ValueNode>(a)) {
+        auto y = std::dynamic_pointer_cast<ValueNode>(b);
+        if (y == nullptr) return false;
+        Value vx = x->getValue(), vy = y->getValue();
+        if (vx.type != vy.type) return false;
+        if (vx.type == P_INT || vx.type == P_CHAR) return vx.ivalue == vy.ivalue;
+        if (vx.type == P_LONG) return vx.lvalue == vy.lvalue;
+        if (vx.type == P_FLOAT) return vx.fvalue == vy.fvalue;
+        if (vx.type == P_STRING) return vx.strvalue == vy.strvalue;
+        return false;
+    } else if (auto x = std::dynamic_pointer_cast<LValueNode>(a)) {
+        auto y = std::dynamic_pointer_cast<LValueNode>(b);
+        return y != nullptr && x->getSymbol() == y->getSymbol() && exprEqual(x->getIndex(), y->getIndex());
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(a)) {
+        auto y = std::dynamic_pointer_cast<UnaryExpNode>(b);
+        return y != nullptr && x->getOp() == y->getOp() && x->getOffset() == y->getOffset() && exprEqual(x->getExpr(), y->getExpr());
+    } else if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(a)) {
+        auto y = std::dynamic_pointer_cast<BinaryExpNode>(b);
+        return y != nullptr && x->getOp() == y->getOp() && x->getCalType() == y->getCalType()
+            && exprEqual(x->getLeft(), y->getLeft()) && exprEqual(x->getRight(), y->getRight());
+    }
+    return false;
+}
+
+std::shared_ptr<VariableDeclareNode> makeTempDecl(const std::shared_ptr<Symbol>& sym, std::shared_ptr<ExprNode> init) {
+    auto decl = std::make_shared<VariableDeclareNode>(sym->type);
+    decl->addIdentifier(sym, std::move(init));
+    return decl;
+}
+
+std::shared_ptr<LValueNode> makeVarRef(const std::shared_ptr<Symbol>& sym) {
+    return std::make_shared<LValueNode>(sym);
+}
+
+std::shared_ptr<ValueNode> makeConstant(const Value& value) {
+    // 浮点字面量从数据段读取，扫描器只登记了源代码中出现的值
+    if (value.type == P_FLOAT && !float_constants.count(value.fvalue)) {
+        float_constants[value.fvalue] = labelAllocator.getLabel(FLOAT_CONSTANT_LABEL);
+    }
+    return std::make_shared<ValueNode>(value);
+}
+
+bool isScalarOf(const std::shared_ptr<ExprNode>& expr, const Symbol* sym) {
+    auto x = std::dynamic_pointer_cast<LValueNode>(expr);
+    return x != nullptr && !x->isArray() && x->getSymbol().get() == sym;
+}
+
+bool mentionsSymbol(const std::shared_ptr<ASTNode>& node, const Symbol* sym) {
+    bool ret = false;
+    forEachNode(node, [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (auto x = std::dynamic_pointer_cast<LValueNode>(n)) {
+            if (x->getSymbol().get() == sym) ret = true;
+        } else if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(n)) {
+            for (const auto& s : x->getSymbols()) {
+                if (s.get() == sym) ret = true;
+            }
+        }
+    });
+    return ret;
+}
+
+std::shared_ptr<ExprNode> stripTransform(std::shared_ptr<ExprNode> expr) {
+    while (auto x = std::dynamic_pointer_cast<UnaryExpNode>(expr)) {
+        if (x->getOp() != U_TRANSFORM) break;
+        expr = x->getExpr();
+    }
+    return expr;
+}
+
+bool getConstantValue(const std::shared_ptr<ExprNode>& expr, long &value) {
+    if (auto x = std::dynamic_pointer_cast<ValueNode>(expr)) {
+        Value v = x->getValue();
+        if (v.type == P_INT) value = v.ivalue;
+        else if (v.type == P_LONG) value = v.lvalue;
+        else return false;
+        return true;
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(expr)) {
+        if (x->getOp() != U_TRANSFORM && x->getOp() != U_MINUS) return false;
+        PrimitiveType type = x->getPrimitiveType();
+        if (type != P_INT && type != P_LONG) return false;
+        if (!getConstantValue(x->getExpr(), value)) return false;
+        if (x->getOp() == U_MINUS) value = -value;
+        if (type == P_INT) value = (int)value;
+        return true;
+    }
+    return false;
+}
+
+bool entersLoop(const std::shared_ptr<StatementNode>& preop, const std::shared_ptr<ExprNode>& cond) {
+    auto init = std::dynamic_pointer_cast<AssignmentNode>(preop);
+    auto cmp = std::dynamic_pointer_cast<BinaryExpNode>(cond);
+    if (init == nullptr || cmp == nullptr) return false;
+    auto var = std::dynamic_pointer_cast<LValueNode>(init->getLvalue());
+    if (var == nullptr || var->isArray()) return false;
+    PrimitiveType type = var->getSymbol()->type;
+    long start, bound;
+    if ((type != P_INT && type != P_LONG) || !getConstantValue(init->getExpr(), start)) return false;
+    if (type == P_INT && (start < INT32_MIN || start > INT32_MAX)) return false;
+    if (!isScalarOf(stripTransform(cmp->getLeft()), var->getSymbol().get()) || !getConstantValue(cmp->getRight(), bound)) return false;
+    switch (cmp->getOp()) {
+        case A_EQ: return start == bound;
+        case A_NE: return start != bound;
+        case A_LT: return start < bound;
+        case A_LE: return start <= bound;
+        case A_GT: return start > bound;
+        case A_GE: return start >= bound;
+        default: return false;
+    }
+}
+
+static Value makeIntConstant(PrimitiveType type, long value) {
+    if (type == P_LONG) return Value{.type = P_LONG, .lvalue = value};
+    if (type == P_CHAR) return Value{.type = P_CHAR, .ivalue = (unsigned char)value};
+    return Value{.type = P_INT, .ivalue = (int)value};
+}
+
+bool convertConstant(const Value& value, PrimitiveType to, Value& result) {
+    if (to != P_CHAR && to != P_INT && to != P_LONG && to != P_FLOAT) return false;
+    if (value.type == P_FLOAT) {
+        if (to == P_FLOAT) {
+            result = value;
+            return true;
+        }
+        // cvttsd2si 遇到超出范围的值得到的是 0x80000000...，不是C语言的转换
+        double limit = to == P_LONG ? 9223372036854775808.0 : 2147483648.0;
+        if (!(value.fvalue > -limit && value.fvalue < limit)) return false;
+        result = makeIntConstant(to, (long)value.fvalue);
+        return true;
+    }
+    long v;
+    if (value.type == P_LONG) v = value.lvalue;
+    else if (value.type == P_INT || value.type == P_CHAR) v = value.ivalue;
+    else return false;
+    if (to == P_FLOAT) result = Value{.type = P_FLOAT, .fvalue = (double)v};
+    else result = makeIntConstant(to, v);
+    return true;
+}
+
+bool evalConstant(const std::shared_ptr<ExprNode>& expr, Value& value) {
+    if (auto x = std::dynamic_pointer_cast<ValueNode>(expr)) {
+        value = x->getValue();
+        return value.type == P_CHAR || value.type == P_INT || value.type == P_LONG || value.type == P_FLOAT;
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(expr)) {
+        UnaryOp op = x->getOp();
+        if (op != U_PLUS && op != U_MINUS && op != U_TRANSFORM) return false;
+        Value operand;
+        if (!evalConstant(x->getExpr(), operand)) return false;
+        if (op == U_TRANSFORM) return convertConstant(operand, x->getPrimitiveType(), value);
+        PrimitiveType type = x->getPrimitiveType();
+        if (type != operand.type || (type != P_INT && type != P_LONG && type != P_FLOAT)) return false;
+        value = operand;
+        if (op == U_PLUS) return true;
+        if (type == P_FLOAT) value.fvalue = -operand.fvalue;
+        else if (type == P_LONG) value.lvalue = (long)(0UL - (unsigned long)operand.lvalue);
+        else value.ivalue = (int)(0U - (unsigned)operand.ivalue);
+        return true;
+    } else if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(expr)) {
+        ExprType op = x->getOp();
+        if (op == A_EQ || op == A_NE || op == A_LT || op == A_LE || op == A_GT || op == A_GE) {
+            // 整数在 long 中比较，有浮点数时在 double 中比较，结果是 long 类型的0或1
+            PrimitiveType type = x->getCalType();
+            if (x->getPrimitiveType() != P_LONG || (type != P_LONG && type != P_FLOAT)) return false;
+            Value left, right, a, b;
+            if (!evalConstant(x->getLeft(), left) || !evalConstant(x->getRight(), right)) return false;
+            if (!convertConstant(left, type, a) || !convertConstant(right, type, b)) return false;
+            int cmp = type == P_FLOAT ? (a.fvalue < b.fvalue ? -1 : a.fvalue > b.fvalue ? 1 : a.fvalue == b.fvalue ? 0 : 2)
+                                      : (a.lvalue < b.lvalue ? -1 : a.lvalue > b.lvalue ? 1 : 0);
+            bool result;
+            switch (op) {
+                case A_EQ: result = cmp == 0; break;
+                case A_NE: result = cmp != 0; break;
+                case A_LT: result = cmp == -1; break;
+                case A_LE: result = cmp == -1 || cmp == 0; break;
+                case A_GT: result = cmp == 1; break;
+                default: result = cmp == 1 || cmp == 0; break;
+            }
+            value = Value{.type = P_LONG, .lvalue = result ? 1L : 0L};
+            return true;
+        }
+        if (op != A_ADD && op != A_SUBTRACT && op != A_MULTIPLY && op != A_DIVIDE && op != A_MOD) return false;
+        // 指针运算的结果是地址，比较和位运算的结果类型和操作数不一致，都不在这里计算
+        PrimitiveType type = x->getCalType();
+        if (x->getPrimitiveType() != type || (type != P_INT && type != P_LONG && type != P_FLOAT)) return false;
+        Value left, right;
+        if (!evalConstant(x->getLeft(), left) || !evalConstant(x->getRight(), right)) return false;
+        if (left.type != type || right.type != type) return false;
+        if (type == P_FLOAT) {
+            double a = left.fvalue, b = right.fvalue;
+            switch (op) {
+                case A_ADD: value = Value{.type = P_FLOAT, .fvalue = a + b}; break;
+                case A_SUBTRACT: value = Value{.type = P_FLOAT, .fvalue = a - b}; break;
+                case A_MULTIPLY: value = Value{.type = P_FLOAT, .fvalue = a * b}; break;
+                case A_DIVIDE: value = Value{.type = P_FLOAT, .fvalue = a / b}; break;
+                default: return false;
+            }
+            // NaN 的符号位由硬件决定，也不能作为数据段常量表的键（和任何值都不可比较）
+            return !std::isnan(value.fvalue);
+        }
+        long a = type == P_LONG ? left.lvalue : left.ivalue;
+        long b = type == P_LONG ? right.lvalue : right.ivalue;
+        long min = type == P_LONG ? std::numeric_limits<long>::min() : std::numeric_limits<int>::min();
+        // 加减乘按64位回绕后截断，int 的结果和32位指令相同
+        switch (op) {
+            case A_ADD: value = makeIntConstant(type, (long)((unsigned long)a + (unsigned long)b)); break;
+            case A_SUBTRACT: value = makeIntConstant(type, (long)((unsigned long)a - (unsigned long)b)); break;
+            case A_MULTIPLY: value = makeIntConstant(type, (long)((unsigned long)a * (unsigned long)b)); break;
+            default:
+                // 除零和 MIN / -1 在运行时触发异常
+                if (b == 0 || (a == min && b == -1)) return false;
+                value = makeIntConstant(type, op == A_DIVIDE ? a / b : a % b);
+        }
+        return true;
+    }
+    return false;
+}
+
+bool getStaticInitializer(const Symbol& sym, const std::shared_ptr<ExprNode>& init, Value& value) {
+    if (sym.is_array || init == nullptr) return false;
+    return evalConstant(init, value) && convertConstant(value, sym.type, value);
+}
+
+bool isInvariantIn(const std::shared_ptr<ExprNode>& expr, const SideEffects& effects, const std::set<Symbol*>& address_taken) {
+    bool ret = true;
+    forEachNode(expr, [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (auto x = std::dynamic_pointer_cast<LValueNode>(n)) {
+            Symbol* sym = x->getSymbol().get();
+            // 局部和全局数组的基址是常量，数组参数是一个指针变量
+            if (x->isArray() && !x->isParam()) return;
+            if (effects.written.count(sym)) ret = false;
+            if ((sym->is_global || address_taken.count(sym)) && (effects.has_call || effects.has_pointer_store)) ret = false;
+        } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(n)) {
+            UnaryOp op = x->getOp();
+            if (op == U_DEREF || op == U_PREINC || op == U_PREDEC || op == U_POSTINC || op == U_POSTDEC) ret = false;
+        } else if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(n)) {
+            long divisor;
+            if ((x->getOp() == A_DIVIDE || x->getOp() == A_MOD) && x->getCalType() != P_FLOAT) {
+                if (!getConstantValue(x->getRight(), divisor) || divisor == 0 || divisor == -1) ret = false;
+            }
+        } else if (std::dynamic_pointer_cast<FunctionCallNode>(n) || std::dynamic_pointer_cast<AssignmentNode>(n)) {
+            ret = false;
+        }
+    });
+    return ret;
+}
+
+std::shared_ptr<ExprNode> cloneExpr(const std::shared_ptr<ExprNode>& expr, const std::map<Symbol*, std::shared_ptr<ExprNode>>& subst) {
+    if (expr == nullptr) return nullptr;
+    if (auto x = std::dynamic_pointer_cast<ValueNode>(expr)) {
+        return std::make_shared<ValueNode>(x->getValue());
+    } else if (auto x = std::dynamic_pointer_cast<LValueNode>(expr)) {
+        auto it = subst.find(x->getSymbol().get());
+        if (it != subst.end() && !x->isArray()) return cloneExpr(it->second);
+        auto sym = x->getSymbol();
+        if (it != subst.end()) {
+            // 数组参数替换为实参数组 &arr，下标仍按形参的维度计算
+            auto addr = std::dynamic_pointer_cast<UnaryExpNode>(it->second);
+            auto arr = addr != nullptr && addr->getOp() == U_ADDR ? std::dynamic_pointer_cast<LValueNode>(addr->getExpr()) : nullptr;
+            if (arr == nullptr || !arr->isArray() || arr->getIndex() != nullptr) throw std::runtime_error("cloneExpr: Array must be substituted by a whole array");
+            sym = arr->getSymbol();
+        }
+        auto ret = std::make_shared<LValueNode>(sym, cloneExpr(x->getIndex(), subst));
+        ret->setIndexLen(x->getIndexLen());
+        ret->setPrimitiveType(x->getPrimitiveType());
+        return ret;
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(expr)) {
+        auto ret = std::make_shared<UnaryExpNode>(x->getOp(), cloneExpr(x->getExpr(), subst), x->getPrimitiveType());
+        ret->setOffset(x->getOffset());
+        return ret;
+    } else if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(expr)) {
+        auto ret = std::make_shared<BinaryExpNode>(x->getOp(), cloneExpr(x->getLeft(), subst), cloneExpr(x->getRight(), subst));
+        ret->updateCalType();
+        ret->setPrimitiveType(x->getPrimitiveType());
+        return ret;
+    } else if (auto x = std::dynamic_pointer_cast<AssignmentNode>(expr)) {
+        auto ret = std::make_shared<AssignmentNode>(cloneExpr(x->getLvalue(), subst), cloneExpr(x->getExpr(), subst));
+        ret->setType(x->getPrimitiveType());
+        return ret;
+    } else if (auto x = std::dynamic_pointer_cast<FunctionCallNode>(expr)) {
+        std::vector<std::shared_ptr<ExprNode>> args;
+        for (const auto& arg : x->getArguments()) {
+            args.push_back(cloneExpr(arg, subst));
+        }
+        auto ret = std::make_shared<FunctionCallNode>(x->getIdentifier(), args, x->getPrimitiveType());
+        ret->updateParamCount();
+        ret->setProfileCount(x->getProfileCount());
+        return ret;
+    }
+    throw std::runtime_error("cloneExpr: Unsupported expression node type");
+}
+
+std::shared_ptr<StatementNode> cloneStatement(const std::shared_ptr<StatementNode>& stmt, const std::map<Symbol*, std::shared_ptr<ExprNode>>& subst, std::map<std::string, std::string>& labels) {
+    if (stmt == nullptr) return nullptr;
+    if (auto x = std::dynamic_pointer_cast<ExprNode>(stmt)) {
+        return cloneExpr(x, subst);
+    } else if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        auto ret = std::make_shared<BlockNode>();
+        for (const auto& s : x->getStatements()) {
+            ret->addStatement(cloneStatement(s, subst, labels));
+        }
+        ret->is_labeled = x->is_labeled;
+        return ret;
+    } else if (auto x = std::dynamic_pointer_cast<PrintStatementNode>(stmt)) {
+        return std::make_shared<PrintStatementNode>(cloneExpr(x->getExpression(), subst));
+    } else if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(stmt)) {
+        auto ret = std::make_shared<VariableDeclareNode>(x->getVariableType());
+        for (const auto& sym : x->getSymbols()) {
+            if (sym->is_array) throw std::runtime_error("cloneStatement: Unsupported array declaration");
+            // 被重命名的局部变量在subst中对应新变量的引用
+            auto it = subst.find(sym.get());
+            auto ref = it != subst.end() ? std::dynamic_pointer_cast<LValueNode>(it->second) : nullptr;
+            ret->addIdentifier(ref != nullptr ? ref->getSymbol() : sym, cloneExpr(x->getInitializer(*sym), subst));
+        }
+        return ret;
+    } else if (auto x = std::dynamic_pointer_cast<IfStatementNode>(stmt)) {
+        auto ret = std::make_shared<IfStatementNode>(cloneExpr(x->getCondition(), subst),
+            cloneStatement(x->getThenStatement(), subst, labels), cloneStatement(x->getElseStatement(), subst, labels));
+        ret->setProfileCounts(x->getThenCount(), x->getElseCount());
+        return ret;
+    } else if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(stmt)) {
+        std::string label_no = labelAllocator.getLabel(LableType::WHILE_LABEL);
+        labels[x->getWhileStartLabel()] = "WHILE_START_" + label_no;
+        labels[x->getWhileEndLabel()] = "WHILE_END_" + label_no;
+        auto ret = std::make_shared<WhileStatementNode>(cloneExpr(x->getCondition(), subst), cloneStatement(x->getBody(), subst, labels));
+        ret->setLabels("WHILE_START_" + label_no, "WHILE_END_" + label_no);
+        return ret;
+    } else if (auto x = std::dynamic_pointer_cast<ForStatementNode>(stmt)) {
+        std::string label_no = labelAllocator.getLabel(LableType::FOR_LABEL);
+        labels[x->getForStartLabel()] = "FOR_START_" + label_no;
+        labels[x->getForEndLabel()] = "FOR_END_" + label_no;
+        auto ret = std::make_shared<ForStatementNode>(cloneStatement(x->getPreopStatement(), subst, labels), cloneExpr(x->getCondition(), subst),
+            cloneStatement(x->getBody(), subst, labels), cloneStatement(x->getPostopStatement(), subst, labels));
+        ret->setLabels("FOR_START_" + label_no, "FOR_END_" + label_no);
+        return ret;
+    } else if (auto x = std::dynamic_pointer_cast<SwitchStatementNode>(stmt)) {
+        std::string switch_end = "SWITCH_END_" + labelAllocator.getLabel(LableType::SWITCH_LABEL);
+        labels[x->getSwitchEndLabel()] = switch_end;
+        std::vector<SwitchStatementNode::Case> cases;
+        for (const auto& c : x->getCases()) {
+            auto body = std::static_pointer_cast<BlockNode>(cloneStatement(c.body, subst, labels));
+            cases.push_back(SwitchStatementNode::Case{c.values, c.is_default, body});
+        }
+        auto ret = std::make_shared<SwitchStatementNode>(cloneExpr(x->getCondition(), subst), cases);
+        ret->setLabel(switch_end);
+        return ret;
+    } else if (auto x = std::dynamic_pointer_cast<BreakStatementNode>(stmt)) {
+        auto it = labels.find(x->getLabel());
+        return std::make_shared<BreakStatementNode>(it != labels.end() ? it->second : x->getLabel());
+    } else if (auto x = std::dynamic_pointer_cast<ContinueStatementNode>(stmt)) {
+        auto it = labels.find(x->getLabel());
+        return std::make_shared<ContinueStatementNode>(it != labels.end() ? it->second : x->getLabel());
+    } else if (auto x = std::dynamic_pointer_cast<ReturnStatementNode>(stmt)) {
+        auto ret = std::make_shared<ReturnStatementNode>(cloneExpr(x->getExpression(), subst));
+        ret->setFunction(x->getFunction());
+        return ret;
+    } else if (auto x = std::dynamic_pointer_cast<ProfileCounterNode>(stmt)) {
+        // 内联展开的函数体仍然累加到被调用函数自己的计数器
+        return std::make_shared<ProfileCounterNode>(x->getIndex());
+    }
+    throw std::runtime_error("cloneStatement: Unsupported statement node type");
+}
+
+bool isTempType(PrimitiveType type) {
+    // char 的运算结果在寄存器中的宽度不固定，不放入临时变量
+    return type == P_INT || type == P_LONG || type == P_FLOAT || is_pointer(type);
+}
+
+bool isConstantExpr(const std::shared_ptr<ExprNode>& expr) {
+    bool ret = true;
+    forEachNode(expr, [&](const std::shared_ptr<ASTNode>& node, int) {
+        if (std::dynamic_pointer_cast<LValueNode>(node)) ret = false;
+    });
+    return ret;
+}
+
+PrimitiveType tempTypeOf(const std::shared_ptr<ExprNode>& expr) {
+    PrimitiveType type = expr->getPrimitiveType();
+    if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(expr)) {
+        // 比较和位运算的结果寄存器类型与节点类型不一致
+        ExprType op = x->getOp();
+        if (op != A_ADD && op != A_SUBTRACT && op != A_MULTIPLY && op != A_DIVIDE && op != A_MOD) return P_NONE;
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(expr)) {
+        UnaryOp op = x->getOp();
+        if (op != U_MINUS && op != U_TRANSFORM && op != U_SCALE && op != U_DEREF && op != U_ADDR) return P_NONE;
+    } else if (auto x = std::dynamic_pointer_cast<LValueNode>(expr)) {
+        if (x->isArray()) type = pointTo(x->getSymbol()->type);
+    } else {
+        return P_NONE;
+    }
+    return isTempType(type) ? type : P_NONE;
+}
+
+int evalCost(const std::shared_ptr<ExprNode>& expr) {
+    if (expr == nullptr) return 0;
+    if (std::dynamic_pointer_cast<ValueNode>(expr)) {
+        return 1;
+    } else if (auto x = std::dynamic_pointer_cast<LValueNode>(expr)) {
+        if (x->isArray()) return x->getIndex() == nullptr ? 1 : evalCost(x->getIndex()) + 2;
+        return x->getSymbol()->is_global ? 2 : 1;
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(expr)) {
+        return evalCost(x->getExpr()) + 1;
+    } else if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(expr)) {
+        return evalCost(x->getLeft()) + evalCost(x->getRight()) + 1;
+    }
+    return 100;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "common/defs.h"
+#include "parser/parser.h"
+#include <functional>
+#include <set>
+#include <map>
+
+// 遍历AST时的回调，loop_depth为当前节点所在的循环嵌套深度
+using NodeCallback = std::function<void(const std::shared_ptr<ASTNode>&, int loop_depth)>;
+
+// 先序遍历node及其所有子节点（语句和表达式）
+void forEachNode(const std::shared_ptr<ASTNode>& node, const NodeCallback& callback, int loop_depth = 0);
+
+// 一段代码对内存的副作用
+struct SideEffects {
+    std::set<Symbol*> written; // 被赋值、自增自减或声明时初始化的变量（包括数组）
+    bool has_call = false; // 调用了用户函数，可能修改任何全局变量或被取地址的变量
+    bool has_pointer_store = false; // 通过指针或数组参数写内存
+};
+
+SideEffects collectSideEffects(const std::shared_ptr<ASTNode>& node);
+
+// 在node中被 U_ADDR 取地址的标量变量
+std::set<Symbol*> collectAddressTaken(const std::shared_ptr<ASTNode>& node);
+
+// 表达式求值是否会修改程序状态（赋值、自增自减、函数调用）
+bool hasSideEffects(const std::shared_ptr<ExprNode>& expr);
+
+// 两个表达式在结构上是否相同
+bool exprEqual(const std::shared_ptr<ExprNode>& a, const std::shared_ptr<ExprNode>& b);
+
+// 声明一个编译器临时变量并用init初始化
+std::shared_ptr<VariableDeclareNode> makeTempDecl(const std::shared_ptr<Symbol>& sym, std::shared_ptr<ExprNode> init);
+
+// 引用变量sym的表达式
+std::shared_ptr<LValueNode> makeVarRef(const std::shared_ptr<Symbol>& sym);
+
+// 值为value的字面量。浮点常量按值共用数据段中的标号，0.0 和 -0.0 不能区分，调用者不应传入 -0.0
+std::shared_ptr<ValueNode> makeConstant(const Value& value);
+
+// expr是否是对标量变量sym的引用
+bool isScalarOf(const std::shared_ptr<ExprNode>& expr, const Symbol* sym);
+
+// node中是否引用了变量sym
+bool mentionsSymbol(const std::shared_ptr<ASTNode>& node, const Symbol* sym);
+
+// 去掉外层的 U_TRANSFORM
+std::shared_ptr<ExprNode> stripTransform(std::shared_ptr<ExprNode> expr);
+
+// 整型常量表达式（字面量、取负、类型转换）的值
+bool getConstantValue(const std::shared_ptr<ExprNode>& expr, long &value);
+
+// 初值和边界都是常量的 for 循环第一次一定进入循环体
+bool entersLoop(const std::shared_ptr<StatementNode>& preop, const std::shared_ptr<ExprNode>& cond);
+
+// 把常量转换成to类型，结果和生成代码中的类型转换一致（char 是无符号的一个字节）；浮点数超出整型范围时返回false
+bool convertConstant(const Value& value, PrimitiveType to, Value& result);
+
+// 编译期计算只由字面量、正负号、类型转换、四则运算和比较组成的表达式，得到和运行时相同的值。
+// 除数为零或结果由硬件决定的表达式返回false
+bool evalConstant(const std::shared_ptr<ExprNode>& expr, Value& value);
+
+// 全局标量的初值在编译期已知时返回true，value是转换成变量类型后的值，直接写进数据段，不需要在main中初始化
+bool getStaticInitializer(const Symbol& sym, const std::shared_ptr<ExprNode>& init, Value& value);
+
+// 在写入集合为effects的代码中，expr每次求值的结果是否相同。不读内存，也不会触发除零异常
+bool isInvariantIn(const std::shared_ptr<ExprNode>& expr, const SideEffects& effects, const std::set<Symbol*>& address_taken);
+
+// 深拷贝表达式，subst中的标量变量替换为对应表达式的拷贝，数组替换为 &arr 形式的整个数组
+std::shared_ptr<ExprNode> cloneExpr(const std::shared_ptr<ExprNode>& expr, const std::map<Symbol*, std::shared_ptr<ExprNode>>& subst = {});
+
+// 深拷贝语句。声明的变量在subst中有对应的变量引用时改为声明该变量；
+// 拷贝出的循环使用新的标号，labels记录旧标号到新标号的映射，用于改写其中的 break/continue
+std::shared_ptr<StatementNode> cloneStatement(const std::shared_ptr<StatementNode>& stmt, const std::map<Symbol*, std::shared_ptr<ExprNode>>& subst, std::map<std::string, std::string>& labels);
+
+// 能否放进编译器临时变量
+bool isTempType(PrimitiveType type);
+
+// 不引用任何变量的表达式，求值只需要立即数，不值得占用临时变量
+bool isConstantExpr(const std::shared_ptr<ExprNode>& expr);
+
+// 把expr的值存入临时变量时临时变量的类型，P_NONE 表示不能存入。数组元素节点的值是元素的地址
+PrimitiveType tempTypeOf(const std::shared_ptr<ExprNode>& expr);
+
+// 粗略估计表达式求值的指令数，LICM 和 GVN 只处理至少两条指令的表达式
+int evalCost(const std::shared_ptr<ExprNode>& expr);
@@ -0,0 +1,166 @@
+#include "optimizer/cfg.h"
+
+ControlFlowGraph::ControlFlowGraph(const std::shared_ptr<FunctionDeclareNode>& func) {
+    newBlock(); // 入口
+    newBlock(); // 出口，return 和函数体的末尾都到这里
+    current = -1;
+    int body = newBlock();
+    addEdge(entry(), body);
+    startBlock(body);
+    buildStatement(func->getBody());
+    jump(exit());
+    computeOrder();
+}
+
+int ControlFlowGraph::newBlock() {
+    int id = blocks.size();
+    blocks.push_back({id, {}, {}, {}});
+    return id;
+}
+
+void ControlFlowGraph::addEdge(int from, int to) {
+    blocks[from].succs.push_back(to);
+    blocks[to].preds.push_back(from);
+}
+
+// break/return 之后的语句不可达，放进一个没有前驱的新块
+void ControlFlowGraph::append(const std::shared_ptr<ASTNode>& node) {
+    if (node == nullptr) return;
+    if (current < 0) current = newBlock();
+    blocks[current].nodes.push_back(node);
+}
+
+// 当前位置跳到块to，之后的位置不可达
+void ControlFlowGraph::jump(int to) {
+    if (current >= 0) addEdge(current, to);
+    current = -1;
+}
+
+void ControlFlowGraph::startBlock(int id) {
+    current = id;
+}
+
+void ControlFlowGraph::buildStatement(const std::shared_ptr<StatementNode>& stmt) {
+    if (stmt == nullptr) return;
+    if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        for (const auto& s : x->getStatements()) buildStatement(s);
+    } else if (auto x = std::dynamic_pointer_cast<IfStatementNode>(stmt)) {
+        append(x->getCondition());
+        int cond = current;
+        int join = newBlock();
+        int then_block = newBlock();
+        addEdge(cond, then_block);
+        startBlock(then_block);
+        buildStatement(x->getThenStatement());
+        jump(join);
+        if (x->getElseStatement() != nullptr) {
+            int else_block = newBlock();
+            addEdge(cond, else_block);
+            startBlock(else_block);
+            buildStatement(x->getElseStatement());
+            jump(join);
+        } else {
+            addEdge(cond, join);
+        }
+        startBlock(join);
+    } else if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(stmt)) {
+        buildLoop(x->getCondition(), x->getBody(), nullptr, x->getWhileStartLabel(), x->getWhileEndLabel());
+    } else if (auto x = std::dynamic_pointer_cast<ForStatementNode>(stmt)) {
+        buildStatement(x->getPreopStatement());
+        buildLoop(x->getCondition(), x->getBody(), x->getPostopStatement(), x->getForStartLabel(), x->getForEndLabel());
+    } else if (auto x = std::dynamic_pointer_cast<SwitchStatementNode>(stmt)) {
+        append(x->getCondition());
+        int dispatch = current;
+        current = -1;
+        int end = newBlock();
+        label_block[x->getSwitchEndLabel()] = end;
+        for (const auto& c : x->getCases()) {
+            int case_block = newBlock();
+            addEdge(dispatch, case_block);
+            jump(case_block); // 上一个分支没有 break 时落入这个分支
+            startBlock(case_block);
+            buildStatement(c.body);
+        }
+        jump(end);
+        if (!x->hasDefault()) addEdge(dispatch, end);
+        startBlock(end);
+    } else if (auto x = std::dynamic_pointer_cast<VectorLoopNode>(stmt)) {
+        // 别名检查和循环不变量的展开在进入循环前求值
+        for (const auto& [a, b] : x->getAliasChecks()) {
+            append(a);
+            append(b);
+        }
+        for (const auto& inv : x->getInvariants()) append(inv.first);
+        int head = newBlock();
+        int end = newBlock();
+        int body = newBlock();
+        jump(head);
+        startBlock(head);
+        append(x->getCondition());
+        addEdge(head, body);
+        addEdge(head, end);
+        startBlock(body);
+        for (const auto& assign : x->getBody()) append(assign);
+        append(x->getIncrement());
+        jump(head);
+        startBlock(end);
+    } else if (auto x = std::dynamic_pointer_cast<BreakStatementNode>(stmt)) {
+        auto it = label_block.find(x->getLabel());
+        if (it == label_block.end()) throw std::runtime_error("ControlFlowGraph: unknown break label " + x->getLabel());
+        jump(it->second);
+    } else if (auto x = std::dynamic_pointer_cast<ContinueStatementNode>(stmt)) {
+        auto it = label_block.find(x->getLabel());
+        if (it == label_block.end()) throw std::runtime_error("ControlFlowGraph: unknown continue label " + x->getLabel());
+        jump(it->second);
+    } else if (auto x = std::dynamic_pointer_cast<ReturnStatementNode>(stmt)) {
+        append(x);
+        jump(exit());
+    } else {
+        // 声明、表达式、print 和计数器都是简单语句
+        append(stmt);
+    }
+}
+
+// 条件单独成块，continue 跳回条件，循环体（和 for 的 postop）执行完也回到条件
+void ControlFlowGraph::buildLoop(const std::shared_ptr<ExprNode>& cond, const std::shared_ptr<StatementNode>& body,
+    const std::shared_ptr<StatementNode>& postop, const std::string& start, const std::string& end) {
+    int head = newBlock();
+    int end_block = newBlock();
+    int body_block = newBlock();
+    label_block[start] = head;
+    label_block[end] = end_block;
+    jump(head);
+    startBlock(head);
+    append(cond);
+    addEdge(head, body_block);
+    addEdge(head, end_block);
+    startBlock(body_block);
+    buildStatement(body);
+    buildStatement(postop);
+    jump(head);
+    startBlock(end_block);
+}
+
+// 非递归的深度优先遍历，函数很大时也不会栈溢出
+void ControlFlowGraph::computeOrder() {
+    std::vector<int> postorder;
+    std::vector<bool> visited(blocks.size(), false);
+    std::vector<std::pair<int, size_t>> stack = {{entry(), 0}};
+    visited[entry()] = true;
+    while (!stack.empty()) {
+        auto& [id, next] = stack.back();
+        if (next < blocks[id].succs.size()) {
+            int succ = blocks[id].succs[next++];
+            if (!visited[succ]) {
+                visited[succ] = true;
+                stack.push_back({succ, 0});
+            }
+        } else {
+            postorder.push_back(id);
+            stack.pop_back();
+        }
+    }
+    rpo.assign(postorder.rbegin(), postorder.rend());
+    rpo_index.assign(blocks.size(), -1);
+    for (size_t i = 0; i < rpo.size(); i++) rpo_index[rpo[i]] = i;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "optimizer/optimizer.h"
+#include <map>
+
+// 基本块：nodes 是按执行顺序排列的简单语句和条件表达式，不含 if/while/for/switch 这样的复合语句，
+// 块内的结点依次执行，只有最后一个结点之后才会分叉
+struct BasicBlock {
+    int id;
+    std::vector<std::shared_ptr<ASTNode>> nodes;
+    std::vector<int> succs;
+    std::vector<int> preds;
+};
+
+// 函数体的控制流图。边和代码生成的跳转一致：for 的 continue 跳到条件而不经过 postop，
+// switch 的分支没有 break 时落入下一个分支，return 跳到出口块。
+// 表达式中没有短路求值，所以条件表达式整体是一个结点
+class ControlFlowGraph {
+public:
+    explicit ControlFlowGraph(const std::shared_ptr<FunctionDeclareNode>& func);
+
+    int entry() const { return 0; }
+    int exit() const { return 1; }
+    const std::vector<BasicBlock>& getBlocks() const { return blocks; }
+    const BasicBlock& getBlock(int id) const { return blocks[id]; }
+    size_t size() const { return blocks.size(); }
+
+    // 从入口可达的块的逆后序，前向问题按这个顺序迭代收敛最快
+    const std::vector<int>& reversePostorder() const { return rpo; }
+    // 块在逆后序中的位置，不可达的块为-1
+    int rpoIndex(int id) const { return rpo_index[id]; }
+    bool isReachable(int id) const { return rpo_index[id] >= 0; }
+
+private:
+    std::vector<BasicBlock> blocks;
+    std::vector<int> rpo;
+    std::vector<int> rpo_index;
+    std::map<std::string, int> label_block; // break/continue 标号跳到的块
+    int current; // 正在追加结点的块，-1 表示当前位置不可达
+
+    int newBlock();
+    void addEdge(int from, int to);
+    void append(const std::shared_ptr<ASTNode>& node);
+    void jump(int to);
+    void startBlock(int id);
+    void buildStatement(const std::shared_ptr<StatementNode>& stmt);
+    void buildLoop(const std::shared_ptr<ExprNode>& cond, const std::shared_ptr<StatementNode>& body,
+        const std::shared_ptr<StatementNode>& postop, const std::string& start, const std::string& end);
+    void computeOrder();
+};
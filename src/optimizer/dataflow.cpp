@@ -0,0 +1,234 @@
+#include "optimizer/dataflow.h"
+#include "optimizer/ast_utils.h"
+#include <algorithm>
+#include <queue>
+#include <set>
+
+DataflowResult solveDataflow(const ControlFlowGraph& cfg, const DataflowProblem& problem) {
+    size_t n = cfg.size();
+    DataflowResult result;
+    // 取交集的问题除了边界之外从全集开始向下收敛
+    result.in.assign(n, BitVector(problem.bits));
+    result.out.assign(n, BitVector(problem.bits));
+    auto& input = problem.forward ? result.in : result.out;
+    auto& output = problem.forward ? result.out : result.in;
+
+    std::vector<int> order = cfg.reversePostorder();
+    if (!problem.forward) std::reverse(order.begin(), order.end());
+    std::vector<int> pos(n, -1);
+    for (size_t i = 0; i < order.size(); i++) pos[order[i]] = i;
+    for (int b : order) output[b] = BitVector(problem.bits, problem.intersect);
+    int boundary = problem.forward ? cfg.entry() : cfg.exit();
+
+    std::priority_queue<int, std::vector<int>, std::greater<int>> worklist; // 按 order 中的位置出队
+    std::vector<bool> queued(order.size(), true);
+    for (size_t i = 0; i < order.size(); i++) worklist.push(i);
+    while (!worklist.empty()) {
+        int p = worklist.top();
+        worklist.pop();
+        queued[p] = false;
+        int b = order[p];
+        const BasicBlock& block = cfg.getBlock(b);
+        const auto& sources = problem.forward ? block.preds : block.succs;
+        BitVector value(problem.bits);
+        if (b == boundary) {
+            value = problem.boundary;
+        } else {
+            bool first = true;
+            for (int s : sources) {
+                if (pos[s] < 0) continue; // 不可达的前驱不影响结果
+                if (first) value = output[s];
+                else if (problem.intersect) value.intersectWith(output[s]);
+                else value.unionWith(output[s]);
+                first = false;
+            }
+        }
+        input[b] = value;
+        value.subtract(problem.kill[b]);
+        value.unionWith(problem.gen[b]);
+        if (value == output[b]) continue;
+        output[b] = std::move(value);
+        for (int t : problem.forward ? block.succs : block.preds) {
+            if (pos[t] >= 0 && !queued[pos[t]]) {
+                queued[pos[t]] = true;
+                worklist.push(pos[t]);
+            }
+        }
+    }
+    return result;
+}
+
+void nodeAccesses(const std::shared_ptr<ASTNode>& node, const std::map<Symbol*, int>& index, BitVector& uses, BitVector& defs) {
+    std::set<ASTNode*> targets; // 只被写入的变量引用
+    auto addDef = [&](Symbol* sym) {
+        auto it = index.find(sym);
+        if (it != index.end()) defs.set(it->second);
+    };
+    forEachNode(node, [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (auto x = std::dynamic_pointer_cast<AssignmentNode>(n)) {
+            auto y = std::dynamic_pointer_cast<LValueNode>(x->getLvalue());
+            if (y != nullptr && y->getIndex() == nullptr) {
+                addDef(y->getSymbol().get());
+                targets.insert(y.get());
+            }
+        } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(n)) {
+            UnaryOp op = x->getOp();
+            auto y = std::dynamic_pointer_cast<LValueNode>(x->getExpr());
+            // 自增自减先读后写，变量同时也是读取
+            if ((op == U_PREINC || op == U_PREDEC || op == U_POSTINC || op == U_POSTDEC) && y != nullptr && y->getIndex() == nullptr) {
+                addDef(y->getSymbol().get());
+            }
+        } else if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(n)) {
+            for (const auto& sym : x->getSymbols()) {
+                if (!sym->is_array && x->getInitializer(*sym) != nullptr) addDef(sym.get());
+            }
+        }
+    });
+    forEachNode(node, [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (auto x = std::dynamic_pointer_cast<LValueNode>(n)) {
+            auto it = index.find(x->getSymbol().get());
+            if (it != index.end() && !targets.count(x.get())) uses.set(it->second);
+        }
+    });
+}
+
+Liveness::Liveness(const ControlFlowGraph& cfg, const std::vector<Symbol*>& vars) : cfg(cfg) {
+    for (Symbol* sym : vars) index.emplace(sym, index.size());
+    DataflowProblem problem = {false, false, index.size(), {}, {}, BitVector(index.size())};
+    for (const auto& block : cfg.getBlocks()) {
+        // 从后往前合成整个块的传递函数
+        BitVector gen(index.size()), kill(index.size());
+        for (auto it = block.nodes.rbegin(); it != block.nodes.rend(); ++it) {
+            BitVector uses(index.size()), defs(index.size());
+            nodeAccesses(*it, index, uses, defs);
+            gen.subtract(defs);
+            gen.unionWith(uses);
+            kill.unionWith(defs);
+        }
+        problem.gen.push_back(std::move(gen));
+        problem.kill.push_back(std::move(kill));
+    }
+    result = solveDataflow(cfg, problem);
+}
+
+void Liveness::walkBackward(int block, const std::function<void(const std::shared_ptr<ASTNode>&, const BitVector& live)>& callback) const {
+    BitVector live = result.out[block];
+    const auto& nodes = cfg.getBlock(block).nodes;
+    for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+        callback(*it, live);
+        BitVector uses(index.size()), defs(index.size());
+        nodeAccesses(*it, index, uses, defs);
+        live.subtract(defs);
+        live.unionWith(uses);
+    }
+}
+
+ReachingDefinitions::ReachingDefinitions(const ControlFlowGraph& cfg, const std::vector<Symbol*>& vars) : cfg(cfg) {
+    for (Symbol* sym : vars) index.emplace(sym, index.size());
+    std::vector<Symbol*> symbols(vars.size());
+    for (const auto& [sym, i] : index) symbols[i] = sym;
+    // 先给所有定值编号，位向量的长度才能确定
+    for (const auto& block : cfg.getBlocks()) {
+        std::vector<int> starts;
+        for (const auto& node : block.nodes) {
+            starts.push_back(defs.size());
+            BitVector uses(index.size()), written(index.size());
+            nodeAccesses(node, index, uses, written);
+            written.forEach([&](size_t i) { defs.push_back({node, symbols[i], block.id}); });
+        }
+        starts.push_back(defs.size());
+        node_defs.push_back(std::move(starts));
+    }
+    defs_of.assign(index.size(), BitVector(defs.size()));
+    for (size_t d = 0; d < defs.size(); d++) defs_of[index[defs[d].symbol]].set(d);
+
+    DataflowProblem problem = {true, false, defs.size(), {}, {}, BitVector(defs.size())};
+    for (const auto& block : cfg.getBlocks()) {
+        BitVector gen(defs.size()), kill(defs.size());
+        for (size_t i = 0; i < block.nodes.size(); i++) {
+            for (int d = node_defs[block.id][i]; d < node_defs[block.id][i + 1]; d++) {
+                const BitVector& same = defs_of[index[defs[d].symbol]];
+                gen.subtract(same);
+                kill.unionWith(same);
+            }
+            for (int d = node_defs[block.id][i]; d < node_defs[block.id][i + 1]; d++) gen.set(d);
+        }
+        problem.gen.push_back(std::move(gen));
+        problem.kill.push_back(std::move(kill));
+    }
+    result = solveDataflow(cfg, problem);
+}
+
+// 结点中对同一个变量的写入只记一个定值，结点执行后它取代这个变量的所有其他定值
+void ReachingDefinitions::transfer(int block, size_t i, BitVector& reaching) const {
+    for (int d = node_defs[block][i]; d < node_defs[block][i + 1]; d++) {
+        reaching.subtract(defs_of[index.at(defs[d].symbol)]);
+    }
+    for (int d = node_defs[block][i]; d < node_defs[block][i + 1]; d++) reaching.set(d);
+}
+
+void ReachingDefinitions::walkForward(int block, const std::function<void(const std::shared_ptr<ASTNode>&, const BitVector& reaching)>& callback) const {
+    BitVector reaching = result.in[block];
+    const auto& nodes = cfg.getBlock(block).nodes;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        callback(nodes[i], reaching);
+        transfer(block, i, reaching);
+    }
+}
+
+DominatorTree::DominatorTree(const ControlFlowGraph& cfg) : entry(cfg.entry()) {
+    size_t n = cfg.size();
+    const auto& rpo = cfg.reversePostorder();
+    idoms.assign(n, -1);
+    idoms[entry] = entry;
+    // 沿着直接支配者往上走到两个块的公共祖先，逆后序编号小的块离入口更近
+    auto intersect = [&](int a, int b) {
+        while (a != b) {
+            while (cfg.rpoIndex(a) > cfg.rpoIndex(b)) a = idoms[a];
+            while (cfg.rpoIndex(b) > cfg.rpoIndex(a)) b = idoms[b];
+        }
+        return a;
+    };
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int b : rpo) {
+            if (b == entry) continue;
+            int dom = -1;
+            for (int p : cfg.getBlock(b).preds) {
+                if (idoms[p] < 0) continue; // 还没有处理过或者不可达
+                dom = dom < 0 ? p : intersect(p, dom);
+            }
+            if (dom >= 0 && idoms[b] != dom) {
+                idoms[b] = dom;
+                changed = true;
+            }
+        }
+    }
+
+    kids.assign(n, {});
+    for (int b : rpo) {
+        if (b != entry) kids[idoms[b]].push_back(b);
+    }
+    pre.assign(n, -1);
+    last.assign(n, -1);
+    int counter = 0;
+    std::vector<std::pair<int, size_t>> stack = {{entry, 0}};
+    pre[entry] = counter++;
+    while (!stack.empty()) {
+        auto& [b, next] = stack.back();
+        if (next < kids[b].size()) {
+            int child = kids[b][next++];
+            pre[child] = counter++;
+            stack.push_back({child, 0});
+        } else {
+            last[b] = counter - 1;
+            stack.pop_back();
+        }
+    }
+}
+
+bool DominatorTree::dominates(int a, int b) const {
+    if (pre[a] < 0 || pre[b] < 0) return false;
+    return pre[a] <= pre[b] && pre[b] <= last[a];
+}
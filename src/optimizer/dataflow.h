@@ -0,0 +1,158 @@
+#pragma once
+#include "optimizer/cfg.h"
+#include <cstdint>
+#include <functional>
+#include <map>
+
+// 定长的稠密位向量，每个数据流事实占一位，集合运算按64位字进行
+class BitVector {
+public:
+    explicit BitVector(size_t n = 0, bool value = false) : n(n), words((n + 63) / 64, value ? ~0UL : 0UL) {
+        trim();
+    }
+
+    size_t size() const { return n; }
+    bool test(size_t i) const { return (words[i / 64] >> (i % 64)) & 1; }
+    void set(size_t i) { words[i / 64] |= 1UL << (i % 64); }
+    void reset(size_t i) { words[i / 64] &= ~(1UL << (i % 64)); }
+
+    // 并入other，返回自身是否改变
+    bool unionWith(const BitVector& other) {
+        bool changed = false;
+        for (size_t i = 0; i < words.size(); i++) {
+            uint64_t w = words[i] | other.words[i];
+            changed |= w != words[i];
+            words[i] = w;
+        }
+        return changed;
+    }
+
+    void intersectWith(const BitVector& other) {
+        for (size_t i = 0; i < words.size(); i++) words[i] &= other.words[i];
+    }
+
+    void subtract(const BitVector& other) {
+        for (size_t i = 0; i < words.size(); i++) words[i] &= ~other.words[i];
+    }
+
+    bool any() const {
+        for (uint64_t w : words) {
+            if (w) return true;
+        }
+        return false;
+    }
+
+    size_t count() const {
+        size_t ret = 0;
+        for (uint64_t w : words) ret += __builtin_popcountl(w);
+        return ret;
+    }
+
+    // 按从小到大的顺序访问每个为1的位
+    template <typename F>
+    void forEach(F f) const {
+        for (size_t i = 0; i < words.size(); i++) {
+            for (uint64_t w = words[i]; w; w &= w - 1) f(i * 64 + __builtin_ctzl(w));
+        }
+    }
+
+    bool operator==(const BitVector& other) const { return words == other.words; }
+    bool operator!=(const BitVector& other) const { return words != other.words; }
+
+private:
+    size_t n;
+    std::vector<uint64_t> words;
+
+    void trim() {
+        if (n % 64 && !words.empty()) words.back() &= (1UL << (n % 64)) - 1;
+    }
+};
+
+// 块上的传递函数都是 out = gen ∪ (in − kill) 形式的数据流问题，后向问题中 in/out 的角色互换
+struct DataflowProblem {
+    bool forward;
+    bool intersect; // 汇合取交集（必然类问题），否则取并集（可能类问题）
+    size_t bits;
+    std::vector<BitVector> gen; // 按块编号
+    std::vector<BitVector> kill;
+    BitVector boundary; // 前向问题入口块的 in，后向问题出口块的 out
+};
+
+// in/out 都是按程序执行方向的块首和块尾，不可达的块为空集
+struct DataflowResult {
+    std::vector<BitVector> in;
+    std::vector<BitVector> out;
+};
+
+// 工作表算法：前向问题按逆后序、后向问题按后序从工作表中取块，每个块只在后继（前驱）的值改变时重新计算，
+// 没有深层嵌套循环时每个块只需要访问常数次
+DataflowResult solveDataflow(const ControlFlowGraph& cfg, const DataflowProblem& problem);
+
+// 结点读写的变量，只统计 index 中的标量。defs 是结点执行后一定被覆盖的变量：赋值和自增自减的目标以及有初值的声明，
+// 表达式没有短路求值，其中的赋值都会执行。uses 包括除了赋值目标之外出现的所有变量，结点中先写后读的变量也算作读
+void nodeAccesses(const std::shared_ptr<ASTNode>& node, const std::map<Symbol*, int>& index, BitVector& uses, BitVector& defs);
+
+// 活跃变量：块首活跃的变量是从这里出发的某条路径上在被覆盖之前读取的变量
+class Liveness {
+public:
+    Liveness(const ControlFlowGraph& cfg, const std::vector<Symbol*>& vars);
+
+    const std::map<Symbol*, int>& getIndex() const { return index; }
+    const BitVector& liveIn(int block) const { return result.in[block]; }
+    const BitVector& liveOut(int block) const { return result.out[block]; }
+    // 从块尾到块首逐个访问结点，live 是结点执行之后活跃的变量
+    void walkBackward(int block, const std::function<void(const std::shared_ptr<ASTNode>&, const BitVector& live)>& callback) const;
+
+private:
+    const ControlFlowGraph& cfg;
+    std::map<Symbol*, int> index;
+    DataflowResult result;
+};
+
+// 到达定值：每个对变量的写入是一个定值，之后再写同一个变量时被杀死
+class ReachingDefinitions {
+public:
+    struct Definition {
+        std::shared_ptr<ASTNode> node;
+        Symbol* symbol;
+        int block;
+    };
+
+    ReachingDefinitions(const ControlFlowGraph& cfg, const std::vector<Symbol*>& vars);
+
+    const std::vector<Definition>& getDefinitions() const { return defs; }
+    const BitVector& reachIn(int block) const { return result.in[block]; }
+    const BitVector& reachOut(int block) const { return result.out[block]; }
+    // 从块首到块尾逐个访问结点，reaching 是结点执行之前到达的定值
+    void walkForward(int block, const std::function<void(const std::shared_ptr<ASTNode>&, const BitVector& reaching)>& callback) const;
+
+private:
+    const ControlFlowGraph& cfg;
+    std::map<Symbol*, int> index;
+    std::vector<Definition> defs;
+    std::vector<std::vector<int>> node_defs; // 按块内结点的顺序排列的定值编号区间的起点，最后多一个终点
+    std::vector<BitVector> defs_of; // 每个变量的全部定值
+    DataflowResult result;
+
+    void transfer(int block, size_t i, BitVector& reaching) const;
+};
+
+// 支配树，用 Cooper-Harvey-Kennedy 的迭代算法按逆后序计算直接支配者，结构化的控制流一两遍就收敛。
+// 再按支配树的先序编号区间回答支配关系的查询，每次查询是常数时间
+class DominatorTree {
+public:
+    explicit DominatorTree(const ControlFlowGraph& cfg);
+
+    // 入口块和不可达的块返回-1
+    int idom(int block) const { return block == entry || idoms[block] < 0 ? -1 : idoms[block]; }
+    const std::vector<int>& children(int block) const { return kids[block]; }
+    // a 支配 b：从入口到b的每条路径都经过a，块支配自己。不可达的块不被任何块支配
+    bool dominates(int a, int b) const;
+
+private:
+    int entry;
+    std::vector<int> idoms;
+    std::vector<std::vector<int>> kids;
+    std::vector<int> pre;
+    std::vector<int> last; // 子树中最大的先序编号
+};
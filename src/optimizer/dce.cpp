@@ -0,0 +1,286 @@
+#include "optimizer/dce.h"
+#include <algorithm>
+
+// stmt执行完后是否可能继续执行下一条语句
+static bool fallsThrough(const std::shared_ptr<StatementNode>& stmt) {
+    if (std::dynamic_pointer_cast<ReturnStatementNode>(stmt) || std::dynamic_pointer_cast<BreakStatementNode>(stmt)
+        || std::dynamic_pointer_cast<ContinueStatementNode>(stmt)) {
+        return false;
+    }
+    if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        auto stmts = x->getStatements();
+        return stmts.empty() || fallsThrough(stmts.back());
+    }
+    if (auto x = std::dynamic_pointer_cast<IfStatementNode>(stmt)) {
+        return x->getElseStatement() == nullptr || fallsThrough(x->getThenStatement()) || fallsThrough(x->getElseStatement());
+    }
+    return true;
+}
+
+static bool isEmpty(const std::shared_ptr<StatementNode>& stmt) {
+    auto x = std::dynamic_pointer_cast<BlockNode>(stmt);
+    return stmt == nullptr || (x != nullptr && x->getStatements().empty());
+}
+
+void DeadCodeElimination::run(const std::shared_ptr<Pragram>& program) {
+    for (const auto& func : program->getFunctions()) {
+        func_name = func->getIdentifier();
+        address_taken = collectAddressTaken(func);
+        removed = 0;
+        simplifyBlock(func->getBody());
+        int last;
+        do {
+            last = removed;
+            LiveSet live;
+            label_live.clear();
+            liveBlock(func->getBody(), live, true);
+        } while (removed != last);
+        if (removed) opt_stats.count(name(), func_name, removed);
+    }
+}
+
+void DeadCodeElimination::simplifyBlock(const std::shared_ptr<BlockNode>& block) {
+    std::vector<std::shared_ptr<StatementNode>> stmts;
+    auto old = block->getStatements();
+    for (size_t i = 0; i < old.size(); i++) {
+        for (const auto& s : simplifyStatement(old[i])) {
+            stmts.push_back(s);
+        }
+        // 没有 goto，跳转语句之后的代码不可达
+        if (!stmts.empty() && !fallsThrough(stmts.back())) {
+            removed += old.size() - i - 1;
+            break;
+        }
+    }
+    block->setStatements(stmts);
+}
+
+std::shared_ptr<StatementNode> DeadCodeElimination::simplifyBody(const std::shared_ptr<StatementNode>& stmt) {
+    if (stmt == nullptr) return nullptr;
+    auto stmts = simplifyStatement(stmt);
+    if (stmts.size() == 1) return stmts[0];
+    auto block = std::make_shared<BlockNode>();
+    block->setStatements(stmts);
+    return block;
+}
+
+// 返回替换stmt的语句序列
+std::vector<std::shared_ptr<StatementNode>> DeadCodeElimination::simplifyStatement(const std::shared_ptr<StatementNode>& stmt) {
+    long value;
+    if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        simplifyBlock(x);
+    } else if (auto x = std::dynamic_pointer_cast<IfStatementNode>(stmt)) {
+        if (getConstantValue(x->getCondition(), value)) {
+            removed++;
+            auto taken = value != 0 ? x->getThenStatement() : x->getElseStatement();
+            if (taken == nullptr) return {};
+            return simplifyStatement(taken);
+        }
+        x->setThenStatement(simplifyBody(x->getThenStatement()));
+        x->setElseStatement(simplifyBody(x->getElseStatement()));
+        if (isEmpty(x->getThenStatement()) && isEmpty(x->getElseStatement()) && !hasSideEffects(x->getCondition())) {
+            removed++;
+            return {};
+        }
+    } else if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(stmt)) {
+        if (getConstantValue(x->getCondition(), value) && value == 0) {
+            removed++;
+            return {};
+        }
+        x->setBody(simplifyBody(x->getBody()));
+    } else if (auto x = std::dynamic_pointer_cast<ForStatementNode>(stmt)) {
+        if (x->getCondition() != nullptr && getConstantValue(x->getCondition(), value) && value == 0) {
+            removed++;
+            if (x->getPreopStatement() == nullptr) return {};
+            return {x->getPreopStatement()};
+        }
+        x->setBody(simplifyBody(x->getBody()));
+    } else if (auto x = std::dynamic_pointer_cast<SwitchStatementNode>(stmt)) {
+        for (const auto& c : x->getCases()) {
+            simplifyBlock(c.body);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<ExprNode>(stmt)) {
+        // 结果被丢弃的表达式，没有副作用时不需要求值
+        if (!hasSideEffects(x)) {
+            removed++;
+            return {};
+        }
+    }
+    return {stmt};
+}
+
+// 参与活跃变量分析的变量：不会通过指针或在其他函数中被访问的局部标量
+bool DeadCodeElimination::isTracked(const Symbol* sym) const {
+    return !sym->is_global && !sym->is_array && !address_taken.count(const_cast<Symbol*>(sym));
+}
+
+void DeadCodeElimination::addUses(const std::shared_ptr<ASTNode>& node, LiveSet& live) const {
+    if (node == nullptr) return;
+    forEachNode(node, [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (auto x = std::dynamic_pointer_cast<LValueNode>(n); x != nullptr && isTracked(x->getSymbol().get())) {
+            live.insert(x->getSymbol().get());
+        }
+    });
+}
+
+// live进入时是块之后活跃的变量，返回时是块之前活跃的变量
+void DeadCodeElimination::liveBlock(const std::shared_ptr<BlockNode>& block, LiveSet& live, bool rewrite) {
+    auto stmts = block->getStatements();
+    std::vector<std::shared_ptr<StatementNode>> kept;
+    for (size_t i = stmts.size(); i-- > 0;) {
+        auto s = liveStatement(stmts[i], live, rewrite);
+        if (s != nullptr) kept.push_back(s);
+    }
+    if (!rewrite) return;
+    std::reverse(kept.begin(), kept.end());
+    block->setStatements(kept);
+}
+
+std::shared_ptr<StatementNode> DeadCodeElimination::liveBody(const std::shared_ptr<StatementNode>& stmt, LiveSet& live, bool rewrite) {
+    if (stmt == nullptr) return nullptr;
+    auto s = liveStatement(stmt, live, rewrite);
+    return s != nullptr ? s : std::make_shared<BlockNode>();
+}
+
+// 返回替换stmt的语句，整条删除时返回空
+std::shared_ptr<StatementNode> DeadCodeElimination::liveStatement(const std::shared_ptr<StatementNode>& stmt, LiveSet& live, bool rewrite) {
+    if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        liveBlock(x, live, rewrite);
+    } else if (auto x = std::dynamic_pointer_cast<IfStatementNode>(stmt)) {
+        LiveSet else_live = live;
+        auto then_stmt = liveBody(x->getThenStatement(), live, rewrite);
+        auto else_stmt = liveBody(x->getElseStatement(), else_live, rewrite);
+        live.insert(else_live.begin(), else_live.end());
+        addUses(x->getCondition(), live);
+        if (rewrite) {
+            x->setThenStatement(then_stmt);
+            x->setElseStatement(else_stmt);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<SwitchStatementNode>(stmt)) {
+        // 分支从后往前分析，没有 break 的分支之后活跃的是下一个分支开头活跃的变量；
+        // 没有 default 时条件不匹配直接到 switch 之后
+        label_live[x->getSwitchEndLabel()] = live;
+        LiveSet entry = x->hasDefault() ? LiveSet{} : live;
+        auto cases = x->getCases();
+        for (size_t i = cases.size(); i-- > 0;) {
+            liveBlock(cases[i].body, live, rewrite);
+            entry.insert(live.begin(), live.end());
+        }
+        live = entry;
+        addUses(x->getCondition(), live);
+    } else if (std::dynamic_pointer_cast<WhileStatementNode>(stmt) || std::dynamic_pointer_cast<ForStatementNode>(stmt)) {
+        live = liveLoop(stmt, live, rewrite);
+    } else if (auto x = std::dynamic_pointer_cast<ReturnStatementNode>(stmt)) {
+        live.clear();
+        addUses(x->getExpression(), live);
+    } else if (auto x = std::dynamic_pointer_cast<BreakStatementNode>(stmt)) {
+        live = label_live[x->getLabel()];
+    } else if (auto x = std::dynamic_pointer_cast<ContinueStatementNode>(stmt)) {
+        live = label_live[x->getLabel()];
+    } else if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(stmt)) {
+        auto symbols = x->getSymbols();
+        for (size_t i = symbols.size(); i-- > 0;) {
+            auto sym = symbols[i];
+            auto init = x->getInitializer(*sym);
+            if (sym->is_array || !isTracked(sym.get())) {
+                addUses(init, live);
+                continue;
+            }
+            // 没有初值的声明不结束活跃范围，循环中上一次迭代留下的值仍可能被读到
+            if (init == nullptr) continue;
+            if (!live.count(sym.get()) && !hasSideEffects(init)) {
+                if (rewrite) {
+                    x->setInitializer(*sym, nullptr);
+                    removed++;
+                }
+                continue;
+            }
+            live.erase(sym.get());
+            addUses(init, live);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<AssignmentNode>(stmt)) {
+        auto lvalue = std::dynamic_pointer_cast<LValueNode>(x->getLvalue());
+        if (lvalue == nullptr || lvalue->isArray() || !isTracked(lvalue->getSymbol().get())) {
+            addUses(stmt, live);
+            return stmt;
+        }
+        Symbol* sym = lvalue->getSymbol().get();
+        if (live.count(sym)) {
+            live.erase(sym);
+            addUses(x->getExpr(), live);
+            return stmt;
+        }
+        // 赋值之后不会再被读到，只保留右边的副作用
+        bool pure = !hasSideEffects(x->getExpr());
+        if (!pure) addUses(x->getExpr(), live);
+        if (!rewrite) return stmt;
+        removed++;
+        return pure ? nullptr : std::static_pointer_cast<StatementNode>(x->getExpr());
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(stmt)) {
+        UnaryOp op = x->getOp();
+        auto lvalue = std::dynamic_pointer_cast<LValueNode>(x->getExpr());
+        bool incdec = op == U_PREINC || op == U_PREDEC || op == U_POSTINC || op == U_POSTDEC;
+        if (incdec && lvalue != nullptr && !lvalue->isArray() && isTracked(lvalue->getSymbol().get()) && !live.count(lvalue->getSymbol().get())) {
+            if (!rewrite) return stmt;
+            removed++;
+            return nullptr;
+        }
+        addUses(stmt, live);
+    } else {
+        // 打印、函数调用、向量循环等：只把读到的变量加入活跃集合
+        addUses(stmt, live);
+    }
+    return stmt;
+}
+
+// 循环头的活跃变量要迭代到不动点：循环体开头活跃的变量在循环头也活跃。
+// break 跳到循环之后，continue 跳到循环头（for 循环的 continue 跳过了后置语句）
+DeadCodeElimination::LiveSet DeadCodeElimination::liveLoop(const std::shared_ptr<StatementNode>& loop, const LiveSet& live_out, bool rewrite) {
+    std::shared_ptr<ExprNode> cond;
+    std::shared_ptr<StatementNode> body, postop;
+    std::string start, end;
+    if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(loop)) {
+        cond = x->getCondition();
+        body = x->getBody();
+        start = x->getWhileStartLabel();
+        end = x->getWhileEndLabel();
+    } else {
+        auto y = std::dynamic_pointer_cast<ForStatementNode>(loop);
+        cond = y->getCondition();
+        body = y->getBody();
+        postop = y->getPostopStatement();
+        start = y->getForStartLabel();
+        end = y->getForEndLabel();
+    }
+
+    LiveSet head = live_out;
+    addUses(cond, head);
+    while (true) {
+        label_live[start] = head;
+        label_live[end] = live_out;
+        LiveSet live = head;
+        if (postop != nullptr) liveStatement(postop, live, false);
+        liveStatement(body, live, false);
+        size_t size = head.size();
+        head.insert(live.begin(), live.end());
+        if (head.size() == size) break;
+    }
+
+    if (rewrite) {
+        label_live[start] = head;
+        label_live[end] = live_out;
+        LiveSet live = head;
+        if (auto x = std::dynamic_pointer_cast<ForStatementNode>(loop)) {
+            if (postop != nullptr) x->setPostopStatement(liveStatement(postop, live, true));
+            x->setBody(liveBody(body, live, true));
+        } else {
+            std::dynamic_pointer_cast<WhileStatementNode>(loop)->setBody(liveBody(body, live, true));
+        }
+    }
+
+    if (auto x = std::dynamic_pointer_cast<ForStatementNode>(loop); x != nullptr && x->getPreopStatement() != nullptr) {
+        auto preop = liveStatement(x->getPreopStatement(), head, rewrite);
+        if (rewrite) x->setPreopStatement(preop);
+    }
+    return head;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "optimizer/optimizer.h"
+#include "optimizer/ast_utils.h"
+#include <set>
+
+// 死代码删除：删掉 return/break/continue 之后不可达的语句，常量条件的 if 只保留会执行的分支，
+// while (0) 整个删掉，没有副作用的表达式语句直接丢弃。
+// 再对没有被取地址的局部标量做活跃变量分析，赋值之后再也不会被读到的变量不再写入，
+// 右边有副作用时只保留右边的求值。删除一条赋值可能让别的赋值变成死代码，反复执行直到没有变化。
+class DeadCodeElimination : public Pass {
+public:
+    std::string name() const override { return "dce"; }
+    void run(const std::shared_ptr<Pragram>& program) override;
+private:
+    using LiveSet = std::set<Symbol*>;
+
+    std::string func_name;
+    std::set<Symbol*> address_taken;
+    std::map<std::string, LiveSet> label_live; // break/continue 跳转到的标号处活跃的变量
+    int removed;
+
+    void simplifyBlock(const std::shared_ptr<BlockNode>& block);
+    std::vector<std::shared_ptr<StatementNode>> simplifyStatement(const std::shared_ptr<StatementNode>& stmt);
+    std::shared_ptr<StatementNode> simplifyBody(const std::shared_ptr<StatementNode>& stmt);
+
+    bool isTracked(const Symbol* sym) const;
+    void addUses(const std::shared_ptr<ASTNode>& node, LiveSet& live) const;
+    void liveBlock(const std::shared_ptr<BlockNode>& block, LiveSet& live, bool rewrite);
+    std::shared_ptr<StatementNode> liveStatement(const std::shared_ptr<StatementNode>& stmt, LiveSet& live, bool rewrite);
+    std::shared_ptr<StatementNode> liveBody(const std::shared_ptr<StatementNode>& stmt, LiveSet& live, bool rewrite);
+    LiveSet liveLoop(const std::shared_ptr<StatementNode>& loop, const LiveSet& live_out, bool rewrite);
+};
@@ -0,0 +1,277 @@
+#include "optimizer/gvn.h"
+#include <algorithm>
+
+void GlobalValueNumbering::run(const std::shared_ptr<Pragram>& program) {
+    for (const auto& func : program->getFunctions()) {
+        func_name = func->getIdentifier();
+        address_taken = collectAddressTaken(func);
+        table.clear();
+        inserted.clear();
+        eliminated = 0;
+        processBlock(func->getBody());
+        if (eliminated > 0) opt_stats.count(name(), func_name, eliminated);
+    }
+}
+
+// 块中记录的值在块结束后丢弃，块后面的语句不被块中的语句支配，临时变量的声明也只能插在块里
+void GlobalValueNumbering::processBlock(const std::shared_ptr<BlockNode>& block) {
+    Frame frame;
+    frame.stmts = block->getStatements();
+    size_t size = table.size();
+    for (frame.pos = 0; frame.pos < frame.stmts.size(); frame.pos++) {
+        auto stmt = frame.stmts[frame.pos]; // 处理语句时可能在它前面插入声明
+        processStatement(stmt, frame);
+    }
+    table.erase(table.begin() + size, table.end());
+    block->setStatements(frame.stmts);
+}
+
+std::shared_ptr<StatementNode> GlobalValueNumbering::processBody(const std::shared_ptr<StatementNode>& stmt) {
+    if (stmt == nullptr) return nullptr;
+    if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        processBlock(x);
+        return stmt;
+    }
+    auto block = std::make_shared<BlockNode>();
+    block->addStatement(stmt);
+    processBlock(block);
+    if (block->getStatements().size() == 1) return block->getStatements()[0];
+    return block;
+}
+
+void GlobalValueNumbering::processStatement(const std::shared_ptr<StatementNode>& stmt, Frame& frame) {
+    Site site{&frame, stmt};
+    Site loop_site{&frame, nullptr};
+    if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        processBlock(x);
+    } else if (auto x = std::dynamic_pointer_cast<IfStatementNode>(stmt)) {
+        visitValue(x->getCondition(), [x](std::shared_ptr<ExprNode> e) { x->setCondition(e); }, site);
+        kill(collectSideEffects(x->getCondition()));
+        auto saved = saveValid();
+        x->setThenStatement(processBody(x->getThenStatement()));
+        restoreValid(saved);
+        x->setElseStatement(processBody(x->getElseStatement()));
+        restoreValid(saved);
+        kill(collectSideEffects(x));
+    } else if (auto x = std::dynamic_pointer_cast<SwitchStatementNode>(stmt)) {
+        visitValue(x->getCondition(), [x](std::shared_ptr<ExprNode> e) { x->setCondition(e); }, site);
+        // 从上一个分支落下来时已经执行了上一个分支的写入
+        kill(collectSideEffects(x));
+        auto saved = saveValid();
+        for (const auto& c : x->getCases()) {
+            processBlock(c.body);
+            restoreValid(saved);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(stmt)) {
+        // 循环中写入的值在每次迭代开始时都可能已经改变
+        kill(collectSideEffects(x));
+        auto saved = saveValid();
+        if (!hasSideEffects(x->getCondition())) visitExpr(x->getCondition(), [x](std::shared_ptr<ExprNode> e) { x->setCondition(e); }, loop_site);
+        x->setBody(processBody(x->getBody()));
+        restoreValid(saved);
+    } else if (auto x = std::dynamic_pointer_cast<ForStatementNode>(stmt)) {
+        // 初始化语句只执行一次，它的值可以在循环前面算好
+        visitStatement(x->getPreopStatement(), site);
+        kill(collectSideEffects(x));
+        auto saved = saveValid();
+        if (!hasSideEffects(x->getCondition())) visitExpr(x->getCondition(), [x](std::shared_ptr<ExprNode> e) { x->setCondition(e); }, loop_site);
+        x->setBody(processBody(x->getBody()));
+        restoreValid(saved);
+    } else {
+        visitStatement(stmt, site);
+    }
+}
+
+// 处理不含控制流的语句，之后按语句的写入使记录的值失效
+void GlobalValueNumbering::visitStatement(const std::shared_ptr<StatementNode>& stmt, const Site& site) {
+    if (stmt == nullptr) return;
+    if (auto x = std::dynamic_pointer_cast<AssignmentNode>(stmt)) {
+        // 右边有副作用时，写入目标的地址和右边的求值顺序有关，不处理目标
+        if (!hasSideEffects(x->getExpr())) visitTarget(x->getLvalue(), site);
+        visitValue(x->getExpr(), [x](std::shared_ptr<ExprNode> e) { x->setExpr(e); }, site);
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(stmt)) {
+        UnaryOp op = x->getOp();
+        if (op == U_PREINC || op == U_PREDEC || op == U_POSTINC || op == U_POSTDEC) visitTarget(x->getExpr(), site);
+    } else if (auto x = std::dynamic_pointer_cast<FunctionCallNode>(stmt)) {
+        visitValue(x, nullptr, site);
+    } else if (auto x = std::dynamic_pointer_cast<PrintStatementNode>(stmt)) {
+        visitValue(x->getExpression(), [x](std::shared_ptr<ExprNode> e) { x->setExpression(e); }, site);
+    } else if (auto x = std::dynamic_pointer_cast<ReturnStatementNode>(stmt)) {
+        if (x->getExpression() != nullptr) visitValue(x->getExpression(), [x](std::shared_ptr<ExprNode> e) { x->setExpression(e); }, site);
+    } else if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(stmt)) {
+        // 逐个变量求初值并写入，后面的初值可以用到前面的变量
+        for (const auto& sym : x->getSymbols()) {
+            auto init = x->getInitializer(*sym);
+            if (!sym->is_array && init != nullptr) {
+                visitValue(init, [x, sym](std::shared_ptr<ExprNode> e) { x->setInitializer(*sym, e); }, site);
+            }
+            SideEffects effects = collectSideEffects(init);
+            effects.written.insert(sym.get());
+            kill(effects);
+        }
+        return;
+    }
+    kill(collectSideEffects(stmt));
+}
+
+// 求值的表达式。有副作用时只处理在副作用之前求值的函数实参
+void GlobalValueNumbering::visitValue(const std::shared_ptr<ExprNode>& expr, const Setter& set, const Site& site) {
+    if (!hasSideEffects(expr)) {
+        visitExpr(expr, set, site);
+        return;
+    }
+    auto call = std::dynamic_pointer_cast<FunctionCallNode>(expr);
+    if (call == nullptr) return;
+    for (const auto& arg : call->getArguments()) {
+        if (hasSideEffects(arg)) return;
+    }
+    auto args = call->getArguments();
+    for (size_t i = 0; i < args.size(); i++) {
+        visitExpr(args[i], [call, i](std::shared_ptr<ExprNode> e) {
+            auto args = call->getArguments();
+            args[i] = e;
+            call->setArguments(args);
+        }, site);
+    }
+}
+
+// 写入目标本身不是读取，只处理解引用的地址
+void GlobalValueNumbering::visitTarget(const std::shared_ptr<ExprNode>& target, const Site& site) {
+    auto x = std::dynamic_pointer_cast<UnaryExpNode>(target);
+    if (x == nullptr || x->getOp() != U_DEREF || hasSideEffects(x->getExpr())) return;
+    Setter set = [x](std::shared_ptr<ExprNode> e) { x->setExpr(e); };
+    auto y = std::dynamic_pointer_cast<LValueNode>(x->getExpr());
+    if (y != nullptr && y->isArray()) visitAddress(y, set, site);
+    else visitExpr(x->getExpr(), set, site);
+}
+
+// 先按整个表达式查找，找不到时再处理子表达式
+void GlobalValueNumbering::visitExpr(const std::shared_ptr<ExprNode>& expr, const Setter& set, const Site& site) {
+    if (expr == nullptr) return;
+    if (isCandidate(expr) && lookup(expr, tempTypeOf(expr), set, site)) return;
+    if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(expr)) {
+        visitExpr(x->getLeft(), [x](std::shared_ptr<ExprNode> e) { x->setLeft(e); }, site);
+        visitExpr(x->getRight(), [x](std::shared_ptr<ExprNode> e) { x->setRight(e); }, site);
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(expr)) {
+        Setter child = [x](std::shared_ptr<ExprNode> e) { x->setExpr(e); };
+        auto y = std::dynamic_pointer_cast<LValueNode>(x->getExpr());
+        if (x->getOp() == U_DEREF && y != nullptr && y->isArray()) {
+            visitAddress(y, child, site);
+        } else if (x->getOp() == U_ADDR && y != nullptr) {
+            // 取地址的变量必须留在原位
+            if (y->isArray() && y->getIndex() != nullptr) visitExpr(y->getIndex(), [y](std::shared_ptr<ExprNode> e) { y->setIndex(e); }, site);
+        } else {
+            visitExpr(x->getExpr(), child, site);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<LValueNode>(expr)) {
+        if (x->isArray() && x->getIndex() != nullptr) visitExpr(x->getIndex(), [x](std::shared_ptr<ExprNode> e) { x->setIndex(e); }, site);
+    }
+}
+
+// 解引用的数组元素地址，换成指针临时变量。常量下标的地址只需要一条指令
+void GlobalValueNumbering::visitAddress(const std::shared_ptr<LValueNode>& lvalue, const Setter& set, const Site& site) {
+    if (lvalue->getIndex() == nullptr) return;
+    PrimitiveType type = tempTypeOf(lvalue);
+    if (type != P_NONE && !isConstantExpr(lvalue->getIndex()) && lookup(lvalue, type, set, site)) return;
+    visitExpr(lvalue->getIndex(), [lvalue](std::shared_ptr<ExprNode> e) { lvalue->setIndex(e); }, site);
+}
+
+bool GlobalValueNumbering::isCandidate(const std::shared_ptr<ExprNode>& expr) const {
+    if (tempTypeOf(expr) == P_NONE || isConstantExpr(expr)) return false;
+    if (auto x = std::dynamic_pointer_cast<LValueNode>(expr)) {
+        return !x->isArray() && x->getSymbol()->is_global;
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(expr)) {
+        if (x->getOp() == U_DEREF) return true;
+        if (x->getOp() == U_ADDR) return false; // 子节点不能换成临时变量，整个表达式也很少重复
+    }
+    return evalCost(expr) >= 3;
+}
+
+// 找到有效的相同值时把expr换成临时变量并返回true；否则记录expr，之后可以复用它的值
+bool GlobalValueNumbering::lookup(const std::shared_ptr<ExprNode>& expr, PrimitiveType type, const Setter& set, const Site& site) {
+    for (auto& value : table) {
+        if (!value.valid || value.type != type || !exprEqual(value.key, expr)) continue;
+        if (value.temp == nullptr) materialize(value);
+        set(makeVarRef(value.temp));
+        eliminated++;
+        return true;
+    }
+    if (site.anchor == nullptr) return false;
+    Available value;
+    value.key = cloneExpr(expr);
+    value.node = expr;
+    value.replace = set;
+    value.type = type;
+    value.site = site;
+    forEachNode(expr, [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (auto x = std::dynamic_pointer_cast<LValueNode>(n)) {
+            auto sym = x->getSymbol();
+            if (x->isArray()) {
+                // 局部和全局数组的基址是常量，数组参数是一个指针变量
+                if (x->isParam()) value.reads.insert(sym.get());
+            } else {
+                value.reads.insert(sym.get());
+                if (sym->is_global || address_taken.count(sym.get())) value.reads_memory = true;
+            }
+        } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(n)) {
+            if (x->getOp() != U_DEREF) return;
+            value.reads_memory = true;
+            auto y = std::dynamic_pointer_cast<LValueNode>(x->getExpr());
+            if (y != nullptr && y->isArray() && !y->isParam()) value.arrays.insert(y->getSymbol().get());
+            else value.reads_pointer = true;
+        }
+    });
+    table.push_back(value);
+    return false;
+}
+
+// 值第二次被用到：在第一次出现的语句前面声明临时变量，第一次出现的地方改成读临时变量。
+// 第一次出现的节点可能在之前插入的另一个临时变量的初值中，新的声明要放在用到它的声明前面
+void GlobalValueNumbering::materialize(Available& value) {
+    value.temp = symbol_table.newTemp(func_name, value.type);
+    value.replace(makeVarRef(value.temp));
+    auto decl = makeTempDecl(value.temp, value.node);
+    inserted.insert(decl.get());
+    auto& stmts = value.site.frame->stmts;
+    size_t pos = std::find(stmts.begin(), stmts.end(), value.site.anchor) - stmts.begin();
+    size_t first = pos;
+    while (first > 0 && inserted.count(stmts[first - 1].get())) first--;
+    for (size_t i = first; i < pos; i++) {
+        if (mentionsSymbol(stmts[i], value.temp.get())) {
+            pos = i;
+            break;
+        }
+    }
+    stmts.insert(stmts.begin() + pos, decl);
+    if (pos <= value.site.frame->pos) value.site.frame->pos++;
+}
+
+void GlobalValueNumbering::kill(const SideEffects& effects) {
+    bool aliased_write = false; // 写入可能通过指针读到的内存
+    for (Symbol* sym : effects.written) {
+        if (sym->is_array || sym->is_global || address_taken.count(sym)) aliased_write = true;
+    }
+    for (auto& value : table) {
+        if (!value.valid) continue;
+        bool killed = (value.reads_memory && (effects.has_call || effects.has_pointer_store)) || (value.reads_pointer && aliased_write);
+        for (Symbol* sym : effects.written) {
+            if (value.reads.count(sym) || value.arrays.count(sym)) killed = true;
+        }
+        if (killed) value.valid = false;
+    }
+}
+
+std::vector<bool> GlobalValueNumbering::saveValid() const {
+    std::vector<bool> ret;
+    for (const auto& value : table) {
+        ret.push_back(value.valid);
+    }
+    return ret;
+}
+
+// 进入另一个分支时恢复分支开始处的状态，分支中新记录的值已经随块丢弃
+void GlobalValueNumbering::restoreValid(const std::vector<bool>& saved) {
+    for (size_t i = 0; i < saved.size() && i < table.size(); i++) {
+        table[i].valid = saved[i];
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "optimizer/optimizer.h"
+#include "optimizer/ast_utils.h"
+#include <functional>
+#include <set>
+
+// 全局值编号：删除支配区域内重复计算的表达式。按语句顺序遍历函数，记录每条语句求值过的表达式，
+// 同一个块中后面的语句以及嵌套在其中的 if/switch 分支、循环体都被它支配。再次遇到结构相同且仍然有效的表达式时，
+// 在第一次出现的语句前面把它算进临时变量，两处都改成读临时变量。
+// 参与编号的有算术运算、数组元素的地址、数组元素和指针的读取以及全局变量的读取。
+// 写入变量使读它的表达式失效，写数组使该数组元素的读取失效，函数调用和通过指针写内存使所有读内存的表达式失效。
+// 只处理除了最外层的赋值之外没有副作用的语句，表达式提前到语句之前求值结果不变。
+class GlobalValueNumbering : public Pass {
+public:
+    std::string name() const override { return "gvn"; }
+    void run(const std::shared_ptr<Pragram>& program) override;
+private:
+    using Setter = std::function<void(std::shared_ptr<ExprNode>)>;
+
+    // 正在处理的块，临时变量的声明插在块中的语句前面
+    struct Frame {
+        std::vector<std::shared_ptr<StatementNode>> stmts;
+        size_t pos = 0; // 当前语句的下标
+    };
+
+    // 语句中表达式所在的位置。anchor 为空时只使用已有的值而不记录新值，用于每次迭代都要求值的循环条件
+    struct Site {
+        Frame* frame;
+        std::shared_ptr<StatementNode> anchor;
+    };
+
+    // 已经求过值的表达式
+    struct Available {
+        std::shared_ptr<ExprNode> key; // 第一次出现时的拷贝，之后原节点的子表达式可能被换成临时变量
+        std::shared_ptr<ExprNode> node; // 第一次出现的节点
+        Setter replace; // 把第一次出现的节点换成别的表达式
+        PrimitiveType type;
+        Site site;
+        std::shared_ptr<Symbol> temp; // 第二次用到时才分配
+        std::set<Symbol*> reads; // 读到的标量变量和数组参数
+        std::set<Symbol*> arrays; // 读取元素的局部和全局数组
+        bool reads_memory = false; // 读取全局变量、被取地址的变量或数组元素
+        bool reads_pointer = false; // 通过指针或数组参数读取，可能与任意数组和全局变量别名
+        bool valid = true;
+    };
+
+    std::string func_name;
+    std::set<Symbol*> address_taken;
+    std::vector<Available> table;
+    std::set<StatementNode*> inserted; // 插入的临时变量声明
+    int eliminated;
+
+    void processBlock(const std::shared_ptr<BlockNode>& block);
+    std::shared_ptr<StatementNode> processBody(const std::shared_ptr<StatementNode>& stmt);
+    void processStatement(const std::shared_ptr<StatementNode>& stmt, Frame& frame);
+    void visitStatement(const std::shared_ptr<StatementNode>& stmt, const Site& site);
+    void visitValue(const std::shared_ptr<ExprNode>& expr, const Setter& set, const Site& site);
+    void visitTarget(const std::shared_ptr<ExprNode>& target, const Site& site);
+    void visitExpr(const std::shared_ptr<ExprNode>& expr, const Setter& set, const Site& site);
+    void visitAddress(const std::shared_ptr<LValueNode>& lvalue, const Setter& set, const Site& site);
+    bool isCandidate(const std::shared_ptr<ExprNode>& expr) const;
+    bool lookup(const std::shared_ptr<ExprNode>& expr, PrimitiveType type, const Setter& set, const Site& site);
+    void materialize(Available& value);
+    void kill(const SideEffects& effects);
+    std::vector<bool> saveValid() const;
+    void restoreValid(const std::vector<bool>& saved);
+};
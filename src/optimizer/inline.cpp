@@ -0,0 +1,519 @@
+#include "optimizer/inline.h"
+#include <functional>
+
+static int countNodes(const std::shared_ptr<ASTNode>& node) {
+    int n = 0;
+    forEachNode(node, [&](const std::shared_ptr<ASTNode>&, int) { n++; });
+    return n;
+}
+
+static bool containsReturn(const std::shared_ptr<StatementNode>& stmt) {
+    bool ret = false;
+    forEachNode(stmt, [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (std::dynamic_pointer_cast<ReturnStatementNode>(n)) ret = true;
+    });
+    return ret;
+}
+
+// stmt的每条执行路径是否都以return结束
+static bool endsWithReturn(const std::shared_ptr<StatementNode>& stmt) {
+    if (std::dynamic_pointer_cast<ReturnStatementNode>(stmt)) return true;
+    if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        auto stmts = x->getStatements();
+        return !stmts.empty() && endsWithReturn(stmts.back());
+    }
+    if (auto x = std::dynamic_pointer_cast<IfStatementNode>(stmt)) {
+        return x->getElseStatement() != nullptr && endsWithReturn(x->getThenStatement()) && endsWithReturn(x->getElseStatement());
+    }
+    return false;
+}
+
+static std::vector<std::shared_ptr<StatementNode>> statementsOf(const std::shared_ptr<StatementNode>& stmt) {
+    if (stmt == nullptr) return {};
+    if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) return x->getStatements();
+    return {stmt};
+}
+
+// 数组实参 &arr，传入整个数组而不是某一行
+static bool isWholeArray(const std::shared_ptr<ExprNode>& arg) {
+    auto x = std::dynamic_pointer_cast<UnaryExpNode>(arg);
+    if (x == nullptr || x->getOp() != U_ADDR) return false;
+    auto y = std::dynamic_pointer_cast<LValueNode>(x->getExpr());
+    return y != nullptr && y->isArray() && y->getIndex() == nullptr;
+}
+
+// 可以在函数体中重复求值的标量实参
+static bool isCheapScalar(const std::shared_ptr<ExprNode>& arg) {
+    auto x = stripTransform(arg);
+    if (std::dynamic_pointer_cast<ValueNode>(x)) return true;
+    auto y = std::dynamic_pointer_cast<LValueNode>(x);
+    return y != nullptr && !y->isArray();
+}
+
+// 把root中（可能包在类型转换里）的调用替换为repl
+static std::shared_ptr<ExprNode> replaceCall(const std::shared_ptr<ExprNode>& root, const std::shared_ptr<ExprNode>& call, const std::shared_ptr<ExprNode>& repl) {
+    if (root == call) return repl;
+    auto x = std::dynamic_pointer_cast<UnaryExpNode>(root);
+    x->setExpr(replaceCall(x->getExpr(), call, repl));
+    return root;
+}
+
+void FunctionInlining::run(const std::shared_ptr<Pragram>& program) {
+    if (compiler_options.inline_limit <= 0) return;
+    functions.clear();
+    recursive.clear();
+    std::map<std::string, std::set<std::string>> calls; // 调用图，不含内置的打印函数
+    for (const auto& func : program->getFunctions()) {
+        functions[func->getIdentifier()] = func;
+    }
+    long max_count = 0;
+    for (const auto& func : program->getFunctions()) {
+        auto& callees = calls[func->getIdentifier()];
+        forEachNode(func->getBody(), [&](const std::shared_ptr<ASTNode>& n, int) {
+            if (auto x = std::dynamic_pointer_cast<FunctionCallNode>(n)) {
+                if (functions.count(x->getIdentifier())) callees.insert(x->getIdentifier());
+                max_count = std::max(max_count, x->getProfileCount());
+            }
+        });
+    }
+    // 执行次数达到最多的调用点的1%算热的
+    hot_count = std::max(max_count / 100, 1L);
+    for (const auto& [name, func] : functions) {
+        std::set<std::string> visited;
+        std::vector<std::string> work(calls[name].begin(), calls[name].end());
+        while (!work.empty()) {
+            std::string f = work.back();
+            work.pop_back();
+            if (f == name) {
+                recursive.insert(name);
+                break;
+            }
+            if (!visited.insert(f).second) continue;
+            work.insert(work.end(), calls[f].begin(), calls[f].end());
+        }
+    }
+
+    // 后序遍历调用图，被调用者在调用者之前处理，展开的是已经内联过的函数体
+    std::vector<std::shared_ptr<FunctionDeclareNode>> order;
+    std::set<std::string> visited;
+    std::function<void(const std::string&)> visit = [&](const std::string& name) {
+        if (!visited.insert(name).second) return;
+        for (const auto& callee : calls[name]) {
+            visit(callee);
+        }
+        order.push_back(functions[name]);
+    };
+    for (const auto& func : program->getFunctions()) {
+        visit(func->getIdentifier());
+    }
+
+    for (const auto& func : order) {
+        func_name = func->getIdentifier();
+        address_taken = collectAddressTaken(func);
+        // 调用者最多增长到原来的两倍再加4倍阈值，避免大量调用点把函数撑得过大
+        growth = 0;
+        max_growth = countNodes(func->getBody()) + 4 * compiler_options.inline_limit;
+        processBlock(func->getBody(), 0);
+    }
+}
+
+void FunctionInlining::processBlock(const std::shared_ptr<BlockNode>& block, int depth) {
+    std::vector<std::shared_ptr<StatementNode>> stmts;
+    for (const auto& stmt : block->getStatements()) {
+        for (const auto& s : processStatement(stmt, depth)) {
+            stmts.push_back(s);
+        }
+    }
+    block->setStatements(stmts);
+}
+
+std::shared_ptr<StatementNode> FunctionInlining::processBody(const std::shared_ptr<StatementNode>& stmt, int depth) {
+    if (stmt == nullptr) return nullptr;
+    auto stmts = processStatement(stmt, depth);
+    if (stmts.size() == 1) return stmts[0];
+    auto block = std::make_shared<BlockNode>();
+    block->setStatements(stmts);
+    return block;
+}
+
+// 返回替换stmt的语句序列，展开的函数体放在原语句前面
+std::vector<std::shared_ptr<StatementNode>> FunctionInlining::processStatement(const std::shared_ptr<StatementNode>& stmt, int depth) {
+    if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        processBlock(x, depth);
+        return {stmt};
+    } else if (auto x = std::dynamic_pointer_cast<IfStatementNode>(stmt)) {
+        x->setCondition(inlineExpr(x->getCondition(), depth));
+        x->setThenStatement(processBody(x->getThenStatement(), depth));
+        x->setElseStatement(processBody(x->getElseStatement(), depth));
+        return {stmt};
+    } else if (auto x = std::dynamic_pointer_cast<SwitchStatementNode>(stmt)) {
+        x->setCondition(inlineExpr(x->getCondition(), depth));
+        for (const auto& c : x->getCases()) {
+            processBlock(c.body, depth);
+        }
+        return {stmt};
+    } else if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(stmt)) {
+        x->setCondition(inlineExpr(x->getCondition(), depth + 1));
+        x->setBody(processBody(x->getBody(), depth + 1));
+        return {stmt};
+    } else if (auto x = std::dynamic_pointer_cast<ForStatementNode>(stmt)) {
+        inlineStatementExprs(x->getPreopStatement(), depth);
+        x->setCondition(inlineExpr(x->getCondition(), depth + 1));
+        x->setBody(processBody(x->getBody(), depth + 1));
+        inlineStatementExprs(x->getPostopStatement(), depth + 1);
+        return {stmt};
+    }
+
+    std::shared_ptr<StatementNode> s = stmt;
+    if (auto x = std::dynamic_pointer_cast<ExprNode>(stmt)) {
+        s = inlineExpr(x, depth);
+        if (s != stmt && !hasSideEffects(std::dynamic_pointer_cast<ExprNode>(s))) return {}; // 结果没有用到的纯函数调用
+    } else {
+        inlineStatementExprs(stmt, depth);
+    }
+    return expandStatement(s, depth);
+}
+
+// 只替换语句中的纯函数调用，用于不能在前面插入语句的位置（for 的初始化和更新语句）
+void FunctionInlining::inlineStatementExprs(const std::shared_ptr<StatementNode>& stmt, int depth) {
+    if (stmt == nullptr) return;
+    if (auto x = std::dynamic_pointer_cast<ExprNode>(stmt)) {
+        inlineChildren(x, depth);
+    } else if (auto x = std::dynamic_pointer_cast<PrintStatementNode>(stmt)) {
+        x->setExpression(inlineExpr(x->getExpression(), depth));
+    } else if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(stmt)) {
+        for (const auto& sym : x->getSymbols()) {
+            auto init = x->getInitializer(*sym);
+            if (sym->is_array || init == nullptr) continue;
+            x->setInitializer(*sym, inlineExpr(init, depth));
+        }
+    } else if (auto x = std::dynamic_pointer_cast<ReturnStatementNode>(stmt)) {
+        if (x->getExpression() != nullptr) x->setExpression(inlineExpr(x->getExpression(), depth));
+    }
+}
+
+// 返回替换expr的表达式：函数体只有一条无副作用的 return 时，调用替换为代入实参后的返回表达式
+std::shared_ptr<ExprNode> FunctionInlining::inlineExpr(const std::shared_ptr<ExprNode>& expr, int depth) {
+    if (expr == nullptr) return nullptr;
+    inlineChildren(expr, depth);
+    auto call = std::dynamic_pointer_cast<FunctionCallNode>(expr);
+    if (call == nullptr) return expr;
+    auto callee = getCallee(call, depth);
+    auto ret = callee != nullptr ? getPureReturn(callee) : nullptr;
+    if (ret == nullptr) return expr;
+
+    // 形参可能被引用多次，只代入不需要计算的实参
+    std::map<Symbol*, std::shared_ptr<ExprNode>> subst;
+    std::vector<std::shared_ptr<Symbol>> params;
+    if (callee->getParams() != nullptr) params = callee->getParams()->getParams();
+    auto args = call->getArguments();
+    for (size_t i = 0; i < params.size(); i++) {
+        if (params[i]->is_array ? !isWholeArray(args[i]) : !isCheapScalar(args[i])) return expr;
+        subst[params[i].get()] = args[i];
+    }
+    growth += countNodes(callee->getBody());
+    opt_stats.count(name(), func_name);
+    return cloneExpr(ret, subst);
+}
+
+// 只处理子表达式，expr本身保留在原位
+void FunctionInlining::inlineChildren(const std::shared_ptr<ExprNode>& expr, int depth) {
+    if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(expr)) {
+        x->setLeft(inlineExpr(x->getLeft(), depth));
+        x->setRight(inlineExpr(x->getRight(), depth));
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(expr)) {
+        x->setExpr(inlineExpr(x->getExpr(), depth));
+    } else if (auto x = std::dynamic_pointer_cast<LValueNode>(expr)) {
+        if (x->getIndex() != nullptr) x->setIndex(inlineExpr(x->getIndex(), depth));
+    } else if (auto x = std::dynamic_pointer_cast<FunctionCallNode>(expr)) {
+        std::vector<std::shared_ptr<ExprNode>> args;
+        for (const auto& arg : x->getArguments()) {
+            args.push_back(inlineExpr(arg, depth));
+        }
+        x->setArguments(args);
+    } else if (auto x = std::dynamic_pointer_cast<AssignmentNode>(expr)) {
+        inlineChildren(x->getLvalue(), depth);
+        x->setExpr(inlineExpr(x->getExpr(), depth));
+    }
+}
+
+// 展开作为语句、赋值右边、单个变量的初值、打印或返回值的调用。
+// 语句中没有其他副作用时，嵌套在表达式里的无副作用函数也提前到语句前面展开
+std::vector<std::shared_ptr<StatementNode>> FunctionInlining::expandStatement(const std::shared_ptr<StatementNode>& stmt, int depth) {
+    std::shared_ptr<ExprNode> root; // 语句中最后求值的表达式
+    std::shared_ptr<Symbol> decl_sym;
+    if (auto x = std::dynamic_pointer_cast<AssignmentNode>(stmt)) {
+        root = x->getExpr();
+    } else if (auto x = std::dynamic_pointer_cast<ExprNode>(stmt)) {
+        root = x;
+    } else if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(stmt)) {
+        auto syms = x->getSymbols();
+        if (syms.size() != 1 || syms[0]->is_array) return {stmt};
+        decl_sym = syms[0];
+        root = x->getInitializer(*decl_sym);
+    } else if (auto x = std::dynamic_pointer_cast<PrintStatementNode>(stmt)) {
+        root = x->getExpression();
+    } else if (auto x = std::dynamic_pointer_cast<ReturnStatementNode>(stmt)) {
+        root = x->getExpression();
+    }
+    if (root == nullptr) return {stmt};
+    auto call = std::dynamic_pointer_cast<FunctionCallNode>(stripTransform(root)); // 在实参之后执行的调用
+
+    std::vector<std::shared_ptr<StatementNode>> ret;
+    if (canHoistCalls(stmt, call)) {
+        if (call != nullptr) {
+            std::vector<std::shared_ptr<ExprNode>> args;
+            for (const auto& arg : call->getArguments()) {
+                args.push_back(expandNested(arg, depth, ret));
+            }
+            call->setArguments(args);
+        } else {
+            root = expandNested(root, depth, ret);
+        }
+    }
+    std::shared_ptr<ExprNode> value;
+    if (call != nullptr && tryExpand(call, depth, ret, value)) {
+        if (stmt == call) {
+            if (value != nullptr && hasSideEffects(value)) ret.push_back(value);
+            return ret;
+        }
+        root = replaceCall(root, call, value);
+    }
+    if (ret.empty()) return {stmt};
+    if (auto x = std::dynamic_pointer_cast<AssignmentNode>(stmt)) {
+        x->setExpr(root);
+    } else if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(stmt)) {
+        x->setInitializer(*decl_sym, root);
+    } else if (auto x = std::dynamic_pointer_cast<PrintStatementNode>(stmt)) {
+        x->setExpression(root);
+    } else if (auto x = std::dynamic_pointer_cast<ReturnStatementNode>(stmt)) {
+        x->setExpression(root);
+    }
+    ret.push_back(stmt);
+    return ret;
+}
+
+// 后序展开expr中调用无副作用函数的子表达式
+std::shared_ptr<ExprNode> FunctionInlining::expandNested(const std::shared_ptr<ExprNode>& expr, int depth, std::vector<std::shared_ptr<StatementNode>>& out) {
+    if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(expr)) {
+        x->setLeft(expandNested(x->getLeft(), depth, out));
+        x->setRight(expandNested(x->getRight(), depth, out));
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(expr)) {
+        x->setExpr(expandNested(x->getExpr(), depth, out));
+    } else if (auto x = std::dynamic_pointer_cast<LValueNode>(expr)) {
+        if (x->getIndex() != nullptr) x->setIndex(expandNested(x->getIndex(), depth, out));
+    } else if (auto x = std::dynamic_pointer_cast<FunctionCallNode>(expr)) {
+        std::vector<std::shared_ptr<ExprNode>> args;
+        for (const auto& arg : x->getArguments()) {
+            args.push_back(expandNested(arg, depth, out));
+        }
+        x->setArguments(args);
+        auto it = functions.find(x->getIdentifier());
+        std::shared_ptr<ExprNode> value;
+        if (it != functions.end() && isPure(it->second) && tryExpand(x, depth, out, value)) return value;
+    }
+    return expr;
+}
+
+// 把嵌套的调用提前不会改变结果：除了最后执行的赋值和调用，语句中只有无副作用函数的调用
+bool FunctionInlining::canHoistCalls(const std::shared_ptr<StatementNode>& stmt, const std::shared_ptr<FunctionCallNode>& call) const {
+    bool ret = true;
+    forEachNode(stmt, [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (n == stmt || n == call) return;
+        if (auto x = std::dynamic_pointer_cast<FunctionCallNode>(n)) {
+            auto it = functions.find(x->getIdentifier());
+            if (it == functions.end() || !isPure(it->second)) ret = false;
+        } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(n)) {
+            UnaryOp op = x->getOp();
+            if (op == U_PREINC || op == U_PREDEC || op == U_POSTINC || op == U_POSTDEC) ret = false;
+        } else if (std::dynamic_pointer_cast<AssignmentNode>(n)) {
+            ret = false;
+        }
+    });
+    return ret;
+}
+
+// 函数只修改自己的参数和局部变量，也不调用其他函数
+bool FunctionInlining::isPure(const std::shared_ptr<FunctionDeclareNode>& func) const {
+    SideEffects effects = collectSideEffects(func->getBody());
+    if (effects.has_call || effects.has_pointer_store) return false;
+    for (Symbol* sym : effects.written) {
+        if (sym->is_global) return false;
+    }
+    return true;
+}
+
+// 满足代价模型和展开条件时把call展开到out，value为代替调用的表达式
+bool FunctionInlining::tryExpand(const std::shared_ptr<FunctionCallNode>& call, int depth, std::vector<std::shared_ptr<StatementNode>>& out, std::shared_ptr<ExprNode>& value) {
+    auto callee = getCallee(call, depth);
+    if (callee == nullptr || !canExpand(callee, call)) return false;
+    size_t first = out.size();
+    value = expandCall(call, callee, out);
+    for (size_t i = first; i < out.size(); i++) {
+        for (Symbol* sym : collectAddressTaken(out[i])) address_taken.insert(sym);
+    }
+    growth += countNodes(callee->getBody());
+    opt_stats.count(name(), func_name);
+    return true;
+}
+
+std::shared_ptr<FunctionDeclareNode> FunctionInlining::getCallee(const std::shared_ptr<FunctionCallNode>& call, int depth) const {
+    auto it = functions.find(call->getIdentifier());
+    if (it == functions.end() || it->first == func_name || recursive.count(it->first)) return nullptr;
+    // 内联省掉了调用本身和实参的传递
+    int size = countNodes(it->second->getBody());
+    int cost = size - 1 - (int)call->getArguments().size();
+    int limit = compiler_options.inline_limit << std::min(depth, 2);
+    // 有 profile 时按调用点实际执行的次数代替循环深度：没执行过的只展开不增大代码的函数，热的按最深的循环处理
+    long count = call->getProfileCount();
+    if (count == 0) limit = 0;
+    else if (count >= hot_count) limit = compiler_options.inline_limit << 2;
+    if (cost > limit || growth + size > max_growth) return nullptr;
+    return it->second;
+}
+
+std::shared_ptr<ExprNode> FunctionInlining::getPureReturn(const std::shared_ptr<FunctionDeclareNode>& callee) const {
+    auto stmts = callee->getBody()->getStatements();
+    if (stmts.size() != 1) return nullptr;
+    auto x = std::dynamic_pointer_cast<ReturnStatementNode>(stmts[0]);
+    if (x == nullptr || x->getExpression() == nullptr || hasSideEffects(x->getExpression())) return nullptr;
+    return x->getExpression();
+}
+
+bool FunctionInlining::canExpand(const std::shared_ptr<FunctionDeclareNode>& callee, const std::shared_ptr<FunctionCallNode>& call) const {
+    bool ret = true;
+    forEachNode(callee->getBody(), [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(n)) {
+            if (x->isArray()) ret = false; // 局部数组需要栈上的整块空间和初始化
+        }
+    });
+    std::vector<std::shared_ptr<Symbol>> params;
+    if (callee->getParams() != nullptr) params = callee->getParams()->getParams();
+    auto args = call->getArguments();
+    for (size_t i = 0; i < params.size(); i++) {
+        if (params[i]->is_array && !isWholeArray(args[i])) ret = false;
+    }
+    return ret && canLowerReturns(callee->getBody()->getStatements());
+}
+
+// 循环中的 return 无法改写；if 中的 return 要求该分支以 return 结束，后面的语句并入另一个分支
+bool FunctionInlining::canLowerReturns(std::vector<std::shared_ptr<StatementNode>> stmts) const {
+    for (size_t k = 0; k < stmts.size(); k++) {
+        auto s = stmts[k];
+        if (std::dynamic_pointer_cast<ReturnStatementNode>(s)) return true;
+        if (!containsReturn(s)) continue;
+        std::vector<std::shared_ptr<StatementNode>> rest(stmts.begin() + k + 1, stmts.end());
+        if (auto x = std::dynamic_pointer_cast<BlockNode>(s)) {
+            auto inner = x->getStatements();
+            inner.insert(inner.end(), rest.begin(), rest.end());
+            return canLowerReturns(inner);
+        }
+        auto x = std::dynamic_pointer_cast<IfStatementNode>(s);
+        if (x == nullptr) return false;
+        auto then_stmts = statementsOf(x->getThenStatement());
+        auto else_stmts = statementsOf(x->getElseStatement());
+        if (endsWithReturn(x->getThenStatement())) else_stmts.insert(else_stmts.end(), rest.begin(), rest.end());
+        else if (x->getElseStatement() != nullptr && endsWithReturn(x->getElseStatement())) then_stmts.insert(then_stmts.end(), rest.begin(), rest.end());
+        else return false;
+        return canLowerReturns(then_stmts) && canLowerReturns(else_stmts);
+    }
+    return true;
+}
+
+// 拷贝stmts到out，return expr 改为给result赋值，return 之后的语句不会执行
+void FunctionInlining::lowerReturns(std::vector<std::shared_ptr<StatementNode>> stmts, const std::map<Symbol*, std::shared_ptr<ExprNode>>& subst,
+    std::map<std::string, std::string>& labels, const std::shared_ptr<Symbol>& result, std::vector<std::shared_ptr<StatementNode>>& out) const {
+    for (size_t k = 0; k < stmts.size(); k++) {
+        auto s = stmts[k];
+        if (auto x = std::dynamic_pointer_cast<ReturnStatementNode>(s)) {
+            if (result != nullptr) out.push_back(std::make_shared<AssignmentNode>(makeVarRef(result), cloneExpr(x->getExpression(), subst)));
+            return;
+        }
+        if (!containsReturn(s)) {
+            out.push_back(cloneStatement(s, subst, labels));
+            continue;
+        }
+        std::vector<std::shared_ptr<StatementNode>> rest(stmts.begin() + k + 1, stmts.end());
+        if (auto x = std::dynamic_pointer_cast<BlockNode>(s)) {
+            auto inner = x->getStatements();
+            inner.insert(inner.end(), rest.begin(), rest.end());
+            lowerReturns(inner, subst, labels, result, out);
+            return;
+        }
+        auto x = std::dynamic_pointer_cast<IfStatementNode>(s);
+        auto then_stmts = statementsOf(x->getThenStatement());
+        auto else_stmts = statementsOf(x->getElseStatement());
+        if (endsWithReturn(x->getThenStatement())) else_stmts.insert(else_stmts.end(), rest.begin(), rest.end());
+        else then_stmts.insert(then_stmts.end(), rest.begin(), rest.end());
+        std::vector<std::shared_ptr<StatementNode>> then_out, else_out;
+        lowerReturns(then_stmts, subst, labels, result, then_out);
+        lowerReturns(else_stmts, subst, labels, result, else_out);
+        auto then_block = std::make_shared<BlockNode>();
+        then_block->setStatements(then_out);
+        auto else_block = std::make_shared<BlockNode>();
+        else_block->setStatements(else_out);
+        out.push_back(std::make_shared<IfStatementNode>(cloneExpr(x->getCondition(), subst), then_block, else_block));
+        return;
+    }
+}
+
+// 把callee的函数体展开到out，返回代替调用的表达式（void函数为nullptr）
+std::shared_ptr<ExprNode> FunctionInlining::expandCall(const std::shared_ptr<FunctionCallNode>& call, const std::shared_ptr<FunctionDeclareNode>& callee,
+    std::vector<std::shared_ptr<StatementNode>>& out) {
+    auto body = callee->getBody();
+    SideEffects effects = collectSideEffects(body);
+    std::set<Symbol*> callee_address_taken = collectAddressTaken(body);
+    std::map<Symbol*, std::shared_ptr<ExprNode>> subst;
+
+    std::vector<std::shared_ptr<Symbol>> params;
+    if (callee->getParams() != nullptr) params = callee->getParams()->getParams();
+    auto args = call->getArguments();
+    bool args_pure = true; // 实参求值时不会修改调用者的变量
+    for (const auto& arg : args) {
+        if (hasSideEffects(arg)) args_pure = false;
+    }
+    for (size_t i = 0; i < params.size(); i++) {
+        Symbol* param = params[i].get();
+        if (param->is_array) {
+            subst[param] = args[i];
+            continue;
+        }
+        // 函数体只读的形参直接代入常量或调用者的局部变量（后者只有通过赋值才会改变，而函数体中看不到它）
+        bool read_only = !effects.written.count(param) && !callee_address_taken.count(param);
+        auto lvalue = std::dynamic_pointer_cast<LValueNode>(args[i]);
+        bool local = args_pure && lvalue != nullptr && !lvalue->isArray() && !lvalue->getSymbol()->is_global && !address_taken.count(lvalue->getSymbol().get());
+        if (read_only && (std::dynamic_pointer_cast<ValueNode>(args[i]) || local)) {
+            subst[param] = args[i];
+            continue;
+        }
+        auto temp = symbol_table.newTemp(func_name, param->type);
+        out.push_back(makeTempDecl(temp, args[i]));
+        subst[param] = makeVarRef(temp);
+    }
+    forEachNode(body, [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(n)) {
+            for (const auto& sym : x->getSymbols()) {
+                subst[sym.get()] = makeVarRef(symbol_table.newTemp(func_name, sym->type));
+            }
+        }
+    });
+
+    std::map<std::string, std::string> labels;
+    auto stmts = body->getStatements();
+    int returns = 0;
+    forEachNode(body, [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (std::dynamic_pointer_cast<ReturnStatementNode>(n)) returns++;
+    });
+    auto last = stmts.empty() ? nullptr : std::dynamic_pointer_cast<ReturnStatementNode>(stmts.back());
+    if (returns == 0 || (returns == 1 && last != nullptr)) {
+        // 唯一的 return 在末尾，返回表达式直接放到调用处
+        for (const auto& s : stmts) {
+            if (s != last) out.push_back(cloneStatement(s, subst, labels));
+        }
+        return last != nullptr ? cloneExpr(last->getExpression(), subst) : nullptr;
+    }
+    std::shared_ptr<Symbol> result;
+    if (callee->getReturnType() != P_VOID) result = symbol_table.newTemp(func_name, callee->getReturnType());
+    lowerReturns(stmts, subst, labels, result, out);
+    return result != nullptr ? makeVarRef(result) : nullptr;
+}
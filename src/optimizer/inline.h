@@ -0,0 +1,47 @@
+#pragma once
+#include "optimizer/optimizer.h"
+#include "optimizer/ast_utils.h"
+#include <set>
+
+// 函数内联：把小函数的函数体直接展开到调用处，省去保存现场、传参、建立栈帧和参数落栈的开销。
+// 函数体只有 return expr 且没有副作用时，调用直接替换为实参代入后的表达式，可以出现在任何表达式中；
+// 否则展开作为语句、赋值右边、声明初值、打印或返回值的调用，语句中没有其他副作用时也展开嵌套在表达式里的无副作用函数：
+// 实参存入新的临时变量，局部变量重命名，提前返回改写成 if/else，返回值存入临时变量。
+// 代价是函数体的节点数减去省掉的调用和实参，不超过 -finline-limit 时内联，调用每在一层循环中阈值翻倍（最多4倍）。
+// 有 profile 时改按调用点的执行次数：从没执行过的阈值为0，热的调用点取4倍。
+// 按调用图自底向上处理，被调用者先完成内联；递归调用链上的函数不内联。
+class FunctionInlining : public Pass {
+public:
+    std::string name() const override { return "inline"; }
+    void run(const std::shared_ptr<Pragram>& program) override;
+private:
+    std::map<std::string, std::shared_ptr<FunctionDeclareNode>> functions;
+    std::set<std::string> recursive; // 能经过调用链回到自身的函数
+
+    std::string func_name;
+    std::set<Symbol*> address_taken;
+    int growth; // 当前函数因内联增加的节点数
+    int max_growth;
+    long hot_count; // 执行次数不少于它的调用点是热的
+
+    void processBlock(const std::shared_ptr<BlockNode>& block, int depth);
+    std::vector<std::shared_ptr<StatementNode>> processStatement(const std::shared_ptr<StatementNode>& stmt, int depth);
+    std::shared_ptr<StatementNode> processBody(const std::shared_ptr<StatementNode>& stmt, int depth);
+    void inlineStatementExprs(const std::shared_ptr<StatementNode>& stmt, int depth);
+    std::shared_ptr<ExprNode> inlineExpr(const std::shared_ptr<ExprNode>& expr, int depth);
+    void inlineChildren(const std::shared_ptr<ExprNode>& expr, int depth);
+    std::vector<std::shared_ptr<StatementNode>> expandStatement(const std::shared_ptr<StatementNode>& stmt, int depth);
+    std::shared_ptr<ExprNode> expandNested(const std::shared_ptr<ExprNode>& expr, int depth, std::vector<std::shared_ptr<StatementNode>>& out);
+    bool canHoistCalls(const std::shared_ptr<StatementNode>& stmt, const std::shared_ptr<FunctionCallNode>& call) const;
+    bool isPure(const std::shared_ptr<FunctionDeclareNode>& func) const;
+    bool tryExpand(const std::shared_ptr<FunctionCallNode>& call, int depth, std::vector<std::shared_ptr<StatementNode>>& out, std::shared_ptr<ExprNode>& value);
+
+    std::shared_ptr<FunctionDeclareNode> getCallee(const std::shared_ptr<FunctionCallNode>& call, int depth) const;
+    std::shared_ptr<ExprNode> getPureReturn(const std::shared_ptr<FunctionDeclareNode>& callee) const;
+    bool canExpand(const std::shared_ptr<FunctionDeclareNode>& callee, const std::shared_ptr<FunctionCallNode>& call) const;
+    bool canLowerReturns(std::vector<std::shared_ptr<StatementNode>> stmts) const;
+    void lowerReturns(std::vector<std::shared_ptr<StatementNode>> stmts, const std::map<Symbol*, std::shared_ptr<ExprNode>>& subst,
+        std::map<std::string, std::string>& labels, const std::shared_ptr<Symbol>& result, std::vector<std::shared_ptr<StatementNode>>& out) const;
+    std::shared_ptr<ExprNode> expandCall(const std::shared_ptr<FunctionCallNode>& call, const std::shared_ptr<FunctionDeclareNode>& callee,
+        std::vector<std::shared_ptr<StatementNode>>& out);
+};
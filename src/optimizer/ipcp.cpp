@@ -0,0 +1,410 @@
+#include "optimizer/ipcp.h"
+#include <cmath>
+#include <cstring>
+
+// 每个函数最多特化的份数
+static const int MAX_CLONES = 4;
+
+static int countNodes(const std::shared_ptr<ASTNode>& node) {
+    int n = 0;
+    forEachNode(node, [&](const std::shared_ptr<ASTNode>&, int) { n++; });
+    return n;
+}
+
+// 能换成常量的标量类型。char 的运算结果在寄存器中的宽度不固定，不参与
+static bool isBindable(const std::shared_ptr<Symbol>& sym) {
+    return !sym->is_array && (sym->type == P_INT || sym->type == P_LONG || sym->type == P_FLOAT);
+}
+
+static bool sameValue(const Value& a, const Value& b) {
+    if (a.type != b.type) return false;
+    if (a.type == P_LONG) return a.lvalue == b.lvalue;
+    if (a.type == P_FLOAT) return std::memcmp(&a.fvalue, &b.fvalue, sizeof(double)) == 0;
+    return a.ivalue == b.ivalue;
+}
+
+// 调用点分组用的键：形参位置和常量的类型、位模式
+static std::string valueKey(int pos, const Value& value) {
+    long bits = value.type == P_LONG ? value.lvalue : value.ivalue;
+    if (value.type == P_FLOAT) std::memcpy(&bits, &value.fvalue, sizeof(double));
+    return std::to_string(pos) + ":" + std::to_string(value.type) + ":" + std::to_string(bits) + ";";
+}
+
+// sym在body中决定控制流或用作乘除、移位的操作数，换成常量后条件、循环次数或运算可以化简
+static bool hasFoldableUse(const std::shared_ptr<BlockNode>& body, const Symbol* sym) {
+    bool ret = false;
+    forEachNode(body, [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (auto x = std::dynamic_pointer_cast<IfStatementNode>(n)) {
+            if (mentionsSymbol(x->getCondition(), sym)) ret = true;
+        } else if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(n)) {
+            if (mentionsSymbol(x->getCondition(), sym)) ret = true;
+        } else if (auto x = std::dynamic_pointer_cast<ForStatementNode>(n)) {
+            if (mentionsSymbol(x->getCondition(), sym) || mentionsSymbol(x->getPreopStatement(), sym)
+                || mentionsSymbol(x->getPostopStatement(), sym)) ret = true;
+        } else if (auto x = std::dynamic_pointer_cast<SwitchStatementNode>(n)) {
+            if (mentionsSymbol(x->getCondition(), sym)) ret = true;
+        } else if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(n)) {
+            ExprType op = x->getOp();
+            if ((op == A_MULTIPLY || op == A_DIVIDE || op == A_MOD || op == A_LSHIFT || op == A_RSHIFT)
+                && (isScalarOf(stripTransform(x->getLeft()), sym) || isScalarOf(stripTransform(x->getRight()), sym))) ret = true;
+        }
+    });
+    return ret;
+}
+
+void InterproceduralConstantPropagation::run(const std::shared_ptr<Pragram>& program) {
+    this->program = program;
+    functions.clear();
+    for (const auto& func : program->getFunctions()) {
+        functions[func->getIdentifier()] = func;
+    }
+    propagateGlobals();
+    buildCallGraph();
+    // 特化产生的拷贝加在函数列表末尾，不再处理
+    auto funcs = program->getFunctions();
+    for (const auto& func : funcs) {
+        propagateArguments(func);
+    }
+    if (compiler_options.specialize_limit <= 0) return;
+    for (const auto& func : funcs) {
+        specialize(func);
+    }
+}
+
+void InterproceduralConstantPropagation::buildCallGraph() {
+    call_sites.clear();
+    long max_count = 0;
+    for (const auto& func : program->getFunctions()) {
+        std::string caller = func->getIdentifier();
+        forEachNode(func->getBody(), [&](const std::shared_ptr<ASTNode>& n, int loop_depth) {
+            auto x = std::dynamic_pointer_cast<FunctionCallNode>(n);
+            if (x == nullptr || !functions.count(x->getIdentifier())) return;
+            call_sites[x->getIdentifier()].push_back(CallSite{x, caller, loop_depth});
+            max_count = std::max(max_count, x->getProfileCount());
+        });
+    }
+    // 和内联相同，执行次数达到最多的调用点的1%算热的
+    hot_count = std::max(max_count / 100, 1L);
+}
+
+// 初值在数据段中、没有任何函数写过也没有被取地址的全局标量，整个程序中都是这个值
+void InterproceduralConstantPropagation::propagateGlobals() {
+    global_values.clear();
+    for (const auto& decl : program->getGlobalVariables()) {
+        for (const auto& sym : decl->getSymbols()) {
+            if (!isBindable(sym)) continue;
+            auto init = decl->getInitializer(*sym);
+            Value value;
+            if (init == nullptr) {
+                convertConstant(Value{.type = P_INT, .ivalue = 0}, sym->type, value);
+            } else if (!getStaticInitializer(*sym, init, value)) {
+                continue;
+            }
+            if (value.type == P_FLOAT && value.fvalue == 0 && std::signbit(value.fvalue)) continue;
+            global_values[sym.get()] = value;
+        }
+    }
+    // 取了地址的全局变量越界后可能指向相邻的全局变量，程序还通过指针写内存时不再认为任何全局变量只读
+    bool escaped = false, pointer_store = false;
+    for (const auto& func : program->getFunctions()) {
+        auto effects = collectSideEffects(func->getBody());
+        for (const auto& sym : effects.written) {
+            global_values.erase(sym);
+        }
+        for (const auto& sym : collectAddressTaken(func)) {
+            if (sym->is_global) escaped = true;
+            global_values.erase(sym);
+        }
+        if (effects.has_pointer_store) pointer_store = true;
+    }
+    if (escaped && pointer_store) global_values.clear();
+    if (global_values.empty()) return;
+    for (const auto& func : program->getFunctions()) {
+        replaced = 0;
+        replaceStatement(func->getBody());
+        if (replaced > 0) opt_stats.count(name(), func->getIdentifier(), replaced);
+    }
+}
+
+// 所有调用点都传入同一个常量的形参改为局部变量。递归调用原样传回没有被修改的形参时，值和外层调用相同
+void InterproceduralConstantPropagation::propagateArguments(const std::shared_ptr<FunctionDeclareNode>& func) {
+    std::string func_name = func->getIdentifier();
+    const auto& sites = call_sites[func_name];
+    if (!canBind(func) || sites.empty()) return;
+    auto params = func->getParams()->getParams();
+    auto effects = collectSideEffects(func->getBody());
+    auto address_taken = collectAddressTaken(func);
+    std::map<int, Value> consts;
+    for (size_t i = 0; i < params.size(); i++) {
+        bool pass_through = !effects.written.count(params[i].get()) && !address_taken.count(params[i].get());
+        bool found = false, same = isBindable(params[i]);
+        Value common;
+        for (const auto& site : sites) {
+            if (!same) break;
+            auto arg = site.call->getArguments()[i];
+            Value value;
+            if (site.caller == func_name && pass_through && isScalarOf(stripTransform(arg), params[i].get())) continue;
+            if (!constantArgument(arg, params[i], value)) same = false;
+            else if (!found) common = value, found = true;
+            else same = sameValue(common, value);
+        }
+        if (same && found) consts[i] = common;
+    }
+    if (consts.empty()) return;
+    bindParams(func, consts);
+    for (const auto& site : sites) {
+        dropArguments(site.call, consts);
+    }
+    opt_stats.count(name(), func_name, consts.size());
+}
+
+// 按用到的形参上传入的常量给其他函数中的调用点分组，热的一组调用同一份特化的拷贝
+void InterproceduralConstantPropagation::specialize(const std::shared_ptr<FunctionDeclareNode>& func) {
+    std::string func_name = func->getIdentifier();
+    if (!canBind(func) || countNodes(func->getBody()) > compiler_options.specialize_limit) return;
+    bool has_array = false;
+    forEachNode(func->getBody(), [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(n)) {
+            for (const auto& sym : x->getSymbols()) {
+                if (sym->is_array) has_array = true;
+            }
+        }
+    });
+    if (has_array) return;
+
+    auto params = func->getParams()->getParams();
+    auto address_taken = collectAddressTaken(func);
+    std::vector<bool> useful(params.size());
+    for (size_t i = 0; i < params.size(); i++) {
+        useful[i] = isBindable(params[i]) && !address_taken.count(params[i].get()) && hasFoldableUse(func->getBody(), params[i].get());
+    }
+
+    std::map<std::string, std::pair<std::map<int, Value>, std::vector<CallSite>>> groups;
+    for (const auto& site : call_sites[func_name]) {
+        if (site.caller == func_name) continue;
+        auto args = site.call->getArguments();
+        std::map<int, Value> consts;
+        std::string key;
+        for (size_t i = 0; i < params.size(); i++) {
+            Value value;
+            if (!useful[i] || !constantArgument(args[i], params[i], value)) continue;
+            consts[i] = value;
+            key += valueKey(i, value);
+        }
+        if (consts.empty()) continue;
+        groups[key].first = consts;
+        groups[key].second.push_back(site);
+    }
+
+    int clones = 0;
+    for (const auto& [key, group] : groups) {
+        const auto& [consts, sites] = group;
+        bool profiled = false, hot = false;
+        long count = 0;
+        for (const auto& site : sites) {
+            long n = site.call->getProfileCount();
+            if (n >= 0) profiled = true, count += n;
+            if (n >= hot_count) hot = true;
+        }
+        if (!profiled) {
+            hot = sites.size() >= 2;
+            for (const auto& site : sites) {
+                if (site.loop_depth > 0) hot = true;
+            }
+        }
+        if (!hot || clones == MAX_CLONES) continue;
+        auto clone = cloneFunction(func, consts, func_name + ".constprop." + std::to_string(clones));
+        clone->setProfileCount(profiled ? count : -1);
+        for (const auto& site : sites) {
+            site.call->setIdentifier(clone->getIdentifier());
+            dropArguments(site.call, consts);
+        }
+        clones++;
+        opt_stats.count("specialize", func_name);
+    }
+}
+
+// 去掉形参后其余参数的位置会变化，栈上传入的参数的偏移在语义分析时已经确定，不能去掉
+bool InterproceduralConstantPropagation::canBind(const std::shared_ptr<FunctionDeclareNode>& func) const {
+    if (func->getIdentifier() == "main" || func->getParams() == nullptr) return false;
+    return !symbol_table.getFunction(func->getIdentifier()).hasStackParams();
+}
+
+// 实参是常量时value是转换成形参类型后的值，-0.0 和 0.0 共用数据段中的标号，不作为常量
+bool InterproceduralConstantPropagation::constantArgument(const std::shared_ptr<ExprNode>& arg, const std::shared_ptr<Symbol>& param, Value& value) const {
+    Value v;
+    if (!isBindable(param) || !evalConstant(arg, v) || !convertConstant(v, param->type, value)) return false;
+    return !(value.type == P_FLOAT && value.fvalue == 0 && std::signbit(value.fvalue));
+}
+
+// 形参原来的栈位置留给同名的局部变量，函数入口用常量初始化
+void InterproceduralConstantPropagation::bindParams(const std::shared_ptr<FunctionDeclareNode>& func, const std::map<int, Value>& consts) {
+    auto params = func->getParams()->getParams();
+    auto rest = std::make_shared<FunctionParamNode>();
+    std::vector<std::shared_ptr<StatementNode>> stmts;
+    for (size_t i = 0; i < params.size(); i++) {
+        auto it = consts.find(i);
+        if (it == consts.end()) {
+            rest->addParam(params[i]);
+            continue;
+        }
+        params[i]->is_param = false;
+        stmts.push_back(makeTempDecl(params[i], makeConstant(it->second)));
+    }
+    auto body = func->getBody();
+    for (const auto& s : body->getStatements()) {
+        stmts.push_back(s);
+    }
+    body->setStatements(stmts);
+    func->setParams(rest);
+    Function& function = symbol_table.getFunctionRef(func->getIdentifier());
+    function.params = rest->getParams();
+    forEachNode(body, [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (auto x = std::dynamic_pointer_cast<ReturnStatementNode>(n)) x->setFunction(function);
+    });
+}
+
+// 拷贝函数体，形参和局部变量都换成新的符号，栈上位置不变。拷贝中常量相同或原样传回形参的递归调用改为调用拷贝
+std::shared_ptr<FunctionDeclareNode> InterproceduralConstantPropagation::cloneFunction(const std::shared_ptr<FunctionDeclareNode>& func,
+    const std::map<int, Value>& consts, const std::string& clone_name) {
+    auto params = func->getParams()->getParams();
+    std::map<Symbol*, std::shared_ptr<ExprNode>> subst;
+    std::vector<std::shared_ptr<Symbol>> copies;
+    std::vector<std::shared_ptr<StatementNode>> stmts;
+    auto rest = std::make_shared<FunctionParamNode>();
+    for (size_t i = 0; i < params.size(); i++) {
+        auto sym = std::make_shared<Symbol>(*params[i]);
+        copies.push_back(sym);
+        if (params[i]->is_array) {
+            subst[params[i].get()] = std::make_shared<UnaryExpNode>(U_ADDR, makeVarRef(sym), sym->type);
+        } else {
+            subst[params[i].get()] = makeVarRef(sym);
+        }
+        auto it = consts.find(i);
+        if (it == consts.end()) {
+            rest->addParam(sym);
+            continue;
+        }
+        sym->is_param = false;
+        stmts.push_back(makeTempDecl(sym, makeConstant(it->second)));
+    }
+    forEachNode(func->getBody(), [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(n)) {
+            for (const auto& sym : x->getSymbols()) {
+                if (!subst.count(sym.get())) subst[sym.get()] = makeVarRef(std::make_shared<Symbol>(*sym));
+            }
+        }
+    });
+    std::map<std::string, std::string> labels;
+    auto body = std::static_pointer_cast<BlockNode>(cloneStatement(func->getBody(), subst, labels));
+    for (const auto& s : body->getStatements()) {
+        stmts.push_back(s);
+    }
+    body->setStatements(stmts);
+
+    Function function = symbol_table.getFunction(func->getIdentifier());
+    function.name = clone_name;
+    function.params = rest->getParams();
+    function.saved_regs.clear();
+    symbol_table.functions.push_back(function);
+
+    auto effects = collectSideEffects(func->getBody());
+    auto address_taken = collectAddressTaken(func);
+    forEachNode(body, [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (auto x = std::dynamic_pointer_cast<ReturnStatementNode>(n)) {
+            x->setFunction(function);
+            return;
+        }
+        auto x = std::dynamic_pointer_cast<FunctionCallNode>(n);
+        if (x == nullptr || x->getIdentifier() != func->getIdentifier()) return;
+        auto args = x->getArguments();
+        for (const auto& [i, value] : consts) {
+            Value v;
+            if (constantArgument(args[i], copies[i], v) && sameValue(v, value)) continue;
+            if (isScalarOf(stripTransform(args[i]), copies[i].get()) && !effects.written.count(params[i].get())
+                && !address_taken.count(params[i].get())) continue;
+            return;
+        }
+        x->setIdentifier(clone_name);
+        dropArguments(x, consts);
+    });
+
+    auto clone = std::make_shared<FunctionDeclareNode>(clone_name, func->getReturnType(), body, rest);
+    program->addFunction(clone);
+    return clone;
+}
+
+void InterproceduralConstantPropagation::dropArguments(const std::shared_ptr<FunctionCallNode>& call, const std::map<int, Value>& consts) {
+    std::vector<std::shared_ptr<ExprNode>> args;
+    auto old_args = call->getArguments();
+    for (size_t i = 0; i < old_args.size(); i++) {
+        if (!consts.count(i)) args.push_back(old_args[i]);
+    }
+    call->setArguments(args);
+    call->updateParamCount();
+}
+
+// 把只读全局标量的读取换成常量。被写的变量不在 global_values 中，赋值左边只需要处理其中的下标
+std::shared_ptr<ExprNode> InterproceduralConstantPropagation::replaceExpr(const std::shared_ptr<ExprNode>& expr) {
+    if (expr == nullptr) return nullptr;
+    if (auto x = std::dynamic_pointer_cast<LValueNode>(expr)) {
+        auto it = global_values.find(x->getSymbol().get());
+        if (it != global_values.end() && !x->isArray()) {
+            replaced++;
+            return makeConstant(it->second);
+        }
+        if (x->getIndex() != nullptr) x->setIndex(replaceExpr(x->getIndex()));
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(expr)) {
+        x->setExpr(replaceExpr(x->getExpr()));
+    } else if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(expr)) {
+        x->setLeft(replaceExpr(x->getLeft()));
+        x->setRight(replaceExpr(x->getRight()));
+    } else if (auto x = std::dynamic_pointer_cast<AssignmentNode>(expr)) {
+        replaceExpr(x->getLvalue());
+        x->setExpr(replaceExpr(x->getExpr()));
+    } else if (auto x = std::dynamic_pointer_cast<FunctionCallNode>(expr)) {
+        std::vector<std::shared_ptr<ExprNode>> args;
+        for (const auto& arg : x->getArguments()) {
+            args.push_back(replaceExpr(arg));
+        }
+        x->setArguments(args);
+    }
+    return expr;
+}
+
+void InterproceduralConstantPropagation::replaceStatement(const std::shared_ptr<StatementNode>& stmt) {
+    if (stmt == nullptr) return;
+    if (auto x = std::dynamic_pointer_cast<ExprNode>(stmt)) {
+        replaceExpr(x);
+    } else if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        for (const auto& s : x->getStatements()) {
+            replaceStatement(s);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<PrintStatementNode>(stmt)) {
+        x->setExpression(replaceExpr(x->getExpression()));
+    } else if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(stmt)) {
+        for (const auto& sym : x->getSymbols()) {
+            auto init = x->getInitializer(*sym);
+            if (!sym->is_array && init != nullptr) x->setInitializer(*sym, replaceExpr(init));
+        }
+    } else if (auto x = std::dynamic_pointer_cast<IfStatementNode>(stmt)) {
+        x->setCondition(replaceExpr(x->getCondition()));
+        replaceStatement(x->getThenStatement());
+        replaceStatement(x->getElseStatement());
+    } else if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(stmt)) {
+        x->setCondition(replaceExpr(x->getCondition()));
+        replaceStatement(x->getBody());
+    } else if (auto x = std::dynamic_pointer_cast<ForStatementNode>(stmt)) {
+        replaceStatement(x->getPreopStatement());
+        if (x->getCondition() != nullptr) x->setCondition(replaceExpr(x->getCondition()));
+        replaceStatement(x->getBody());
+        replaceStatement(x->getPostopStatement());
+    } else if (auto x = std::dynamic_pointer_cast<SwitchStatementNode>(stmt)) {
+        x->setCondition(replaceExpr(x->getCondition()));
+        for (const auto& c : x->getCases()) {
+            replaceStatement(c.body);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<ReturnStatementNode>(stmt)) {
+        if (x->getExpression() != nullptr) x->setExpression(replaceExpr(x->getExpression()));
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "optimizer/optimizer.h"
+#include "optimizer/ast_utils.h"
+#include <set>
+#include <map>
+
+// 过程间常量传播：由调用图找出每个函数的全部调用点。
+// 没有任何函数写过、也没有被取地址的全局标量，把读取替换成它在数据段中的初值。
+// 所有调用点（递归调用原样传回形参的除外）都传入同一个常量的形参，从函数和调用点中去掉，改为用这个常量初始化的局部变量。
+// 函数特化：常量形参用在条件、循环控制或乘除移位中时，热的调用点改为调用一份把这些形参换成常量的函数拷贝，
+// 拷贝中参数相同的递归调用也调用拷贝本身。拷贝的函数体不超过 -fspecialize-limit 个结点，每个函数最多特化4份。
+// 没有 profile 时循环中的调用点、或者至少两个调用点传入相同的常量时算热的。
+// 常量只是作为局部变量的初值出现，由后面的常量传播代入并折叠。
+class InterproceduralConstantPropagation : public Pass {
+public:
+    std::string name() const override { return "ipcp"; }
+    void run(const std::shared_ptr<Pragram>& program) override;
+private:
+    struct CallSite {
+        std::shared_ptr<FunctionCallNode> call;
+        std::string caller;
+        int loop_depth;
+    };
+
+    std::shared_ptr<Pragram> program;
+    std::map<std::string, std::shared_ptr<FunctionDeclareNode>> functions;
+    std::map<std::string, std::vector<CallSite>> call_sites; // 调用图：每个函数被调用的位置，不含内置的打印函数
+    long hot_count; // 执行次数不少于它的调用点是热的
+    std::map<Symbol*, Value> global_values; // 只读的全局标量的值
+    int replaced;
+
+    void buildCallGraph();
+    void propagateGlobals();
+    void propagateArguments(const std::shared_ptr<FunctionDeclareNode>& func);
+    void specialize(const std::shared_ptr<FunctionDeclareNode>& func);
+
+    bool canBind(const std::shared_ptr<FunctionDeclareNode>& func) const;
+    bool constantArgument(const std::shared_ptr<ExprNode>& arg, const std::shared_ptr<Symbol>& param, Value& value) const;
+    void bindParams(const std::shared_ptr<FunctionDeclareNode>& func, const std::map<int, Value>& consts);
+    std::shared_ptr<FunctionDeclareNode> cloneFunction(const std::shared_ptr<FunctionDeclareNode>& func, const std::map<int, Value>& consts, const std::string& clone_name);
+    static void dropArguments(const std::shared_ptr<FunctionCallNode>& call, const std::map<int, Value>& consts);
+
+    std::shared_ptr<ExprNode> replaceExpr(const std::shared_ptr<ExprNode>& expr);
+    void replaceStatement(const std::shared_ptr<StatementNode>& stmt);
+};
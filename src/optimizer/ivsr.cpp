@@ -0,0 +1,524 @@
+#include "optimizer/ivsr.h"
+
+static bool isComparison(ExprType op) {
+    return op == A_LT || op == A_LE || op == A_GT || op == A_GE || op == A_EQ || op == A_NE;
+}
+
+// 两边同乘负数后比较方向相反
+static ExprType flipComparison(ExprType op) {
+    switch (op) {
+        case A_LT: return A_GT;
+        case A_LE: return A_GE;
+        case A_GT: return A_LT;
+        case A_GE: return A_LE;
+        default: return op;
+    }
+}
+
+void InductionVariableStrengthReduction::run(const std::shared_ptr<Pragram>& program) {
+    for (const auto& func : program->getFunctions()) {
+        func_name = func->getIdentifier();
+        address_taken = collectAddressTaken(func);
+        std::vector<Frame> frames;
+        processBlock(func->getBody(), nullptr, frames);
+    }
+}
+
+void InductionVariableStrengthReduction::processBlock(const std::shared_ptr<BlockNode>& block, const std::shared_ptr<StatementNode>& owner, std::vector<Frame>& frames) {
+    std::vector<std::shared_ptr<StatementNode>> stmts;
+    auto old_stmts = block->getStatements();
+    for (size_t i = 0; i < old_stmts.size(); i++) {
+        frames.push_back({block, i, owner});
+        for (const auto& s : processStatement(old_stmts[i], frames)) {
+            stmts.push_back(s);
+        }
+        frames.pop_back();
+    }
+    block->setStatements(stmts);
+}
+
+std::shared_ptr<StatementNode> InductionVariableStrengthReduction::processBody(const std::shared_ptr<StatementNode>& stmt, const std::shared_ptr<StatementNode>& owner, std::vector<Frame>& frames) {
+    if (stmt == nullptr) return nullptr;
+    if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        processBlock(x, owner, frames);
+        return stmt;
+    }
+    frames.push_back({nullptr, 0, owner});
+    auto stmts = processStatement(stmt, frames);
+    frames.pop_back();
+    if (stmts.size() == 1) return stmts[0];
+    auto block = std::make_shared<BlockNode>();
+    block->setStatements(stmts);
+    return block;
+}
+
+std::vector<std::shared_ptr<StatementNode>> InductionVariableStrengthReduction::processStatement(const std::shared_ptr<StatementNode>& stmt, std::vector<Frame>& frames) {
+    if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        processBlock(x, stmt, frames);
+        return {stmt};
+    } else if (auto x = std::dynamic_pointer_cast<IfStatementNode>(stmt)) {
+        x->setThenStatement(processBody(x->getThenStatement(), stmt, frames));
+        x->setElseStatement(processBody(x->getElseStatement(), stmt, frames));
+        return {stmt};
+    } else if (auto x = std::dynamic_pointer_cast<SwitchStatementNode>(stmt)) {
+        for (const auto& c : x->getCases()) {
+            processBlock(c.body, stmt, frames);
+        }
+        return {stmt};
+    } else if (!std::dynamic_pointer_cast<WhileStatementNode>(stmt) && !std::dynamic_pointer_cast<ForStatementNode>(stmt)) {
+        return {stmt};
+    }
+
+    // 内层循环先处理；副作用在此之前收集，内层生成的指针写入仍然对应原来的数组
+    LoopContext ctx;
+    ctx.effects = collectSideEffects(stmt);
+    if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(stmt)) {
+        x->setBody(processBody(x->getBody(), stmt, frames));
+    } else if (auto x = std::dynamic_pointer_cast<ForStatementNode>(stmt)) {
+        x->setBody(processBody(x->getBody(), stmt, frames));
+    }
+    for (Symbol* sym : collectSideEffects(stmt).written) ctx.effects.written.insert(sym);
+    return reduceLoop(stmt, ctx, frames);
+}
+
+std::vector<std::shared_ptr<StatementNode>> InductionVariableStrengthReduction::reduceLoop(const std::shared_ptr<StatementNode>& loop, LoopContext& ctx, const std::vector<Frame>& frames) {
+    std::shared_ptr<ExprNode> cond;
+    std::shared_ptr<StatementNode> body, postop;
+    auto while_stmt = std::dynamic_pointer_cast<WhileStatementNode>(loop);
+    auto for_stmt = std::dynamic_pointer_cast<ForStatementNode>(loop);
+    if (while_stmt != nullptr) {
+        cond = while_stmt->getCondition();
+        body = while_stmt->getBody();
+    } else {
+        cond = for_stmt->getCondition();
+        body = for_stmt->getBody();
+        postop = for_stmt->getPostopStatement();
+    }
+
+    // 每次迭代都可能执行的部分中对每个变量的写入次数，for 的初始化语句只在循环前执行一次
+    std::map<Symbol*, size_t> writes;
+    for (const std::shared_ptr<ASTNode>& node : std::vector<std::shared_ptr<ASTNode>>{cond, body, postop}) {
+        forEachNode(node, [&](const std::shared_ptr<ASTNode>& n, int) {
+            if (auto x = std::dynamic_pointer_cast<AssignmentNode>(n)) {
+                if (auto y = std::dynamic_pointer_cast<LValueNode>(x->getLvalue())) writes[y->getSymbol().get()]++;
+            } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(n)) {
+                UnaryOp op = x->getOp();
+                if (op != U_PREINC && op != U_PREDEC && op != U_POSTINC && op != U_POSTDEC) return;
+                if (auto y = std::dynamic_pointer_cast<LValueNode>(x->getExpr())) writes[y->getSymbol().get()]++;
+            } else if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(n)) {
+                for (const auto& sym : x->getSymbols()) {
+                    writes[sym.get()]++;
+                }
+            }
+        });
+    }
+    findUpdates(body, ctx);
+    findUpdates(postop, ctx);
+    // 所有写入都是 i = i ± c 形式的语句才是基本归纳变量
+    for (auto it = ctx.updates.begin(); it != ctx.updates.end();) {
+        Symbol* sym = it->first;
+        bool ok = writes[sym] == it->second.size() && (sym->type == P_INT || sym->type == P_LONG)
+            && !sym->is_global && !sym->is_array && address_taken.count(sym) == 0;
+        it = ok ? std::next(it) : ctx.updates.erase(it);
+    }
+    if (ctx.updates.empty()) return {loop};
+
+    findAddresses(cond, ctx);
+    findAddresses(body, ctx);
+    findAddresses(postop, ctx);
+    if (ctx.pointers.empty()) return {loop};
+
+    if (while_stmt != nullptr) {
+        while_stmt->setCondition(replaceAddresses(cond, ctx));
+    } else if (cond != nullptr) {
+        for_stmt->setCondition(replaceAddresses(cond, ctx));
+    }
+    replaceInStatement(body, ctx);
+    replaceInStatement(postop, ctx);
+
+    std::vector<std::shared_ptr<StatementNode>> limit_decls;
+    for (const auto& [iv, updates] : ctx.updates) {
+        eliminateCounter(loop, iv, ctx, frames, limit_decls);
+    }
+
+    std::vector<std::shared_ptr<StatementNode>> ret;
+    if (while_stmt != nullptr) {
+        while_stmt->setBody(insertBumpsInBody(body, ctx));
+    } else {
+        for_stmt->setBody(insertBumpsInBody(body, ctx));
+        if (postop != nullptr) for_stmt->setPostopStatement(insertBumpsInBody(postop, ctx));
+        // 指针要用初始化之后的计数器计算
+        if (for_stmt->getPreopStatement() != nullptr) ret.push_back(for_stmt->getPreopStatement());
+        for_stmt->setPreopStatement(nullptr);
+    }
+    for (const auto& ptr : ctx.pointers) {
+        ret.push_back(makeTempDecl(ptr.temp, ptr.addr));
+    }
+    for (const auto& decl : limit_decls) {
+        ret.push_back(decl);
+    }
+    ret.push_back(loop);
+    opt_stats.count(name(), func_name, ctx.pointers.size());
+    return ret;
+}
+
+// 在语句位置上查找 i = i + c、i = i - c、i++、i-- 形式的更新
+void InductionVariableStrengthReduction::findUpdates(const std::shared_ptr<StatementNode>& stmt, LoopContext& ctx) const {
+    if (stmt == nullptr) return;
+    Symbol* sym;
+    long step;
+    if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        for (const auto& s : x->getStatements()) {
+            findUpdates(s, ctx);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<IfStatementNode>(stmt)) {
+        findUpdates(x->getThenStatement(), ctx);
+        findUpdates(x->getElseStatement(), ctx);
+    } else if (auto x = std::dynamic_pointer_cast<SwitchStatementNode>(stmt)) {
+        for (const auto& c : x->getCases()) {
+            findUpdates(c.body, ctx);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(stmt)) {
+        findUpdates(x->getBody(), ctx);
+    } else if (auto x = std::dynamic_pointer_cast<ForStatementNode>(stmt)) {
+        findUpdates(x->getBody(), ctx);
+        findUpdates(x->getPostopStatement(), ctx);
+    } else if (matchUpdate(stmt, sym, step)) {
+        ctx.updates[sym].push_back({stmt, step});
+    }
+}
+
+bool InductionVariableStrengthReduction::matchUpdate(const std::shared_ptr<StatementNode>& stmt, Symbol*& sym, long& step) const {
+    if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(stmt)) {
+        auto y = std::dynamic_pointer_cast<LValueNode>(x->getExpr());
+        if (y == nullptr || y->isArray()) return false;
+        sym = y->getSymbol().get();
+        if (x->getOp() == U_PREINC || x->getOp() == U_POSTINC) step = 1;
+        else if (x->getOp() == U_PREDEC || x->getOp() == U_POSTDEC) step = -1;
+        else return false;
+        return true;
+    } else if (auto x = std::dynamic_pointer_cast<AssignmentNode>(stmt)) {
+        auto y = std::dynamic_pointer_cast<LValueNode>(x->getLvalue());
+        auto z = std::dynamic_pointer_cast<BinaryExpNode>(x->getExpr());
+        if (y == nullptr || y->isArray() || z == nullptr || z->getCalType() != y->getSymbol()->type) return false;
+        sym = y->getSymbol().get();
+        if (z->getOp() == A_ADD && isScalarOf(z->getLeft(), sym) && getConstantValue(z->getRight(), step)) return true;
+        if (z->getOp() == A_ADD && isScalarOf(z->getRight(), sym) && getConstantValue(z->getLeft(), step)) return true;
+        if (z->getOp() == A_SUBTRACT && isScalarOf(z->getLeft(), sym) && getConstantValue(z->getRight(), step)) {
+            step = -step;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 地址表达式：U_DEREF 的操作数，以及指针临时变量的初始化表达式（循环不变量外提生成的行地址）
+void InductionVariableStrengthReduction::findAddresses(const std::shared_ptr<ASTNode>& node, LoopContext& ctx) {
+    forEachNode(node, [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(n)) {
+            if (x->getOp() != U_DEREF) return;
+            auto y = std::dynamic_pointer_cast<LValueNode>(x->getExpr());
+            if (y == nullptr || y->isArray()) addAddress(x->getExpr(), ctx);
+        } else if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(n)) {
+            for (const auto& sym : x->getSymbols()) {
+                auto init = x->getInitializer(*sym);
+                if (is_pointer(sym->type) && init != nullptr) addAddress(init, ctx);
+            }
+        }
+    });
+}
+
+void InductionVariableStrengthReduction::addAddress(const std::shared_ptr<ExprNode>& addr, LoopContext& ctx) {
+    PrimitiveType type = addr->getPrimitiveType();
+    if (!is_pointer(type) && !is_array(type)) return;
+    for (const auto& [iv, updates] : ctx.updates) {
+        long coef;
+        if (!linearCoef(addr, iv, ctx, coef) || coef == 0) continue;
+        for (size_t i = 0; i < ctx.pointers.size(); i++) {
+            if (ctx.pointers[i].iv == iv && exprEqual(ctx.pointers[i].addr, addr)) {
+                ctx.replaced[addr.get()] = i;
+                return;
+            }
+        }
+        auto temp = symbol_table.newTemp(func_name, is_pointer(type) ? type : pointTo(type));
+        ctx.replaced[addr.get()] = ctx.pointers.size();
+        ctx.pointers.push_back({addr, temp, iv, coef});
+        return;
+    }
+}
+
+// expr 是否等于 coef * iv + 循环不变量，coef 以字节为单位
+bool InductionVariableStrengthReduction::linearCoef(const std::shared_ptr<ExprNode>& expr, Symbol* iv, const LoopContext& ctx, long& coef) const {
+    if (!mentionsSymbol(expr, iv)) {
+        coef = 0;
+        return isInvariantIn(expr, ctx.effects, address_taken);
+    }
+    if (auto x = std::dynamic_pointer_cast<LValueNode>(expr)) {
+        if (!x->isArray()) {
+            coef = 1;
+            return true;
+        }
+        if (x->isParam() && ctx.effects.written.count(x->getSymbol().get())) return false;
+        return linearCoef(x->getIndex(), iv, ctx, coef);
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(expr)) {
+        PrimitiveType from = x->getExpr()->getPrimitiveType(), to = x->getPrimitiveType();
+        switch (x->getOp()) {
+            case U_TRANSFORM:
+                if ((from != P_INT && from != P_LONG) || (to != P_INT && to != P_LONG)) return false;
+                return linearCoef(x->getExpr(), iv, ctx, coef);
+            case U_PLUS:
+                return linearCoef(x->getExpr(), iv, ctx, coef);
+            case U_MINUS:
+                if (!linearCoef(x->getExpr(), iv, ctx, coef)) return false;
+                coef = -coef;
+                return true;
+            case U_SCALE:
+                if (!linearCoef(x->getExpr(), iv, ctx, coef)) return false;
+                coef *= x->getOffset();
+                return true;
+            default:
+                return false;
+        }
+    } else if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(expr)) {
+        if (x->getCalType() != P_INT && x->getCalType() != P_LONG) return false;
+        long left, right, value;
+        switch (x->getOp()) {
+            case A_ADD: case A_SUBTRACT:
+                if (!linearCoef(x->getLeft(), iv, ctx, left) || !linearCoef(x->getRight(), iv, ctx, right)) return false;
+                coef = x->getOp() == A_ADD ? left + right : left - right;
+                return true;
+            case A_MULTIPLY:
+                if (getConstantValue(x->getRight(), value) && linearCoef(x->getLeft(), iv, ctx, left)) {
+                    coef = left * value;
+                    return true;
+                }
+                if (getConstantValue(x->getLeft(), value) && linearCoef(x->getRight(), iv, ctx, right)) {
+                    coef = right * value;
+                    return true;
+                }
+                return false;
+            default:
+                return false;
+        }
+    }
+    return false;
+}
+
+std::shared_ptr<ExprNode> InductionVariableStrengthReduction::replaceAddresses(const std::shared_ptr<ExprNode>& expr, LoopContext& ctx) {
+    if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(expr)) {
+        x->setLeft(replaceAddresses(x->getLeft(), ctx));
+        x->setRight(replaceAddresses(x->getRight(), ctx));
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(expr)) {
+        auto it = ctx.replaced.find(x->getExpr().get());
+        if (x->getOp() == U_DEREF && it != ctx.replaced.end()) {
+            x->setExpr(makeVarRef(ctx.pointers[it->second].temp));
+        } else {
+            x->setExpr(replaceAddresses(x->getExpr(), ctx));
+        }
+    } else if (auto x = std::dynamic_pointer_cast<LValueNode>(expr)) {
+        if (x->getIndex() != nullptr) x->setIndex(replaceAddresses(x->getIndex(), ctx));
+    } else if (auto x = std::dynamic_pointer_cast<FunctionCallNode>(expr)) {
+        std::vector<std::shared_ptr<ExprNode>> args;
+        for (const auto& arg : x->getArguments()) {
+            args.push_back(replaceAddresses(arg, ctx));
+        }
+        x->setArguments(args);
+    } else if (auto x = std::dynamic_pointer_cast<AssignmentNode>(expr)) {
+        replaceAddresses(x->getLvalue(), ctx);
+        x->setExpr(replaceAddresses(x->getExpr(), ctx));
+    }
+    return expr;
+}
+
+void InductionVariableStrengthReduction::replaceInStatement(const std::shared_ptr<StatementNode>& stmt, LoopContext& ctx) {
+    if (stmt == nullptr) return;
+    if (auto x = std::dynamic_pointer_cast<ExprNode>(stmt)) {
+        replaceAddresses(x, ctx);
+    } else if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        for (const auto& s : x->getStatements()) {
+            replaceInStatement(s, ctx);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<PrintStatementNode>(stmt)) {
+        x->setExpression(replaceAddresses(x->getExpression(), ctx));
+    } else if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(stmt)) {
+        for (const auto& sym : x->getSymbols()) {
+            auto init = x->getInitializer(*sym);
+            if (init == nullptr || sym->is_array) continue;
+            auto it = ctx.replaced.find(init.get());
+            if (it != ctx.replaced.end()) x->setInitializer(*sym, makeVarRef(ctx.pointers[it->second].temp));
+            else x->setInitializer(*sym, replaceAddresses(init, ctx));
+        }
+    } else if (auto x = std::dynamic_pointer_cast<IfStatementNode>(stmt)) {
+        x->setCondition(replaceAddresses(x->getCondition(), ctx));
+        replaceInStatement(x->getThenStatement(), ctx);
+        replaceInStatement(x->getElseStatement(), ctx);
+    } else if (auto x = std::dynamic_pointer_cast<SwitchStatementNode>(stmt)) {
+        x->setCondition(replaceAddresses(x->getCondition(), ctx));
+        for (const auto& c : x->getCases()) {
+            replaceInStatement(c.body, ctx);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(stmt)) {
+        x->setCondition(replaceAddresses(x->getCondition(), ctx));
+        replaceInStatement(x->getBody(), ctx);
+    } else if (auto x = std::dynamic_pointer_cast<ForStatementNode>(stmt)) {
+        replaceInStatement(x->getPreopStatement(), ctx);
+        if (x->getCondition() != nullptr) x->setCondition(replaceAddresses(x->getCondition(), ctx));
+        replaceInStatement(x->getBody(), ctx);
+        replaceInStatement(x->getPostopStatement(), ctx);
+    } else if (auto x = std::dynamic_pointer_cast<ReturnStatementNode>(stmt)) {
+        if (x->getExpression() != nullptr) x->setExpression(replaceAddresses(x->getExpression(), ctx));
+    }
+}
+
+// 在归纳变量的每条更新语句后面移动派生指针，被删除的计数器连同更新语句一起去掉
+std::vector<std::shared_ptr<StatementNode>> InductionVariableStrengthReduction::insertBumps(const std::shared_ptr<StatementNode>& stmt, LoopContext& ctx) {
+    Symbol* sym;
+    long step;
+    if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        std::vector<std::shared_ptr<StatementNode>> stmts;
+        for (const auto& s : x->getStatements()) {
+            for (const auto& t : insertBumps(s, ctx)) {
+                stmts.push_back(t);
+            }
+        }
+        x->setStatements(stmts);
+    } else if (auto x = std::dynamic_pointer_cast<IfStatementNode>(stmt)) {
+        x->setThenStatement(insertBumpsInBody(x->getThenStatement(), ctx));
+        x->setElseStatement(insertBumpsInBody(x->getElseStatement(), ctx));
+    } else if (auto x = std::dynamic_pointer_cast<SwitchStatementNode>(stmt)) {
+        for (const auto& c : x->getCases()) {
+            insertBumps(c.body, ctx);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(stmt)) {
+        x->setBody(insertBumpsInBody(x->getBody(), ctx));
+    } else if (auto x = std::dynamic_pointer_cast<ForStatementNode>(stmt)) {
+        x->setBody(insertBumpsInBody(x->getBody(), ctx));
+        x->setPostopStatement(insertBumpsInBody(x->getPostopStatement(), ctx));
+    } else if (matchUpdate(stmt, sym, step) && ctx.updates.count(sym)) {
+        std::vector<std::shared_ptr<StatementNode>> ret;
+        if (ctx.eliminated.count(sym) == 0) ret.push_back(stmt);
+        for (const auto& ptr : ctx.pointers) {
+            if (ptr.iv != sym) continue;
+            Value delta{.type = P_LONG, .lvalue = ptr.coef * step};
+            auto sum = std::make_shared<BinaryExpNode>(A_ADD, makeVarRef(ptr.temp), std::make_shared<ValueNode>(delta));
+            sum->updateCalType();
+            sum->updateTypeAfterCal();
+            ret.push_back(std::make_shared<AssignmentNode>(makeVarRef(ptr.temp), sum));
+        }
+        return ret;
+    }
+    return {stmt};
+}
+
+std::shared_ptr<StatementNode> InductionVariableStrengthReduction::insertBumpsInBody(const std::shared_ptr<StatementNode>& stmt, LoopContext& ctx) {
+    if (stmt == nullptr) return nullptr;
+    auto stmts = insertBumps(stmt, ctx);
+    if (stmts.size() == 1) return stmts[0];
+    auto block = std::make_shared<BlockNode>();
+    block->setStatements(stmts);
+    return block;
+}
+
+// 计数器只用于地址计算和退出条件 i op n 时，把条件改成 p op &a[n] 并删除计数器
+bool InductionVariableStrengthReduction::eliminateCounter(const std::shared_ptr<StatementNode>& loop, Symbol* iv, LoopContext& ctx, const std::vector<Frame>& frames, std::vector<std::shared_ptr<StatementNode>>& decls) {
+    std::shared_ptr<ExprNode> cond;
+    std::shared_ptr<StatementNode> body, postop;
+    if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(loop)) {
+        cond = x->getCondition();
+        body = x->getBody();
+    } else if (auto x = std::dynamic_pointer_cast<ForStatementNode>(loop)) {
+        cond = x->getCondition();
+        body = x->getBody();
+        postop = x->getPostopStatement();
+    }
+    auto cmp = std::dynamic_pointer_cast<BinaryExpNode>(cond);
+    if (cmp == nullptr || !isComparison(cmp->getOp())) return false;
+    bool iv_left = isScalarOf(stripTransform(cmp->getLeft()), iv);
+    if (!iv_left && !isScalarOf(stripTransform(cmp->getRight()), iv)) return false;
+    // 界限要转换成计数器的类型才能代入地址表达式
+    std::shared_ptr<ExprNode> bound = stripTransform(iv_left ? cmp->getRight() : cmp->getLeft());
+    if (bound->getPrimitiveType() != P_INT && bound->getPrimitiveType() != P_LONG) return false;
+    if (bound->getPrimitiveType() != iv->type) bound = std::make_shared<UnaryExpNode>(U_TRANSFORM, bound, iv->type);
+    if (!isInvariantIn(bound, ctx.effects, address_taken)) return false;
+
+    // 除了更新语句，计数器只能出现在条件里
+    int uses = 0;
+    for (const std::shared_ptr<ASTNode>& node : std::vector<std::shared_ptr<ASTNode>>{cond, body, postop}) {
+        forEachNode(node, [&](const std::shared_ptr<ASTNode>& n, int) {
+            if (isScalarOf(std::dynamic_pointer_cast<ExprNode>(n), iv)) uses++;
+        });
+    }
+    for (const auto& [stmt, step] : ctx.updates[iv]) {
+        forEachNode(stmt, [&](const std::shared_ptr<ASTNode>& n, int) {
+            if (isScalarOf(std::dynamic_pointer_cast<ExprNode>(n), iv)) uses--;
+        });
+    }
+    if (uses != 1 || !isDeadAfter(iv, frames)) return false;
+
+    const DerivedPointer* ptr = nullptr;
+    for (const auto& p : ctx.pointers) {
+        if (p.iv == iv && (ptr == nullptr || (ptr->coef < 0 && p.coef > 0))) ptr = &p;
+    }
+    auto limit = symbol_table.newTemp(func_name, ptr->temp->type);
+    decls.push_back(makeTempDecl(limit, cloneExpr(ptr->addr, {{iv, bound}})));
+    ExprType op = ptr->coef > 0 ? cmp->getOp() : flipComparison(cmp->getOp());
+    auto new_cond = iv_left ? std::make_shared<BinaryExpNode>(op, makeVarRef(ptr->temp), makeVarRef(limit))
+                            : std::make_shared<BinaryExpNode>(op, makeVarRef(limit), makeVarRef(ptr->temp));
+    new_cond->updateCalType();
+    new_cond->updateTypeAfterCal();
+    if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(loop)) x->setCondition(new_cond);
+    else if (auto x = std::dynamic_pointer_cast<ForStatementNode>(loop)) x->setCondition(new_cond);
+    ctx.eliminated.insert(iv);
+    return true;
+}
+
+// 循环结束后 sym 是否一定在被读取之前被重新赋值（或函数返回）
+bool InductionVariableStrengthReduction::isDeadAfter(const Symbol* sym, const std::vector<Frame>& frames) const {
+    enum ScanResult { NONE, KILL, READ };
+    auto isKill = [&](const std::shared_ptr<StatementNode>& stmt) {
+        auto x = std::dynamic_pointer_cast<AssignmentNode>(stmt);
+        return x != nullptr && isScalarOf(x->getLvalue(), sym) && !mentionsSymbol(x->getExpr(), sym);
+    };
+    auto hasJump = [&](const std::shared_ptr<StatementNode>& stmt) {
+        bool ret = false;
+        forEachNode(stmt, [&](const std::shared_ptr<ASTNode>& n, int) {
+            if (std::dynamic_pointer_cast<BreakStatementNode>(n) || std::dynamic_pointer_cast<ContinueStatementNode>(n)) ret = true;
+        });
+        return ret;
+    };
+    auto scan = [&](const std::vector<std::shared_ptr<StatementNode>>& stmts, size_t from, size_t to) {
+        for (size_t i = from; i < to && i < stmts.size(); i++) {
+            if (isKill(stmts[i])) return KILL;
+            if (auto x = std::dynamic_pointer_cast<ForStatementNode>(stmts[i])) {
+                if (isKill(x->getPreopStatement())) return KILL;
+            }
+            // break/continue 会跳过后面的赋值
+            if (mentionsSymbol(stmts[i], sym) || hasJump(stmts[i])) return READ;
+        }
+        return NONE;
+    };
+
+    for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+        if (it->block == nullptr) return false;
+        auto stmts = it->block->getStatements();
+        ScanResult r = scan(stmts, it->index + 1, stmts.size());
+        if (r != NONE) return r == KILL;
+        if (it->owner == nullptr) return true; // 函数结束
+        std::shared_ptr<ExprNode> cond;
+        std::shared_ptr<StatementNode> postop;
+        if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(it->owner)) {
+            cond = x->getCondition();
+        } else if (auto x = std::dynamic_pointer_cast<ForStatementNode>(it->owner)) {
+            cond = x->getCondition();
+            postop = x->getPostopStatement();
+        } else if (std::dynamic_pointer_cast<SwitchStatementNode>(it->owner)) {
+            return false; // 可能落入后面的分支
+        } else {
+            continue; // if 的分支或普通块，接着看它后面的语句
+        }
+        // 外层循环进入下一次迭代：经过条件后从循环体开头执行到当前位置
+        if (mentionsSymbol(cond, sym) || mentionsSymbol(postop, sym)) return false;
+        if (scan(stmts, 0, it->index + 1) != KILL) return false;
+    }
+    return true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "optimizer/optimizer.h"
+#include "optimizer/ast_utils.h"
+#include <set>
+
+// 归纳变量强度削弱：循环中只以 i = i ± c 形式更新的整型变量是基本归纳变量，
+// 与它线性相关的数组元素地址（如 &a[i + k]、&a[i][j] 的行地址）在循环前算成指针，
+// 之后每次更新 i 时把指针加上相应的字节数，循环中的访问变成一次解引用。
+// 如果 i 除了地址计算只出现在退出条件里且在循环后不再被读取，就把条件改成指针比较并删除 i 的更新。
+class InductionVariableStrengthReduction : public Pass {
+public:
+    std::string name() const override { return "ivsr"; }
+    void run(const std::shared_ptr<Pragram>& program) override;
+private:
+    // 语句在某个块中的位置，用于判断变量在循环结束后是否还会被读取
+    struct Frame {
+        std::shared_ptr<BlockNode> block; // nullptr 表示语句不在块中（if 的分支直接是一条语句）
+        size_t index;
+        std::shared_ptr<StatementNode> owner; // 块所属的 if/while/for，函数体为 nullptr
+    };
+    // 由归纳变量派生出的指针
+    struct DerivedPointer {
+        std::shared_ptr<ExprNode> addr; // 循环入口处的地址表达式
+        std::shared_ptr<Symbol> temp;
+        Symbol* iv;
+        long coef; // 归纳变量每加1，地址增加的字节数
+    };
+    struct LoopContext {
+        SideEffects effects;
+        std::map<Symbol*, std::vector<std::pair<std::shared_ptr<StatementNode>, long>>> updates; // 归纳变量的更新语句及步长
+        std::map<ExprNode*, size_t> replaced; // 被替换的地址表达式 -> pointers 下标
+        std::vector<DerivedPointer> pointers;
+        std::set<Symbol*> eliminated; // 被删除的循环计数器
+    };
+
+    std::string func_name;
+    std::set<Symbol*> address_taken;
+
+    void processBlock(const std::shared_ptr<BlockNode>& block, const std::shared_ptr<StatementNode>& owner, std::vector<Frame>& frames);
+    std::vector<std::shared_ptr<StatementNode>> processStatement(const std::shared_ptr<StatementNode>& stmt, std::vector<Frame>& frames);
+    std::shared_ptr<StatementNode> processBody(const std::shared_ptr<StatementNode>& stmt, const std::shared_ptr<StatementNode>& owner, std::vector<Frame>& frames);
+    std::vector<std::shared_ptr<StatementNode>> reduceLoop(const std::shared_ptr<StatementNode>& loop, LoopContext& ctx, const std::vector<Frame>& frames);
+
+    void findUpdates(const std::shared_ptr<StatementNode>& stmt, LoopContext& ctx) const;
+    bool matchUpdate(const std::shared_ptr<StatementNode>& stmt, Symbol*& sym, long& step) const;
+    void findAddresses(const std::shared_ptr<ASTNode>& node, LoopContext& ctx);
+    void addAddress(const std::shared_ptr<ExprNode>& addr, LoopContext& ctx);
+    bool linearCoef(const std::shared_ptr<ExprNode>& expr, Symbol* iv, const LoopContext& ctx, long& coef) const;
+    std::shared_ptr<ExprNode> replaceAddresses(const std::shared_ptr<ExprNode>& expr, LoopContext& ctx);
+    void replaceInStatement(const std::shared_ptr<StatementNode>& stmt, LoopContext& ctx);
+    std::vector<std::shared_ptr<StatementNode>> insertBumps(const std::shared_ptr<StatementNode>& stmt, LoopContext& ctx);
+    std::shared_ptr<StatementNode> insertBumpsInBody(const std::shared_ptr<StatementNode>& stmt, LoopContext& ctx);
+    bool eliminateCounter(const std::shared_ptr<StatementNode>& loop, Symbol* iv, LoopContext& ctx, const std::vector<Frame>& frames, std::vector<std::shared_ptr<StatementNode>>& decls);
+    bool isDeadAfter(const Symbol* sym, const std::vector<Frame>& frames) const;
+};
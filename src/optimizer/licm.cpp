@@ -0,0 +1,259 @@
+#include "optimizer/licm.h"
+
+void LoopInvariantCodeMotion::run(const std::shared_ptr<Pragram>& program) {
+    for (const auto& func : program->getFunctions()) {
+        func_name = func->getIdentifier();
+        address_taken = collectAddressTaken(func);
+        processBlock(func->getBody());
+    }
+}
+
+void LoopInvariantCodeMotion::processBlock(const std::shared_ptr<BlockNode>& block) {
+    std::vector<std::shared_ptr<StatementNode>> stmts;
+    for (const auto& stmt : block->getStatements()) {
+        for (const auto& s : processStatement(stmt)) {
+            stmts.push_back(s);
+        }
+    }
+    block->setStatements(stmts);
+}
+
+std::shared_ptr<StatementNode> LoopInvariantCodeMotion::processBody(const std::shared_ptr<StatementNode>& stmt) {
+    if (stmt == nullptr) return nullptr;
+    auto stmts = processStatement(stmt);
+    if (stmts.size() == 1) return stmts[0];
+    auto block = std::make_shared<BlockNode>();
+    block->setStatements(stmts);
+    return block;
+}
+
+// 返回替换stmt的语句序列，外提出来的临时变量声明放在循环前面
+std::vector<std::shared_ptr<StatementNode>> LoopInvariantCodeMotion::processStatement(const std::shared_ptr<StatementNode>& stmt) {
+    if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        processBlock(x);
+        return {stmt};
+    } else if (auto x = std::dynamic_pointer_cast<IfStatementNode>(stmt)) {
+        x->setThenStatement(processBody(x->getThenStatement()));
+        x->setElseStatement(processBody(x->getElseStatement()));
+        return {stmt};
+    } else if (auto x = std::dynamic_pointer_cast<SwitchStatementNode>(stmt)) {
+        for (const auto& c : x->getCases()) {
+            processBlock(c.body);
+        }
+        return {stmt};
+    } else if (!std::dynamic_pointer_cast<WhileStatementNode>(stmt) && !std::dynamic_pointer_cast<ForStatementNode>(stmt)) {
+        return {stmt};
+    }
+
+    // 副作用在处理内层循环之前收集，内层外提出来的指针写入仍然对应原来的数组
+    LoopContext ctx;
+    ctx.effects = collectSideEffects(stmt);
+    // 外提的临时变量在循环前无条件求值，条件至少求值一次；循环体和 postop 只有一定进入循环时才不算受保护
+    if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(stmt)) {
+        x->setBody(processBody(x->getBody()));
+        for (Symbol* sym : collectSideEffects(x).written) ctx.effects.written.insert(sym);
+        long value;
+        bool entered = getConstantValue(x->getCondition(), value) && value != 0;
+        x->setCondition(hoistExpr(x->getCondition(), ctx, false));
+        hoistStatement(x->getBody(), ctx, !entered);
+    } else if (auto x = std::dynamic_pointer_cast<ForStatementNode>(stmt)) {
+        x->setBody(processBody(x->getBody()));
+        for (Symbol* sym : collectSideEffects(x).written) ctx.effects.written.insert(sym);
+        bool entered = entersLoop(x->getPreopStatement(), x->getCondition());
+        x->setCondition(hoistExpr(x->getCondition(), ctx, false));
+        hoistStatement(x->getBody(), ctx, !entered);
+        hoistStatement(x->getPostopStatement(), ctx, !entered);
+    }
+    if (ctx.hoisted.empty()) return {stmt};
+    opt_stats.count(name(), func_name, ctx.hoisted.size());
+    std::vector<std::shared_ptr<StatementNode>> ret = ctx.decls;
+    ret.push_back(stmt);
+    return ret;
+}
+
+// guarded 表示语句不一定在每次迭代中执行，此时不外提可能越界的数组读取
+void LoopInvariantCodeMotion::hoistStatement(const std::shared_ptr<StatementNode>& stmt, LoopContext& ctx, bool guarded) {
+    if (stmt == nullptr) return;
+    if (auto x = std::dynamic_pointer_cast<ExprNode>(stmt)) {
+        hoistChildren(x, ctx, guarded); // 表达式语句本身的值没有用到
+    } else if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        for (const auto& s : x->getStatements()) {
+            hoistStatement(s, ctx, guarded);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<PrintStatementNode>(stmt)) {
+        x->setExpression(hoistExpr(x->getExpression(), ctx, guarded));
+    } else if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(stmt)) {
+        for (const auto& sym : x->getSymbols()) {
+            auto init = x->getInitializer(*sym);
+            if (sym->is_array || init == nullptr) continue;
+            x->setInitializer(*sym, hoistExpr(init, ctx, guarded));
+        }
+    } else if (auto x = std::dynamic_pointer_cast<IfStatementNode>(stmt)) {
+        x->setCondition(hoistExpr(x->getCondition(), ctx, guarded));
+        hoistStatement(x->getThenStatement(), ctx, true);
+        hoistStatement(x->getElseStatement(), ctx, true);
+    } else if (auto x = std::dynamic_pointer_cast<SwitchStatementNode>(stmt)) {
+        x->setCondition(hoistExpr(x->getCondition(), ctx, guarded));
+        for (const auto& c : x->getCases()) {
+            hoistStatement(c.body, ctx, true);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(stmt)) {
+        x->setCondition(hoistExpr(x->getCondition(), ctx, guarded));
+        hoistStatement(x->getBody(), ctx, true);
+    } else if (auto x = std::dynamic_pointer_cast<ForStatementNode>(stmt)) {
+        hoistStatement(x->getPreopStatement(), ctx, guarded);
+        x->setCondition(hoistExpr(x->getCondition(), ctx, guarded));
+        hoistStatement(x->getBody(), ctx, true);
+        hoistStatement(x->getPostopStatement(), ctx, true);
+    } else if (auto x = std::dynamic_pointer_cast<ReturnStatementNode>(stmt)) {
+        if (x->getExpression() != nullptr) x->setExpression(hoistExpr(x->getExpression(), ctx, guarded));
+    }
+}
+
+// 返回替换expr的表达式
+std::shared_ptr<ExprNode> LoopInvariantCodeMotion::hoistExpr(const std::shared_ptr<ExprNode>& expr, LoopContext& ctx, bool guarded) {
+    if (expr == nullptr) return nullptr;
+    PrimitiveType type = tempTypeOf(expr);
+    if (type != P_NONE && evalCost(expr) >= 2 && !isConstantExpr(expr) && isInvariant(expr, ctx, guarded)) {
+        return makeTemp(expr, type, ctx);
+    }
+    hoistChildren(expr, ctx, guarded);
+    return expr;
+}
+
+// 只处理子表达式，expr本身保留在原位（赋值目标、自增自减的操作数等）
+void LoopInvariantCodeMotion::hoistChildren(const std::shared_ptr<ExprNode>& expr, LoopContext& ctx, bool guarded) {
+    if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(expr)) {
+        x->setLeft(hoistExpr(x->getLeft(), ctx, guarded));
+        x->setRight(hoistExpr(x->getRight(), ctx, guarded));
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(expr)) {
+        UnaryOp op = x->getOp();
+        if (op == U_ADDR || op == U_DEREF) {
+            if (auto y = std::dynamic_pointer_cast<LValueNode>(x->getExpr())) {
+                // 取地址的变量必须留在原位
+                if (y->isArray()) x->setExpr(hoistArrayAddress(y, ctx, guarded, op == U_DEREF));
+            } else {
+                x->setExpr(hoistExpr(x->getExpr(), ctx, guarded));
+            }
+        } else if (op == U_PREINC || op == U_PREDEC || op == U_POSTINC || op == U_POSTDEC) {
+            if (std::dynamic_pointer_cast<UnaryExpNode>(x->getExpr())) hoistChildren(x->getExpr(), ctx, guarded);
+        } else {
+            x->setExpr(hoistExpr(x->getExpr(), ctx, guarded));
+        }
+    } else if (auto x = std::dynamic_pointer_cast<LValueNode>(expr)) {
+        if (x->isArray() && x->getIndex() != nullptr) x->setIndex(hoistExpr(x->getIndex(), ctx, guarded));
+    } else if (auto x = std::dynamic_pointer_cast<FunctionCallNode>(expr)) {
+        std::vector<std::shared_ptr<ExprNode>> args;
+        for (const auto& arg : x->getArguments()) {
+            args.push_back(hoistExpr(arg, ctx, guarded));
+        }
+        x->setArguments(args);
+    } else if (auto x = std::dynamic_pointer_cast<AssignmentNode>(expr)) {
+        if (std::dynamic_pointer_cast<UnaryExpNode>(x->getLvalue())) hoistChildren(x->getLvalue(), ctx, guarded);
+        x->setExpr(hoistExpr(x->getExpr(), ctx, guarded));
+    }
+}
+
+// 处理 U_DEREF/U_ADDR 下的数组元素地址。整个地址不变时换成指针临时变量（仅 U_DEREF，
+// U_ADDR 的子节点如果是普通变量会被当作取该变量的地址）；下标形如 inv + var 时，
+// 把 &a[inv] 外提，循环中只计算 &a[inv] + var * size。
+std::shared_ptr<ExprNode> LoopInvariantCodeMotion::hoistArrayAddress(const std::shared_ptr<LValueNode>& lvalue, LoopContext& ctx, bool guarded, bool allow_temp) {
+    auto sym = lvalue->getSymbol();
+    if (lvalue->getIndex() == nullptr) return lvalue;
+    if (allow_temp && evalCost(lvalue) >= 2 && isInvariant(lvalue, ctx, guarded)) {
+        return makeTemp(lvalue, pointTo(sym->type), ctx);
+    }
+
+    auto scale = std::dynamic_pointer_cast<UnaryExpNode>(lvalue->getIndex());
+    if (scale != nullptr && scale->getOp() == U_TRANSFORM) scale = std::dynamic_pointer_cast<UnaryExpNode>(scale->getExpr()); // 语义检查给下标加的类型转换
+    auto sum = scale != nullptr && scale->getOp() == U_SCALE ? std::dynamic_pointer_cast<BinaryExpNode>(scale->getExpr()) : nullptr;
+    if (sum != nullptr && sum->getOp() == A_ADD && sum->getCalType() != P_FLOAT) {
+        std::shared_ptr<ExprNode> inv = sum->getLeft(), var = sum->getRight();
+        if (!isInvariant(inv, ctx, guarded)) std::swap(inv, var);
+        if (isInvariant(inv, ctx, guarded) && !isInvariant(var, ctx, guarded) && evalCost(inv) >= 2 && !isConstantExpr(inv)) {
+            auto inv_scale = std::make_shared<UnaryExpNode>(U_SCALE, inv, P_LONG);
+            inv_scale->setOffset(scale->getOffset());
+            auto base = std::make_shared<LValueNode>(sym, inv_scale);
+            if (isInvariant(base, ctx, guarded)) {
+                auto var_scale = std::make_shared<UnaryExpNode>(U_SCALE, hoistExpr(var, ctx, guarded), P_LONG);
+                var_scale->setOffset(scale->getOffset());
+                auto addr = std::make_shared<BinaryExpNode>(A_ADD, makeTemp(base, pointTo(sym->type), ctx), var_scale);
+                addr->updateCalType();
+                addr->updateTypeAfterCal();
+                return addr;
+            }
+        }
+    }
+    lvalue->setIndex(hoistExpr(lvalue->getIndex(), ctx, guarded));
+    return lvalue;
+}
+
+std::shared_ptr<ExprNode> LoopInvariantCodeMotion::makeTemp(const std::shared_ptr<ExprNode>& expr, PrimitiveType type, LoopContext& ctx) {
+    for (const auto& [hoisted, sym] : ctx.hoisted) {
+        if (sym->type == type && exprEqual(hoisted, expr)) return makeVarRef(sym);
+    }
+    auto sym = symbol_table.newTemp(func_name, type);
+    ctx.decls.push_back(makeTempDecl(sym, expr));
+    ctx.hoisted.push_back({expr, sym});
+    return makeVarRef(sym);
+}
+
+bool LoopInvariantCodeMotion::isWritten(const std::shared_ptr<Symbol>& sym, const LoopContext& ctx) const {
+    return ctx.effects.written.count(sym.get()) > 0;
+}
+
+bool LoopInvariantCodeMotion::isInvariant(const std::shared_ptr<ExprNode>& expr, const LoopContext& ctx, bool guarded) const {
+    const SideEffects& effects = ctx.effects;
+    if (expr == nullptr) return true;
+    if (std::dynamic_pointer_cast<ValueNode>(expr)) {
+        return true;
+    } else if (auto x = std::dynamic_pointer_cast<LValueNode>(expr)) {
+        auto sym = x->getSymbol();
+        if (x->isArray()) {
+            // 数组元素的地址：局部和全局数组的基址是常量，数组参数是一个指针变量
+            if (x->isParam() && isWritten(sym, ctx)) return false;
+            return isInvariant(x->getIndex(), ctx, guarded);
+        }
+        if (isWritten(sym, ctx)) return false;
+        if (sym->is_global || address_taken.count(sym.get())) {
+            return !effects.has_call && !effects.has_pointer_store;
+        }
+        return true;
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(expr)) {
+        switch (x->getOp()) {
+            case U_PREINC: case U_PREDEC: case U_POSTINC: case U_POSTDEC:
+                return false;
+            case U_ADDR:
+                if (auto y = std::dynamic_pointer_cast<LValueNode>(x->getExpr())) {
+                    if (!y->isArray()) return true; // 变量的地址在函数内不变
+                }
+                return isInvariant(x->getExpr(), ctx, guarded);
+            case U_DEREF: {
+                // 只读取数组元素；通过普通指针的读取可能与任意数组别名
+                auto y = std::dynamic_pointer_cast<LValueNode>(x->getExpr());
+                if (guarded || y == nullptr || !y->isArray()) return false;
+                if (effects.has_call || effects.has_pointer_store || isWritten(y->getSymbol(), ctx)) return false;
+                if (y->isParam()) {
+                    // 数组参数可能指向本函数中的任意数组
+                    for (Symbol* sym : effects.written) {
+                        if (sym->is_array) return false;
+                    }
+                }
+                return isInvariant(y, ctx, guarded);
+            }
+            default:
+                return isInvariant(x->getExpr(), ctx, guarded);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(expr)) {
+        if ((x->getOp() == A_DIVIDE || x->getOp() == A_MOD) && x->getCalType() != P_FLOAT) {
+            // 外提后即使循环一次都不执行也会求值，除数必须是不会触发异常的常量
+            auto y = std::dynamic_pointer_cast<ValueNode>(x->getRight());
+            if (y == nullptr) return false;
+            Value value = y->getValue();
+            long divisor = value.type == P_LONG ? value.lvalue : value.type == P_INT ? value.ivalue : 0;
+            if (divisor == 0 || divisor == -1) return false;
+        }
+        return isInvariant(x->getLeft(), ctx, guarded) && isInvariant(x->getRight(), ctx, guarded);
+    }
+    return false; // 函数调用和赋值
+}
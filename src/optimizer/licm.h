@@ -0,0 +1,35 @@
+#pragma once
+#include "optimizer/optimizer.h"
+#include "optimizer/ast_utils.h"
+#include <set>
+
+// 循环不变量外提：把 while/for 循环中每次迭代结果都相同的表达式提到循环前面，
+// 计算一次存入编译器临时变量。内层循环先处理，外提出来的声明会继续参与外层循环的外提。
+// 别名模型是保守的：全局变量、数组和被取地址的变量只有在循环中被写入或出现函数调用时才视为被修改。
+// 对数组下标 a[inv + var]，先把 &a[inv] 算成指针，循环中只剩 var 的缩放和一次加法。
+class LoopInvariantCodeMotion : public Pass {
+public:
+    std::string name() const override { return "licm"; }
+    void run(const std::shared_ptr<Pragram>& program) override;
+private:
+    // 正在外提的循环
+    struct LoopContext {
+        SideEffects effects;
+        std::vector<std::pair<std::shared_ptr<ExprNode>, std::shared_ptr<Symbol>>> hoisted; // 已外提的表达式及其临时变量
+        std::vector<std::shared_ptr<StatementNode>> decls; // 放在循环前面的临时变量声明
+    };
+
+    std::string func_name;
+    std::set<Symbol*> address_taken;
+
+    void processBlock(const std::shared_ptr<BlockNode>& block);
+    std::vector<std::shared_ptr<StatementNode>> processStatement(const std::shared_ptr<StatementNode>& stmt);
+    std::shared_ptr<StatementNode> processBody(const std::shared_ptr<StatementNode>& stmt);
+    void hoistStatement(const std::shared_ptr<StatementNode>& stmt, LoopContext& ctx, bool guarded);
+    std::shared_ptr<ExprNode> hoistExpr(const std::shared_ptr<ExprNode>& expr, LoopContext& ctx, bool guarded);
+    void hoistChildren(const std::shared_ptr<ExprNode>& expr, LoopContext& ctx, bool guarded);
+    std::shared_ptr<ExprNode> hoistArrayAddress(const std::shared_ptr<LValueNode>& lvalue, LoopContext& ctx, bool guarded, bool allow_temp);
+    std::shared_ptr<ExprNode> makeTemp(const std::shared_ptr<ExprNode>& expr, PrimitiveType type, LoopContext& ctx);
+    bool isInvariant(const std::shared_ptr<ExprNode>& expr, const LoopContext& ctx, bool guarded) const;
+    bool isWritten(const std::shared_ptr<Symbol>& sym, const LoopContext& ctx) const;
+};
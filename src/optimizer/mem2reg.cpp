@@ -0,0 +1,216 @@
+#include "optimizer/mem2reg.h"
+#include "optimizer/ast_utils.h"
+#include <algorithm>
+
+static const std::vector<std::string> int_param_regs = { "%rdi", "%rsi", "%rdx", "%rcx", "%r8", "%r9" };
+static const std::vector<std::string> float_param_regs = { "%xmm0", "%xmm1", "%xmm2", "%xmm3", "%xmm4", "%xmm5", "%xmm6", "%xmm7" };
+static const std::vector<std::string> callee_saved_regs = { "%rbx", "%r14", "%r15" };
+// %xmm8-%xmm11 是表达式求值用的临时寄存器
+static const std::vector<std::string> float_local_regs = { "%xmm12", "%xmm13", "%xmm14", "%xmm15" };
+
+void RegisterPromotion::run(const std::shared_ptr<Pragram>& program) {
+    std::vector<std::shared_ptr<ASTNode>> global_inits;
+    for (const auto& var : program->getGlobalVariables()) {
+        for (const auto& sym : var->getSymbols()) {
+            auto init = var->getInitializer(*sym);
+            Value value;
+            if (!sym->is_array && init != nullptr && !getStaticInitializer(*sym, init, value)) global_inits.push_back(init);
+        }
+    }
+    for (const auto& func : program->getFunctions()) {
+        // 编译期算不出初值的全局变量在main的开头初始化
+        if (func->getIdentifier() == "main") promoteFunction(func, global_inits);
+        else promoteFunction(func, {});
+    }
+}
+
+void RegisterPromotion::promoteFunction(const std::shared_ptr<FunctionDeclareNode>& func, const std::vector<std::shared_ptr<ASTNode>>& extra) {
+    std::map<Symbol*, Candidate> candidates;
+    std::set<Symbol*> address_taken;
+    std::set<std::string> clobbered; // 代码生成时会被隐式使用的寄存器
+    bool is_leaf = true;
+    int order = 0;
+
+    auto addCandidate = [&](const std::shared_ptr<Symbol>& sym) {
+        if (sym->is_global || sym->is_array || sym->pos_in_stack > 0) return; // 栈上传入的参数保持原样
+        if (candidates.count(sym.get()) == 0) candidates[sym.get()] = {sym, 0, order++};
+    };
+
+    std::vector<std::shared_ptr<Symbol>> params;
+    if (func->getParams() != nullptr) params = func->getParams()->getParams();
+    for (const auto& param : params) {
+        if (param->is_array) {
+            // 数组参数实际上是一个指针
+            if (param->pos_in_stack < 0 && candidates.count(param.get()) == 0) candidates[param.get()] = {param, 0, order++};
+        } else {
+            addCandidate(param);
+        }
+    }
+
+    auto visit = [&](const std::shared_ptr<ASTNode>& node, int loop_depth) {
+        long weight = 1;
+        for (int i = 0; i < std::min(loop_depth, 4); i++) weight *= 10;
+        if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(node)) {
+            for (const auto& sym : x->getSymbols()) {
+                addCandidate(sym);
+                if (x->getInitializer(*sym) != nullptr && sym->is_array) {
+                    clobbered.insert("%rdi"); // rep movs/stos 使用 %rsi/%rdi/%rcx/%rax
+                    clobbered.insert("%rsi");
+                    clobbered.insert("%rcx");
+                }
+            }
+        } else if (auto x = std::dynamic_pointer_cast<LValueNode>(node)) {
+            auto it = candidates.find(x->getSymbol().get());
+            if (it != candidates.end()) it->second.weight += weight;
+        } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(node)) {
+            if (x->getOp() == U_ADDR) {
+                if (auto y = std::dynamic_pointer_cast<LValueNode>(x->getExpr())) {
+                    if (!y->isArray()) address_taken.insert(y->getSymbol().get());
+                }
+            }
+        } else if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(node)) {
+            if ((x->getOp() == A_DIVIDE || x->getOp() == A_MOD) && x->getCalType() != P_FLOAT) {
+                clobbered.insert("%rdx"); // idiv 使用 %rdx:%rax
+                if (x->getCalType() == P_CHAR) clobbered.insert("%rcx"); // char 除法把除数放在 %ecx
+            } else if (x->getOp() == A_LSHIFT || x->getOp() == A_RSHIFT) {
+                clobbered.insert("%rcx"); // 移位次数放在 %cl
+            }
+        } else if (std::dynamic_pointer_cast<FunctionCallNode>(node) || std::dynamic_pointer_cast<PrintStatementNode>(node)) {
+            is_leaf = false;
+        }
+    };
+    for (const auto& node : extra) forEachNode(node, visit);
+    forEachNode(func->getBody(), visit);
+
+    std::vector<Candidate> sorted;
+    for (const auto& [sym, cand] : candidates) {
+        if (address_taken.count(sym) == 0) sorted.push_back(cand);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const Candidate& a, const Candidate& b) {
+        if (a.weight != b.weight) return a.weight > b.weight;
+        return a.order < b.order;
+    });
+
+    std::vector<std::string> int_pool; // 可用的通用寄存器，按代价从低到高排列
+    std::vector<std::string> float_pool;
+    std::set<std::string> reserved; // 仍保存着传入参数的寄存器
+    if (is_leaf) {
+        int int_idx = 0, float_idx = 0;
+        for (const auto& param : params) {
+            if (param->type == P_FLOAT) {
+                if (float_idx < (int)float_param_regs.size()) reserved.insert(float_param_regs[float_idx++]);
+            } else if (int_idx < (int)int_param_regs.size()) {
+                reserved.insert(int_param_regs[int_idx++]);
+            }
+        }
+        for (const auto& reg : int_param_regs) {
+            if (!clobbered.count(reg) && !reserved.count(reg)) int_pool.push_back(reg);
+        }
+        float_pool = float_local_regs;
+    }
+    Function &function = symbol_table.getFunctionRef(func->getIdentifier());
+    std::vector<std::string> callee_saved = callee_saved_regs;
+    if (function.omitsFramePointer()) callee_saved.push_back("%rbp"); // 不建立栈帧时%rbp也是普通的被调用者保存寄存器
+    int_pool.insert(int_pool.end(), callee_saved.begin(), callee_saved.end());
+
+    // 参数优先留在传入的寄存器中，这样函数入口处不需要任何搬运
+    std::set<Symbol*> assigned;
+    if (is_leaf) {
+        int int_idx = 0, float_idx = 0;
+        for (const auto& param : params) {
+            std::string incoming;
+            if (param->type == P_FLOAT) {
+                if (float_idx < (int)float_param_regs.size()) incoming = float_param_regs[float_idx++];
+            } else if (int_idx < (int)int_param_regs.size()) {
+                incoming = int_param_regs[int_idx++];
+            }
+            if (incoming.empty() || clobbered.count(incoming)) continue;
+            if (candidates.count(param.get()) == 0 || address_taken.count(param.get())) continue;
+            param->home_reg = incoming;
+            assigned.insert(param.get());
+        }
+    }
+
+    std::vector<Symbol*> vars;
+    for (const auto& cand : sorted) vars.push_back(cand.symbol.get());
+    auto interference = buildInterference(func, params, vars);
+
+    // 按权重从高到低着色：取池中第一个没有被冲突的变量占用的寄存器，活跃范围不相交的变量可以共用一个寄存器
+    std::map<Symbol*, int> index;
+    for (size_t i = 0; i < vars.size(); i++) index[vars[i]] = i;
+    std::vector<std::string> colors(vars.size());
+    for (Symbol* sym : assigned) colors[index[sym]] = sym->home_reg;
+    std::set<std::string> saved; // 已经在序言中保存的被调用者保存寄存器
+    int promoted = 0;
+    for (size_t i = 0; i < sorted.size(); i++) {
+        Symbol *sym = sorted[i].symbol.get();
+        if (assigned.count(sym)) {
+            promoted++;
+            continue;
+        }
+        std::set<std::string> busy;
+        interference[i].forEach([&](size_t j) { busy.insert(colors[j]); });
+        auto &pool = sym->type == P_FLOAT ? float_pool : int_pool;
+        for (const auto& reg : pool) {
+            if (busy.count(reg)) continue;
+            bool is_callee_saved = std::find(callee_saved.begin(), callee_saved.end(), reg) != callee_saved.end();
+            // 被调用者保存寄存器需要额外的保存和恢复，只访问一两次的变量不值得，已经保存过的寄存器则可以直接共用
+            if (is_callee_saved && !saved.count(reg) && sorted[i].weight < 3) continue;
+            if (is_callee_saved && !saved.count(reg)) {
+                int slot = symbol_table.allocateFrameSlot(function.name, 8);
+                function.saved_regs.push_back({reg, slot});
+                saved.insert(reg);
+            }
+            sym->home_reg = reg;
+            colors[i] = reg;
+            promoted++;
+            break;
+        }
+    }
+    if (promoted) opt_stats.count(name(), func->getIdentifier(), promoted);
+}
+
+// 冲突图：变量被写入时，除了它自己之外所有在写入之后仍然活跃的变量都和它冲突。
+// 形如 v = e 的语句在算完 e 之后才写 v，e 中最后一次读取的变量可以和 v 共用寄存器；
+// 其他写入变量的语句中写入的时机不确定，语句中读写的所有变量都互相冲突。
+// 参数在函数入口同时写入，彼此冲突，也和入口处活跃的所有变量冲突
+std::vector<BitVector> RegisterPromotion::buildInterference(const std::shared_ptr<FunctionDeclareNode>& func,
+    const std::vector<std::shared_ptr<Symbol>>& params, const std::vector<Symbol*>& vars) {
+    ControlFlowGraph cfg(func);
+    Liveness liveness(cfg, vars);
+    const auto& index = liveness.getIndex();
+    std::vector<BitVector> interference(vars.size(), BitVector(vars.size()));
+    auto addConflicts = [&](size_t v, const BitVector& live) {
+        live.forEach([&](size_t u) {
+            if (u == v) return;
+            interference[v].set(u);
+            interference[u].set(v);
+        });
+    };
+
+    BitVector entry = liveness.liveIn(cfg.entry());
+    for (const auto& param : params) {
+        auto it = index.find(param.get());
+        if (it != index.end()) entry.set(it->second);
+    }
+    for (const auto& param : params) {
+        auto it = index.find(param.get());
+        if (it != index.end()) addConflicts(it->second, entry);
+    }
+
+    for (int b : cfg.reversePostorder()) {
+        liveness.walkBackward(b, [&](const std::shared_ptr<ASTNode>& node, const BitVector& live) {
+            BitVector uses(vars.size()), defs(vars.size());
+            nodeAccesses(node, index, uses, defs);
+            if (!defs.any()) return;
+            bool simple = defs.count() == 1 && (std::dynamic_pointer_cast<AssignmentNode>(node) || std::dynamic_pointer_cast<VariableDeclareNode>(node));
+            BitVector others = live;
+            if (!simple) {
+                others.unionWith(uses);
+                others.unionWith(defs);
+            }
+            defs.forEach([&](size_t v) { addConflicts(v, others); });
+        });
+    }
+    return interference;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include "optimizer/optimizer.h"
+#include "optimizer/dataflow.h"
+#include <set>
+
+// 把地址从未被 U_ADDR 取走的标量局部变量和参数提升到寄存器中，整个生命周期都不再访问栈。
+// 叶子函数可以使用调用者保存寄存器，参数直接留在传入的寄存器里；
+// 非叶子函数只能使用被调用者保存寄存器，并在函数序言/尾声中保存和恢复。
+// 在控制流图上做活跃变量分析，活跃范围不相交的变量共用同一个寄存器。
+class RegisterPromotion : public Pass {
+public:
+    std::string name() const override { return "mem2reg"; }
+    void run(const std::shared_ptr<Pragram>& program) override;
+private:
+    struct Candidate {
+        std::shared_ptr<Symbol> symbol;
+        long weight; // 按循环深度加权的引用次数
+        int order; // 首次出现的位置，权重相同时保持源代码顺序
+    };
+    void promoteFunction(const std::shared_ptr<FunctionDeclareNode>& func, const std::vector<std::shared_ptr<ASTNode>>& extra);
+    std::vector<BitVector> buildInterference(const std::shared_ptr<FunctionDeclareNode>& func,
+        const std::vector<std::shared_ptr<Symbol>>& params, const std::vector<Symbol*>& vars);
+};
@@ -0,0 +1,201 @@
+#include "optimizer/narrow.h"
+#include <cmath>
+
+// 整数类型的字节数，其他类型为0
+static int intWidth(PrimitiveType type) {
+    switch (type) {
+        case P_CHAR: return 1;
+        case P_INT: return 4;
+        case P_LONG: return 8;
+        default: return 0;
+    }
+}
+
+static bool isLiteral(const Value& value) {
+    return value.type != P_FLOAT || value.fvalue != 0 || !std::signbit(value.fvalue);
+}
+
+static bool isExtensionFrom(const std::shared_ptr<ExprNode>& expr, PrimitiveType from) {
+    auto x = std::dynamic_pointer_cast<UnaryExpNode>(expr);
+    return x != nullptr && x->getOp() == U_TRANSFORM && x->getExpr()->getPrimitiveType() == from && intWidth(x->getPrimitiveType()) > intWidth(from);
+}
+
+void TypeNarrowing::run(const std::shared_ptr<Pragram>& program) {
+    for (const auto& func : program->getFunctions()) {
+        narrowed = 0;
+        narrowStatement(func->getBody());
+        if (narrowed) opt_stats.count(name(), func->getIdentifier(), narrowed);
+    }
+}
+
+// 向量循环中的表达式形式固定，不做改写
+void TypeNarrowing::narrowStatement(const std::shared_ptr<StatementNode>& stmt) {
+    if (stmt == nullptr) return;
+    if (auto x = std::dynamic_pointer_cast<ExprNode>(stmt)) {
+        narrowExpr(x);
+    } else if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        for (const auto& s : x->getStatements()) {
+            narrowStatement(s);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<PrintStatementNode>(stmt)) {
+        x->setExpression(narrowExpr(x->getExpression()));
+    } else if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(stmt)) {
+        for (const auto& sym : x->getSymbols()) {
+            auto init = x->getInitializer(*sym);
+            if (init != nullptr && !sym->is_array) x->setInitializer(*sym, narrowExpr(init));
+        }
+    } else if (auto x = std::dynamic_pointer_cast<IfStatementNode>(stmt)) {
+        x->setCondition(narrowExpr(x->getCondition()));
+        narrowStatement(x->getThenStatement());
+        narrowStatement(x->getElseStatement());
+    } else if (auto x = std::dynamic_pointer_cast<SwitchStatementNode>(stmt)) {
+        x->setCondition(narrowExpr(x->getCondition()));
+        for (const auto& c : x->getCases()) {
+            narrowStatement(c.body);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(stmt)) {
+        x->setCondition(narrowExpr(x->getCondition()));
+        narrowStatement(x->getBody());
+    } else if (auto x = std::dynamic_pointer_cast<ForStatementNode>(stmt)) {
+        narrowStatement(x->getPreopStatement());
+        if (x->getCondition() != nullptr) x->setCondition(narrowExpr(x->getCondition()));
+        narrowStatement(x->getBody());
+        narrowStatement(x->getPostopStatement());
+    } else if (auto x = std::dynamic_pointer_cast<ReturnStatementNode>(stmt)) {
+        if (x->getExpression() != nullptr) x->setExpression(narrowExpr(x->getExpression()));
+    }
+}
+
+// 先改写子表达式，再看当前结点能否替换。赋值目标和取地址、自增自减的操作数只会改写其中的下标
+std::shared_ptr<ExprNode> TypeNarrowing::narrowExpr(const std::shared_ptr<ExprNode>& expr) {
+    if (auto x = std::dynamic_pointer_cast<LValueNode>(expr)) {
+        if (x->getIndex() == nullptr) return expr;
+        // 语义分析给缩放后的下标套上的 long→int 转换并不截断，代码生成按 long 使用下标的寄存器，
+        // 不能当成只用到低32位，直接去掉
+        auto index = x->getIndex();
+        auto y = std::dynamic_pointer_cast<UnaryExpNode>(index);
+        if (y != nullptr && y->getOp() == U_TRANSFORM && y->getPrimitiveType() == P_INT && y->getExpr()->getPrimitiveType() == P_LONG) {
+            index = y->getExpr();
+        }
+        x->setIndex(narrowExpr(index));
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(expr)) {
+        x->setExpr(narrowExpr(x->getExpr()));
+        return narrowUnary(x);
+    } else if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(expr)) {
+        x->setLeft(narrowExpr(x->getLeft()));
+        x->setRight(narrowExpr(x->getRight()));
+    } else if (auto x = std::dynamic_pointer_cast<FunctionCallNode>(expr)) {
+        std::vector<std::shared_ptr<ExprNode>> args;
+        for (const auto& arg : x->getArguments()) {
+            args.push_back(narrowExpr(arg));
+        }
+        x->setArguments(args);
+    } else if (auto x = std::dynamic_pointer_cast<AssignmentNode>(expr)) {
+        narrowExpr(x->getLvalue());
+        x->setExpr(narrowExpr(x->getExpr()));
+    }
+    return expr;
+}
+
+std::shared_ptr<ExprNode> TypeNarrowing::narrowUnary(const std::shared_ptr<UnaryExpNode>& expr) {
+    UnaryOp op = expr->getOp();
+    if (op == U_SCALE) {
+        // 常量下标直接算出字节偏移，省掉 movl/movslq/salq 三条指令
+        Value value;
+        if (evalConstant(expr->getExpr(), value) && intWidth(value.type)) {
+            long index = value.type == P_LONG ? value.lvalue : value.ivalue;
+            narrowed++;
+            return makeConstant(Value{.type = P_LONG, .lvalue = (long)((unsigned long)index * expr->getOffset())});
+        }
+        // 无符号的 char 先扩展成 int 再扩展成 long，等于一次零扩展
+        if (expr->getExpr()->getPrimitiveType() == P_INT && isExtensionFrom(expr->getExpr(), P_CHAR)) {
+            auto inner = std::dynamic_pointer_cast<UnaryExpNode>(expr->getExpr())->getExpr();
+            expr->setExpr(std::make_shared<UnaryExpNode>(U_TRANSFORM, inner, P_LONG));
+            narrowed++;
+        }
+        return expr;
+    }
+    if (op != U_TRANSFORM) return expr;
+
+    Value value;
+    if (evalConstant(expr, value) && isLiteral(value)) {
+        narrowed++;
+        return makeConstant(value);
+    }
+    PrimitiveType to = expr->getPrimitiveType();
+    auto inner = std::dynamic_pointer_cast<UnaryExpNode>(expr->getExpr());
+    if (inner != nullptr && inner->getOp() == U_TRANSFORM && intWidth(to)) {
+        // 两次转换合成一次：先扩展再截断回不比原来窄的类型时只剩下一次扩展（或者什么都不剩），
+        // char 是无符号的，经过 int 扩展成 long 和直接零扩展相同
+        PrimitiveType from = inner->getExpr()->getPrimitiveType();
+        PrimitiveType mid = inner->getPrimitiveType();
+        bool widen = intWidth(from) && intWidth(mid) >= intWidth(to) && intWidth(to) >= intWidth(from);
+        bool zero_extend = from == P_CHAR && intWidth(mid) > 1 && intWidth(to) > 1;
+        if (widen || zero_extend) {
+            narrowed++;
+            if (to == from) return inner->getExpr();
+            return std::make_shared<UnaryExpNode>(U_TRANSFORM, inner->getExpr(), to);
+        }
+    }
+    // 截断成 int 或 char 的 long 运算只需要低32位
+    if ((to == P_INT || to == P_CHAR) && expr->getExpr()->getPrimitiveType() == P_LONG) {
+        auto low = lowBits(expr->getExpr());
+        if (low != nullptr) {
+            narrowed++;
+            if (to == P_INT) return low;
+            expr->setExpr(low);
+        }
+    }
+    return expr;
+}
+
+// 计算 long 表达式低32位的 int 表达式，不能只用32位运算算出来时返回空。
+// 不修改原来的结点，子表达式的求值顺序不变
+std::shared_ptr<ExprNode> TypeNarrowing::lowBits(const std::shared_ptr<ExprNode>& expr) const {
+    if (expr->getPrimitiveType() != P_LONG) return nullptr;
+    if (auto x = std::dynamic_pointer_cast<ValueNode>(expr)) {
+        Value value = x->getValue();
+        if (value.type != P_LONG) return nullptr;
+        return makeConstant(Value{.type = P_INT, .ivalue = (int)value.lvalue});
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(expr)) {
+        if (x->getOp() != U_TRANSFORM) return nullptr;
+        PrimitiveType from = x->getExpr()->getPrimitiveType();
+        if (from == P_INT) return x->getExpr();
+        if (from == P_CHAR) return std::make_shared<UnaryExpNode>(U_TRANSFORM, x->getExpr(), P_INT);
+    } else if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(expr)) {
+        ExprType op = x->getOp();
+        if (x->getCalType() != P_LONG) return nullptr;
+        if (op == A_LSHIFT || op == A_RSHIFT) {
+            // 移位次数是0到31的常量时，32位移位的结果就是64位移位结果的低32位。
+            // 64位的右移是逻辑右移，左操作数是 int 的符号扩展时低32位等于 int 的算术右移
+            Value count;
+            if (!evalConstant(x->getRight(), count) || (count.type != P_CHAR && count.type != P_INT)) return nullptr;
+            if (count.ivalue < 0 || count.ivalue >= 32) return nullptr;
+            std::shared_ptr<ExprNode> left;
+            if (op == A_LSHIFT) {
+                left = lowBits(x->getLeft());
+            } else if (isExtensionFrom(x->getLeft(), P_INT)) {
+                left = std::dynamic_pointer_cast<UnaryExpNode>(x->getLeft())->getExpr();
+            } else if (auto y = std::dynamic_pointer_cast<ValueNode>(x->getLeft()); y != nullptr && y->getValue().type == P_LONG
+                && y->getValue().lvalue == (int)y->getValue().lvalue) {
+                left = makeConstant(Value{.type = P_INT, .ivalue = (int)y->getValue().lvalue});
+            }
+            if (left == nullptr) return nullptr;
+            auto ret = std::make_shared<BinaryExpNode>(op, left, x->getRight());
+            ret->updateCalType();
+            ret->setPrimitiveType(P_INT); // updateTypeAfterCal 总是把移位的结果定为 long
+            return ret;
+        }
+        // 加减乘和位运算结果的低32位只取决于操作数的低32位
+        if (op != A_ADD && op != A_SUBTRACT && op != A_MULTIPLY && op != A_AND && op != A_OR && op != A_XOR) return nullptr;
+        auto left = lowBits(x->getLeft());
+        if (left == nullptr) return nullptr;
+        auto right = lowBits(x->getRight());
+        if (right == nullptr) return nullptr;
+        auto ret = std::make_shared<BinaryExpNode>(op, left, right);
+        ret->updateCalType();
+        ret->updateTypeAfterCal();
+        return ret;
+    }
+    return nullptr;
+}
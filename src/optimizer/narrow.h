@@ -0,0 +1,20 @@
+#pragma once
+#include "optimizer/optimizer.h"
+#include "optimizer/ast_utils.h"
+
+// 类型收窄：语义分析为了统一运算类型随手插入 int→long 的扩展，移位的左操作数总是扩展成 long，数组下标按 long 缩放，
+// 结果又被截断回 int 时中间的64位运算和符号扩展都是多余的。这里把只有低32位被用到的 long 运算改写成 int 运算，
+// 抵消一对互逆的类型转换，常量上的类型转换和下标缩放在编译期算掉，只在扩展后的高位真正被读到的地方保留转换。
+// 剩下的从变量和内存读出后立即扩展的转换由代码生成合并进 movslq/movzbl 装载
+class TypeNarrowing : public Pass {
+public:
+    std::string name() const override { return "narrow"; }
+    void run(const std::shared_ptr<Pragram>& program) override;
+private:
+    int narrowed;
+
+    void narrowStatement(const std::shared_ptr<StatementNode>& stmt);
+    std::shared_ptr<ExprNode> narrowExpr(const std::shared_ptr<ExprNode>& expr);
+    std::shared_ptr<ExprNode> narrowUnary(const std::shared_ptr<UnaryExpNode>& expr);
+    std::shared_ptr<ExprNode> lowBits(const std::shared_ptr<ExprNode>& expr) const;
+};
@@ -0,0 +1,62 @@
+#include "optimizer/optimizer.h"
+#include "optimizer/mem2reg.h"
+#include "optimizer/licm.h"
+#include "optimizer/ivsr.h"
+#include "optimizer/gvn.h"
+#include "optimizer/vectorize.h"
+#include "optimizer/inline.h"
+#include "optimizer/tailcall.h"
+#include "optimizer/dce.h"
+#include "optimizer/sccp.h"
+#include "optimizer/profile.h"
+#include "optimizer/narrow.h"
+#include "optimizer/unroll.h"
+#include "optimizer/ipcp.h"
+
+OptStats opt_stats;
+
+void OptStats::print(std::ostream &out) const {
+    out << "Optimization statistics:" << std::endl;
+    for (const auto& [pass, funcs] : counters) {
+        for (const auto& [func, n] : funcs) {
+            out << "\t" << pass << "\t" << func << "\t" << n << std::endl;
+        }
+    }
+}
+
+Optimizer::Optimizer(std::shared_ptr<Pragram> ast) : ast(ast) {
+    // 计数点在任何变换之前按源代码编号，插桩和使用 profile 的两次编译才能对上
+    if (compiler_options.profile_generate) passes.push_back(std::make_unique<ProfileFeedback>(true));
+    else if (!compiler_options.profile_use.empty()) passes.push_back(std::make_unique<ProfileFeedback>(false));
+    // 内联最先执行，展开后的函数体和调用者一起参与后面的循环优化
+    passes.push_back(std::make_unique<FunctionInlining>());
+    // 没有内联的调用中传入的常量代入被调用函数，由后面的常量传播折叠
+    passes.push_back(std::make_unique<InterproceduralConstantPropagation>());
+    // 尾递归改写成循环之后，循环体还可以继续做循环优化
+    passes.push_back(std::make_unique<TailCallOptimization>());
+    // 内联进来的实参和局部常量代入之后，条件可能变成常量，循环边界也变成立即数
+    passes.push_back(std::make_unique<ConstantPropagation>());
+    // 先删掉内联和常量条件留下的死代码，后面的循环优化只需要处理真正执行的语句
+    passes.push_back(std::make_unique<DeadCodeElimination>());
+    // 向量化要在外提和强度削弱之前识别 a[i] 形式的数组访问
+    passes.push_back(std::make_unique<LoopVectorization>());
+    // 展开后每份循环体中的 a[i + k] 还要经过外提、强度削弱和值编号
+    passes.push_back(std::make_unique<LoopUnrolling>());
+    passes.push_back(std::make_unique<LoopInvariantCodeMotion>());
+    passes.push_back(std::make_unique<InductionVariableStrengthReduction>());
+    // 循环中的表达式已经外提，剩下的重复计算在支配区域内复用
+    passes.push_back(std::make_unique<GlobalValueNumbering>());
+    // 外提和强度削弱之后原来的变量可能不再被读到
+    passes.push_back(std::make_unique<DeadCodeElimination>());
+    // 前面的遍按语义分析给出的类型生成表达式，最后再把只用到低32位的 long 运算收窄
+    passes.push_back(std::make_unique<TypeNarrowing>());
+    // 寄存器提升必须最后执行，前面的遍可能会引入新的局部变量
+    passes.push_back(std::make_unique<RegisterPromotion>());
+}
+
+void Optimizer::optimize() {
+    for (auto& pass : passes) {
+        if (compiler_options.enable_log) std::cout << "Running pass " << pass->name() << "." << std::endl;
+        pass->run(ast);
+    }
+}
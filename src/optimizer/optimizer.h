@@ -0,0 +1,41 @@
+#pragma once
+#include "common/defs.h"
+#include "parser/parser.h"
+#include <memory>
+#include <vector>
+
+// 记录每个优化遍在每个函数上的变换次数，用于 -fopt-stats 输出
+class OptStats {
+public:
+    void count(const std::string &pass, const std::string &func, int n = 1) {
+        counters[pass][func] += n;
+    }
+    int get(const std::string &pass, const std::string &func) const {
+        auto it = counters.find(pass);
+        if (it == counters.end()) return 0;
+        auto jt = it->second.find(func);
+        return jt == it->second.end() ? 0 : jt->second;
+    }
+    void print(std::ostream &out) const;
+private:
+    std::map<std::string, std::map<std::string, int>> counters;
+};
+
+extern OptStats opt_stats;
+
+// 所有优化遍的基类，每个遍在语义检查之后、代码生成之前改写AST或符号表
+class Pass {
+public:
+    virtual ~Pass() = default;
+    virtual std::string name() const = 0;
+    virtual void run(const std::shared_ptr<Pragram>& program) = 0;
+};
+
+class Optimizer {
+public:
+    Optimizer(std::shared_ptr<Pragram> ast);
+    void optimize();
+private:
+    std::shared_ptr<Pragram> ast;
+    std::vector<std::unique_ptr<Pass>> passes;
+};
@@ -0,0 +1,131 @@
+#include "optimizer/profile.h"
+#include <fstream>
+
+void ProfileFeedback::run(const std::shared_ptr<Pragram>& program) {
+    counts.clear();
+    long checksum = walkProgram(program);
+    if (instrument) {
+        program->setProfileCounters(next, checksum);
+        return;
+    }
+    // 先编号算出校验和，profile 和程序对得上时再标注一遍
+    if (readProfile(checksum)) walkProgram(program);
+}
+
+// 按函数顺序给计数点编号，返回由函数名和每个函数的计数点个数算出的校验和（FNV-1a）
+long ProfileFeedback::walkProgram(const std::shared_ptr<Pragram>& program) {
+    unsigned long hash = 14695981039346656037UL;
+    next = 0;
+    for (const auto& func : program->getFunctions()) {
+        int first = next;
+        std::shared_ptr<StatementNode> body = func->getBody();
+        long count = probe(body);
+        func->setProfileCount(count);
+        walkBlock(func->getBody(), count);
+        if (instrument || !counts.empty()) opt_stats.count(name(), func->getIdentifier(), next - first);
+        for (char c : func->getIdentifier() + ":" + std::to_string(next - first) + ";") {
+            hash = (hash ^ (unsigned char)c) * 1099511628211UL;
+        }
+    }
+    return (long)hash;
+}
+
+// 文件的第一行是校验和与计数器个数，之后每行一个计数
+bool ProfileFeedback::readProfile(long checksum) {
+    const std::string& file = compiler_options.profile_use;
+    std::ifstream in(file);
+    if (!in) {
+        std::cerr << "Warning: cannot open profile " << file << ", compiling without it" << std::endl;
+        return false;
+    }
+    long file_checksum, n;
+    if (!(in >> file_checksum >> n) || file_checksum != checksum || n != next) {
+        std::cerr << "Warning: profile " << file << " does not match the program, ignored" << std::endl;
+        return false;
+    }
+    counts.assign(n, 0);
+    for (long& count : counts) {
+        if (!(in >> count) || count < 0) {
+            std::cerr << "Warning: profile " << file << " is truncated, ignored" << std::endl;
+            counts.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+// 在body开头分配一个计数点，返回读入的执行次数，插桩或者没有 profile 时返回-1。
+// 插桩时不是块的body包成块，没有 else 的 if 也会得到一个只有计数器的 else 块
+long ProfileFeedback::probe(std::shared_ptr<StatementNode>& body) {
+    int index = next++;
+    if (!instrument) return index < (int)counts.size() ? counts[index] : -1;
+    auto counter = std::make_shared<ProfileCounterNode>(index);
+    if (auto block = std::dynamic_pointer_cast<BlockNode>(body)) {
+        auto stmts = block->getStatements();
+        stmts.insert(stmts.begin(), counter);
+        block->setStatements(stmts);
+        return -1;
+    }
+    auto block = std::make_shared<BlockNode>();
+    block->addStatement(counter);
+    if (body != nullptr) block->addStatement(body);
+    body = block;
+    return -1;
+}
+
+void ProfileFeedback::walkBlock(const std::shared_ptr<BlockNode>& block, long count) {
+    for (const auto& stmt : block->getStatements()) {
+        walkStatement(stmt, count);
+    }
+}
+
+// count是stmt所在的块的执行次数
+void ProfileFeedback::walkStatement(const std::shared_ptr<StatementNode>& stmt, long count) {
+    if (stmt == nullptr) return;
+    if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        walkBlock(x, count);
+    } else if (auto x = std::dynamic_pointer_cast<IfStatementNode>(stmt)) {
+        annotateCalls(x->getCondition(), count);
+        auto then_stmt = x->getThenStatement();
+        auto else_stmt = x->getElseStatement();
+        long then_count = probe(then_stmt);
+        long else_count = probe(else_stmt);
+        walkStatement(then_stmt, then_count);
+        walkStatement(else_stmt, else_count);
+        if (instrument) {
+            x->setThenStatement(then_stmt);
+            x->setElseStatement(else_stmt);
+        } else {
+            x->setProfileCounts(then_count, else_count);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(stmt)) {
+        auto body = x->getBody();
+        long body_count = probe(body);
+        annotateCalls(x->getCondition(), body_count);
+        walkStatement(body, body_count);
+        x->setBody(body);
+    } else if (auto x = std::dynamic_pointer_cast<ForStatementNode>(stmt)) {
+        walkStatement(x->getPreopStatement(), count);
+        auto body = x->getBody();
+        long body_count = probe(body);
+        annotateCalls(x->getCondition(), body_count);
+        walkStatement(body, body_count);
+        walkStatement(x->getPostopStatement(), body_count);
+        x->setBody(body);
+    } else if (auto x = std::dynamic_pointer_cast<SwitchStatementNode>(stmt)) {
+        annotateCalls(x->getCondition(), count);
+        for (const auto& c : x->getCases()) {
+            std::shared_ptr<StatementNode> body = c.body;
+            walkStatement(body, probe(body));
+        }
+    } else {
+        annotateCalls(stmt, count);
+    }
+}
+
+void ProfileFeedback::annotateCalls(const std::shared_ptr<ASTNode>& node, long count) {
+    if (instrument) return;
+    forEachNode(node, [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (auto x = std::dynamic_pointer_cast<FunctionCallNode>(n)) x->setProfileCount(count);
+    });
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "optimizer/optimizer.h"
+#include "optimizer/ast_utils.h"
+
+// 基于 profile 的优化。-fprofile-generate 在函数入口、if 的两个分支、循环体和 switch 每个分支的开头插入计数器，
+// 程序退出时由 src/lib/profile.c 把计数写进 profile 文件，多次运行的计数累加。
+// -fprofile-use 按同样的顺序给计数点编号，把读入的次数标在函数、if 和调用点上：
+// 代码生成让执行得多的分支落空、把从没执行过的分支和函数放进 .text.unlikely，内联按调用点的冷热调整阈值。
+// 两种模式都在其他优化之前运行，编号只取决于源代码；计数器布局的校验和对不上时忽略整个 profile。
+class ProfileFeedback : public Pass {
+public:
+    explicit ProfileFeedback(bool instrument) : instrument(instrument) {}
+    std::string name() const override { return instrument ? "profile-generate" : "profile-use"; }
+    void run(const std::shared_ptr<Pragram>& program) override;
+private:
+    bool instrument; // 插入计数器，否则读入 profile
+    std::vector<long> counts; // 读入的计数，下标是计数器编号
+    int next; // 下一个计数点的编号
+
+    long walkProgram(const std::shared_ptr<Pragram>& program);
+    bool readProfile(long checksum);
+    long probe(std::shared_ptr<StatementNode>& body);
+    void walkBlock(const std::shared_ptr<BlockNode>& block, long count);
+    void walkStatement(const std::shared_ptr<StatementNode>& stmt, long count);
+    void annotateCalls(const std::shared_ptr<ASTNode>& node, long count);
+};
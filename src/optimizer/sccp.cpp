@@ -0,0 +1,355 @@
+#include "optimizer/sccp.h"
+#include <cstring>
+#include <cmath>
+
+// 浮点常量按值在数据段中共用标号，-0.0 会被当成 0.0，不能写成字面量
+static bool isLiteral(const Value& value) {
+    return value.type != P_FLOAT || value.fvalue != 0 || !std::signbit(value.fvalue);
+}
+
+static bool isTrue(const Value& value) {
+    if (value.type == P_FLOAT) return value.fvalue != 0;
+    if (value.type == P_LONG) return value.lvalue != 0;
+    return value.ivalue != 0;
+}
+
+bool ConstantPropagation::Fact::operator==(const Fact& other) const {
+    if (copy != nullptr || other.copy != nullptr) return copy == other.copy;
+    if (value.type != other.value.type) return false;
+    // 0.0 和 -0.0 是不同的常量
+    if (value.type == P_FLOAT) return std::memcmp(&value.fvalue, &other.value.fvalue, sizeof(double)) == 0;
+    if (value.type == P_LONG) return value.lvalue == other.value.lvalue;
+    return value.ivalue == other.value.ivalue;
+}
+
+bool ConstantPropagation::State::operator==(const State& other) const {
+    return reachable == other.reachable && facts == other.facts;
+}
+
+void ConstantPropagation::run(const std::shared_ptr<Pragram>& program) {
+    for (const auto& func : program->getFunctions()) {
+        func_name = func->getIdentifier();
+        address_taken = collectAddressTaken(func);
+        label_state.clear();
+        replaced = 0;
+        // 参数和没有初值的变量不在状态中，值未知
+        State state;
+        walkBlock(func->getBody(), state, true);
+        if (replaced) opt_stats.count(name(), func_name, replaced);
+    }
+}
+
+// 参与分析的变量：不会通过指针或在其他函数中被访问的局部标量
+bool ConstantPropagation::isTracked(const Symbol* sym) const {
+    return !sym->is_global && !sym->is_array && !address_taken.count(const_cast<Symbol*>(sym));
+}
+
+ConstantPropagation::State ConstantPropagation::unreachable() {
+    State state;
+    state.reachable = false;
+    return state;
+}
+
+// 汇合点上只保留所有可达的前驱都相同的值
+ConstantPropagation::State ConstantPropagation::meet(const State& a, const State& b) {
+    if (!a.reachable) return b;
+    if (!b.reachable) return a;
+    State ret;
+    for (const auto& [sym, fact] : a.facts) {
+        auto it = b.facts.find(sym);
+        if (it != b.facts.end() && it->second == fact) ret.facts[sym] = fact;
+    }
+    return ret;
+}
+
+// sym被写入，fact为空表示新值未知。原来等于sym的拷贝不再成立
+void ConstantPropagation::assign(State& state, Symbol* sym, const Fact* fact) const {
+    for (auto it = state.facts.begin(); it != state.facts.end();) {
+        if (it->second.copy.get() == sym) it = state.facts.erase(it);
+        else ++it;
+    }
+    if (fact != nullptr && fact->copy.get() != sym) state.facts[sym] = *fact;
+    else state.facts.erase(sym);
+}
+
+void ConstantPropagation::killWrites(State& state, const std::shared_ptr<ASTNode>& node) const {
+    for (Symbol* sym : collectSideEffects(node).written) {
+        if (isTracked(sym)) assign(state, sym, nullptr);
+    }
+}
+
+// 把已知是常量的变量代入后计算expr
+bool ConstantPropagation::evaluate(const std::shared_ptr<ExprNode>& expr, const State& state, Value& value) const {
+    if (expr == nullptr || !state.reachable) return false;
+    std::map<Symbol*, std::shared_ptr<ExprNode>> subst;
+    bool known = true;
+    forEachNode(expr, [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (auto x = std::dynamic_pointer_cast<LValueNode>(n)) {
+            auto it = state.facts.find(x->getSymbol().get());
+            if (x->isArray() || it == state.facts.end() || it->second.copy != nullptr) known = false;
+            else subst[it->first] = std::make_shared<ValueNode>(it->second.value);
+        } else if (std::dynamic_pointer_cast<FunctionCallNode>(n) || std::dynamic_pointer_cast<AssignmentNode>(n)) {
+            known = false;
+        }
+    });
+    return known && evalConstant(cloneExpr(expr, subst), value);
+}
+
+// 表达式内部（赋值、自增自减）写入的变量
+std::set<Symbol*> ConstantPropagation::nestedWrites(const std::shared_ptr<ExprNode>& expr) const {
+    std::set<Symbol*> ret;
+    for (Symbol* sym : collectSideEffects(expr).written) {
+        if (isTracked(sym)) ret.insert(sym);
+    }
+    return ret;
+}
+
+void ConstantPropagation::walkBlock(const std::shared_ptr<BlockNode>& block, State& state, bool rewrite) {
+    for (const auto& stmt : block->getStatements()) {
+        walkStatement(stmt, state, rewrite);
+    }
+}
+
+// state进入时是stmt之前的状态，返回时是stmt之后的状态。rewrite为true时按进入时的状态改写变量的读取
+void ConstantPropagation::walkStatement(const std::shared_ptr<StatementNode>& stmt, State& state, bool rewrite) {
+    // 不可达的代码留给死代码删除
+    if (stmt == nullptr || !state.reachable) return;
+    if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        walkBlock(x, state, rewrite);
+    } else if (auto x = std::dynamic_pointer_cast<IfStatementNode>(stmt)) {
+        x->setCondition(rewriteCondition(x->getCondition(), state, rewrite));
+        killWrites(state, x->getCondition());
+        Value value;
+        State then_state = state, else_state = state;
+        if (!hasSideEffects(x->getCondition()) && evaluate(x->getCondition(), state, value)) {
+            if (isTrue(value)) else_state = unreachable();
+            else then_state = unreachable();
+        }
+        walkStatement(x->getThenStatement(), then_state, rewrite);
+        walkStatement(x->getElseStatement(), else_state, rewrite);
+        state = meet(then_state, else_state);
+    } else if (auto x = std::dynamic_pointer_cast<SwitchStatementNode>(stmt)) {
+        x->setCondition(rewriteCondition(x->getCondition(), state, rewrite));
+        killWrites(state, x->getCondition());
+        // 条件是常量时只有匹配的分支（没有时是 default）可以从 switch 进入，其他分支只能从上一个分支落下来
+        Value value;
+        long key = 0;
+        bool known = !hasSideEffects(x->getCondition()) && evaluate(x->getCondition(), state, value) && value.type != P_FLOAT;
+        if (known) key = value.type == P_LONG ? value.lvalue : value.ivalue;
+        const auto& cases = x->getCases();
+        int target = -1;
+        if (known) {
+            for (size_t i = 0; i < cases.size(); i++) {
+                for (long v : cases[i].values) {
+                    if (v == key) target = i;
+                }
+            }
+            for (size_t i = 0; i < cases.size() && target < 0; i++) {
+                if (cases[i].is_default) target = i;
+            }
+        }
+        label_state[x->getSwitchEndLabel()] = unreachable();
+        State fall = unreachable();
+        for (size_t i = 0; i < cases.size(); i++) {
+            State entry = !known || (int)i == target ? state : unreachable();
+            fall = meet(fall, entry);
+            walkBlock(cases[i].body, fall, rewrite);
+        }
+        State after = meet(fall, label_state[x->getSwitchEndLabel()]);
+        if (known ? target < 0 : !x->hasDefault()) after = meet(after, state);
+        state = after;
+    } else if (std::dynamic_pointer_cast<WhileStatementNode>(stmt) || std::dynamic_pointer_cast<ForStatementNode>(stmt)) {
+        walkLoop(stmt, state, rewrite);
+    } else if (auto x = std::dynamic_pointer_cast<BreakStatementNode>(stmt)) {
+        label_state[x->getLabel()] = meet(label_state[x->getLabel()], state);
+        state = unreachable();
+    } else if (auto x = std::dynamic_pointer_cast<ContinueStatementNode>(stmt)) {
+        label_state[x->getLabel()] = meet(label_state[x->getLabel()], state);
+        state = unreachable();
+    } else if (auto x = std::dynamic_pointer_cast<ReturnStatementNode>(stmt)) {
+        if (rewrite && x->getExpression() != nullptr) {
+            x->setExpression(rewriteExpr(x->getExpression(), state, nestedWrites(x->getExpression())));
+        }
+        state = unreachable();
+    } else if (auto x = std::dynamic_pointer_cast<PrintStatementNode>(stmt)) {
+        if (rewrite) x->setExpression(rewriteExpr(x->getExpression(), state, nestedWrites(x->getExpression())));
+        killWrites(state, x->getExpression());
+    } else if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(stmt)) {
+        // 没有初值的声明不改变状态，循环中上一次迭代留下的值仍可能被读到
+        for (const auto& sym : x->getSymbols()) {
+            auto init = x->getInitializer(*sym);
+            if (init == nullptr) continue;
+            if (sym->is_array) {
+                killWrites(state, init);
+                continue;
+            }
+            if (rewrite) {
+                init = rewriteExpr(init, state, nestedWrites(init));
+                x->setInitializer(*sym, init);
+            }
+            killWrites(state, init);
+            if (isTracked(sym.get())) walkAssign(sym, init, state);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<AssignmentNode>(stmt)) {
+        // 右边和写入目标中的下标先求值，其中写入的变量在这条语句中不替换
+        std::set<Symbol*> skip = nestedWrites(x->getExpr());
+        for (Symbol* sym : nestedWrites(x->getLvalue())) {
+            skip.insert(sym);
+        }
+        if (rewrite) {
+            rewriteTarget(x->getLvalue(), state, skip);
+            x->setExpr(rewriteExpr(x->getExpr(), state, skip));
+        }
+        for (Symbol* sym : skip) {
+            assign(state, sym, nullptr);
+        }
+        auto lvalue = std::dynamic_pointer_cast<LValueNode>(x->getLvalue());
+        if (lvalue != nullptr && !lvalue->isArray() && isTracked(lvalue->getSymbol().get())) walkAssign(lvalue->getSymbol(), x->getExpr(), state);
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(stmt)) {
+        UnaryOp op = x->getOp();
+        auto lvalue = std::dynamic_pointer_cast<LValueNode>(x->getExpr());
+        bool incdec = op == U_PREINC || op == U_PREDEC || op == U_POSTINC || op == U_POSTDEC;
+        if (incdec && lvalue != nullptr && !lvalue->isArray() && isTracked(lvalue->getSymbol().get())) {
+            auto sym = lvalue->getSymbol();
+            auto it = state.facts.find(sym.get());
+            Fact fact;
+            long delta = op == U_PREINC || op == U_POSTINC ? 1 : -1;
+            bool known = it != state.facts.end() && it->second.copy == nullptr;
+            if (known && it->second.value.type == P_FLOAT) {
+                fact.value = Value{.type = P_FLOAT, .fvalue = it->second.value.fvalue + delta};
+            } else if (known) {
+                const Value& old = it->second.value;
+                long v = old.type == P_LONG ? old.lvalue : old.ivalue;
+                known = convertConstant(Value{.type = P_LONG, .lvalue = (long)((unsigned long)v + delta)}, sym->type, fact.value);
+            }
+            assign(state, sym.get(), known ? &fact : nullptr);
+            return;
+        }
+        if (rewrite && incdec) rewriteTarget(x->getExpr(), state, nestedWrites(x));
+        killWrites(state, x);
+    } else if (auto x = std::dynamic_pointer_cast<FunctionCallNode>(stmt)) {
+        if (rewrite) rewriteExpr(x, state, nestedWrites(x));
+        killWrites(state, x);
+    } else {
+        // 向量循环、计数器等
+        killWrites(state, stmt);
+    }
+}
+
+// 把expr的值赋给sym之后的状态
+void ConstantPropagation::walkAssign(const std::shared_ptr<Symbol>& sym, const std::shared_ptr<ExprNode>& expr, State& state) const {
+    Fact fact;
+    Value value;
+    if (!hasSideEffects(expr) && evaluate(expr, state, value) && convertConstant(value, sym->type, fact.value) && isLiteral(fact.value)) {
+        assign(state, sym.get(), &fact);
+        return;
+    }
+    // 同类型变量之间的拷贝
+    auto y = std::dynamic_pointer_cast<LValueNode>(expr);
+    if (y != nullptr && !y->isArray() && isTracked(y->getSymbol().get()) && y->getSymbol()->type == sym->type) {
+        auto it = state.facts.find(y->getSymbol().get());
+        if (it != state.facts.end()) fact = it->second;
+        else fact.copy = y->getSymbol();
+        assign(state, sym.get(), &fact);
+        return;
+    }
+    assign(state, sym.get(), nullptr);
+}
+
+// 循环头的状态迭代到不动点：一开始假设只有进入循环的那条边可达，每次迭代把循环体末尾和 continue 的状态汇合进来。
+// break 跳到循环之后，continue 跳到循环头（for 循环的 continue 跳过了后置语句）
+void ConstantPropagation::walkLoop(const std::shared_ptr<StatementNode>& loop, State& state, bool rewrite) {
+    auto x = std::dynamic_pointer_cast<WhileStatementNode>(loop);
+    auto y = std::dynamic_pointer_cast<ForStatementNode>(loop);
+    std::string start = x != nullptr ? x->getWhileStartLabel() : y->getForStartLabel();
+    std::string end = x != nullptr ? x->getWhileEndLabel() : y->getForEndLabel();
+    if (y != nullptr) walkStatement(y->getPreopStatement(), state, rewrite);
+    if (!state.reachable) return;
+
+    // 从循环头走一遍循环体，返回回到循环头的状态，exit是离开循环时的状态
+    auto iterate = [&](const State& head, bool rw, State& exit) {
+        label_state[start] = unreachable();
+        label_state[end] = unreachable();
+        State s = head;
+        std::shared_ptr<ExprNode> cond = x != nullptr ? x->getCondition() : y->getCondition();
+        if (rw) {
+            cond = rewriteCondition(cond, s, true);
+            if (x != nullptr) x->setCondition(cond);
+            else y->setCondition(cond);
+        }
+        killWrites(s, cond);
+        Value value;
+        bool known = cond == nullptr || (!hasSideEffects(cond) && evaluate(cond, s, value));
+        bool taken = cond == nullptr || isTrue(value);
+        State body = !known || taken ? s : unreachable();
+        walkStatement(x != nullptr ? x->getBody() : y->getBody(), body, rw);
+        if (y != nullptr) walkStatement(y->getPostopStatement(), body, rw);
+        exit = meet(!known || !taken ? s : unreachable(), label_state[end]);
+        return meet(body, label_state[start]);
+    };
+
+    State head = state, exit;
+    while (true) {
+        State next = meet(state, iterate(head, false, exit));
+        if (next == head) break;
+        head = next;
+    }
+    if (rewrite) iterate(head, true, exit);
+    state = exit;
+}
+
+std::shared_ptr<ExprNode> ConstantPropagation::rewriteExpr(const std::shared_ptr<ExprNode>& expr, const State& state, const std::set<Symbol*>& skip) {
+    if (expr == nullptr) return nullptr;
+    if (auto x = std::dynamic_pointer_cast<LValueNode>(expr)) {
+        if (x->isArray()) {
+            if (x->getIndex() != nullptr) x->setIndex(rewriteExpr(x->getIndex(), state, skip));
+            return expr;
+        }
+        Symbol* sym = x->getSymbol().get();
+        auto it = state.facts.find(sym);
+        if (skip.count(sym) || it == state.facts.end()) return expr;
+        replaced++;
+        if (it->second.copy != nullptr) return makeVarRef(it->second.copy);
+        return makeConstant(it->second.value);
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(expr)) {
+        UnaryOp op = x->getOp();
+        if (op == U_ADDR || op == U_PREINC || op == U_PREDEC || op == U_POSTINC || op == U_POSTDEC) {
+            rewriteTarget(x->getExpr(), state, skip);
+            return expr;
+        }
+        x->setExpr(rewriteExpr(x->getExpr(), state, skip));
+    } else if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(expr)) {
+        x->setLeft(rewriteExpr(x->getLeft(), state, skip));
+        x->setRight(rewriteExpr(x->getRight(), state, skip));
+    } else if (auto x = std::dynamic_pointer_cast<FunctionCallNode>(expr)) {
+        std::vector<std::shared_ptr<ExprNode>> args;
+        for (const auto& arg : x->getArguments()) {
+            args.push_back(rewriteExpr(arg, state, skip));
+        }
+        x->setArguments(args);
+    } else if (auto x = std::dynamic_pointer_cast<AssignmentNode>(expr)) {
+        rewriteTarget(x->getLvalue(), state, skip);
+        x->setExpr(rewriteExpr(x->getExpr(), state, skip));
+    }
+    // 代入常量之后整个表达式可能在编译期算出来
+    Value value;
+    if (!std::dynamic_pointer_cast<ValueNode>(expr) && evalConstant(expr, value) && isLiteral(value)) return makeConstant(value);
+    return expr;
+}
+
+// 写入目标本身不替换，只改写其中的下标和指针
+void ConstantPropagation::rewriteTarget(const std::shared_ptr<ExprNode>& target, const State& state, const std::set<Symbol*>& skip) {
+    if (auto x = std::dynamic_pointer_cast<LValueNode>(target)) {
+        if (x->isArray() && x->getIndex() != nullptr) x->setIndex(rewriteExpr(x->getIndex(), state, skip));
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(target)) {
+        if (x->getOp() == U_DEREF) x->setExpr(rewriteExpr(x->getExpr(), state, skip));
+    }
+}
+
+std::shared_ptr<ExprNode> ConstantPropagation::rewriteCondition(const std::shared_ptr<ExprNode>& cond, const State& state, bool rewrite) {
+    if (cond == nullptr || !rewrite) return cond;
+    auto ret = rewriteExpr(cond, state, nestedWrites(cond));
+    // 条件折叠成常量的分支
+    if (!std::dynamic_pointer_cast<ValueNode>(cond) && std::dynamic_pointer_cast<ValueNode>(ret)) replaced++;
+    return ret;
+}
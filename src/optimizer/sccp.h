@@ -0,0 +1,50 @@
+#pragma once
+#include "optimizer/optimizer.h"
+#include "optimizer/ast_utils.h"
+#include <set>
+#include <map>
+
+// 稀疏条件常量传播：对没有被取地址的局部标量做前向数据流分析，记录每个程序点上变量是常量还是另一个变量的拷贝。
+// 条件是常量时只分析会执行的分支，循环头的状态迭代到不动点，结果和在 SSA 上做 SCCP 相同，只是 phi 隐含在
+// 结构化控制流的汇合点上。之后把变量的读取替换成常量或拷贝的源变量，折叠出来的常量表达式直接算出结果，
+// 常量条件留给死代码删除去掉不执行的分支。
+class ConstantPropagation : public Pass {
+public:
+    std::string name() const override { return "sccp"; }
+    void run(const std::shared_ptr<Pragram>& program) override;
+private:
+    // 变量在某个程序点上已知的值，不在状态中的变量值未知
+    struct Fact {
+        std::shared_ptr<Symbol> copy; // 非空时变量等于copy的当前值，否则等于value
+        Value value;
+        bool operator==(const Fact& other) const;
+    };
+
+    // 程序点上的状态。reachable 为false表示这个点不可达，汇合时不起作用
+    struct State {
+        bool reachable = true;
+        std::map<Symbol*, Fact> facts;
+        bool operator==(const State& other) const;
+    };
+
+    std::string func_name;
+    std::set<Symbol*> address_taken;
+    std::map<std::string, State> label_state; // 跳转到 break/continue 标号处的状态的汇合
+    int replaced;
+
+    bool isTracked(const Symbol* sym) const;
+    static State unreachable();
+    static State meet(const State& a, const State& b);
+    void assign(State& state, Symbol* sym, const Fact* fact) const;
+    void killWrites(State& state, const std::shared_ptr<ASTNode>& node) const;
+    bool evaluate(const std::shared_ptr<ExprNode>& expr, const State& state, Value& value) const;
+    std::set<Symbol*> nestedWrites(const std::shared_ptr<ExprNode>& expr) const;
+
+    void walkBlock(const std::shared_ptr<BlockNode>& block, State& state, bool rewrite);
+    void walkStatement(const std::shared_ptr<StatementNode>& stmt, State& state, bool rewrite);
+    void walkAssign(const std::shared_ptr<Symbol>& sym, const std::shared_ptr<ExprNode>& expr, State& state) const;
+    void walkLoop(const std::shared_ptr<StatementNode>& loop, State& state, bool rewrite);
+    std::shared_ptr<ExprNode> rewriteExpr(const std::shared_ptr<ExprNode>& expr, const State& state, const std::set<Symbol*>& skip);
+    void rewriteTarget(const std::shared_ptr<ExprNode>& target, const State& state, const std::set<Symbol*>& skip);
+    std::shared_ptr<ExprNode> rewriteCondition(const std::shared_ptr<ExprNode>& cond, const State& state, bool rewrite);
+};
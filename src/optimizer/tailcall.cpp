@@ -0,0 +1,236 @@
+#include "optimizer/tailcall.h"
+
+void TailCallOptimization::run(const std::shared_ptr<Pragram>& program) {
+    for (const auto& func : program->getFunctions()) {
+        func_name = func->getIdentifier();
+        return_type = func->getReturnType();
+        params.clear();
+        if (func->getParams() != nullptr) params = func->getParams()->getParams();
+        convertSelfRecursion(func);
+        markTailCalls(func);
+    }
+}
+
+// 对同一个数组参数原样传递的自递归调用
+std::shared_ptr<FunctionCallNode> TailCallOptimization::getSelfCall(const std::shared_ptr<ExprNode>& expr) const {
+    auto call = std::dynamic_pointer_cast<FunctionCallNode>(expr);
+    if (call == nullptr || call->getIdentifier() != func_name) return nullptr;
+    auto args = call->getArguments();
+    for (size_t i = 0; i < params.size(); i++) {
+        if (!params[i]->is_array) continue;
+        auto x = std::dynamic_pointer_cast<UnaryExpNode>(args[i]);
+        if (x == nullptr || x->getOp() != U_ADDR) return nullptr;
+        auto y = std::dynamic_pointer_cast<LValueNode>(x->getExpr());
+        if (y == nullptr || y->getSymbol() != params[i] || y->getIndex() != nullptr) return nullptr;
+    }
+    return call;
+}
+
+// 递归调用前后求值结果相同的操作数：只读局部标量和常量
+bool TailCallOptimization::isAccumulable(const std::shared_ptr<ExprNode>& expr) const {
+    if (hasSideEffects(expr)) return false;
+    bool ret = true;
+    forEachNode(expr, [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (std::dynamic_pointer_cast<FunctionCallNode>(n)) ret = false;
+        if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(n); x != nullptr && x->getOp() == U_DEREF) ret = false;
+        if (auto x = std::dynamic_pointer_cast<LValueNode>(n); x != nullptr && (x->getSymbol()->is_global || x->isArray())) ret = false;
+    });
+    return ret;
+}
+
+TailCallOptimization::ReturnKind TailCallOptimization::classify(const std::shared_ptr<ExprNode>& expr,
+    std::shared_ptr<FunctionCallNode>& call, std::shared_ptr<ExprNode>& operand, ExprType& op) const {
+    if (expr == nullptr) return RETURN_BASE;
+    if ((call = getSelfCall(expr)) != nullptr) return RETURN_TAIL;
+    // 整数加法和乘法满足交换律和结合律，A op f(x) 可以先把A累加起来
+    auto x = std::dynamic_pointer_cast<BinaryExpNode>(expr);
+    if (x == nullptr || (x->getOp() != A_ADD && x->getOp() != A_MULTIPLY)) return RETURN_BASE;
+    if ((return_type != P_INT && return_type != P_LONG) || x->getCalType() != return_type) return RETURN_BASE;
+    op = x->getOp();
+    if ((call = getSelfCall(x->getRight())) != nullptr && isAccumulable(x->getLeft())) {
+        operand = x->getLeft();
+        return RETURN_ACCUMULATE;
+    }
+    if ((call = getSelfCall(x->getLeft())) != nullptr && isAccumulable(x->getRight())) {
+        operand = x->getRight();
+        return RETURN_ACCUMULATE;
+    }
+    return RETURN_BASE;
+}
+
+bool TailCallOptimization::convertSelfRecursion(const std::shared_ptr<FunctionDeclareNode>& func) {
+    // 参数被取地址时，下一次迭代的参数和上一次的指针指向同一个位置
+    if (!collectAddressTaken(func).empty()) return false;
+
+    // 所有累加形式的返回必须使用同一种运算
+    acc = nullptr;
+    bool has_accumulate = false;
+    bool mixed = false;
+    forEachNode(func->getBody(), [&](const std::shared_ptr<ASTNode>& n, int) {
+        auto x = std::dynamic_pointer_cast<ReturnStatementNode>(n);
+        if (x == nullptr) return;
+        std::shared_ptr<FunctionCallNode> call;
+        std::shared_ptr<ExprNode> operand;
+        ExprType op;
+        if (classify(x->getExpression(), call, operand, op) != RETURN_ACCUMULATE) return;
+        if (has_accumulate && op != acc_op) mixed = true;
+        has_accumulate = true;
+        acc_op = op;
+    });
+    if (has_accumulate && !mixed) acc = symbol_table.newTemp(func_name, return_type);
+
+    std::string label_no = labelAllocator.getLabel(LableType::WHILE_LABEL);
+    loop_start = "WHILE_START_" + label_no;
+    std::string loop_end = "WHILE_END_" + label_no;
+    converted = 0;
+    auto body = func->getBody();
+    rewriteBlock(body, true);
+    if (converted == 0) return false;
+
+    // 函数体放进 while (1)，执行到末尾时跳出循环
+    auto loop_body = std::make_shared<BlockNode>();
+    loop_body->setStatements(body->getStatements());
+    loop_body->addStatement(std::make_shared<BreakStatementNode>(loop_end));
+    auto loop = std::make_shared<WhileStatementNode>(std::make_shared<ValueNode>(Value{.type = P_INT, .ivalue = 1}), loop_body);
+    loop->setLabels(loop_start, loop_end);
+    std::vector<std::shared_ptr<StatementNode>> stmts;
+    if (acc != nullptr) {
+        Value init = return_type == P_LONG ? Value{.type = P_LONG, .lvalue = acc_op == A_ADD ? 0 : 1}
+                                           : Value{.type = P_INT, .ivalue = acc_op == A_ADD ? 0 : 1};
+        stmts.push_back(makeTempDecl(acc, std::make_shared<ValueNode>(init)));
+    }
+    stmts.push_back(loop);
+    body->setStatements(stmts);
+    opt_stats.count(name(), func_name, converted);
+    return true;
+}
+
+// tail表示语句执行完后函数就返回，void函数在这里的自递归调用语句也是尾调用
+void TailCallOptimization::rewriteBlock(const std::shared_ptr<BlockNode>& block, bool tail) {
+    auto stmts = block->getStatements();
+    for (size_t i = 0; i < stmts.size(); i++) {
+        bool stmt_tail = tail && i + 1 == stmts.size();
+        if (i + 1 < stmts.size()) {
+            auto next = std::dynamic_pointer_cast<ReturnStatementNode>(stmts[i + 1]);
+            stmt_tail = next != nullptr && next->getExpression() == nullptr;
+        }
+        stmts[i] = rewriteStatement(stmts[i], stmt_tail);
+    }
+    block->setStatements(stmts);
+}
+
+std::shared_ptr<StatementNode> TailCallOptimization::rewriteStatement(const std::shared_ptr<StatementNode>& stmt, bool tail) {
+    if (stmt == nullptr) return nullptr;
+    if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        rewriteBlock(x, tail);
+    } else if (auto x = std::dynamic_pointer_cast<IfStatementNode>(stmt)) {
+        x->setThenStatement(rewriteStatement(x->getThenStatement(), tail));
+        x->setElseStatement(rewriteStatement(x->getElseStatement(), tail));
+    } else if (auto x = std::dynamic_pointer_cast<SwitchStatementNode>(stmt)) {
+        for (const auto& c : x->getCases()) {
+            rewriteBlock(c.body, false);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(stmt)) {
+        x->setBody(rewriteStatement(x->getBody(), false));
+    } else if (auto x = std::dynamic_pointer_cast<ForStatementNode>(stmt)) {
+        x->setBody(rewriteStatement(x->getBody(), false));
+    } else if (auto x = std::dynamic_pointer_cast<ReturnStatementNode>(stmt)) {
+        std::shared_ptr<FunctionCallNode> call;
+        std::shared_ptr<ExprNode> operand;
+        ExprType op;
+        ReturnKind kind = classify(x->getExpression(), call, operand, op);
+        if (kind == RETURN_ACCUMULATE && acc == nullptr) kind = RETURN_BASE;
+        if (kind == RETURN_BASE) {
+            // 基本情况返回之前累加的结果
+            if (acc == nullptr) return stmt;
+            auto ret = std::make_shared<BinaryExpNode>(acc_op, makeVarRef(acc), x->getExpression());
+            ret->updateCalType();
+            ret->updateTypeAfterCal();
+            x->setExpression(ret);
+            return stmt;
+        }
+        std::vector<std::shared_ptr<StatementNode>> stmts;
+        if (kind == RETURN_ACCUMULATE) {
+            auto sum = std::make_shared<BinaryExpNode>(acc_op, makeVarRef(acc), operand);
+            sum->updateCalType();
+            sum->updateTypeAfterCal();
+            stmts.push_back(std::make_shared<AssignmentNode>(makeVarRef(acc), sum));
+        }
+        makeJump(call, stmts);
+        auto block = std::make_shared<BlockNode>();
+        block->setStatements(stmts);
+        return block;
+    } else if (auto x = std::dynamic_pointer_cast<ExprNode>(stmt)) {
+        auto call = getSelfCall(x);
+        if (!tail || return_type != P_VOID || call == nullptr) return stmt;
+        std::vector<std::shared_ptr<StatementNode>> stmts;
+        makeJump(call, stmts);
+        auto block = std::make_shared<BlockNode>();
+        block->setStatements(stmts);
+        return block;
+    }
+    return stmt;
+}
+
+// 用实参给参数重新赋值后回到循环开头。所有实参都要用调用前的参数值求值，
+// 实参读到前面已经被赋值的参数或者有副作用时，先存入临时变量
+void TailCallOptimization::makeJump(const std::shared_ptr<FunctionCallNode>& call, std::vector<std::shared_ptr<StatementNode>>& out) {
+    auto args = call->getArguments();
+    bool all_temps = false;
+    for (const auto& arg : args) {
+        if (hasSideEffects(arg)) all_temps = true;
+    }
+    std::vector<std::shared_ptr<StatementNode>> assigns;
+    std::vector<bool> reassigned(params.size(), false);
+    for (size_t i = 0; i < params.size(); i++) {
+        if (params[i]->is_array || isScalarOf(args[i], params[i].get())) continue;
+        bool need_temp = all_temps;
+        for (size_t k = 0; k < i; k++) {
+            if (reassigned[k] && mentionsSymbol(args[i], params[k].get())) need_temp = true;
+        }
+        reassigned[i] = true;
+        if (need_temp) {
+            auto temp = symbol_table.newTemp(func_name, params[i]->type);
+            out.push_back(makeTempDecl(temp, args[i]));
+            assigns.push_back(std::make_shared<AssignmentNode>(makeVarRef(params[i]), makeVarRef(temp)));
+        } else {
+            assigns.push_back(std::make_shared<AssignmentNode>(makeVarRef(params[i]), args[i]));
+        }
+    }
+    out.insert(out.end(), assigns.begin(), assigns.end());
+    out.push_back(std::make_shared<ContinueStatementNode>(loop_start));
+    converted++;
+}
+
+// return g(args) 的实参都在寄存器中传递时，可以在拆掉栈帧之后跳转到g。
+// 栈帧中的变量被取过地址时，指针可能传给了g，栈帧必须保留到g返回
+void TailCallOptimization::markTailCalls(const std::shared_ptr<FunctionDeclareNode>& func) {
+    bool escapes = false;
+    forEachNode(func->getBody(), [&](const std::shared_ptr<ASTNode>& n, int) {
+        auto x = std::dynamic_pointer_cast<UnaryExpNode>(n);
+        if (x == nullptr || x->getOp() != U_ADDR) return;
+        auto y = std::dynamic_pointer_cast<LValueNode>(x->getExpr());
+        if (y == nullptr || (!y->getSymbol()->is_global && !(y->getSymbol()->is_param && y->isArray()))) escapes = true;
+    });
+    if (escapes) return;
+
+    forEachNode(func->getBody(), [&](const std::shared_ptr<ASTNode>& n, int) {
+        auto x = std::dynamic_pointer_cast<ReturnStatementNode>(n);
+        if (x == nullptr) return;
+        auto call = std::dynamic_pointer_cast<FunctionCallNode>(x->getExpression());
+        if (call == nullptr) return;
+        int int_count = 0;
+        int float_count = 0;
+        bool nested = false;
+        for (const auto& arg : call->getArguments()) {
+            if (arg->getCalculateType() == P_FLOAT) float_count++;
+            else int_count++;
+            forEachNode(arg, [&](const std::shared_ptr<ASTNode>& m, int) {
+                if (std::dynamic_pointer_cast<FunctionCallNode>(m)) nested = true;
+            });
+        }
+        if (int_count > 6 || float_count > 8 || nested) return;
+        x->setTailCall(true);
+        opt_stats.count(name(), func_name);
+    });
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "optimizer/optimizer.h"
+#include "optimizer/ast_utils.h"
+#include <set>
+
+// 尾调用优化：函数体外面套一层 while (1)，自递归的尾调用 return f(args) 改写成给参数重新赋值后 continue；
+// return A + f(args) / return A * f(args) 这样只差一次整数加法或乘法的递归引入累加变量，基本情况返回 acc op B。
+// 剩下的 return g(args) 在实参都能放进寄存器、当前栈帧没有被取地址时标记为尾调用，
+// 代码生成时拆掉当前栈帧后直接 jmp 到 g，调用链再深也不会增加栈空间。
+class TailCallOptimization : public Pass {
+public:
+    std::string name() const override { return "tailcall"; }
+    void run(const std::shared_ptr<Pragram>& program) override;
+private:
+    enum ReturnKind { RETURN_BASE, RETURN_TAIL, RETURN_ACCUMULATE };
+
+    std::string func_name;
+    PrimitiveType return_type;
+    std::vector<std::shared_ptr<Symbol>> params;
+    std::shared_ptr<Symbol> acc; // 累加变量，没有累加形式的递归时为空
+    ExprType acc_op;
+    std::string loop_start;
+    int converted; // 改写成跳转的递归调用个数
+
+    bool convertSelfRecursion(const std::shared_ptr<FunctionDeclareNode>& func);
+    ReturnKind classify(const std::shared_ptr<ExprNode>& expr, std::shared_ptr<FunctionCallNode>& call, std::shared_ptr<ExprNode>& operand, ExprType& op) const;
+    std::shared_ptr<FunctionCallNode> getSelfCall(const std::shared_ptr<ExprNode>& expr) const;
+    bool isAccumulable(const std::shared_ptr<ExprNode>& expr) const;
+    void rewriteBlock(const std::shared_ptr<BlockNode>& block, bool tail);
+    std::shared_ptr<StatementNode> rewriteStatement(const std::shared_ptr<StatementNode>& stmt, bool tail);
+    void makeJump(const std::shared_ptr<FunctionCallNode>& call, std::vector<std::shared_ptr<StatementNode>>& out);
+    void markTailCalls(const std::shared_ptr<FunctionDeclareNode>& func);
+};
@@ -0,0 +1,288 @@
+#include "optimizer/unroll.h"
+
+// 完全展开的最大迭代次数
+static const long FULL_UNROLL_TRIPS = 16;
+
+static int countNodes(const std::shared_ptr<ASTNode>& node) {
+    int count = 0;
+    forEachNode(node, [&](const std::shared_ptr<ASTNode>&, int) { count++; });
+    return count;
+}
+
+static std::shared_ptr<ValueNode> makeInteger(PrimitiveType type, long value) {
+    if (type == P_LONG) return makeConstant(Value{.type = P_LONG, .lvalue = value});
+    return makeConstant(Value{.type = P_INT, .ivalue = (int)value});
+}
+
+static std::shared_ptr<ExprNode> makeBinary(ExprType op, const std::shared_ptr<ExprNode>& left, const std::shared_ptr<ExprNode>& right) {
+    auto ret = std::make_shared<BinaryExpNode>(op, left, right);
+    ret->updateCalType();
+    ret->updateTypeAfterCal();
+    return ret;
+}
+
+static std::shared_ptr<ExprNode> toLong(const std::shared_ptr<ExprNode>& expr) {
+    if (expr->getPrimitiveType() == P_LONG) return expr;
+    return std::make_shared<UnaryExpNode>(U_TRANSFORM, expr, P_LONG);
+}
+
+void LoopUnrolling::run(const std::shared_ptr<Pragram>& program) {
+    if (compiler_options.unroll_limit <= 0) return;
+    for (const auto& func : program->getFunctions()) {
+        func_name = func->getIdentifier();
+        address_taken = collectAddressTaken(func);
+        processBlock(func->getBody());
+    }
+}
+
+// 紧跟在向量循环后面的是处理剩余元素的标量循环，不展开
+void LoopUnrolling::processBlock(const std::shared_ptr<BlockNode>& block) {
+    std::vector<std::shared_ptr<StatementNode>> stmts;
+    bool after_vector = false;
+    for (const auto& stmt : block->getStatements()) {
+        if (after_vector && std::dynamic_pointer_cast<ForStatementNode>(stmt)) {
+            stmts.push_back(stmt);
+        } else {
+            for (const auto& s : processStatement(stmt)) {
+                stmts.push_back(s);
+            }
+        }
+        after_vector = std::dynamic_pointer_cast<VectorLoopNode>(stmt) != nullptr;
+    }
+    block->setStatements(stmts);
+}
+
+std::shared_ptr<StatementNode> LoopUnrolling::processBody(const std::shared_ptr<StatementNode>& stmt) {
+    if (stmt == nullptr) return nullptr;
+    auto stmts = processStatement(stmt);
+    if (stmts.size() == 1) return stmts[0];
+    auto block = std::make_shared<BlockNode>();
+    block->setStatements(stmts);
+    return block;
+}
+
+std::vector<std::shared_ptr<StatementNode>> LoopUnrolling::processStatement(const std::shared_ptr<StatementNode>& stmt) {
+    if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        processBlock(x);
+    } else if (auto x = std::dynamic_pointer_cast<IfStatementNode>(stmt)) {
+        x->setThenStatement(processBody(x->getThenStatement()));
+        x->setElseStatement(processBody(x->getElseStatement()));
+    } else if (auto x = std::dynamic_pointer_cast<SwitchStatementNode>(stmt)) {
+        for (const auto& c : x->getCases()) {
+            processBlock(c.body);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(stmt)) {
+        x->setBody(processBody(x->getBody()));
+    } else if (auto x = std::dynamic_pointer_cast<ForStatementNode>(stmt)) {
+        x->setBody(processBody(x->getBody()));
+        return unrollLoop(x);
+    }
+    return {stmt};
+}
+
+// 返回替换 loop 的语句序列
+std::vector<std::shared_ptr<StatementNode>> LoopUnrolling::unrollLoop(const std::shared_ptr<ForStatementNode>& loop) {
+    LoopContext ctx;
+    ctx.loop = loop;
+    if (!matchLoop(ctx) || !canCopy(ctx)) return {loop};
+    int size = countNodes(loop->getBody());
+
+    // 初值和边界都是常量时迭代次数已知
+    long start, end, trip = -1;
+    auto init = std::dynamic_pointer_cast<AssignmentNode>(loop->getPreopStatement());
+    if (init != nullptr && isScalarOf(init->getLvalue(), ctx.iv.get()) && getConstantValue(init->getExpr(), start)
+        && getConstantValue(ctx.bound, end)) {
+        trip = std::max(0L, end - start + (ctx.inclusive ? 1 : 0));
+        // 循环结束时计数器的值要放得进计数器的类型
+        if (ctx.iv->type == P_INT && start + trip != (int)(start + trip)) trip = -1;
+    }
+    if (trip >= 0 && trip <= FULL_UNROLL_TRIPS && trip * size <= 4 * compiler_options.unroll_limit) return unrollFully(ctx, start, trip);
+
+    // 部分展开只对没有调用的循环有意义，调用的开销远大于循环本身的开销
+    bool has_call = false;
+    forEachNode(loop->getBody(), [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (std::dynamic_pointer_cast<FunctionCallNode>(n) || std::dynamic_pointer_cast<PrintStatementNode>(n)) has_call = true;
+    });
+    int factor = compiler_options.unroll_factor;
+    while (factor > 1 && factor * size > compiler_options.unroll_limit) factor--;
+    if (has_call || factor < 2 || (trip >= 0 && trip < 2 * factor)) return {loop};
+    return unrollPartially(ctx, factor, trip < 0 || trip % factor != 0);
+}
+
+// for (...; i < n; i++)、++i 或 i = i + 1，n 是循环中不变的整数，循环体中没有其他循环，也不修改 i
+bool LoopUnrolling::matchLoop(LoopContext& ctx) const {
+    auto loop = ctx.loop;
+    auto body = loop->getBody();
+    if (body == nullptr || loop->getCondition() == nullptr) return false;
+    std::shared_ptr<LValueNode> target;
+    auto update = loop->getPostopStatement();
+    if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(update)) {
+        if (x->getOp() != U_PREINC && x->getOp() != U_POSTINC) return false;
+        target = std::dynamic_pointer_cast<LValueNode>(x->getExpr());
+    } else if (auto x = std::dynamic_pointer_cast<AssignmentNode>(update)) {
+        target = std::dynamic_pointer_cast<LValueNode>(x->getLvalue());
+        auto y = std::dynamic_pointer_cast<BinaryExpNode>(stripTransform(x->getExpr()));
+        long value;
+        if (target == nullptr || y == nullptr || y->getOp() != A_ADD) return false;
+        if (!isScalarOf(stripTransform(y->getLeft()), target->getSymbol().get()) || !getConstantValue(y->getRight(), value) || value != 1) return false;
+    }
+    if (target == nullptr || target->isArray()) return false;
+    ctx.iv = target->getSymbol();
+    if ((ctx.iv->type != P_INT && ctx.iv->type != P_LONG) || ctx.iv->is_global || address_taken.count(ctx.iv.get())) return false;
+
+    bool innermost = true;
+    forEachNode(body, [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (std::dynamic_pointer_cast<WhileStatementNode>(n) || std::dynamic_pointer_cast<ForStatementNode>(n)
+            || std::dynamic_pointer_cast<VectorLoopNode>(n)) innermost = false;
+    });
+    if (!innermost) return false;
+    ctx.effects = collectSideEffects(body);
+    if (ctx.effects.written.count(ctx.iv.get())) return false;
+    ctx.effects.written.insert(ctx.iv.get());
+
+    auto cmp = std::dynamic_pointer_cast<BinaryExpNode>(loop->getCondition());
+    if (cmp == nullptr) return false;
+    ExprType op = cmp->getOp();
+    if (isScalarOf(stripTransform(cmp->getLeft()), ctx.iv.get()) && (op == A_LT || op == A_LE)) {
+        ctx.bound = stripTransform(cmp->getRight());
+        ctx.inclusive = op == A_LE;
+    } else if (isScalarOf(stripTransform(cmp->getRight()), ctx.iv.get()) && (op == A_GT || op == A_GE)) {
+        ctx.bound = stripTransform(cmp->getLeft());
+        ctx.inclusive = op == A_GE;
+    } else {
+        return false;
+    }
+    if (ctx.bound->getPrimitiveType() != P_INT && ctx.bound->getPrimitiveType() != P_LONG) return false;
+    return isInvariantIn(ctx.bound, ctx.effects, address_taken);
+}
+
+// 循环体能否复制：跳出或继续这个循环的语句在展开后没有对应的位置，数组声明不能拷贝
+bool LoopUnrolling::canCopy(const LoopContext& ctx) const {
+    bool ret = true;
+    std::string start = ctx.loop->getForStartLabel();
+    std::string end = ctx.loop->getForEndLabel();
+    forEachNode(ctx.loop->getBody(), [&](const std::shared_ptr<ASTNode>& n, int) {
+        if (auto x = std::dynamic_pointer_cast<BreakStatementNode>(n)) {
+            if (x->getLabel() == start || x->getLabel() == end) ret = false;
+        } else if (auto x = std::dynamic_pointer_cast<ContinueStatementNode>(n)) {
+            if (x->getLabel() == start || x->getLabel() == end) ret = false;
+        } else if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(n)) {
+            for (const auto& sym : x->getSymbols()) {
+                if (sym->is_array) ret = false;
+            }
+        }
+    });
+    return ret;
+}
+
+// 依次执行 trip 份循环体，第k份中的 i 是常量 start + k，最后给 i 赋上循环结束时的值
+std::vector<std::shared_ptr<StatementNode>> LoopUnrolling::unrollFully(const LoopContext& ctx, long start, long trip) {
+    std::vector<std::shared_ptr<StatementNode>> ret;
+    for (long k = 0; k < trip; k++) {
+        for (const auto& s : copyBody(ctx, makeInteger(ctx.iv->type, start + k))) {
+            ret.push_back(s);
+        }
+    }
+    ret.push_back(std::make_shared<AssignmentNode>(makeVarRef(ctx.iv), makeInteger(ctx.iv->type, start + trip)));
+    opt_stats.count("unroll-full", func_name);
+    return ret;
+}
+
+// for (init; i + factor - 1 < n; i = i + factor) { body(i); body(i + 1); ... } 之后接着原来的循环处理剩下的迭代。
+// 迭代次数是份数的倍数时不需要剩下的循环，条件也不用改。条件在 long 上计算，i + factor - 1 不会溢出
+std::vector<std::shared_ptr<StatementNode>> LoopUnrolling::unrollPartially(const LoopContext& ctx, int factor, bool remainder) {
+    auto loop = ctx.loop;
+    auto body = std::make_shared<BlockNode>();
+    for (int k = 0; k < factor; k++) {
+        std::shared_ptr<ExprNode> value = makeVarRef(ctx.iv);
+        if (k > 0) value = makeBinary(A_ADD, value, makeInteger(ctx.iv->type, k));
+        for (const auto& s : copyBody(ctx, value)) {
+            body->addStatement(s);
+        }
+    }
+    std::shared_ptr<ExprNode> cond = cloneExpr(loop->getCondition());
+    if (remainder) {
+        auto last = makeBinary(A_ADD, toLong(makeVarRef(ctx.iv)), makeInteger(P_LONG, factor - 1));
+        cond = makeBinary(ctx.inclusive ? A_LE : A_LT, last, toLong(cloneExpr(ctx.bound)));
+    }
+    auto step = makeBinary(A_ADD, makeVarRef(ctx.iv), makeInteger(ctx.iv->type, factor));
+    auto unrolled = std::make_shared<ForStatementNode>(loop->getPreopStatement(), cond, body, std::make_shared<AssignmentNode>(makeVarRef(ctx.iv), step));
+    std::string label_no = labelAllocator.getLabel(LableType::FOR_LABEL);
+    unrolled->setLabels("FOR_START_" + label_no, "FOR_END_" + label_no);
+    opt_stats.count(name(), func_name);
+    if (!remainder) return {unrolled};
+    loop->setPreopStatement(nullptr);
+    return {unrolled, loop};
+}
+
+// 把 i 换成 value 的一份循环体，循环体是块时拆开成其中的语句
+std::vector<std::shared_ptr<StatementNode>> LoopUnrolling::copyBody(const LoopContext& ctx, const std::shared_ptr<ExprNode>& value) {
+    std::map<Symbol*, std::shared_ptr<ExprNode>> subst{{ctx.iv.get(), value}};
+    std::map<std::string, std::string> labels;
+    auto copy = cloneStatement(ctx.loop->getBody(), subst, labels);
+    foldStatement(copy);
+    if (auto x = std::dynamic_pointer_cast<BlockNode>(copy)) return x->getStatements();
+    return {copy};
+}
+
+// 代入常量后算出常量子表达式。语义分析给数组下标套上的 long→int 转换并不截断，保留它，只计算里面的下标
+std::shared_ptr<ExprNode> LoopUnrolling::foldExpr(const std::shared_ptr<ExprNode>& expr) {
+    if (expr == nullptr) return nullptr;
+    if (auto x = std::dynamic_pointer_cast<LValueNode>(expr)) {
+        auto index = std::dynamic_pointer_cast<UnaryExpNode>(x->getIndex());
+        if (index != nullptr && index->getOp() == U_TRANSFORM) index->setExpr(foldExpr(index->getExpr()));
+        else if (x->getIndex() != nullptr) x->setIndex(foldExpr(x->getIndex()));
+        return expr;
+    } else if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(expr)) {
+        x->setExpr(foldExpr(x->getExpr()));
+    } else if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(expr)) {
+        x->setLeft(foldExpr(x->getLeft()));
+        x->setRight(foldExpr(x->getRight()));
+    } else if (auto x = std::dynamic_pointer_cast<AssignmentNode>(expr)) {
+        foldExpr(x->getLvalue());
+        x->setExpr(foldExpr(x->getExpr()));
+        return expr;
+    } else if (auto x = std::dynamic_pointer_cast<FunctionCallNode>(expr)) {
+        std::vector<std::shared_ptr<ExprNode>> args;
+        for (const auto& arg : x->getArguments()) {
+            args.push_back(foldExpr(arg));
+        }
+        x->setArguments(args);
+        return expr;
+    } else {
+        return expr;
+    }
+    // 浮点常量要登记到数据段，-0.0 又不能区分，只计算整数
+    Value value;
+    if (evalConstant(expr, value) && value.type != P_FLOAT) return makeConstant(value);
+    return expr;
+}
+
+void LoopUnrolling::foldStatement(const std::shared_ptr<StatementNode>& stmt) {
+    if (stmt == nullptr) return;
+    if (auto x = std::dynamic_pointer_cast<ExprNode>(stmt)) {
+        foldExpr(x);
+    } else if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        for (const auto& s : x->getStatements()) {
+            foldStatement(s);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<PrintStatementNode>(stmt)) {
+        x->setExpression(foldExpr(x->getExpression()));
+    } else if (auto x = std::dynamic_pointer_cast<VariableDeclareNode>(stmt)) {
+        for (const auto& sym : x->getSymbols()) {
+            auto init = x->getInitializer(*sym);
+            if (init != nullptr) x->setInitializer(*sym, foldExpr(init));
+        }
+    } else if (auto x = std::dynamic_pointer_cast<IfStatementNode>(stmt)) {
+        x->setCondition(foldExpr(x->getCondition()));
+        foldStatement(x->getThenStatement());
+        foldStatement(x->getElseStatement());
+    } else if (auto x = std::dynamic_pointer_cast<SwitchStatementNode>(stmt)) {
+        x->setCondition(foldExpr(x->getCondition()));
+        for (const auto& c : x->getCases()) {
+            foldStatement(c.body);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<ReturnStatementNode>(stmt)) {
+        if (x->getExpression() != nullptr) x->setExpression(foldExpr(x->getExpression()));
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "optimizer/optimizer.h"
+#include "optimizer/ast_utils.h"
+#include <set>
+
+// 循环展开：最内层的计数循环 for (i = s; i < n; i++) 中 i 只由 i++ 更新、n 在循环中不变时，
+// 次数是不超过16的常量就完全展开，每份循环体中的 i 换成常量；否则按 -funroll-factor 给出的份数部分展开，
+// 第k份循环体中的 i 换成 i + k，每次迭代 i 加上份数，不足一次展开的迭代留给后面原来的循环。
+// 展开后的循环体不能超过 -funroll-limit 个结点，完全展开的全部循环体也不能超过这个大小的4倍。
+// 向量化之后剩下的标量循环只处理不足一个向量的元素，不再展开。
+class LoopUnrolling : public Pass {
+public:
+    std::string name() const override { return "unroll"; }
+    void run(const std::shared_ptr<Pragram>& program) override;
+private:
+    // 正在展开的循环
+    struct LoopContext {
+        std::shared_ptr<ForStatementNode> loop;
+        std::shared_ptr<Symbol> iv; // 每次迭代加1的循环计数器
+        std::shared_ptr<ExprNode> bound;
+        bool inclusive; // 条件是 i <= n
+        SideEffects effects;
+    };
+
+    std::string func_name;
+    std::set<Symbol*> address_taken;
+
+    void processBlock(const std::shared_ptr<BlockNode>& block);
+    std::vector<std::shared_ptr<StatementNode>> processStatement(const std::shared_ptr<StatementNode>& stmt);
+    std::shared_ptr<StatementNode> processBody(const std::shared_ptr<StatementNode>& stmt);
+    std::vector<std::shared_ptr<StatementNode>> unrollLoop(const std::shared_ptr<ForStatementNode>& loop);
+
+    bool matchLoop(LoopContext& ctx) const;
+    bool canCopy(const LoopContext& ctx) const;
+    std::vector<std::shared_ptr<StatementNode>> unrollFully(const LoopContext& ctx, long start, long trip);
+    std::vector<std::shared_ptr<StatementNode>> unrollPartially(const LoopContext& ctx, int factor, bool remainder);
+    std::vector<std::shared_ptr<StatementNode>> copyBody(const LoopContext& ctx, const std::shared_ptr<ExprNode>& value);
+
+    std::shared_ptr<ExprNode> foldExpr(const std::shared_ptr<ExprNode>& expr);
+    void foldStatement(const std::shared_ptr<StatementNode>& stmt);
+};
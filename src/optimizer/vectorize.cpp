@@ -0,0 +1,260 @@
+#include "optimizer/vectorize.h"
+
+// 可用的向量寄存器个数，与寄存器分配器中的 xmm8 ~ xmm11 对应
+static const int VECTOR_REGISTERS = 4;
+
+static bool isVectorType(PrimitiveType type) {
+    return type == P_INT || type == P_LONG || type == P_FLOAT;
+}
+
+static void addUnique(std::vector<std::shared_ptr<Symbol>>& syms, const std::shared_ptr<Symbol>& sym) {
+    for (const auto& s : syms) {
+        if (s == sym) return;
+    }
+    syms.push_back(sym);
+}
+
+void LoopVectorization::run(const std::shared_ptr<Pragram>& program) {
+    for (const auto& func : program->getFunctions()) {
+        func_name = func->getIdentifier();
+        address_taken = collectAddressTaken(func);
+        processBlock(func->getBody());
+    }
+}
+
+void LoopVectorization::processBlock(const std::shared_ptr<BlockNode>& block) {
+    std::vector<std::shared_ptr<StatementNode>> stmts;
+    for (const auto& stmt : block->getStatements()) {
+        for (const auto& s : processStatement(stmt)) {
+            stmts.push_back(s);
+        }
+    }
+    block->setStatements(stmts);
+}
+
+std::shared_ptr<StatementNode> LoopVectorization::processBody(const std::shared_ptr<StatementNode>& stmt) {
+    if (stmt == nullptr) return nullptr;
+    auto stmts = processStatement(stmt);
+    if (stmts.size() == 1) return stmts[0];
+    auto block = std::make_shared<BlockNode>();
+    block->setStatements(stmts);
+    return block;
+}
+
+std::vector<std::shared_ptr<StatementNode>> LoopVectorization::processStatement(const std::shared_ptr<StatementNode>& stmt) {
+    if (auto x = std::dynamic_pointer_cast<BlockNode>(stmt)) {
+        processBlock(x);
+        return {stmt};
+    } else if (auto x = std::dynamic_pointer_cast<IfStatementNode>(stmt)) {
+        x->setThenStatement(processBody(x->getThenStatement()));
+        x->setElseStatement(processBody(x->getElseStatement()));
+        return {stmt};
+    } else if (auto x = std::dynamic_pointer_cast<SwitchStatementNode>(stmt)) {
+        for (const auto& c : x->getCases()) {
+            processBlock(c.body);
+        }
+        return {stmt};
+    } else if (auto x = std::dynamic_pointer_cast<WhileStatementNode>(stmt)) {
+        x->setBody(processBody(x->getBody()));
+        return vectorizeLoop(stmt);
+    } else if (auto x = std::dynamic_pointer_cast<ForStatementNode>(stmt)) {
+        x->setBody(processBody(x->getBody()));
+        return vectorizeLoop(stmt);
+    }
+    return {stmt};
+}
+
+// 返回替换loop的语句序列：for 的初始化语句、向量循环、原来的标量循环
+std::vector<std::shared_ptr<StatementNode>> LoopVectorization::vectorizeLoop(const std::shared_ptr<StatementNode>& loop) {
+    auto while_stmt = std::dynamic_pointer_cast<WhileStatementNode>(loop);
+    auto for_stmt = std::dynamic_pointer_cast<ForStatementNode>(loop);
+    std::shared_ptr<ExprNode> cond = while_stmt != nullptr ? while_stmt->getCondition() : for_stmt->getCondition();
+    std::shared_ptr<StatementNode> body = while_stmt != nullptr ? while_stmt->getBody() : for_stmt->getBody();
+    std::vector<std::shared_ptr<StatementNode>> stmts;
+    if (auto x = std::dynamic_pointer_cast<BlockNode>(body)) stmts = x->getStatements();
+    else if (body != nullptr) stmts.push_back(body);
+
+    // while 循环的计数器在循环体的最后一条语句中更新
+    std::shared_ptr<StatementNode> update;
+    if (for_stmt != nullptr) {
+        update = for_stmt->getPostopStatement();
+    } else if (!stmts.empty()) {
+        update = stmts.back();
+        stmts.pop_back();
+    }
+    if (cond == nullptr || stmts.empty()) return {loop};
+
+    LoopContext ctx;
+    ctx.iv = matchIncrement(update);
+    if (ctx.iv == nullptr) return {loop};
+    ctx.effects = collectSideEffects(body);
+    ctx.effects.written.insert(ctx.iv.get());
+    std::shared_ptr<ExprNode> bound;
+    bool inclusive;
+    if (!matchCondition(cond, ctx, bound, inclusive)) return {loop};
+
+    // 循环体只能是 a[i] = 向量表达式
+    std::vector<std::shared_ptr<AssignmentNode>> assigns;
+    for (const auto& stmt : stmts) {
+        auto assign = std::dynamic_pointer_cast<AssignmentNode>(stmt);
+        if (assign == nullptr) return {loop};
+        auto arr = matchAccess(assign->getLvalue(), ctx);
+        if (arr == nullptr || assign->getPrimitiveType() != ctx.elem) return {loop};
+        int need = registerNeed(assign->getExpr(), ctx);
+        if (need < 0 || need > VECTOR_REGISTERS) return {loop};
+        addUnique(ctx.stored, arr);
+        assigns.push_back(assign);
+    }
+
+    int width = (compiler_options.avx2 ? 32 : 16) / symbol_table.typeToSize(ctx.elem);
+    // 剩余元素个数判断：i + width <= n（i <= n 时为 i + width - 1 <= n），在 long 上计算不会溢出
+    std::shared_ptr<ExprNode> first = makeVarRef(ctx.iv);
+    if (ctx.iv->type != P_LONG) first = std::make_shared<UnaryExpNode>(U_TRANSFORM, first, P_LONG);
+    Value last{.type = P_LONG, .lvalue = inclusive ? width - 1 : width};
+    auto sum = std::make_shared<BinaryExpNode>(A_ADD, first, std::make_shared<ValueNode>(last));
+    sum->updateCalType();
+    sum->updateTypeAfterCal();
+    std::shared_ptr<ExprNode> limit = cloneExpr(bound);
+    if (limit->getPrimitiveType() != P_LONG) limit = std::make_shared<UnaryExpNode>(U_TRANSFORM, limit, P_LONG);
+    auto vec_cond = std::make_shared<BinaryExpNode>(A_LE, sum, limit);
+    vec_cond->updateCalType();
+    vec_cond->updateTypeAfterCal();
+
+    Value step = ctx.iv->type == P_LONG ? Value{.type = P_LONG, .lvalue = width} : Value{.type = P_INT, .ivalue = width};
+    auto next = std::make_shared<BinaryExpNode>(A_ADD, makeVarRef(ctx.iv), std::make_shared<ValueNode>(step));
+    next->updateCalType();
+    next->updateTypeAfterCal();
+    auto increment = std::make_shared<AssignmentNode>(makeVarRef(ctx.iv), next);
+
+    // 标量循环之后还会被其他遍改写，向量循环使用独立的拷贝
+    std::vector<std::shared_ptr<AssignmentNode>> vec_body;
+    for (const auto& assign : assigns) {
+        vec_body.push_back(std::dynamic_pointer_cast<AssignmentNode>(cloneExpr(assign)));
+    }
+    auto vec_loop = std::make_shared<VectorLoopNode>(vec_cond, vec_body, increment, ctx.elem, width);
+    for (const auto& assign : vec_body) {
+        collectInvariants(assign->getExpr(), vec_loop, width * symbol_table.typeToSize(ctx.elem));
+    }
+    // 不同的全局或局部数组不会重叠，只有数组参数需要检查
+    for (size_t i = 0; i < ctx.stored.size(); i++) {
+        for (const auto& arr : ctx.arrays) {
+            if (arr == ctx.stored[i] || (!arr->is_param && !ctx.stored[i]->is_param)) continue;
+            bool checked = false;
+            for (size_t j = 0; j < i; j++) {
+                if (ctx.stored[j] == arr) checked = true;
+            }
+            if (!checked) vec_loop->addAliasCheck(makeVarRef(ctx.stored[i]), makeVarRef(arr));
+        }
+    }
+
+    opt_stats.count(name(), func_name);
+    std::vector<std::shared_ptr<StatementNode>> ret;
+    if (for_stmt != nullptr && for_stmt->getPreopStatement() != nullptr) {
+        ret.push_back(for_stmt->getPreopStatement());
+        for_stmt->setPreopStatement(nullptr);
+    }
+    ret.push_back(vec_loop);
+    ret.push_back(loop);
+    return ret;
+}
+
+// i++、++i、i = i + 1 或 i = 1 + i，返回计数器
+std::shared_ptr<Symbol> LoopVectorization::matchIncrement(const std::shared_ptr<StatementNode>& stmt) const {
+    std::shared_ptr<LValueNode> target;
+    if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(stmt)) {
+        if (x->getOp() != U_PREINC && x->getOp() != U_POSTINC) return nullptr;
+        target = std::dynamic_pointer_cast<LValueNode>(x->getExpr());
+    } else if (auto x = std::dynamic_pointer_cast<AssignmentNode>(stmt)) {
+        target = std::dynamic_pointer_cast<LValueNode>(x->getLvalue());
+        auto y = std::dynamic_pointer_cast<BinaryExpNode>(stripTransform(x->getExpr()));
+        if (target == nullptr || y == nullptr || y->getOp() != A_ADD) return nullptr;
+        const Symbol* sym = target->getSymbol().get();
+        long value;
+        bool ok = (isScalarOf(stripTransform(y->getLeft()), sym) && getConstantValue(y->getRight(), value) && value == 1)
+            || (isScalarOf(stripTransform(y->getRight()), sym) && getConstantValue(y->getLeft(), value) && value == 1);
+        if (!ok) return nullptr;
+    }
+    if (target == nullptr || target->isArray()) return nullptr;
+    auto sym = target->getSymbol();
+    if ((sym->type != P_INT && sym->type != P_LONG) || sym->is_global || address_taken.count(sym.get())) return nullptr;
+    return sym;
+}
+
+// 条件为 i < n、i <= n 或对称的 n > i、n >= i，n 在循环中不变
+bool LoopVectorization::matchCondition(const std::shared_ptr<ExprNode>& cond, const LoopContext& ctx, std::shared_ptr<ExprNode>& bound, bool& inclusive) const {
+    auto cmp = std::dynamic_pointer_cast<BinaryExpNode>(cond);
+    if (cmp == nullptr) return false;
+    const Symbol* iv = ctx.iv.get();
+    ExprType op = cmp->getOp();
+    if (isScalarOf(stripTransform(cmp->getLeft()), iv) && (op == A_LT || op == A_LE)) {
+        bound = stripTransform(cmp->getRight());
+        inclusive = op == A_LE;
+    } else if (isScalarOf(stripTransform(cmp->getRight()), iv) && (op == A_GT || op == A_GE)) {
+        bound = stripTransform(cmp->getLeft());
+        inclusive = op == A_GE;
+    } else {
+        return false;
+    }
+    if (bound->getPrimitiveType() != P_INT && bound->getPrimitiveType() != P_LONG) return false;
+    return isInvariantIn(bound, ctx.effects, address_taken);
+}
+
+// a[i]，a 是元素类型与其他访问相同的一维数组，返回数组
+std::shared_ptr<Symbol> LoopVectorization::matchAccess(const std::shared_ptr<ExprNode>& expr, LoopContext& ctx) const {
+    auto x = std::dynamic_pointer_cast<UnaryExpNode>(expr);
+    if (x == nullptr || x->getOp() != U_DEREF) return nullptr;
+    auto y = std::dynamic_pointer_cast<LValueNode>(x->getExpr());
+    if (y == nullptr || !y->isArray()) return nullptr;
+    auto scale = std::dynamic_pointer_cast<UnaryExpNode>(stripTransform(y->getIndex()));
+    if (scale == nullptr || scale->getOp() != U_SCALE || !isScalarOf(stripTransform(scale->getExpr()), ctx.iv.get())) return nullptr;
+    PrimitiveType elem = valueAt(y->getSymbol()->type);
+    if (!isVectorType(elem) || scale->getOffset() != symbol_table.typeToSize(elem)) return nullptr;
+    if (ctx.elem != P_NONE && ctx.elem != elem) return nullptr;
+    ctx.elem = elem;
+    addUnique(ctx.arrays, y->getSymbol());
+    return y->getSymbol();
+}
+
+// 按生成代码的顺序（先左后右）计算向量表达式需要的向量寄存器个数，不能向量化时返回-1
+int LoopVectorization::registerNeed(const std::shared_ptr<ExprNode>& expr, LoopContext& ctx) const {
+    if (expr->getPrimitiveType() != ctx.elem) return -1;
+    if (matchAccess(expr, ctx) != nullptr) return 1;
+    if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(expr)) {
+        ExprType op = x->getOp();
+        if (x->getCalType() != ctx.elem) return -1;
+        if (op != A_ADD && op != A_SUBTRACT && op != A_MULTIPLY && op != A_DIVIDE) return -1;
+        // 没有64位整数的向量乘法，整数除法也没有向量指令
+        if (op == A_MULTIPLY && ctx.elem == P_LONG) return -1;
+        if (op == A_DIVIDE && ctx.elem != P_FLOAT) return -1;
+        int left = registerNeed(x->getLeft(), ctx);
+        int right = registerNeed(x->getRight(), ctx);
+        if (left < 0 || right < 0) return -1;
+        int need = std::max(left, right + 1);
+        // SSE2 用 pmuludq 模拟32位乘法时需要一个临时寄存器
+        if (op == A_MULTIPLY && ctx.elem == P_INT && !compiler_options.avx2) need = std::max(need, 3);
+        return need;
+    }
+    return isBroadcast(expr, ctx) ? 1 : -1;
+}
+
+// 可以在每次迭代中求值后复制到整个向量的标量：常量和循环中不变的变量（可能经过类型转换）
+bool LoopVectorization::isBroadcast(const std::shared_ptr<ExprNode>& expr, const LoopContext& ctx) const {
+    auto inner = stripTransform(expr);
+    if (!std::dynamic_pointer_cast<ValueNode>(inner)) {
+        auto x = std::dynamic_pointer_cast<LValueNode>(inner);
+        if (x == nullptr || x->isArray()) return false;
+    }
+    return isInvariantIn(expr, ctx.effects, address_taken);
+}
+
+// 为向量表达式中每个标量叶子分配一个向量大小的栈槽
+void LoopVectorization::collectInvariants(const std::shared_ptr<ExprNode>& expr, const std::shared_ptr<VectorLoopNode>& vec_loop, int bytes) {
+    if (auto x = std::dynamic_pointer_cast<UnaryExpNode>(expr)) {
+        if (x->getOp() == U_DEREF) return;
+    } else if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(expr)) {
+        collectInvariants(x->getLeft(), vec_loop, bytes);
+        collectInvariants(x->getRight(), vec_loop, bytes);
+        return;
+    }
+    vec_loop->addInvariant(expr, symbol_table.allocateFrameSlot(func_name, bytes));
+}
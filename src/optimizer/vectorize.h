@@ -0,0 +1,37 @@
+#pragma once
+#include "optimizer/optimizer.h"
+#include "optimizer/ast_utils.h"
+#include <set>
+
+// 循环向量化：最内层的计数循环 for (i = s; i < n; i++) { a[i] = b[i] op c[i]; ... } 中只有按 i 访问的
+// 一维 int/long/float 数组赋值时，在原循环前面插入一个向量循环，每次用 SSE2（-mavx2 时用 AVX2）处理一个向量宽度的元素，
+// 剩下不足一个向量的元素仍由原来的标量循环处理。数组参数可能互相重叠，在运行时检查起始地址的距离，不够一个向量时只执行标量循环。
+class LoopVectorization : public Pass {
+public:
+    std::string name() const override { return "vectorize"; }
+    void run(const std::shared_ptr<Pragram>& program) override;
+private:
+    // 正在分析的循环
+    struct LoopContext {
+        std::shared_ptr<Symbol> iv; // 每次迭代加1的循环计数器
+        SideEffects effects;
+        PrimitiveType elem = P_NONE; // 所有数组访问的元素类型
+        std::vector<std::shared_ptr<Symbol>> stored; // 被赋值的数组
+        std::vector<std::shared_ptr<Symbol>> arrays; // 访问到的所有数组
+    };
+
+    std::string func_name;
+    std::set<Symbol*> address_taken;
+
+    void processBlock(const std::shared_ptr<BlockNode>& block);
+    std::vector<std::shared_ptr<StatementNode>> processStatement(const std::shared_ptr<StatementNode>& stmt);
+    std::shared_ptr<StatementNode> processBody(const std::shared_ptr<StatementNode>& stmt);
+    std::vector<std::shared_ptr<StatementNode>> vectorizeLoop(const std::shared_ptr<StatementNode>& loop);
+
+    std::shared_ptr<Symbol> matchIncrement(const std::shared_ptr<StatementNode>& stmt) const;
+    bool matchCondition(const std::shared_ptr<ExprNode>& cond, const LoopContext& ctx, std::shared_ptr<ExprNode>& bound, bool& inclusive) const;
+    std::shared_ptr<Symbol> matchAccess(const std::shared_ptr<ExprNode>& expr, LoopContext& ctx) const;
+    int registerNeed(const std::shared_ptr<ExprNode>& expr, LoopContext& ctx) const;
+    bool isBroadcast(const std::shared_ptr<ExprNode>& expr, const LoopContext& ctx) const;
+    void collectInvariants(const std::shared_ptr<ExprNode>& expr, const std::shared_ptr<VectorLoopNode>& vec_loop, int bytes);
+};
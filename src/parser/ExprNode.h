@@ -128,6 +128,7 @@ class UnaryExpNode : public ExprNode {
         }
         UnaryOp getOp() const { return op; }
         std::shared_ptr<ExprNode> getExpr() const { return expr; }
+        void setExpr(std::shared_ptr<ExprNode> expr) { this->expr = std::move(expr); }
         std::string convertTypeToString() const {
             switch (op) {
                 case U_PLUS:
@@ -219,6 +220,9 @@ class LValueNode : public ExprNode {
             Symbol sym = *identifier; // Return a copy of the identifier symbol
             return sym; 
         }
+        std::shared_ptr<Symbol> getSymbol() const {
+            return identifier; // Return the shared symbol so that passes can update it in place
+        }
         void walk(std::string prefix) override {
             // Implement the walk method to print the identifier
             std::cout << prettyPrint(prefix) << "LValue Identifier: " << identifier->name << ", Type: " << convertTypeToString() << std::endl;
@@ -273,6 +277,10 @@ class FunctionCallNode : public ExprNode {
             return identifier; // Return the function identifier
         }
 
+        void setIdentifier(std::string new_identifier) {
+            identifier = std::move(new_identifier); // Redirect the call to another function
+        }
+
         std::vector<std::shared_ptr<ExprNode>> getArguments() const {
             return args; // Return the list of arguments for the function call
         }
@@ -302,9 +310,18 @@ class FunctionCallNode : public ExprNode {
             return true; // Return whether the stack needs to be adjusted
         }
 
+        void setProfileCount(long count) {
+            profile_count = count;
+        }
+
+        long getProfileCount() const {
+            return profile_count;
+        }
+
     private:
         std::string identifier; // Identifier for the function being called
         std::vector<std::shared_ptr<ExprNode>> args; // Arguments for the function call
+        long profile_count = -1; // -fprofile-use 读入的调用点执行次数，没有 profile 时为-1
 
         int int_param_count; // Count of integer parameters
         int float_param_count; // Count of float parameters
@@ -24,6 +24,9 @@ class BlockNode : public StatementNode {
         std::vector<std::shared_ptr<StatementNode>> getStatements() const {
             return statements; // Return the list of statements
         }
+        void setStatements(std::vector<std::shared_ptr<StatementNode>> stmts) {
+            statements = std::move(stmts); // Replace the list of statements
+        }
         bool is_labeled = false; // Flag to indicate if the block has a label
 
     private:
@@ -152,6 +155,9 @@ class VariableDeclareNode : public StatementNode {
             }
             return ret; // Return the list of identifiers
         }
+        std::vector<std::shared_ptr<Symbol>> getSymbols() const {
+            return identifiers; // Return the shared symbols of the declared variables
+        }
         std::shared_ptr<ExprNode> getInitializer(Symbol identifier) const {
             for (size_t i = 0; i < identifiers.size(); ++i) {
                 if ((*identifiers[i]) == identifier) {
@@ -236,10 +242,38 @@ class IfStatementNode : public StatementNode {
         std::shared_ptr<StatementNode> getElseStatement() const {
             return else_stmt; // Return the else statement if it exists
         }
+
+        void setCondition(std::shared_ptr<ExprNode> condition) {
+            this->condition = std::move(condition);
+        }
+
+        void setThenStatement(std::shared_ptr<StatementNode> stmt) {
+            then_stmt = std::move(stmt);
+        }
+
+        void setElseStatement(std::shared_ptr<StatementNode> stmt) {
+            else_stmt = std::move(stmt);
+        }
+
+        void setProfileCounts(long then_count, long else_count) {
+            this->then_count = then_count;
+            this->else_count = else_count;
+        }
+
+        long getThenCount() const {
+            return then_count;
+        }
+
+        long getElseCount() const {
+            return else_count;
+        }
     private:
         std::shared_ptr<ExprNode> condition;
         std::shared_ptr<StatementNode> then_stmt;
         std::shared_ptr<StatementNode> else_stmt;
+        // -fprofile-use 读入的两个分支的执行次数，没有 profile 时为-1
+        long then_count = -1;
+        long else_count = -1;
 };
 
 class WhileStatementNode : public StatementNode {
@@ -264,6 +298,14 @@ class WhileStatementNode : public StatementNode {
             return body; // Return the body of the while loop
         }
 
+        void setCondition(std::shared_ptr<ExprNode> condition) {
+            this->condition = std::move(condition);
+        }
+
+        void setBody(std::shared_ptr<StatementNode> body) {
+            this->body = std::move(body);
+        }
+
         void setLabels(std::string while_start, std::string while_end) {
             this->while_start = while_start;
             this->while_end = while_end;
@@ -317,6 +359,22 @@ class ForStatementNode : public StatementNode {
             return postop_stmt; // Return the post-operation statement
         }
 
+        void setCondition(std::shared_ptr<ExprNode> condition) {
+            this->condition = std::move(condition);
+        }
+
+        void setBody(std::shared_ptr<StatementNode> body) {
+            this->body = std::move(body);
+        }
+
+        void setPreopStatement(std::shared_ptr<StatementNode> stmt) {
+            preop_stmt = std::move(stmt);
+        }
+
+        void setPostopStatement(std::shared_ptr<StatementNode> stmt) {
+            postop_stmt = std::move(stmt);
+        }
+
         void setLabels(std::string for_start_, std::string for_end_) {
             for_start = for_start_;
             for_end = for_end_; // Set the start and end labels for the for loop
@@ -341,6 +399,140 @@ class ForStatementNode : public StatementNode {
 
 };
 
+// switch 语句：cases 按源代码中的顺序排列，连续的 case 标号合并成一个分支，
+// 分支末尾没有 break 时落入下一个分支。break 跳到 switch_end，continue 仍属于外层循环
+class SwitchStatementNode : public StatementNode {
+    public:
+        struct Case {
+            std::vector<long> values; // case 标号的值
+            bool is_default = false;
+            std::shared_ptr<BlockNode> body;
+        };
+
+        SwitchStatementNode(std::shared_ptr<ExprNode> condition, std::vector<Case> cases)
+            : condition(std::move(condition)), cases(std::move(cases)) {
+            stmt_type = S_SWITCH; // Set the statement type to switch
+            type = P_NONE; // Set the type of the switch statement to void
+        }
+
+        void walk(std::string prefix) override {
+            std::cout << prettyPrint(prefix) << "Switch Statement: " << std::endl;
+            condition->walk(prefix + "\t"); // Walk the condition expression
+            for (const auto& c : cases) {
+                std::cout << prettyPrint(prefix + "\t") << (c.is_default ? "Default" : "Case");
+                for (long value : c.values) std::cout << " " << value;
+                std::cout << ": " << std::endl;
+                c.body->walk(prefix + "\t\t"); // Walk the statements of the case
+            }
+        }
+
+        std::shared_ptr<ExprNode> getCondition() const {
+            return condition; // Return the condition expression
+        }
+
+        const std::vector<Case>& getCases() const {
+            return cases; // Return the cases in source order
+        }
+
+        bool hasDefault() const {
+            for (const auto& c : cases) {
+                if (c.is_default) return true;
+            }
+            return false;
+        }
+
+        void setCondition(std::shared_ptr<ExprNode> condition) {
+            this->condition = std::move(condition);
+        }
+
+        void setCaseValues(size_t i, std::vector<long> values) {
+            cases[i].values = std::move(values);
+        }
+
+        void setCaseBody(size_t i, std::shared_ptr<BlockNode> body) {
+            cases[i].body = std::move(body);
+        }
+
+        void setLabel(std::string switch_end) {
+            this->switch_end = switch_end;
+        }
+
+        std::string getSwitchEndLabel() const {
+            return switch_end; // Return the end label for the switch statement
+        }
+
+    private:
+        std::shared_ptr<ExprNode> condition; // Value being dispatched on
+        std::vector<Case> cases;
+        std::string switch_end; // Label after the switch, target of break
+};
+
+// 向量化后的循环，由优化器生成：每次迭代把body中的赋值同时作用于width个连续元素，
+// 之后紧跟原来的标量循环处理剩下的元素。alias_checks中的两个数组起始地址相距不足一个向量时直接跳过向量循环。
+// 循环中只有向量指令：标量在进入循环前展开成向量，避免 AVX 与 SSE 指令混用时的状态切换
+class VectorLoopNode : public StatementNode {
+    public:
+        VectorLoopNode(std::shared_ptr<ExprNode> condition, std::vector<std::shared_ptr<AssignmentNode>> body, std::shared_ptr<ExprNode> increment, PrimitiveType elem_type, int width)
+            : condition(std::move(condition)), body(std::move(body)), increment(std::move(increment)), elem_type(elem_type), width(width) {
+            stmt_type = S_VECTOR;
+            type = P_NONE;
+        }
+
+        void walk(std::string prefix) override {
+            std::cout << prettyPrint(prefix) << "Vector Loop, Width " << width << ": " << std::endl;
+            condition->walk(prefix + "\t");
+            for (const auto& stmt : body) {
+                stmt->walk(prefix + "\t");
+            }
+            increment->walk(prefix + "\t");
+        }
+
+        std::shared_ptr<ExprNode> getCondition() const {
+            return condition;
+        }
+
+        const std::vector<std::shared_ptr<AssignmentNode>>& getBody() const {
+            return body;
+        }
+
+        std::shared_ptr<ExprNode> getIncrement() const {
+            return increment;
+        }
+
+        PrimitiveType getElementType() const {
+            return elem_type;
+        }
+
+        int getWidth() const {
+            return width;
+        }
+
+        void addAliasCheck(std::shared_ptr<ExprNode> a, std::shared_ptr<ExprNode> b) {
+            alias_checks.push_back({std::move(a), std::move(b)});
+        }
+
+        const std::vector<std::pair<std::shared_ptr<ExprNode>, std::shared_ptr<ExprNode>>>& getAliasChecks() const {
+            return alias_checks;
+        }
+
+        void addInvariant(std::shared_ptr<ExprNode> expr, int pos) {
+            invariants.push_back({std::move(expr), pos});
+        }
+
+        const std::vector<std::pair<std::shared_ptr<ExprNode>, int>>& getInvariants() const {
+            return invariants;
+        }
+
+    private:
+        std::shared_ptr<ExprNode> condition; // 剩余元素足够一个向量时为真
+        std::vector<std::shared_ptr<AssignmentNode>> body; // 形如 a[i] = b[i] op c[i] 的赋值
+        std::shared_ptr<ExprNode> increment; // i = i + width
+        PrimitiveType elem_type; // 数组元素类型：P_INT, P_LONG 或 P_FLOAT
+        int width; // 每次迭代处理的元素个数
+        std::vector<std::pair<std::shared_ptr<ExprNode>, std::shared_ptr<ExprNode>>> alias_checks; // 可能重叠的数组参数的起始地址
+        std::vector<std::pair<std::shared_ptr<ExprNode>, int>> invariants; // body中循环不变的标量，进入循环前复制成向量存放在栈帧的pos处
+};
+
 class FunctionParamNode : public StatementNode {
     public:
         FunctionParamNode() = default;
@@ -446,11 +638,24 @@ class FunctionDeclareNode : public  StatementNode {
             return params; // Return the function parameters
         }
 
+        void setParams(std::shared_ptr<FunctionParamNode> new_params) {
+            params = std::move(new_params); // Replace the function parameters
+        }
+
+        void setProfileCount(long count) {
+            profile_count = count;
+        }
+
+        long getProfileCount() const {
+            return profile_count;
+        }
+
     private:
         std::shared_ptr<FunctionParamNode> params; // Function parameters
         std::string identifier;
         PrimitiveType return_type;
         std::shared_ptr<BlockNode> body;
+        long profile_count = -1; // 函数被调用的次数，没有 profile 时为-1
 };
 
 
@@ -487,9 +692,16 @@ class ReturnStatementNode : public StatementNode {
         void setExpression(std::shared_ptr<ExprNode> expr) {
             expression = std::move(expr); // Set the expression being returned
         }
+        void setTailCall(bool tail_call) {
+            this->tail_call = tail_call;
+        }
+        bool isTailCall() const {
+            return tail_call;
+        }
     private:
         std::shared_ptr<ExprNode> expression; // Expression to return
         Function func;
+        bool tail_call = false; // 返回的调用可以复用当前栈帧，直接跳转到被调用函数
 };
 
 class Pragram: public ASTNode {
@@ -517,9 +729,21 @@ class Pragram: public ASTNode {
         std::vector<std::shared_ptr<FunctionDeclareNode>> getFunctions() const {
             return functions; // Return the list of functions
         }
+        void setProfileCounters(long counters, long checksum) {
+            profile_counters = counters;
+            profile_checksum = checksum;
+        }
+        long getProfileCounters() const {
+            return profile_counters;
+        }
+        long getProfileChecksum() const {
+            return profile_checksum;
+        }
     private:
         std::vector<std::shared_ptr<VariableDeclareNode>> global_vars; // List of statements in the program
         std::vector<std::shared_ptr<FunctionDeclareNode>> functions; // List of functions in the program
+        long profile_counters = 0; // -fprofile-generate 插入的计数器个数
+        long profile_checksum = 0; // 计数器布局的校验和，和计数一起写进 profile
 };
 
 class BreakStatementNode : public StatementNode {
@@ -554,4 +778,22 @@ class ContinueStatementNode : public StatementNode {
         }
     private:
         std::string label; // Label associated with the continue statement, if any
-};
\ No newline at end of file
+};
+
+// -fprofile-generate 插入的计数器：每执行一次，__profile_counters[index] 加一
+class ProfileCounterNode : public StatementNode {
+    public:
+        ProfileCounterNode(int index) : index(index) {
+            stmt_type = S_PROFILE;
+            type = P_NONE;
+        }
+
+        void walk(std::string prefix) override {
+            std::cout << prettyPrint(prefix) << "Profile Counter: " << index << std::endl;
+        }
+        int getIndex() const {
+            return index;
+        }
+    private:
+        int index;
+};
@@ -332,63 +332,7 @@ std::shared_ptr<BlockNode> Parser::parseBlock() {
         stmt_limit = true; // If the next token is not '{', we limit the statements to one
     }
     while (current < toks.size() && peek().type != T_RBRACE) {
-        if (peek().type == T_PRINT) {
-            std::shared_ptr<StatementNode> stmt = parsePrintStatement();
-            assert(consume().type == T_SEMI);
-            stmts->addStatement(stmt);
-        } else if (peek().type == T_INT || peek().type == T_CHAR 
-                || peek().type == T_FLOAT || peek().type == T_LONG) {
-            std::shared_ptr<VariableDeclareNode> var_decl = parseVariableDeclare();
-            assert(consume().type == T_SEMI);
-            stmts->addStatement(var_decl);
-        } else if (peek().type == T_IDENTIFIER || peek().type == T_STAR) {
-            std::shared_ptr<ExprNode> expr = parseExpressionWithPrecedence(0);
-            assert(consume().type == T_SEMI);
-            stmts->addStatement(expr);
-
-        } else if (peek().type == T_LBRACE) {
-            std::shared_ptr<BlockNode> block = parseBlock();
-            stmts->addStatement(block);
-        } else if (peek().type == T_IF) { 
-            std::shared_ptr<IfStatementNode> if_stmt = parseIfStatement();
-            stmts->addStatement(if_stmt);
-        } else if (peek().type == T_WHILE) {
-            std::shared_ptr<WhileStatementNode> while_stmt = parseWhileStatement();
-            stmts->addStatement(while_stmt);
-        } else if (peek().type == T_SEMI) {
-            consume(); // Skip empty statement
-        } else if (peek().type == T_FOR) {
-            std::shared_ptr<ForStatementNode> for_stmt = parseForStatement();
-            stmts->addStatement(for_stmt);
-        } else if (peek().type == T_RETURN) {
-            std::shared_ptr<ReturnStatementNode> return_stmt = parseReturnStatement();
-            assert(consume().type == T_SEMI);
-            stmts->addStatement(return_stmt);
-        } else if (peek().type == T_BREAK) {
-            consume();
-            if (loop_end_labels.empty()) {
-                throw std::runtime_error("Parser::parseBlock: 'break' statement not inside a loop at line " + 
-                    std::to_string(peek().line_no) + ", column " + 
-                    std::to_string(peek().column_no));
-            }
-            std::shared_ptr<BreakStatementNode> break_stmt = std::make_shared<BreakStatementNode>(loop_end_labels.back());
-            assert(consume().type == T_SEMI); // Expect a semicolon after break statement
-            stmts->addStatement(break_stmt);
-        } else if (peek().type == T_CONTINUE) {
-            consume(); // Consume the 'continue' token
-            if (loop_st_labels.empty()) {
-                throw std::runtime_error("Parser::parseBlock: 'continue' statement not inside a loop at line " + 
-                    std::to_string(peek().line_no) + ", column " + 
-                    std::to_string(peek().column_no));
-            }
-            std::shared_ptr<ContinueStatementNode> continue_stmt = std::make_shared<ContinueStatementNode>(loop_st_labels.back());
-            assert(consume().type == T_SEMI); // Expect a semicolon after continue statement
-            stmts->addStatement(continue_stmt);
-        } else {
-            throw std::runtime_error("Parser::parseStatement: Expected statement at line " + 
-                std::to_string(peek().line_no) + ", column " + 
-                std::to_string(peek().column_no));
-        }
+        parseStatement(stmts);
         if (stmt_limit) {
             break; // If we are limiting to one statement, break after the first statement
         }
@@ -400,6 +344,70 @@ std::shared_ptr<BlockNode> Parser::parseBlock() {
     return stmts;
 }
 
+// 解析一条语句加入stmts，声明的变量属于stmts所在的作用域
+void Parser::parseStatement(const std::shared_ptr<BlockNode>& stmts) {
+    if (peek().type == T_PRINT) {
+        std::shared_ptr<StatementNode> stmt = parsePrintStatement();
+        assert(consume().type == T_SEMI);
+        stmts->addStatement(stmt);
+    } else if (peek().type == T_INT || peek().type == T_CHAR 
+            || peek().type == T_FLOAT || peek().type == T_LONG) {
+        std::shared_ptr<VariableDeclareNode> var_decl = parseVariableDeclare();
+        assert(consume().type == T_SEMI);
+        stmts->addStatement(var_decl);
+    } else if (peek().type == T_IDENTIFIER || peek().type == T_STAR) {
+        std::shared_ptr<ExprNode> expr = parseExpressionWithPrecedence(0);
+        assert(consume().type == T_SEMI);
+        stmts->addStatement(expr);
+
+    } else if (peek().type == T_LBRACE) {
+        std::shared_ptr<BlockNode> block = parseBlock();
+        stmts->addStatement(block);
+    } else if (peek().type == T_IF) { 
+        std::shared_ptr<IfStatementNode> if_stmt = parseIfStatement();
+        stmts->addStatement(if_stmt);
+    } else if (peek().type == T_WHILE) {
+        std::shared_ptr<WhileStatementNode> while_stmt = parseWhileStatement();
+        stmts->addStatement(while_stmt);
+    } else if (peek().type == T_SEMI) {
+        consume(); // Skip empty statement
+    } else if (peek().type == T_FOR) {
+        std::shared_ptr<ForStatementNode> for_stmt = parseForStatement();
+        stmts->addStatement(for_stmt);
+    } else if (peek().type == T_RETURN) {
+        std::shared_ptr<ReturnStatementNode> return_stmt = parseReturnStatement();
+        assert(consume().type == T_SEMI);
+        stmts->addStatement(return_stmt);
+    } else if (peek().type == T_BREAK) {
+        consume();
+        if (loop_end_labels.empty()) {
+            throw std::runtime_error("Parser::parseBlock: 'break' statement not inside a loop at line " + 
+                std::to_string(peek().line_no) + ", column " + 
+                std::to_string(peek().column_no));
+        }
+        std::shared_ptr<BreakStatementNode> break_stmt = std::make_shared<BreakStatementNode>(loop_end_labels.back());
+        assert(consume().type == T_SEMI); // Expect a semicolon after break statement
+        stmts->addStatement(break_stmt);
+    } else if (peek().type == T_CONTINUE) {
+        consume(); // Consume the 'continue' token
+        if (loop_st_labels.empty()) {
+            throw std::runtime_error("Parser::parseBlock: 'continue' statement not inside a loop at line " + 
+                std::to_string(peek().line_no) + ", column " + 
+                std::to_string(peek().column_no));
+        }
+        std::shared_ptr<ContinueStatementNode> continue_stmt = std::make_shared<ContinueStatementNode>(loop_st_labels.back());
+        assert(consume().type == T_SEMI); // Expect a semicolon after continue statement
+        stmts->addStatement(continue_stmt);
+    } else if (peek().type == T_SWITCH) {
+        std::shared_ptr<SwitchStatementNode> switch_stmt = parseSwitchStatement();
+        stmts->addStatement(switch_stmt);
+    } else {
+        throw std::runtime_error("Parser::parseStatement: Expected statement at line " + 
+            std::to_string(peek().line_no) + ", column " + 
+            std::to_string(peek().column_no));
+    }
+}
+
 std::shared_ptr<ArrayInitializer> Parser::parseArrayInitializer(std::shared_ptr<Symbol>sym, std::vector<int> &dimensions, int depth) {
     if (depth >= (int)dimensions.size()) {
         throw std::runtime_error("Parser::parseArrayInitializer: Depth exceeds dimensions size at line " + 
@@ -545,6 +553,66 @@ std::shared_ptr<WhileStatementNode> Parser::parseWhileStatement() {
     return ret;
 }
 
+// case 标号只能是整数常量（包括字符常量），可以带负号
+long Parser::parseCaseValue() {
+    bool negative = false;
+    if (peek().type == T_MINUS) {
+        consume();
+        negative = true;
+    }
+    Token tok = consume();
+    if (tok.type != T_NUMBER || (tok.value.type != P_INT && tok.value.type != P_LONG)) {
+        throw std::runtime_error("Parser::parseCaseValue: Expected integer constant in case label at line " +
+            std::to_string(tok.line_no) + ", column " +
+            std::to_string(tok.column_no));
+    }
+    long value = tok.value.type == P_INT ? tok.value.ivalue : tok.value.lvalue;
+    return negative ? -value : value;
+}
+
+std::shared_ptr<SwitchStatementNode> Parser::parseSwitchStatement() {
+    assert(consume().type == T_SWITCH);
+    assert(consume().type == T_LPAREN);
+    std::shared_ptr<ExprNode> condition = parseExpressionWithPrecedence(0);
+    assert(consume().type == T_RPAREN);
+    assert(consume().type == T_LBRACE);
+    std::string switch_end = "SWITCH_END_" + labelAllocator.getLabel(LableType::SWITCH_LABEL);
+    // break 跳出 switch，continue 仍然对应外层循环
+    loop_end_labels.push_back(switch_end);
+    symbol_table.enterScope(); // 所有分支共用一个作用域
+    std::vector<SwitchStatementNode::Case> cases;
+    while (current < toks.size() && peek().type != T_RBRACE) {
+        if (peek().type == T_CASE || peek().type == T_DEFAULT) {
+            // 紧挨着的标号属于同一个分支
+            if (cases.empty() || !cases.back().body->getStatements().empty()) {
+                cases.push_back(SwitchStatementNode::Case{{}, false, std::make_shared<BlockNode>()});
+            }
+            if (consume().type == T_CASE) {
+                cases.back().values.push_back(parseCaseValue());
+            } else {
+                cases.back().is_default = true;
+            }
+            if (consume().type != T_COLON) {
+                throw std::runtime_error("Parser::parseSwitchStatement: Expected ':' after case label at line " +
+                    std::to_string(peek().line_no) + ", column " +
+                    std::to_string(peek().column_no));
+            }
+        } else if (cases.empty()) {
+            throw std::runtime_error("Parser::parseSwitchStatement: Statement before the first case label at line " +
+                std::to_string(peek().line_no) + ", column " +
+                std::to_string(peek().column_no));
+        } else {
+            parseStatement(cases.back().body);
+        }
+    }
+    assert(consume().type == T_RBRACE);
+    symbol_table.exitScope();
+    loop_end_labels.pop_back();
+    auto ret = std::make_shared<SwitchStatementNode>(std::move(condition), std::move(cases));
+    ret->setLabel(switch_end);
+    return ret;
+}
+
 // 要么是声明，要么是表达式
 std::shared_ptr<StatementNode> Parser::parseSingleStatement() {
     if (peek().type == T_INT || peek().type == T_CHAR ||
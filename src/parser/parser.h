@@ -61,6 +61,7 @@ public:
      ;
      */
     std::shared_ptr<BlockNode> parseBlock();
+    void parseStatement(const std::shared_ptr<BlockNode>& stmts);
     std::shared_ptr<PrintStatementNode> parsePrintStatement();
 
     // 有关变量
@@ -95,6 +96,17 @@ public:
    // while: while_statement: 'while' '(' true_false_expression ')' compound_statement  ;
    std::shared_ptr<WhileStatementNode> parseWhileStatement();
 
+   // switch:
+   /*
+    switch_statement: 'switch' '(' expression ')' '{' switch_item* '}'  ;
+    switch_item: 'case' ['-'] NUMBER ':'
+        |        'default' ':'
+        |        statement
+        ;
+   */
+   std::shared_ptr<SwitchStatementNode> parseSwitchStatement();
+   long parseCaseValue();
+
    // for: 
    /*
     for_statement: 'for' '(' preop_statement ';'
@@ -304,6 +304,8 @@ bool Scanner::scan(Token& token) {
         token.type = T_INVERT;
     } else if (c == '^') {
         token.type = T_XOR; // Assuming T_XOR is defined in TokenType
+    } else if (c == ':') {
+        token.type = T_COLON;
     } else {
         throw std::runtime_error("Unexpected character: " + std::string(1, c) 
                                  + " at line " + std::to_string(line_no) 
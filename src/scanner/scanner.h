@@ -13,6 +13,9 @@ class Scanner {
                 throw std::runtime_error("Failed to open file: " + source_path);
             }
             read_index = 0;
+            putback_char = 0;
+            line_no = 1;
+            column_no = 0;
         }
         // Destructor
         ~Scanner() = default;
@@ -35,6 +38,9 @@ class Scanner {
             {"return", T_RETURN},
             {"break", T_BREAK},
             {"continue", T_CONTINUE},
+            {"switch", T_SWITCH},
+            {"case", T_CASE},
+            {"default", T_DEFAULT},
         };
         int line_no;
         int column_no;
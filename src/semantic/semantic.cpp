@@ -160,6 +160,9 @@ void Semantic::checkStatement(std::shared_ptr<StatementNode> stmt) {
         case S_RETURN:
             checkReturnStatement(std::dynamic_pointer_cast<ReturnStatementNode>(stmt));
             break;
+        case S_SWITCH:
+            checkSwitchStatement(std::dynamic_pointer_cast<SwitchStatementNode>(stmt));
+            break;
         default:
             break;
     }
@@ -214,6 +217,38 @@ void Semantic::checkWhileStatement(std::shared_ptr<WhileStatementNode> node) {
     checkStatement(node->getBody());
 }
 
+// 条件统一转换为long再分派，case 标号先按条件原来的类型截断
+void Semantic::checkSwitchStatement(std::shared_ptr<SwitchStatementNode> node) {
+    checkExpression(node->getCondition());
+    PrimitiveType type = node->getCondition()->getCalculateType();
+    if (type != P_INT && type != P_CHAR && type != P_LONG) {
+        throw std::runtime_error("Semantic::checkSwitchStatement: Switch condition must be an integer");
+    }
+    if (type != P_LONG) {
+        node->setCondition(std::make_shared<UnaryExpNode>(U_TRANSFORM, node->getCondition(), P_LONG));
+    }
+    std::set<long> seen;
+    int defaults = 0;
+    const auto& cases = node->getCases();
+    for (size_t i = 0; i < cases.size(); i++) {
+        std::vector<long> values;
+        for (long value : cases[i].values) {
+            // char 提升为 int 后比较
+            if (type != P_LONG) value = static_cast<int>(value);
+            if (!seen.insert(value).second) {
+                throw std::runtime_error("Semantic::checkSwitchStatement: Duplicate case value " + std::to_string(value));
+            }
+            values.push_back(value);
+        }
+        node->setCaseValues(i, values);
+        if (cases[i].is_default) defaults++;
+        checkBlock(cases[i].body);
+    }
+    if (defaults > 1) {
+        throw std::runtime_error("Semantic::checkSwitchStatement: Multiple default labels in one switch");
+    }
+}
+
 void Semantic::checkExpression(std::shared_ptr<ExprNode> node) {
     if (auto x = std::dynamic_pointer_cast<BinaryExpNode>(node)) {
         checkExpression(x->getLeft());
@@ -1,6 +1,7 @@
 #pragma once
 #include "common/defs.h"
 #include "parser/parser.h"
+#include <set>
 
 class Semantic {
 public:
@@ -16,6 +17,7 @@ public:
     void checkIfStatement(std::shared_ptr<IfStatementNode> node);
     void checkWhileStatement(std::shared_ptr<WhileStatementNode> node);
     void checkForStatement(std::shared_ptr<ForStatementNode> node);
+    void checkSwitchStatement(std::shared_ptr<SwitchStatementNode> node);
     void checkStatement(std::shared_ptr<StatementNode> node);
     void checkReturnStatement(std::shared_ptr<ReturnStatementNode> node);
 private:
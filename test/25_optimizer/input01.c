@@ -0,0 +1,50 @@
+int swap(int *a, int *b) {
+    int t;
+    t = *a;
+    *a = *b;
+    *b = t;
+    return 0;
+}
+
+int divmod(int a, int b, int c) {
+    int q, r, k;
+    q = a / c;
+    r = a % c;
+    k = b << 2;
+    return q + r + k + c;
+}
+
+long dot(int a[], int b[], int n) {
+    int i;
+    long s;
+    s = 0;
+    for (i = 0; i < n; i++) {
+        s = s + a[i] * b[i];
+    }
+    return s;
+}
+
+int main() {
+    int x, y, i, acc;
+    int a[8];
+    int b[8];
+    char c;
+    x = 3;
+    y = 4;
+    swap(&x, &y);
+    printint(x);
+    printint(y);
+    printint(divmod(100, 3, 7));
+    acc = 0;
+    c = 0;
+    for (i = 0; i < 8; i++) {
+        a[i] = i + 1;
+        b[i] = 8 - i;
+        acc = acc + divmod(i, i, 3);
+        c++;
+    }
+    printint(acc);
+    printint(c);
+    printlong(dot(a, b, 8));
+    return 0;
+}
@@ -0,0 +1,48 @@
+int hash(int x) {
+    int h;
+    h = x * 31 + 7;
+    h = h * 5;
+    h = h * 9 - x * 3;
+    h = h * -6;
+    h = h * 1000003;
+    return h;
+}
+long lmul(long x) {
+    long r;
+    r = x * 12 + x * 40 - x * 1024 + x * 100000;
+    r = r * 10000000000;
+    return r;
+}
+int main() {
+    int i, s, t, m;
+    long l, ls;
+    s = 0;
+    for (i = -1000; i < 1000; i = i + 7) {
+        s = s + i / 3 + i / 7 - i / -5 + i / 16 + i / -8 + i / 2 + i / 1 + i / -1;
+        s = s + i % 3 + i % 7 + i % -5 + i % 16 + i % -8 + i % 2 + i % 1 + i % 1000;
+        s = s + hash(i) / 641 + hash(i) % 641 + hash(i) / 2147483647 + hash(i) / -2147483648;
+    }
+    printint(s);
+    t = 2147483647;
+    printint(t / 10);
+    printint(t % 10);
+    t = -2147483647 - 1;
+    printint(t / 10);
+    printint(t % 10);
+    printint(t / 4);
+    printint(t % 4);
+    printint(t / -2147483648);
+    printint(t % -2147483648);
+    ls = 0;
+    for (l = -100000000000; l < 100000000000; l = l + 999999937) {
+        ls = ls + l / 3 + l % 3 + l / 1000000007 + l % 1000000007 + l / -64 + l % 64 + lmul(l) / 10000000000;
+        ls = ls + l / 7 + l % -7 + l / 12345678901 + l % 12345678901;
+    }
+    printlong(ls);
+    m = 0;
+    for (i = 1; i < 50; i++) {
+        m = m + hash(i) % 97 + hash(-i) / 10 + i * 0 + i * 1 + i * -1 + i * 2 + i * 24 + i * -3;
+    }
+    printint(m);
+    return 0;
+}
@@ -0,0 +1,160 @@
+int g[8][10];
+int h[6][5][4];
+int n;
+int scale;
+float fa[5][6];
+long la[4][4];
+int bump() {
+    scale = scale + 1;
+    return scale;
+}
+int sum2(int a[][10], int rows) {
+    int i, j, s;
+    s = 0;
+    for (i = 0; i < rows; i++) {
+        for (j = 0; j < 10; j++) {
+            s = s + a[i][j] * (i + 1);
+        }
+    }
+    return s;
+}
+void fill(int a[][10], int rows) {
+    int i, j;
+    for (i = 0; i < rows; i++) {
+        j = 0;
+        while (j < 10) {
+            a[i][j] = i * 10 + j;
+            j++;
+        }
+    }
+}
+int alias(int a[], int b[], int k) {
+    int i, s;
+    s = 0;
+    for (i = 0; i < 5; i++) {
+        a[i] = b[k] + i;
+        s = s + b[k];
+    }
+    return s;
+}
+int ga[10];
+int none(int cnt, int k) {
+    int i, s;
+    s = 0;
+    i = 0;
+    while (i < cnt) {
+        s = s + ga[k];
+        i = i + 1;
+    }
+    for (i = 0; i < cnt; i++) {
+        s = s + ga[k + 1];
+    }
+    return s;
+}
+int main() {
+    int i, j, k, s, t, m;
+    int *p;
+    int loc[5][6];
+    int v[10];
+    n = 8;
+    scale = 3;
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < 10; j++) {
+            g[i][j] = i * scale + j;
+        }
+    }
+    s = 0;
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < 10; j++) {
+            s = s + g[i][j] * n + g[j % 8][i];
+        }
+    }
+    printint(s);
+    for (i = 0; i < 6; i++) {
+        for (j = 0; j < 5; j++) {
+            for (k = 0; k < 4; k++) {
+                h[i][j][k] = i * 100 + j * 10 + k;
+            }
+        }
+    }
+    s = 0;
+    for (i = 0; i < 6; i++) {
+        for (j = 0; j < 5; j++) {
+            for (k = 0; k < 4; k++) {
+                s = s + h[i][j][k] - h[5 - i][j][3 - k];
+                t = h[i][4 - j][k];
+                s = s + t;
+            }
+        }
+    }
+    printint(s);
+    for (i = 0; i < 5; i++) {
+        for (j = 0; j < 6; j++) {
+            loc[i][j] = i - j;
+            fa[i][j] = i * 0.5 + j;
+        }
+    }
+    s = 0;
+    for (i = 0; i < 5; i++) {
+        for (j = 0; j < 6; j++) {
+            s = s + loc[i][j] * loc[i][0];
+            loc[i][0] = loc[i][0] + 1;
+        }
+    }
+    printint(s);
+    float f;
+    f = 0.0;
+    for (i = 0; i < 5; i++) {
+        for (j = 0; j < 6; j++) {
+            f = f + fa[i][j] * fa[4 - i][5];
+        }
+    }
+    printfloat(f);
+
+    s = 0;
+    for (i = 0; i < 4; i++) {
+        s = s + scale * 2 + bump();
+    }
+    printint(s);
+
+    m = 5;
+    p = &m;
+    s = 0;
+    for (i = 0; i < 4; i++) {
+        s = s + m * 3;
+        *p = *p + 1;
+    }
+    printint(s);
+    fill(g, 8);
+    printint(sum2(g, 8));
+    for (i = 0; i < 10; i++) { v[i] = i; }
+    printint(alias(v, v, 2));
+    printint(v[2]);
+
+    s = 0;
+    k = 1000000;
+    for (i = 0; i < 3; i++) {
+        if (i > 5) {
+            s = s + v[k];
+        }
+        s = s + n / 4 + n % 3;
+    }
+    printint(s);
+    long ls;
+    ls = 0;
+    for (i = 0; i < 4; i++) {
+        for (j = 0; j < 4; j++) {
+            la[i][j] = i * 1000000000000 + j;
+        }
+    }
+    for (i = 0; i < 4; i++) {
+        for (j = 0; j < 4; j++) {
+            ls = ls + la[i][j] + la[j][i] * 2;
+        }
+    }
+    printlong(ls);
+    k = 1000000;
+    printint(none(n - 8, k * 1000));
+    printint(none(n - 8, 1000000000));
+    return 0;
+}
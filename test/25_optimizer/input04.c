@@ -0,0 +1,124 @@
+int g[40];
+long lg[20];
+float fg[16];
+char cg[30];
+int m2[6][7];
+int dot(int a[], int b[], int n) {
+    int i, s;
+    s = 0;
+    for (i = 0; i < n; i++) {
+        s = s + a[i] * b[i];
+    }
+    return s;
+}
+int rev(int a[], int n) {
+    int i, s;
+    s = 0;
+    i = n - 1;
+    while (i >= 0) {
+        s = s * 3 + a[i] - a[n - 1 - i];
+        i = i - 1;
+    }
+    return s;
+}
+int stride(int a[], int n) {
+    int i, s;
+    s = 0;
+    for (i = 1; i < n; i = i + 3) {
+        s = s + a[i] + a[i - 1];
+    }
+    return s + i;
+}
+int main() {
+    int i, j, s, k, n;
+    long l, ls;
+    float f;
+    int loc[25];
+    n = 40;
+    for (i = 0; i < n; i++) {
+        g[i] = i * 7 % 11;
+    }
+    printint(dot(g, g, 40));
+    printint(rev(g, 40));
+    printint(stride(g, 40));
+    i = 0;
+    while (i != 25) {
+        loc[i] = g[i + 10] - g[i];
+        i = i + 1;
+    }
+    s = 0;
+    for (i = 24; i > -1; i--) {
+        s = s + loc[i] * i;
+    }
+    printint(s);
+    printint(i);
+    for (l = 0; l < 20; l++) {
+        lg[l] = l * 100000000000;
+    }
+    ls = 0;
+    l = 19;
+    while (l >= 0) {
+        ls = ls + lg[l] / 3;
+        l = l - 2;
+    }
+    printlong(ls);
+    for (i = 0; i < 16; i++) {
+        fg[i] = i * 0.25;
+    }
+    f = 0.0;
+    for (i = 0; i < 16; i = i + 2) {
+        f = f + fg[i] * fg[i + 1];
+    }
+    printfloat(f);
+    for (i = 0; i < 30; i++) {
+        cg[i] = i + 65;
+    }
+    s = 0;
+    for (i = 0; i < 30; i++) {
+        s = s + cg[i];
+    }
+    printint(s);
+    for (i = 0; i < 6; i++) {
+        for (j = 0; j < 7; j++) {
+            m2[i][j] = i * j + j;
+        }
+    }
+    s = 0;
+    for (j = 0; j < 7; j++) {
+        for (i = 0; i < 6; i++) {
+            s = s + m2[i][j] * (j + 1);
+        }
+    }
+    printint(s);
+    s = 0;
+    k = 0;
+    for (i = 0; i < 40; i++) {
+        if (g[i] > 5) {
+            k = k + 1;
+            s = s + loc[k];
+        }
+        if (i > 30) {
+            break;
+        }
+    }
+    printint(s);
+    printint(k);
+    s = 0;
+    i = 0;
+    while (i < 40) {
+        i = i + 1;
+        if (g[i - 1] == 3) {
+            continue;
+        }
+        s = s + g[i - 1];
+    }
+    printint(s);
+    j = 0;
+    while (j < 20) {
+        g[j] = g[j + 1] + g[j];
+        j = j + 1;
+    }
+    printint(g[0] + g[19]);
+    printint(j);
+    return 0;
+}
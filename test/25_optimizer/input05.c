@@ -0,0 +1,80 @@
+int ga[37];
+int gb[37];
+int gc[37];
+long la[21];
+long lb[21];
+float fa[19];
+float fb[19];
+float fc[19];
+void vadd(int a[], int b[], int c[], int n) {
+    int i;
+    for (i = 0; i < n; i++) {
+        a[i] = b[i] + c[i];
+    }
+}
+void vmul(int a[], int b[], int n, int k) {
+    int i;
+    i = 0;
+    while (i < n) {
+        a[i] = b[i] * a[i] * k - 3;
+        i = i + 1;
+    }
+}
+void fsaxpy(float y[], float x[], float alpha, int n) {
+    int i;
+    for (i = 0; i <= n; ++i) {
+        y[i] = alpha * x[i] + y[i];
+    }
+}
+int main() {
+    int i, s, n;
+    long ls;
+    float f;
+    for (i = 0; i < 37; i++) {
+        gb[i] = i * 3 - 20;
+        gc[i] = 100 - i * i;
+    }
+    vadd(ga, gb, gc, 37);
+    s = 0;
+    for (i = 0; i < 37; i++) {
+        s = s * 7 + ga[i];
+    }
+    printint(s);
+    vmul(ga, gb, 37, 5);
+    s = 0;
+    for (i = 0; i < 37; i++) {
+        s = s * 7 + ga[i];
+    }
+    printint(s);
+    vadd(gb, gb, gb, 30);
+    printint(gb[29] + gb[0]);
+    vadd(gb, gc, gc, 3);
+    printint(gb[0] + gb[1] + gb[2] + gb[3]);
+    for (i = 0; i < 21; i++) {
+        lb[i] = i * 1000000007;
+    }
+    n = 21;
+    for (i = 2; i < n; i++) {
+        la[i] = lb[i] - la[i] + 12345678901;
+    }
+    ls = 0;
+    for (i = 0; i < 21; i++) {
+        ls = ls + la[i] * i;
+    }
+    printlong(ls);
+    for (i = 0; i < 19; i++) {
+        fa[i] = i * 0.5;
+        fb[i] = 3.5 - i;
+    }
+    fsaxpy(fa, fb, 1.5, 17);
+    for (i = 1; i < 19; i++) {
+        fc[i] = fa[i] / fb[i] + i;
+    }
+    f = 0.0;
+    for (i = 0; i < 19; i++) {
+        f = f + fa[i] * 3.0 + fc[i];
+    }
+    printfloat(f);
+    printint(i);
+    return 0;
+}
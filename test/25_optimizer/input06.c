@@ -0,0 +1,113 @@
+int m[4][4];
+int g;
+int sq(int x) {
+    return x * x;
+}
+int get(int a[], int i) {
+    return a[i];
+}
+float fmix(float a, float b) {
+    return a * 0.5 + b;
+}
+int clamp(int x, int lo, int hi) {
+    if (x < lo) {
+        return lo;
+    }
+    if (x > hi) {
+        return hi;
+    }
+    return x;
+}
+void bump(int n) {
+    g = g + n;
+    n = n * 2;
+    g = g + n;
+}
+int sum(int a[], int n) {
+    int i, s;
+    s = 0;
+    for (i = 0; i < n; i++) {
+        if (a[i] > 100) {
+            break;
+        }
+        s = s + a[i];
+    }
+    return s;
+}
+int fact(int n) {
+    if (n <= 1) {
+        return 1;
+    }
+    return n * fact(n - 1);
+}
+int sign(int x) {
+    if (x < 0) {
+        return -1;
+    } else {
+        if (x == 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+int twice(int x) {
+    return sq(x) + sq(x + 1);
+}
+int trace(int a[][4]) {
+    int i, s;
+    s = 0;
+    i = 0;
+    while (i < 4) {
+        s = s + a[i][i];
+        i++;
+    }
+    return s;
+}
+int cell(int a[][4], int r, int c) {
+    return a[r][c] * 2;
+}
+long lmax(long a, long b) {
+    if (a > b) {
+        return a;
+    }
+    return b;
+}
+int main() {
+    int a[20];
+    int i, j, t;
+    long best;
+    float f;
+    for (i = 0; i < 20; i++) {
+        a[i] = sq(i) - 3 * i;
+    }
+    t = 0;
+    for (i = 0; i < 20; i++) {
+        t = t + get(a, i) + clamp(a[i], 0, 50);
+        bump(i);
+    }
+    printint(t);
+    printint(g);
+    printint(sum(a, 20));
+    int s = sum(a, 10);
+    printint(s);
+    printint(fact(6));
+    printint(sign(-5) + sign(0) * 10 + sign(7) * 100);
+    printint(twice(3));
+    f = fmix(3.0, 1.5);
+    printfloat(f);
+    sum(a, 3);
+    for (i = 0; i < 4; i++) {
+        for (j = 0; j < 4; j++) {
+            m[i][j] = i * 4 + j;
+        }
+    }
+    printint(trace(m));
+    best = 0;
+    for (i = 0; i < 4; i++) {
+        for (j = 0; j < 4; j++) {
+            best = lmax(best, cell(m, i, j) - j * 3);
+        }
+    }
+    printlong(best);
+    return clamp(t, 0, 1) - 1;
+}
@@ -0,0 +1,87 @@
+int a[8];
+long sum(long n) {
+    if (n == 0) {
+        return 0;
+    }
+    return n + sum(n - 1);
+}
+int gcd(int x, int y) {
+    if (y == 0) {
+        return x;
+    }
+    return gcd(y, x % y);
+}
+long fact(int n, long acc) {
+    if (n <= 1) {
+        return acc;
+    }
+    return fact(n - 1, acc * n);
+}
+int pow2(int n) {
+    if (n == 0) {
+        return 1;
+    }
+    return 2 * pow2(n - 1);
+}
+int count(int arr[], int i, int n, int v) {
+    int c;
+    if (i >= n) {
+        return 0;
+    }
+    c = 0;
+    if (arr[i] == v) {
+        c = 1;
+    }
+    return c + count(arr, i + 1, n, v);
+}
+void fill(int arr[], int i, int n) {
+    if (i < n) {
+        arr[i] = i * i % 5;
+        fill(arr, i + 1, n);
+    }
+}
+int swapdown(int x, int y, int k) {
+    if (k == 0) {
+        return x * 100 + y;
+    }
+    return swapdown(y, x, k - 1);
+}
+int collatz(long n, int steps) {
+    if (n == 1) {
+        return steps;
+    }
+    if (n % 2 == 0) {
+        return collatz(n / 2, steps + 1);
+    }
+    return collatz(3 * n + 1, steps + 1);
+}
+int fib(int n) {
+    if (n < 2) {
+        return n;
+    }
+    return fib(n - 1) + fib(n - 2);
+}
+int twice(int x) {
+    return gcd(x * 6, 84);
+}
+float half(float x, int k) {
+    if (k == 0) {
+        return x;
+    }
+    return half(x * 0.5, k - 1);
+}
+int main() {
+    int i;
+    printlong(sum(10000000));
+    printint(gcd(1071, 462));
+    printlong(fact(20, 1));
+    printint(pow2(30));
+    fill(a, 0, 8);
+    printint(count(a, 0, 8, 4));
+    printint(swapdown(3, 7, 5));
+    printint(collatz(27, 0));
+    printint(fib(20));
+    printint(twice(35));
+    printfloat(half(48.0, 4));
+    return 0;
+}
@@ -0,0 +1,83 @@
+int g;
+int a[16];
+int bump(int x) {
+    g = g + x;
+    return g;
+}
+int dead(int n) {
+    int i, t, s, k = 5;
+    s = 0;
+    for (i = 0; i < n; i++) {
+        t = a[i] * 3;
+        if (0) {
+            s = s + t;
+        }
+        s = s + a[i];
+        t = bump(1);
+        k = k + 1;
+        if (i > 100) {
+            break;
+            s = 0;
+        }
+    }
+    return s;
+    s = 7;
+}
+int carried(int n) {
+    int i, prev, cur;
+    prev = 0;
+    cur = 1;
+    i = 0;
+    while (i < n) {
+        int next = prev + cur;
+        prev = cur;
+        cur = next;
+        i++;
+    }
+    return prev;
+}
+int skip(int n) {
+    int i, s, last;
+    s = 0;
+    last = -1;
+    i = 0;
+    while (i < n - 1) {
+        i++;
+        if (a[i] % 3 == 0) {
+            last = i;
+            continue;
+        }
+        s = s + a[i];
+        if (s > 50) {
+            break;
+        }
+        last = 0;
+    }
+    return s * 100 + last;
+}
+int consts(int x) {
+    int r;
+    r = 0;
+    if (1) {
+        r = x + 1;
+    } else {
+        r = x - 1;
+    }
+    while (0) {
+        r = r * 2;
+    }
+    x + r;
+    return r;
+}
+int main() {
+    int i;
+    for (i = 0; i < 16; i++) {
+        a[i] = i * 7 % 11;
+    }
+    printint(dead(16));
+    printint(g);
+    printint(carried(30));
+    printint(skip(16));
+    printint(consts(41));
+    return 0;
+}
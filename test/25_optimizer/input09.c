@@ -0,0 +1,109 @@
+int a[10];
+long big;
+char c;
+int cmpval(int x, int y) {
+    int r;
+    r = (x < y) + (x <= 3) * 2 + (5 > x) * 4 + (x == y) * 8 + (x != -2) * 16 + (y >= x) * 32;
+    return r;
+}
+long lcmp(long x) {
+    long r;
+    r = 0;
+    if (x > 3000000000) {
+        r = r + 1;
+    }
+    if (x < -3000000000) {
+        r = r + 2;
+    }
+    if (x != 0) {
+        r = r + 4;
+    }
+    if (-1 < x) {
+        r = r + 8;
+    }
+    return r;
+}
+int bits(int x, int y) {
+    int n;
+    n = 0;
+    if (x & y) {
+        n = n + 1;
+    }
+    if (x - y) {
+        n = n + 2;
+    }
+    if (x * y) {
+        n = n + 4;
+    }
+    if (x ^ y) {
+        n = n + 8;
+    }
+    if (x) {
+        n = n + 16;
+    }
+    if (x >> 1) {
+        n = n + 32;
+    }
+    return n;
+}
+int chars(char d) {
+    int n;
+    n = 0;
+    if (d == 'a') {
+        n = n + 1;
+    }
+    if (d < c) {
+        n = n + 2;
+    }
+    if (d) {
+        n = n + 4;
+    }
+    return n;
+}
+int mixed(int x, long y) {
+    if (x < y) {
+        return 1;
+    }
+    if (y == x) {
+        return 2;
+    }
+    return 3;
+}
+int main() {
+    int i, s;
+    s = 0;
+    for (i = 0; i < 10; i++) {
+        a[i] = i - 5;
+    }
+    for (i = 0; i < 10; i++) {
+        if (a[i] < 0) {
+            s = s + 1;
+        }
+        if (a[i] >= -2) {
+            s = s + 10;
+        }
+        if ((a[i] & 4) != 0) {
+            s = s + 100;
+        }
+    }
+    printint(s);
+    printint(cmpval(1, 2));
+    printint(cmpval(-2, -2));
+    printint(cmpval(7, 4));
+    big = 4000000000;
+    printlong(lcmp(big));
+    printlong(lcmp(-big));
+    printlong(lcmp(0));
+    printlong(lcmp(-1));
+    printint(bits(6, 3));
+    printint(bits(0, 5));
+    printint(bits(1, 1));
+    c = 'm';
+    printint(chars('a'));
+    printint(chars('z'));
+    printint(chars(0));
+    printint(mixed(3, 4000000000));
+    printint(mixed(-1, -1));
+    printint(mixed(5, -4000000000));
+    return 0;
+}
@@ -0,0 +1,63 @@
+int calls;
+int sq(int x) {
+    calls = calls + 1;
+    return x * x;
+}
+int add3(int a, int b, int c) {
+    return a + b + c;
+}
+int sum8(int a, int b, int c, int d, int e, int f, int g, int h) {
+    return a + 2 * b + 3 * c + 4 * d + 5 * e + 6 * f + 7 * g + 8 * h;
+}
+long lmix(long a, int b, long c) {
+    return a * b - c;
+}
+float fhalf(float x) {
+    return x / 2.0;
+}
+float fmix(float a, int b, float c) {
+    return a * b + c;
+}
+int poly(int x) {
+    int r;
+    r = sq(x) + sq(x + 1) * sq(x + 2) - sq(x - 1);
+    return r;
+}
+int walk(int n) {
+    int i;
+    int s;
+    s = 0;
+    i = 0;
+    while (i < n) {
+        s = s + sq(i) - add3(i, sq(i + 1), i * 2) + (i + 1) * sq(2);
+        i = i + 1;
+    }
+    return s;
+}
+int main() {
+    int a[8];
+    int i;
+    float f;
+    long l;
+    calls = 0;
+    printint(poly(3));
+    printint(walk(1000));
+    printint(add3(sq(2), sq(3), sq(4)));
+    printint(add3(1, add3(2, sq(3), 4), add3(sq(5), 6, sq(7))));
+    printint(sum8(1, 2, 3, 4, 5, 6, 7, 8));
+    printint(sum8(sq(1), 2, sq(3), 4, sq(5), 6, sq(7), sq(8)));
+    printint(sum8(1, sq(2), 3, add3(1, 2, sq(2)), 5, 6, sum8(1, 1, 1, 1, 1, 1, 1, sq(3)), sq(4)));
+    i = 0;
+    while (i < 8) {
+        a[i] = sq(i) - sq(i - 1);
+        i = i + 1;
+    }
+    printint(a[0] + a[3] * a[7]);
+    l = 5000000000;
+    printlong(lmix(l, sq(3), lmix(l, 2, sq(4))));
+    f = 3.5;
+    printfloat(fmix(f, sq(2), fhalf(f)) + fhalf(fmix(fhalf(f), 3, f)));
+    printfloat(fhalf(f) * fhalf(fhalf(f)) + f);
+    printint(calls);
+    return 0;
+}
@@ -0,0 +1,68 @@
+int hits;
+long total;
+int fib(int n) {
+    if (n < 2) {
+        return n;
+    }
+    return fib(n - 1) + fib(n - 2);
+}
+int clamp(int x, int lo, int hi) {
+    if (x < lo) return lo;
+    if (x > hi) return hi;
+    hits = hits + 1;
+    return x * 2 - lo;
+}
+long lsel(long a, char c, long b) {
+    if (c == 'a') return a + b * 3;
+    if (a > b) return a - b;
+    return fib(c - 90) + b;
+}
+void note(int x) {
+    if (x < 0) return;
+    if ((x & 1) == 0) return;
+    total = total + x;
+}
+int many(int a, int b, int c, int d, int e, int f, int g, int h) {
+    if (a == 0) return b - c;
+    return a + b + c + d + e + f + g * h + many(a - 1, b, c, d, e, f, g, h);
+}
+int leafy(int n) {
+    int a[6];
+    int i;
+    int s;
+    if (n <= 0) return -1;
+    i = 0;
+    while (i < 6) {
+        a[i] = i;
+        i = i + 1;
+    }
+    s = 0;
+    i = 0;
+    while (i < n) {
+        a[i % 6] = i * 3 + i % 8;
+        s = s + a[i % 6] - a[(i + 3) % 6] * (i % 2);
+        i = i + 1;
+    }
+    return s;
+}
+int main() {
+    int i;
+    hits = 0;
+    total = 0;
+    printint(fib(24));
+    printint(clamp(-5, 0, 10) + clamp(50, 0, 10) * 100 + clamp(7, 1, 10) * 10000);
+    printint(hits);
+    printlong(lsel(5, 'a', 7));
+    printlong(lsel(9000000000, 'b', 7));
+    printlong(lsel(5, 'c', 70));
+    i = -3;
+    while (i < 20) {
+        note(i);
+        i = i + 1;
+    }
+    printlong(total);
+    printint(many(5, 1, 2, 3, 4, 5, 6, 7));
+    printint(leafy(0));
+    printint(leafy(100));
+    return 0;
+}
@@ -0,0 +1,50 @@
+int n = 100;
+long big = 4000000000;
+long wrap = 2147483647 + 1;
+int neg = -(7 * 6) / 4;
+int rem = -17 % 5;
+char c = 200 + 100;
+float pi = 3.25;
+float half = 1 / 2.0;
+float fz = 0.0;
+int truncated = 7.9;
+long fl = -2500000000.75;
+int zero;
+long lzero = 0;
+int *p;
+int dyn = n * 2;
+long dyn2 = big + n;
+int arr[4] = {1, 2, 3};
+long larr[3];
+char buf[3];
+int sq(int x) { return x * x; }
+int called = sq(9);
+
+int main() {
+    printint(n);
+    printlong(big);
+    printlong(wrap);
+    printint(neg);
+    printint(rem);
+    printint(c);
+    printfloat(pi);
+    printfloat(half);
+    printfloat(fz);
+    printint(truncated);
+    printlong(fl);
+    printint(zero);
+    printlong(lzero);
+    printint(dyn);
+    printlong(dyn2);
+    printint(called);
+    p = &n;
+    printint(*p);
+    n = n + 1;
+    printint(n);
+    printint(arr[2] + arr[3]);
+    larr[1] = 5;
+    printlong(larr[0] + larr[1]);
+    buf[2] = 'a';
+    printint(buf[2]);
+    return 0;
+}
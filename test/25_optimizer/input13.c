@@ -0,0 +1,35 @@
+long sum(int n) {
+    int small[3] = {1, 2, 3};
+    char word[7] = {104, 101, 108, 108, 111};
+    long wide[3] = {5000000000, 1, 7};
+    float f[5] = {1.5, 2.25};
+    int grid[3][4] = {{1, 2}, {3, 4, 5, 6}, {7}};
+    int big[200] = {9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33};
+    int mid[40] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    long zeros[100] = {0};
+    long total = 0;
+    int i;
+    int j;
+    for (i = 0; i < 3; i++) total = total + small[i] * (i + 1);
+    for (i = 0; i < 7; i++) total = total + word[i];
+    for (i = 0; i < 3; i++) total = total + wide[i];
+    for (i = 0; i < 3; i++) {
+        for (j = 0; j < 4; j++) total = total + grid[i][j] * (i * 4 + j);
+    }
+    for (i = 0; i < 200; i++) total = total + big[i] * i;
+    for (i = 0; i < 40; i++) total = total + mid[i];
+    for (i = 0; i < 100; i++) total = total + zeros[i];
+    printfloat(f[0] + f[1] + f[2] + f[4]);
+    small[n % 3] = 100;
+    big[n % 200] = 1000;
+    zeros[n % 100] = 5;
+    word[6] = 1;
+    return total;
+}
+
+int main() {
+    printlong(sum(1));
+    printlong(sum(2));
+    printlong(sum(3));
+    return 0;
+}
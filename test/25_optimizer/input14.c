@@ -0,0 +1,115 @@
+int op(int code, int a, int b) {
+    switch (code) {
+        case 0: return a + b;
+        case 1: return a - b;
+        case 2: return a * b;
+        case 3: return a / b;
+        case 4: return a % b;
+        case 6: return a ^ b;
+        case 7: return a << 2;
+        default: return -1;
+    }
+}
+
+int sparse(long x) {
+    int r = 0;
+    switch (x) {
+        case -1000: r = 1; break;
+        case 7: r = 2; break;
+        case 100: r = 3; break;
+        case 5000: r = 4; break;
+        case 123456: r = 5; break;
+        case 9000000000: r = 6; break;
+        case 77:
+        case 78: r = 7; break;
+    }
+    return r;
+}
+
+int vowel(char c) {
+    switch (c) {
+        case 'a': case 'e': case 'i': case 'o': case 'u':
+            return 1;
+        case 'y':
+            return 2;
+    }
+    return 0;
+}
+
+int fall(int n) {
+    int s = 0;
+    switch (n) {
+        case 1: s = s + 1;
+        case 2: s = s + 10;
+        case 3: s = s + 100; break;
+        default: s = 1000;
+        case 4: s = s + 5;
+    }
+    return s;
+}
+
+long run(int n) {
+    int code[12] = {1, 3, 2, 4, 5, 3, 7, 5, 6, 0};
+    long acc = 0;
+    int pc = 0;
+    int steps = 0;
+    while (1) {
+        int op = code[pc];
+        pc = pc + 1;
+        steps++;
+        switch (op) {
+            case 0: return acc * 1000 + steps;
+            case 1: acc = code[pc]; pc++; break;
+            case 2: acc = acc + code[pc]; pc++; break;
+            case 3: acc = acc * code[pc]; pc++; break;
+            case 4: acc = acc - code[pc]; pc++; break;
+            case 5: print acc; break;
+            case 6:
+                if (n > 0) {
+                    n--;
+                    pc = 2;
+                    continue;
+                }
+                break;
+            default: return -1;
+        }
+    }
+}
+
+int main() {
+    int i;
+    long total = 0;
+    for (i = -2; i < 10; i++) total = total * 3 + op(i, 17, 5);
+    print total;
+    total = 0;
+    long keys[10] = {1000, 7, 100, 5000, 123456, 9000000000, 77, 78, 79, 8};
+    for (i = 0; i < 10; i++) total = total * 8 + sparse(keys[i]);
+    print total + sparse(0 - 1000);
+    total = 0;
+    char c;
+    for (c = 'a'; c <= 'z'; c++) total = total + vowel(c) * c;
+    print total;
+    for (i = 0; i < 6; i++) print fall(i);
+    print run(2);
+    int j;
+    total = 0;
+    for (i = 0; i < 5; i++) {
+        j = 0;
+        while (j < 5) {
+            j++;
+            switch (i * 5 + j) {
+                case 3: continue;
+                case 12: break;
+                case 20: case 21: case 22: total = total + 100;
+                default:
+                    switch (j) {
+                        case 1: total = total + i; break;
+                        default: total = total + 1;
+                    }
+            }
+            total = total * 2;
+        }
+    }
+    print total;
+    return 0;
+}
@@ -0,0 +1,46 @@
+int rare(int x) {
+    int y = x * x;
+    if (y > 100) y = y - 100;
+    return y - 7;
+}
+
+long classify(int x) {
+    long r;
+    if (x < 0) {
+        r = 0 - x;
+    } else {
+        r = x * 2;
+    }
+    if (x == 12345) {
+        r = r + rare(x);
+    }
+    if (x % 7 != 3) r = r + 1;
+    else r = r - 1;
+    return r;
+}
+
+int main() {
+    int i;
+    long s = 0;
+    for (i = -20; i < 2000; i++) {
+        s = s + classify(i);
+        if (i > 5000) print rare(i);
+    }
+    print s;
+    float f = 0.5;
+    int below = 0;
+    for (i = 0; i < 50; i++) {
+        if (f < 0.25) below++;
+        else f = f * 0.75;
+    }
+    print below;
+    int c = 0;
+    i = 0;
+    while (i < 300) {
+        if (i < 290) c = c + 2;
+        else c = c + rare(i);
+        i++;
+    }
+    print c;
+    return 0;
+}
@@ -0,0 +1,58 @@
+long gcd(long a, long b) {
+    while (b != 0) {
+        long t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+int count_odd(int n) {
+    int c = 0;
+    int i = 0;
+    while (i < n) {
+        i++;
+        if (i % 2 == 0) continue;
+        c++;
+    }
+    return c;
+}
+
+int main() {
+    int i;
+    int j;
+    long s = 0;
+    for (i = 5; i < 3; i++) s = s + 1000;
+    for (i = 0; i < 0; i++) s = s + 2000;
+    for (i = 10; i >= 0; i--) s = s + i;
+    print s;
+    print gcd(1071, 462) + gcd(17, 0);
+    print count_odd(0) + count_odd(1) * 10 + count_odd(9) * 100;
+    s = 0;
+    for (i = 0; i < 40; i++) {
+        for (j = i; j < 40; j = j + 3) {
+            if (j == 30) break;
+            s = s + i * j;
+        }
+    }
+    print s;
+    i = 0;
+    while (1) {
+        i = i + 7;
+        if (i > 100) break;
+    }
+    print i;
+    long k;
+    s = 0;
+    for (k = 3000000000; k < 3000000010; k++) s = s + k % 7;
+    print s;
+    char c;
+    int vowels = 0;
+    for (c = 'a'; c != 'z'; c++) {
+        switch (c) {
+            case 'a': case 'e': case 'i': case 'o': case 'u': vowels++;
+        }
+    }
+    print vowels;
+    return 0;
+}
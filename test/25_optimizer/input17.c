@@ -0,0 +1,69 @@
+int g;
+int h[8];
+long cells[16];
+
+int bump() {
+    g = g + 1;
+    return g;
+}
+
+void fill(int p[], int n) {
+    int i;
+    for (i = 0; i < n; i++) p[i] = i * 3;
+}
+
+int mix(int p[], int a[], int i) {
+    int x = p[i] + a[i];
+    a[i] = 7;
+    return x + p[i] + a[i];
+}
+
+long histogram(int n) {
+    int i;
+    for (i = 0; i < 16; i++) cells[i] = 0;
+    for (i = 0; i < n; i++) {
+        cells[(i * 7 + 3) % 16] = cells[(i * 7 + 3) % 16] + i;
+        cells[(i * 7 + 3) % 16]++;
+    }
+    long s = 0;
+    for (i = 0; i < 16; i++) s = s + cells[i] * (i + 1);
+    return s;
+}
+
+int main() {
+    int a[8];
+    int i = 2;
+    fill(a, 8);
+    a[i + 1] = a[i + 1] + a[i] * a[i];
+    print a[i + 1];
+
+    g = 5;
+    if (g * 2 > g + 4) print g * 2 - (g + 4);
+    int t = g * 3;
+    bump();
+    print t + g * 3;
+
+    h[2] = 10;
+    int *p = &h[2];
+    int before = h[2] + 1;
+    *p = 20;
+    print before + h[2] + 1;
+
+    int k = i * 5 + 1;
+    if (k > 0) {
+        k = i * 5 + 1 + k;
+    } else {
+        k = 0;
+    }
+    print k + i * 5;
+
+    switch (i) {
+        case 2: i = i + 4;
+        case 6: print i * 5 + 1; break;
+        default: print 0;
+    }
+
+    print mix(a, a, 3);
+    print histogram(100);
+    return 0;
+}
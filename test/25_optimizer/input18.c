@@ -0,0 +1,87 @@
+int scale(int x, int k) {
+    if (k == 0) return x;
+    return x * k;
+}
+
+long triangle() {
+    int n = 20;
+    int i;
+    long s = 0;
+    for (i = 0; i < n; i++) s = s + i;
+    return s;
+}
+
+int nested() {
+    int rows = 6;
+    int cols = rows + 2;
+    int i;
+    int j;
+    int t = 0;
+    for (i = 0; i < rows; i++) {
+        int step = 1;
+        for (j = 0; j < cols; j = j + step) {
+            if (j == 5) step = 2;
+            t = t + i * j;
+        }
+    }
+    return t;
+}
+
+int flow(int x) {
+    int mode = 3;
+    int r = 0;
+    int k = 0;
+    while (k < 10) {
+        k++;
+        if (mode > 2) {
+            r = r + k;
+        } else {
+            r = r - 100;
+        }
+        if (k == 7) {
+            mode = 1;
+            continue;
+        }
+        if (k == 9) break;
+    }
+    switch (mode) {
+        case 1: r = r * 2;
+        case 2: r = r + 1; break;
+        case 3: r = 0;
+        default: r = -1;
+    }
+    return r + x;
+}
+
+int copies(int a) {
+    int b = a;
+    int c = b;
+    int d = c + b;
+    b = 4;
+    return d + c * b;
+}
+
+int area() {
+    float w = 2.5;
+    float h = w * 4.0;
+    int n = 3;
+    return w * h / n;
+}
+
+int main() {
+    print triangle();
+    print nested();
+    print flow(5);
+    print copies(6);
+    print area();
+    print scale(7, 0) + scale(7, 3);
+    int limit = 5;
+    int i;
+    int acc = 1;
+    for (i = 1; i <= limit; i++) acc = acc * 2 + i;
+    print acc;
+    char c = 'a';
+    c = c + 2;
+    print c;
+    return 0;
+}
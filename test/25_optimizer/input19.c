@@ -0,0 +1,51 @@
+int a[20];
+int g;
+int id(int x) {
+    g = g + x;
+    return x;
+}
+int phases(int n) {
+    int i, s, t, u, v, w, k;
+    s = 0;
+    for (i = 0; i < n; i++) {
+        s = s + id(i);
+    }
+    t = s * 2;
+    i = 0;
+    while (i < n) {
+        i++;
+        if (i == 3) continue;
+        t = t - id(a[i - 1]);
+    }
+    u = 1;
+    k = 0;
+    while (k < n) {
+        switch (k % 3) {
+            case 0:
+                u = u + id(k);
+                break;
+            case 1:
+                u = u * 2;
+            default:
+                u = u - 1;
+        }
+        if (u > 1000) break;
+        k++;
+    }
+    v = t + u;
+    w = 0;
+    for (i = 0; i < 4; i++) {
+        w = w + id(v + i);
+    }
+    return w + s;
+}
+int main() {
+    int i;
+    for (i = 0; i < 20; i++) {
+        a[i] = i * i - 7;
+    }
+    print phases(12);
+    print phases(20);
+    print g;
+    return 0;
+}
@@ -0,0 +1,54 @@
+int g[8];
+char s[6];
+
+int mix(int a, int b, int c) {
+    int r = (a & b) + c;
+    r = r + ((a | c) ^ b) * 3;
+    int h = a << 4;
+    int q = a >> 2;
+    return r + h - q;
+}
+
+long total(int v[], int n) {
+    long t = 0;
+    int i;
+    for (i = 0; i < n; i++) t = t + v[i] * 3;
+    return t;
+}
+
+int back(int v[]) {
+    int *p;
+    p = &v[6];
+    return *(p - 1) + *(p - 3);
+}
+
+long bytes(int n) {
+    long t = 0;
+    int i;
+    char c;
+    for (i = 0; i < n; i++) {
+        c = s[i];
+        t = t * 7 + c;
+    }
+    return t;
+}
+
+int main() {
+    int i;
+    for (i = 0; i < 8; i++) g[i] = i * i - 20;
+    s[0] = 200; s[1] = 7; s[2] = 255; s[3] = 31; s[4] = 128; s[5] = 3;
+    print mix(-77, 45, -9);
+    print mix(1000003, -8, 12);
+    print total(g, 8);
+    print back(g);
+    print g[2] + g[7];
+    print bytes(6);
+    int x = -123456;
+    long y = x;
+    int z = (x << 3) ^ (x >> 5);
+    print y * 4;
+    print z;
+    int w = s[0];
+    print w + s[4];
+    return 0;
+}
@@ -0,0 +1,38 @@
+int v[10];
+
+int chain(int a, int b, int c, int d, int e, int f) {
+    return a - (b - (c - (d - (e - f))));
+}
+
+int nested(int i) {
+    return v[i] - (v[i + 1] * (v[i + 2] + (v[i + 3] - v[i + 4] * v[i + 5])));
+}
+
+int deep(int x, int y) {
+    return (x + 1) * (y - (x * (y + (x - (y * 3 + x)))));
+}
+
+void put(int *p, int i, int j) {
+    *(p + (i + j * (i - j + (j - i * 2) + 5))) = i * 100 + j;
+}
+
+float fsum(float a, float b, float c, float d, float e) {
+    return a - (b - (c * (d + e)));
+}
+
+int main() {
+    int i;
+    for (i = 0; i < 10; i++) v[i] = i * 3 - 7;
+    print chain(1, 2, 3, 4, 5, 6);
+    print chain(-40, 17, 9000, -3, 12, 77);
+    print nested(0);
+    print nested(3);
+    print deep(3, 5);
+    print deep(-11, 4);
+    put(v, 2, 1);
+    print v[5];
+    if (v[1] < v[2] - (v[3] - (v[4] - (v[5] - v[6])))) print 1;
+    else print 0;
+    print fsum(1.5, 2.25, 3.0, 4.5, 0.25);
+    return 0;
+}
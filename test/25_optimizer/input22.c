@@ -0,0 +1,83 @@
+int g[16];
+long total;
+char text[8];
+
+long sum(int v[], int n) {
+    long t = 0;
+    int i;
+    for (i = 0; i < n; i++) t = t + v[i] + 5;
+    return t;
+}
+
+int window(int *p, int i) {
+    return *(p + i + 1) - *(p + 2) + *(p + i - 1) * 3;
+}
+
+int bits(int x, long y) {
+    int r = x << 3;
+    r = r ^ (x >> 2);
+    y = y >> 4;
+    return r + (y & 255);
+}
+
+float dot(float a[], float b[], int n) {
+    float s = 0.0;
+    int i;
+    for (i = 0; i < n; i++) s = s + a[i] * b[i];
+    return s;
+}
+
+int count(char s[], char c) {
+    int k = 0;
+    int i;
+    for (i = 0; s[i] != 0; i++) {
+        if (s[i] == c) k++;
+    }
+    return k;
+}
+
+int main() {
+    long w[6];
+    float fa[4];
+    float fb[4];
+    int i;
+    int *p;
+    for (i = 0; i < 16; i++) g[i] = i * i - 20;
+    print sum(g, 16);
+    p = &g[4];
+    print window(p, 3);
+    print *(p - 2) + g[i - 1];
+    g[3]++;
+    g[i - 6]--;
+    g[0]--;
+    *(p + 1) = 0;
+    *(p + 2) = -9;
+    print g[3] + g[10] + g[0] + g[5] + g[6];
+    for (i = 0; i < 6; i++) {
+        w[i] = i;
+        w[i] = w[i] * 1000000000;
+    }
+    total = 7;
+    for (i = 0; i < 6; i++) total = total + w[i];
+    total = total - w[2];
+    print total / 1000;
+    w[5] = w[4] - w[1];
+    if (w[5] > w[3]) print 1;
+    else print 0;
+    print bits(-77, 123456789);
+    for (i = 0; i < 4; i++) {
+        fa[i] = i + 0.5;
+        fb[i] = 4 - i;
+    }
+    print dot(fa, fb, 4);
+    text[0] = 'b';
+    text[1] = 'a';
+    text[2] = 'n';
+    text[3] = 'a';
+    text[4] = 'n';
+    text[5] = 'a';
+    text[6] = 0;
+    print count(text, 'a');
+    print count(text, 'n');
+    return 0;
+}
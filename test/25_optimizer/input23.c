@@ -0,0 +1,161 @@
+int data[12];
+long limit;
+
+int imax(int x, int y) {
+    int m;
+    if (x > y) m = x;
+    else m = y;
+    return m;
+}
+
+long clamp(long v, long lo, long hi) {
+    if (v < lo) v = lo;
+    if (v > hi) v = hi;
+    return v;
+}
+
+int absdiff(int x, int y) {
+    int d;
+    if (x - y < 0) d = y - x;
+    else d = x - y;
+    return d;
+}
+
+int later(int *p, int *q, int a, int b) {
+    if (a < b) p = q;
+    return *p;
+}
+
+void capall(int n) {
+    int i;
+    for (i = 0; i < n; i++) {
+        long v = data[i];
+        if (v > limit) limit = v + 1;
+    }
+}
+
+void sort(int n) {
+    int i;
+    int j;
+    for (i = 0; i < n; i++) {
+        int min = i;
+        int t;
+        for (j = i + 1; j < n; j++) {
+            if (data[j] < data[min]) min = j;
+        }
+        t = data[i];
+        data[i] = data[min];
+        data[min] = t;
+    }
+}
+
+float fsmall(float x, float y) {
+    float m;
+    if (x < y) m = x;
+    else m = y;
+    return m;
+}
+
+float fbig(float x, float y) {
+    float m = x;
+    if (m < y) m = y;
+    return m;
+}
+
+float pick(float x, float y, float p, float q, int op) {
+    float r;
+    if (op == 0) {
+        if (x == y) r = p;
+        else r = q;
+    } else if (op == 1) {
+        if (x != y) r = p;
+        else r = q;
+    } else if (op == 2) {
+        if (x <= y) r = p;
+        else r = q;
+    } else {
+        if (x > y) r = p + 1.0;
+        else r = q;
+    }
+    return r;
+}
+
+int scaled(int a) {
+    int t;
+    int m;
+    t = a * 3;
+    if (t > 5) {
+        m = 0;
+    } else {
+        m = 3;
+    }
+    return m;
+}
+
+int shifted(int a) {
+    int t;
+    int m;
+    t = a + a;
+    if (t < 4) m = t + 1;
+    else m = 9;
+    return m;
+}
+
+int runs(int n) {
+    int i;
+    int s = 0;
+    for (i = 1; i < n; i++) {
+        int t;
+        int m;
+        t = data[i] - data[i - 1];
+        if (t > 0) m = t;
+        else m = 0;
+        s = s + m * i;
+    }
+    return s;
+}
+
+int peaks(int n) {
+    int i;
+    int s = 0;
+    for (i = 0; i < n; i++) {
+        int t;
+        int m;
+        t = data[i] * 2 + i;
+        if (t < data[i]) {
+            m = 1;
+        } else {
+            m = 5;
+        }
+        s = s + m;
+    }
+    return s;
+}
+
+int main() {
+    int i;
+    float zero = 0.0;
+    float nan;
+    for (i = 0; i < 12; i++) data[i] = (i * 53) % 17 - 8;
+    print imax(3, 9) + imax(-2, -7);
+    print clamp(-50, -10, 10) + clamp(5, -10, 10) * 100 + clamp(99, -10, 10) * 10000;
+    print absdiff(4, 11) + absdiff(11, 4) * 10;
+    print later(&data[2], &data[5], 1, 2) + later(&data[7], &data[1], 2, 1) * 10;
+    limit = 0;
+    capall(12);
+    print limit;
+    sort(12);
+    for (i = 0; i < 12; i++) print data[i];
+    print fsmall(2.5, 1.25) + fsmall(3.0, 0.5);
+    print fbig(2.5, 1.25) + fbig(3.0, 0.5);
+    nan = zero / zero;
+    print fsmall(nan, 1.5);
+    print fbig(2.0, nan);
+    for (i = 0; i < 4; i++) {
+        print pick(1.0, 2.0, 10.0, 20.0, i) + pick(2.0, 2.0, 100.0, 200.0, i) + pick(nan, 2.0, 1000.0, 2000.0, i);
+    }
+    for (i = -2; i < 4; i++) print scaled(i) + shifted(i) * 10;
+    print runs(12);
+    print peaks(12);
+    return 0;
+}
@@ -0,0 +1,61 @@
+int a[40];
+long m[8][8];
+
+long sum(int v[], int n) {
+    long t = 0;
+    int i;
+    for (i = 0; i < n; i++) t = t + v[i] * 3;
+    return t;
+}
+
+int inclusive(int lo, int hi) {
+    int s = 0;
+    int i;
+    for (i = lo; hi >= i; i++) {
+        int d = a[i] - i;
+        s = s + d * d;
+    }
+    return s + i;
+}
+
+long matrix(int n) {
+    long t = 0;
+    int i;
+    long j;
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < 8; j = j + 1) m[i][j] = i * j + 1;
+    }
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < 8; j++) t = t + m[i][j] * m[j][i];
+    }
+    return t + j;
+}
+
+int find(int x, int n) {
+    int i;
+    for (i = 0; i < n; i++) {
+        if (a[i] == x) break;
+    }
+    return i;
+}
+
+int main() {
+    int i;
+    int k = 0;
+    for (i = 0; i < 40; i++) a[i] = (i * 7) % 11 - 3;
+    for (i = 3; i < 7; i++) k = k * 10 + a[i];
+    print k;
+    print i;
+    print sum(a, 40);
+    print sum(a, 37);
+    print sum(a, 5);
+    print sum(a, 0);
+    print inclusive(2, 33);
+    print inclusive(10, 12);
+    print inclusive(5, 4);
+    print matrix(8);
+    print matrix(3);
+    print find(7, 40);
+    print find(100, 40);
+    return 0;
+}
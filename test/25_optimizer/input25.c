@@ -0,0 +1,75 @@
+int size = 20;
+long scale = 3;
+float ratio = 0.5;
+int table[64];
+int hits;
+
+long fill(int v[], int n, int step) {
+    long t = 0;
+    int i;
+    for (i = 0; i < n; i = i + step) {
+        v[i] = i * scale;
+        t = t + v[i];
+        if (t > 1000) t = t - 1000;
+    }
+    return t;
+}
+
+int power(int x, int e) {
+    int r;
+    if (e == 0) return 1;
+    r = power(x, e / 2);
+    r = r * r;
+    if (e % 2 == 1) r = r * x;
+    return r;
+}
+
+int walk(int n, int mode) {
+    int k = 0;
+    int i;
+    while (n > 0) {
+        if (mode == 1) k = k + n;
+        else if (mode == 2) k = k + n * n;
+        else k = k - 1;
+        for (i = 0; i < 3; i++) hits++;
+        n--;
+    }
+    return k;
+}
+
+float blend(float a, float b, float w) {
+    float s = 0.0;
+    int i;
+    for (i = 0; i < size; i++) {
+        s = s + a * w + b * (1.0 - w);
+        if (s > 100.0) s = s / 2.0;
+    }
+    return s;
+}
+
+int countdown(int n, int limit) {
+    int c = 0;
+    int j;
+    limit = limit * 2;
+    while (n > limit) {
+        n = n - 1;
+        c++;
+        for (j = 0; j < limit; j = j + 5) hits = hits + j % 3;
+        if (c % 4 == 0) hits = hits - c;
+    }
+    return c;
+}
+
+int main() {
+    int i;
+    long t = 0;
+    for (i = 0; i < 4; i++) t = t + fill(table, size, 2) + fill(table, 64, i + 1);
+    print t;
+    print power(3, 5) + power(2, 10) + power(7, 0);
+    for (i = 0; i < 3; i++) print walk(i + 4, 1) + walk(i, 2) + walk(5, i);
+    print hits;
+    print blend(1.5, 2.5, ratio) + blend(3.0, 1.0, 0.25);
+    print countdown(50, 7) + countdown(30, 7) * 100;
+    print hits;
+    return 0;
+}
@@ -0,0 +1,42 @@
+int plus(int x) {
+    int r = 0;
+    if (x + 7) r = 1;
+    return r;
+}
+
+int minus(int x) {
+    int r;
+    if (x - 3) {
+        r = 10;
+    } else {
+        r = 20;
+    }
+    return r;
+}
+
+int rplus(int x) {
+    int r = 0;
+    if (5 + x) r = 2;
+    return r;
+}
+
+long wide(long l) {
+    long r = 0;
+    if (l + 5) r = l;
+    return r;
+}
+
+int main() {
+    int i;
+    int k;
+    int none = 0;
+    for (i = -8; i < 5; i = i + 1) {
+        print plus(i) + minus(i) + rplus(i);
+        print wide(i);
+        k = i * 2;
+        if (k - 4) none = none + 1;
+        if (k + 6) none = none + 10;
+    }
+    print none;
+    return 0;
+}
@@ -0,0 +1,6 @@
+4
+3
+35
+150
+8
+120
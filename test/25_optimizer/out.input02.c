@@ -0,0 +1,11 @@
+3616724
+214748364
+7
+-214748364
+-8
+-536870912
+0
+1
+0
+91880262178
+249787810
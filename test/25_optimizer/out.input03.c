@@ -0,0 +1,13 @@
+10576
+32580
+-95
+615.000000
+58
+78
+18420
+16
+4
+12
+72000000000072
+0
+0
@@ -0,0 +1,14 @@
+1434
+1711186032
+173
+45
+-1
+3333333333330
+38.500000
+2385
+2352
+-6
+15
+190
+16
+20
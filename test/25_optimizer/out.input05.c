@@ -0,0 +1,7 @@
+281297788
+15438315
+94
+568
+2610273527736
+36.191112
+19
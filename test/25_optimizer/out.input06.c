@@ -0,0 +1,10 @@
+2550
+570
+308
+150
+720
+99
+25
+3.000000
+30
+24
@@ -0,0 +1,10 @@
+50000005000000
+21
+2432902008176640000
+1073741824
+3
+703
+111
+6765
+42
+3.000000
@@ -0,0 +1,5 @@
+81
+16
+832040
+5413
+42
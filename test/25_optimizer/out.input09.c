@@ -0,0 +1,17 @@
+575
+55
+46
+16
+13
+6
+8
+4
+63
+10
+21
+7
+4
+2
+1
+2
+3
@@ -0,0 +1,12 @@
+405
+-496500
+29
+96
+204
+1064
+935
+64
+35000000016
+20.125000
+5.031250
+3038
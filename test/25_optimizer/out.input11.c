@@ -0,0 +1,10 @@
+46368
+131000
+1
+26
+8999999993
+104
+100
+299
+-1
+7988
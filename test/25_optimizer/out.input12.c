@@ -0,0 +1,21 @@
+100
+4000000000
+-2147483648
+-10
+-2
+44
+3.250000
+0.500000
+0.000000
+7
+-2500000000
+0
+0
+200
+4000000100
+81
+100
+101
+3
+5
+97
@@ -0,0 +1,6 @@
+3.750000
+5000018469
+3.750000
+5000018469
+3.750000
+5000018469
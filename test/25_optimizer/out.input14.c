@@ -0,0 +1,17 @@
+465197
+41086913
+773
+1005
+111
+110
+100
+5
+1005
+7
+49
+53
+371
+375
+2625
+2625017
+16806942
@@ -0,0 +1,3 @@
+3999658
+47
+866895
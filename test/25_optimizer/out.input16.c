@@ -0,0 +1,7 @@
+55
+38
+510
+89069
+105
+36
+5
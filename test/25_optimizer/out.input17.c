@@ -0,0 +1,8 @@
+45
+1
+33
+32
+32
+31
+104
+42404
@@ -0,0 +1,8 @@
+190
+330
+-338
+36
+8
+28
+89
+99
@@ -0,0 +1,3 @@
+-892
+-5236
+-3289
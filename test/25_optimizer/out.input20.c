@@ -0,0 +1,9 @@
+-1302
+13750033
+-60
+-6
+13
+3468090
+-493824
+990958
+328
@@ -0,0 +1,9 @@
+-3
+8881
+-163
+1097
+140
+840
+201
+0
+13.500000
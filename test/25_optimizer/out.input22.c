@@ -0,0 +1,10 @@
+1000
+76
+189
+39
+13000000
+0
+837
+15.000000
+3
+2
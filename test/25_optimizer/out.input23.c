@@ -0,0 +1,33 @@
+7
+100490
+77
+62
+9
+-8
+-7
+-6
+-5
+-4
+-3
+-2
+0
+2
+4
+6
+8
+1.750000
+5.500000
+1.500000
+2.000000
+2120.000000
+1210.000000
+2110.000000
+2220.000000
+-27
+-7
+13
+33
+90
+90
+111
+44
@@ -0,0 +1,13 @@
+7296
+7
+246
+222
+33
+0
+11036
+354
+5
+21240
+900
+3
+40
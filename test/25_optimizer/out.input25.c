@@ -0,0 +1,9 @@
+2623
+1268
+5
+31
+81
+99
+70.000000
+1636
+35
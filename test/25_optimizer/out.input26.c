@@ -0,0 +1,27 @@
+13
+-8
+12
+-7
+13
+-6
+11
+0
+13
+-4
+13
+-3
+13
+-2
+13
+-1
+13
+0
+13
+1
+13
+2
+23
+3
+13
+4
+132